@@ -243,6 +243,8 @@ typedef long aom_codec_flags_t;
 // when an experimental feature you use is modified or removed. If you are not
 // sure, DO NOT use experimental features.
 #define AOM_CODEC_USE_EXPERIMENTAL 0x1 /**< Enables experimental features */
+/*!\brief Tracks memory usage per subsystem, see ::aom_mem_usage_t */
+#define AOM_CODEC_USE_MEM_ACCOUNTING 0x2
 
 /*!\brief Time Stamp Type
  *
@@ -350,6 +352,82 @@ typedef enum aom_superblock_size {
   AOM_SUPERBLOCK_SIZE_DYNAMIC  /**< Select superblock size dynamically. */
 } aom_superblock_size_t;
 
+/*!\brief Memory allocation tags.
+ *
+ * Identifies the subsystem that makes an allocation through an
+ * ::aom_codec_allocator_t.
+ */
+typedef enum aom_mem_tag {
+  AOM_MEM_TAG_OTHER,           /**< Not attributed to a subsystem */
+  AOM_MEM_TAG_FRAME_BUFFER,    /**< Frame buffer pixel data */
+  AOM_MEM_TAG_MODE_INFO,       /**< Mode info arrays */
+  AOM_MEM_TAG_TPL_STATS,       /**< TPL model statistics */
+  AOM_MEM_TAG_LOOKAHEAD,       /**< Encoder lookahead queue */
+  AOM_MEM_TAG_PC_TREE,         /**< Partition search context trees */
+  AOM_MEM_TAG_THREAD_DATA,     /**< Per-thread encoder data */
+  AOM_MEM_TAG_FIRSTPASS_STATS, /**< First pass statistics */
+  AOM_MEM_TAG_LOOP_FILTER,     /**< Loop filter, CDEF and LR scratch */
+  AOM_MEM_TAG_COUNT            /**< Number of tags */
+} aom_mem_tag_t;
+
+/*!\brief Allocation callback prototype
+ *
+ * Returns a block of at least size bytes, or NULL on failure. The block only
+ * needs the alignment malloc() would give it; the codec aligns within it.
+ * Both size and tag are passed back to the matching ::aom_free_cb_fn_t, so
+ * the callback may serve different sizes or tags from different pools.
+ */
+typedef void *(*aom_alloc_cb_fn_t)(void *priv, size_t size, aom_mem_tag_t tag);
+
+/*!\brief Free callback prototype
+ *
+ * Releases a block returned by the ::aom_alloc_cb_fn_t, called with the size
+ * and tag the block was allocated with.
+ */
+typedef void (*aom_free_cb_fn_t)(void *priv, void *ptr, size_t size,
+                                 aom_mem_tag_t tag);
+
+/*!\brief Codec allocator
+ *
+ * Passed to aom_codec_enc_init_with_allocator() or
+ * aom_codec_dec_init_with_allocator() to route the memory a codec instance
+ * allocates. The callbacks are called from the
+ * thread calling into the codec and from its worker threads, so they must
+ * be thread safe. The allocator must outlive the codec instance.
+ */
+typedef struct aom_codec_allocator {
+  /*!\brief Allocation callback, or NULL to use the built-in allocator. */
+  aom_alloc_cb_fn_t alloc_cb;
+  /*!\brief Free callback, required if alloc_cb is set. */
+  aom_free_cb_fn_t free_cb;
+  /*!\brief Private data passed to the callbacks. */
+  void *cb_priv;
+  /*!\brief Back large frame buffers, mode info and TPL stats with 2 MB
+   * transparent huge pages where the platform supports them. Only used by
+   * the built-in allocator.
+   */
+  int use_huge_pages;
+} aom_codec_allocator_t;
+
+/*!\brief Memory usage per subsystem
+ *
+ * Reported by codec instances initialized with the
+ * #AOM_CODEC_USE_MEM_ACCOUNTING flag. Sizes include the alignment padding of
+ * each allocation.
+ */
+typedef struct aom_mem_usage {
+  size_t current_bytes[AOM_MEM_TAG_COUNT]; /**< Allocated now, per tag */
+  size_t peak_bytes[AOM_MEM_TAG_COUNT];    /**< Most ever allocated, per tag */
+  size_t total_current_bytes;              /**< Allocated now */
+  size_t total_peak_bytes;                 /**< Most ever allocated */
+} aom_mem_usage_t;
+
+/*!\brief Returns a short description of a memory tag, for reports.
+ *
+ * \param[in]     tag            The tag to describe.
+ */
+const char *aom_mem_tag_to_string(aom_mem_tag_t tag);
+
 /*
  * Library Version Number Interface
  *
@@ -129,6 +129,39 @@ aom_codec_err_t aom_codec_dec_init_ver(aom_codec_ctx_t *ctx,
 #define aom_codec_dec_init(ctx, iface, cfg, flags) \
   aom_codec_dec_init_ver(ctx, iface, cfg, flags, AOM_DECODER_ABI_VERSION)
 
+/*!\brief Initialize a decoder instance with an allocator
+ *
+ * Like aom_codec_dec_init_ver(), but all the memory the decoder instance
+ * allocates, from init until aom_codec_destroy(), is routed through
+ * allocator. Applications should call the aom_codec_dec_init_with_allocator
+ * convenience macro instead of this function directly.
+ *
+ * \param[in]    ctx       Pointer to this instance's context.
+ * \param[in]    iface     Pointer to the algorithm interface to use.
+ * \param[in]    cfg       Configuration to use, if known. May be NULL.
+ * \param[in]    flags     Bitfield of AOM_CODEC_USE_* flags
+ * \param[in]    allocator Allocator for the decoder's memory, or NULL to use
+ *                         malloc(). Must outlive the decoder instance.
+ * \param[in]    ver       ABI version number. Must be set to
+ *                         AOM_DECODER_ABI_VERSION
+ * \retval #AOM_CODEC_OK
+ *     The decoder algorithm has been initialized.
+ * \retval #AOM_CODEC_MEM_ERROR
+ *     Memory allocation failed.
+ */
+aom_codec_err_t aom_codec_dec_init_with_allocator_ver(
+    aom_codec_ctx_t *ctx, aom_codec_iface_t *iface,
+    const aom_codec_dec_cfg_t *cfg, aom_codec_flags_t flags,
+    const aom_codec_allocator_t *allocator, int ver);
+
+/*!\brief Convenience macro for aom_codec_dec_init_with_allocator_ver()
+ *
+ * Ensures the ABI version parameter is properly set.
+ */
+#define aom_codec_dec_init_with_allocator(ctx, iface, cfg, flags, allocator) \
+  aom_codec_dec_init_with_allocator_ver(ctx, iface, cfg, flags, allocator,  \
+                                        AOM_DECODER_ABI_VERSION)
+
 /*!\brief Parse stream info from a buffer
  *
  * Performs high level parsing of the bitstream. Construction of a decoder
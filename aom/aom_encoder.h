@@ -943,6 +943,39 @@ aom_codec_err_t aom_codec_enc_init_ver(aom_codec_ctx_t *ctx,
 #define aom_codec_enc_init(ctx, iface, cfg, flags) \
   aom_codec_enc_init_ver(ctx, iface, cfg, flags, AOM_ENCODER_ABI_VERSION)
 
+/*!\brief Initialize an encoder instance with an allocator
+ *
+ * Like aom_codec_enc_init_ver(), but all the memory the encoder instance
+ * allocates, from init until aom_codec_destroy(), is routed through
+ * allocator. Applications should call the aom_codec_enc_init_with_allocator
+ * convenience macro instead of this function directly.
+ *
+ * \param[in]    ctx       Pointer to this instance's context.
+ * \param[in]    iface     Pointer to the algorithm interface to use.
+ * \param[in]    cfg       Configuration to use, if known.
+ * \param[in]    flags     Bitfield of AOM_CODEC_USE_* flags
+ * \param[in]    allocator Allocator for the encoder's memory, or NULL to use
+ *                         malloc(). Must outlive the encoder instance.
+ * \param[in]    ver       ABI version number. Must be set to
+ *                         AOM_ENCODER_ABI_VERSION
+ * \retval #AOM_CODEC_OK
+ *     The encoder algorithm has been initialized.
+ * \retval #AOM_CODEC_MEM_ERROR
+ *     Memory allocation failed.
+ */
+aom_codec_err_t aom_codec_enc_init_with_allocator_ver(
+    aom_codec_ctx_t *ctx, aom_codec_iface_t *iface,
+    const aom_codec_enc_cfg_t *cfg, aom_codec_flags_t flags,
+    const aom_codec_allocator_t *allocator, int ver);
+
+/*!\brief Convenience macro for aom_codec_enc_init_with_allocator_ver()
+ *
+ * Ensures the ABI version parameter is properly set.
+ */
+#define aom_codec_enc_init_with_allocator(ctx, iface, cfg, flags, allocator) \
+  aom_codec_enc_init_with_allocator_ver(ctx, iface, cfg, flags, allocator,  \
+                                        AOM_ENCODER_ABI_VERSION)
+
 /*!\brief Get the default configuration for a usage.
  *
  * Initializes an encoder configuration structure with default values. Supports
@@ -1085,6 +1118,14 @@ aom_codec_err_t aom_codec_encode(aom_codec_ctx_t *ctx, const aom_image_t *img,
  * that may output multiple packets for a single encoded frame (e.g., lagged
  * encoding) or if the application does not reset the buffer periodically.
  *
+ * By default the packet is copied into the buffer if it fits, and no byte
+ * past the end of the packet is written. With AV1E_SET_ZERO_COPY_OUTPUT
+ * enabled, the AV1 encoder writes the compressed data directly into the
+ * buffer, without an intermediate copy, when `pad_after` is 0 and the space
+ * left in the buffer has room for each frame of the temporal unit: twice the
+ * size of an uncompressed frame plus 8192 bytes. In that case the space past
+ * the end of the packet may be used as scratch space.
+ *
  * Applications may restore the default behavior of the codec providing
  * the compressed data buffer by calling this function with a NULL
  * buffer.
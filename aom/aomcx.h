@@ -1577,6 +1577,90 @@ enum aome_enc_control_id {
    */
   AV1E_SET_MAX_CONSEC_FRAME_DROP_MS_CBR = 169,
 
+  /*!\brief Codec control to set the encode time budget per frame, in
+   * microseconds, for realtime encoding, unsigned int parameter.
+   *
+   * When set, the encoder measures how long each frame takes to encode and
+   * raises the speed used for the following frames above the one set by
+   * AOME_SET_CPUUSED while it is over budget, lowering it again once there is
+   * enough headroom. For spatial layers the budget applies to each layer
+   * frame. Value of 0 (default) disables it.
+   */
+  AV1E_SET_RTC_FRAME_TIME_BUDGET = 170,
+
+  /*!\brief Codec control to get the encode time budget statistics,
+   * aom_rtc_time_budget_stats_t* parameter.
+   */
+  AV1E_GET_RTC_TIME_BUDGET_STATS = 171,
+
+  /*!\brief Codec control to let the encoder keep using the memory of input
+   * images instead of copying them into its lookahead buffers,
+   * aom_zero_copy_input_t* parameter.
+   *
+   * An image is borrowed when it has the layout of the lookahead buffers:
+   * the same strides, 32-byte aligned luma and 16-byte aligned chroma planes,
+   * and at least the border returned by AV1E_GET_INPUT_BORDER. Images
+   * allocated by aom_img_alloc_with_border() with an align of 32, a
+   * size_align of 8 and that border have this layout. Monochrome and NV12
+   * images, and images that do not meet these conditions, are copied as
+   * before. The encoder writes the extended borders into the padding of a
+   * borrowed image, so the application must neither read nor modify the
+   * image, padding included, until its release callback is called.
+   *
+   * Once this control is set, the release callback is called exactly once
+   * for every image passed to the encoder by aom_codec_encode(): right away
+   * when the image was copied or could not be queued, and otherwise when the
+   * encoder no longer needs it, at the latest when the encoder is destroyed.
+   * The callback receives the image's user_priv. Images that
+   * aom_codec_encode() rejects before they reach the encoder, for a zero
+   * duration or a bit depth that does not match the
+   * AOM_CODEC_USE_HIGHBITDEPTH flag, are not released. Must be set before
+   * the first frame is encoded; passing NULL or a NULL callback disables
+   * zero copy.
+   */
+  AV1E_SET_ZERO_COPY_INPUT = 172,
+
+  /*!\brief Codec control to get the border, in luma pixels, of the
+   * encoder's lookahead buffers, int* parameter. Before the first frame is
+   * encoded, this is the border for the current configuration, so it should
+   * be queried after all other controls are set.
+   */
+  AV1E_GET_INPUT_BORDER = 173,
+
+  /*!\brief Codec control to get the encoder's memory usage per subsystem,
+   * aom_mem_usage_t* parameter. Requires the encoder to be initialized with
+   * the AOM_CODEC_USE_MEM_ACCOUNTING flag.
+   */
+  AV1E_GET_MEM_USAGE = 174,
+
+  /*!\brief Codec control to time the encoder stages listed in
+   * aom_enc_stage_t, unsigned int parameter
+   *
+   * - 0 = disable (default)
+   * - 1 = enable
+   *
+   * The timings are read with AV1E_GET_STAGE_TIMINGS. When disabled, the
+   * encoder does not read the clock.
+   */
+  AV1E_SET_STAGE_TIMING = 175,
+
+  /*!\brief Codec control to get the time spent in each encoder stage,
+   * aom_enc_stage_timings_t* parameter. Returns AOM_CODEC_INCAPABLE unless
+   * AV1E_SET_STAGE_TIMING is enabled.
+   */
+  AV1E_GET_STAGE_TIMINGS = 176,
+
+  /*!\brief Codec control to write the compressed data straight into the
+   * buffer set with aom_codec_set_cx_data_buf(), unsigned int parameter
+   *
+   * - 0 = disable (default)
+   * - 1 = enable
+   *
+   * When enabled, the encoder may use the space in that buffer past the end
+   * of the packet as scratch space. See aom_codec_set_cx_data_buf().
+   */
+  AV1E_SET_ZERO_COPY_OUTPUT = 177,
+
   // Any new encoder control IDs should be added above.
   // Maximum allowed encoder control ID is 229.
   // No encoder control ID should be added below.
@@ -1776,6 +1860,65 @@ typedef struct aom_svc_ref_frame_comp_pred {
   int use_comp_pred[3]; /**<Compound reference flag. */
 } aom_svc_ref_frame_comp_pred_t;
 
+/*!brief Encode time budget statistics for realtime encoding */
+typedef struct aom_rtc_time_budget_stats {
+  unsigned int budget_us;         /**< Encode time budget per frame */
+  unsigned int last_time_us;      /**< Encode time of the last frame */
+  unsigned int avg_time_us;       /**< Smoothed encode time of non key frames */
+  unsigned int frame_count;       /**< Frames encoded with a budget */
+  unsigned int over_budget_count; /**< Frames that went over budget */
+  int speed;                      /**< Speed used for the last frame */
+} aom_rtc_time_budget_stats_t;
+
+/*!brief Callback releasing an input image borrowed by the encoder
+ *
+ * \param[in] cb_priv    The cb_priv member of aom_zero_copy_input_t
+ * \param[in] user_priv  The user_priv member of the released image
+ */
+typedef void (*aom_release_input_cb_fn_t)(void *cb_priv, void *user_priv);
+
+/*!brief Parameters for zero copy input, see AV1E_SET_ZERO_COPY_INPUT */
+typedef struct aom_zero_copy_input {
+  aom_release_input_cb_fn_t release_cb; /**< Called when an image is freed */
+  void *cb_priv;                        /**< Private data for release_cb */
+  /*!
+   * Writable padding, in luma pixels, around each input image after its
+   * width and height are rounded up to a multiple of 8. The chroma padding
+   * is this value shifted by the chroma subsampling.
+   */
+  unsigned int border;
+} aom_zero_copy_input_t;
+
+/*!brief Encoder stages timed by AV1E_SET_STAGE_TIMING */
+typedef enum {
+  AOM_ENC_STAGE_FIRST_PASS,         /**< First pass analysis */
+  AOM_ENC_STAGE_TEMPORAL_FILTER,    /**< Temporal filtering of ARF sources */
+  AOM_ENC_STAGE_TPL,                /**< TPL model construction */
+  AOM_ENC_STAGE_MOTION_SEARCH,      /**< Motion search of the final encode */
+  AOM_ENC_STAGE_RD,                 /**< Mode and partition search, minus ME */
+  AOM_ENC_STAGE_LOOP_FILTER_SEARCH, /**< Deblocking filter level search */
+  AOM_ENC_STAGE_CDEF_SEARCH,        /**< CDEF strength search */
+  AOM_ENC_STAGE_RESTORATION_SEARCH, /**< Loop restoration search */
+  AOM_ENC_STAGE_PACK,               /**< Bitstream packing */
+  AOM_ENC_STAGE_COUNT               /**< Number of stages */
+} aom_enc_stage_t;
+
+/*!brief Encoder stage timings, see AV1E_GET_STAGE_TIMINGS
+ *
+ * AOM_ENC_STAGE_MOTION_SEARCH and AOM_ENC_STAGE_RD are CPU time summed over
+ * the encoding threads; the other stages are elapsed time.
+ */
+typedef struct aom_enc_stage_timings {
+  /*!
+   * Microseconds spent in each stage by the last aom_codec_encode() call
+   */
+  int64_t frame_us[AOM_ENC_STAGE_COUNT];
+  /*!
+   * Microseconds spent in each stage since timing was enabled
+   */
+  int64_t total_us[AOM_ENC_STAGE_COUNT];
+} aom_enc_stage_timings_t;
+
 /*!brief Frame drop modes for spatial/quality layer SVC */
 typedef enum {
   AOM_LAYER_DROP,           /**< Any spatial layer can drop. */
@@ -2279,6 +2422,31 @@ AOM_CTRL_USE_TYPE(AV1E_SET_POSTENCODE_DROP_RTC, int)
 AOM_CTRL_USE_TYPE(AV1E_SET_MAX_CONSEC_FRAME_DROP_MS_CBR, int)
 #define AOM_CTRL_AV1E_SET_MAX_CONSEC_FRAME_DROP_MS_CBR
 
+AOM_CTRL_USE_TYPE(AV1E_SET_RTC_FRAME_TIME_BUDGET, unsigned int)
+#define AOM_CTRL_AV1E_SET_RTC_FRAME_TIME_BUDGET
+
+AOM_CTRL_USE_TYPE(AV1E_GET_RTC_TIME_BUDGET_STATS,
+                  aom_rtc_time_budget_stats_t *)
+#define AOM_CTRL_AV1E_GET_RTC_TIME_BUDGET_STATS
+
+AOM_CTRL_USE_TYPE(AV1E_SET_ZERO_COPY_INPUT, aom_zero_copy_input_t *)
+#define AOM_CTRL_AV1E_SET_ZERO_COPY_INPUT
+
+AOM_CTRL_USE_TYPE(AV1E_GET_INPUT_BORDER, int *)
+#define AOM_CTRL_AV1E_GET_INPUT_BORDER
+
+AOM_CTRL_USE_TYPE(AV1E_GET_MEM_USAGE, aom_mem_usage_t *)
+#define AOM_CTRL_AV1E_GET_MEM_USAGE
+
+AOM_CTRL_USE_TYPE(AV1E_SET_STAGE_TIMING, unsigned int)
+#define AOM_CTRL_AV1E_SET_STAGE_TIMING
+
+AOM_CTRL_USE_TYPE(AV1E_GET_STAGE_TIMINGS, aom_enc_stage_timings_t *)
+#define AOM_CTRL_AV1E_GET_STAGE_TIMINGS
+
+AOM_CTRL_USE_TYPE(AV1E_SET_ZERO_COPY_OUTPUT, unsigned int)
+#define AOM_CTRL_AV1E_SET_ZERO_COPY_OUTPUT
+
 /*!\endcond */
 /*! @} - end defgroup aom_encoder */
 #ifdef __cplusplus
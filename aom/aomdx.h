@@ -183,6 +183,29 @@ typedef struct av1_ext_ref_frame {
   int num;
 } av1_ext_ref_frame_t;
 
+/*!\brief Decoder stages timed by AV1D_SET_STAGE_TIMING */
+typedef enum {
+  AOM_DEC_STAGE_PARSE,            /**< Mode info and coefficient parsing */
+  AOM_DEC_STAGE_RECON,            /**< Prediction and reconstruction */
+  AOM_DEC_STAGE_LOOP_FILTER,      /**< Deblocking filter */
+  AOM_DEC_STAGE_CDEF,             /**< CDEF */
+  AOM_DEC_STAGE_SUPERRES,         /**< Super-resolution upscaling */
+  AOM_DEC_STAGE_LOOP_RESTORATION, /**< Loop restoration */
+  AOM_DEC_STAGE_COUNT             /**< Number of stages */
+} aom_dec_stage_t;
+
+/*!\brief Decoder stage timings, see AV1D_GET_STAGE_TIMINGS
+ *
+ * AOM_DEC_STAGE_PARSE and AOM_DEC_STAGE_RECON are CPU time summed over the
+ * tile decoding threads; the filter stages are elapsed time.
+ */
+typedef struct aom_dec_stage_timings {
+  /*! Microseconds spent in each stage by the last aom_codec_decode() call. */
+  int64_t frame_us[AOM_DEC_STAGE_COUNT];
+  /*! Microseconds spent in each stage since timing was enabled. */
+  int64_t total_us[AOM_DEC_STAGE_COUNT];
+} aom_dec_stage_timings_t;
+
 /*!\enum aom_dec_control_id
  * \brief AOM decoder control functions
  *
@@ -466,6 +489,26 @@ enum aom_dec_control_id {
    * be used.
    */
   AV1D_GET_MI_INFO,
+
+  /*!\brief Codec control function to get the decoder's memory usage per
+   * subsystem, aom_mem_usage_t* parameter. Requires the decoder to be
+   * initialized with the AOM_CODEC_USE_MEM_ACCOUNTING flag.
+   */
+  AV1D_GET_MEM_USAGE,
+
+  /*!\brief Codec control function to time the decoder stages listed in
+   * aom_dec_stage_t, unsigned int parameter
+   *
+   * - 0 = disable (default)
+   * - 1 = enable
+   */
+  AV1D_SET_STAGE_TIMING,
+
+  /*!\brief Codec control function to get the time spent in each decoder
+   * stage, aom_dec_stage_timings_t* parameter. Returns AOM_CODEC_INCAPABLE
+   * unless AV1D_SET_STAGE_TIMING is enabled.
+   */
+  AV1D_GET_STAGE_TIMINGS,
 };
 
 /*!\cond */
@@ -598,6 +641,15 @@ AOM_CTRL_USE_TYPE(AOMD_GET_ORDER_HINT, unsigned int *)
 // The AOM_CTRL_USE_TYPE macro can't be used with AV1D_GET_MI_INFO because
 // AV1D_GET_MI_INFO takes more than one parameter.
 #define AOM_CTRL_AV1D_GET_MI_INFO
+
+AOM_CTRL_USE_TYPE(AV1D_GET_MEM_USAGE, aom_mem_usage_t *)
+#define AOM_CTRL_AV1D_GET_MEM_USAGE
+
+AOM_CTRL_USE_TYPE(AV1D_SET_STAGE_TIMING, unsigned int)
+#define AOM_CTRL_AV1D_SET_STAGE_TIMING
+
+AOM_CTRL_USE_TYPE(AV1D_GET_STAGE_TIMINGS, aom_dec_stage_timings_t *)
+#define AOM_CTRL_AV1D_GET_STAGE_TIMINGS
 /*!\endcond */
 /*! @} - end defgroup aom_decoder */
 #ifdef __cplusplus
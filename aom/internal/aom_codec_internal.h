@@ -324,6 +324,12 @@ struct aom_codec_iface {
 struct aom_codec_priv {
   const char *err_detail;
   aom_codec_flags_t init_flags;
+  // Made current for the calling thread by each aom_codec_* call that enters
+  // the algorithm.
+  const aom_codec_allocator_t *allocator;
+  // Set if the instance was initialized with AOM_CODEC_USE_MEM_ACCOUNTING.
+  // allocator then points to its wrapper allocator.
+  struct aom_mem_accounting *mem_accounting;
   struct {
     aom_fixed_buf_t cx_data_dst_buf;
     unsigned int cx_data_pad_before;
@@ -22,6 +22,7 @@
 
 #include "aom/aom_integer.h"
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_mem/aom_mem.h"
 
 int aom_codec_version(void) { return VERSION_PACKED; }
 
@@ -73,7 +74,13 @@ aom_codec_err_t aom_codec_destroy(aom_codec_ctx_t *ctx) {
     ctx->err = AOM_CODEC_ERROR;
     return AOM_CODEC_ERROR;
   }
+  // The accounting outlives the instance's memory, priv included.
+  aom_mem_accounting_t *const mem_accounting = ctx->priv->mem_accounting;
+  const aom_codec_allocator_t *const prev_allocator =
+      aom_mem_set_allocator(ctx->priv->allocator);
   ctx->iface->destroy((aom_codec_alg_priv_t *)ctx->priv);
+  aom_mem_set_allocator(prev_allocator);
+  aom_mem_accounting_destroy(mem_accounting);
   ctx->iface = NULL;
   ctx->name = NULL;
   ctx->priv = NULL;
@@ -106,7 +113,10 @@ aom_codec_err_t aom_codec_control(aom_codec_ctx_t *ctx, int ctrl_id, ...) {
     if (entry->ctrl_id == ctrl_id) {
       va_list ap;
       va_start(ap, ctrl_id);
+      const aom_codec_allocator_t *const prev_allocator =
+          aom_mem_set_allocator(ctx->priv->allocator);
       ctx->err = entry->fn((aom_codec_alg_priv_t *)ctx->priv, ap);
+      aom_mem_set_allocator(prev_allocator);
       va_end(ap);
       return ctx->err;
     }
@@ -125,8 +135,11 @@ aom_codec_err_t aom_codec_set_option(aom_codec_ctx_t *ctx, const char *name,
     ctx->err = AOM_CODEC_ERROR;
     return AOM_CODEC_ERROR;
   }
+  const aom_codec_allocator_t *const prev_allocator =
+      aom_mem_set_allocator(ctx->priv->allocator);
   ctx->err =
       ctx->iface->set_option((aom_codec_alg_priv_t *)ctx->priv, name, value);
+  aom_mem_set_allocator(prev_allocator);
   return ctx->err;
 }
 
@@ -198,3 +211,19 @@ const char *aom_obu_type_to_string(OBU_TYPE type) {
   }
   return "<Invalid OBU Type>";
 }
+
+const char *aom_mem_tag_to_string(aom_mem_tag_t tag) {
+  switch (tag) {
+    case AOM_MEM_TAG_OTHER: return "other";
+    case AOM_MEM_TAG_FRAME_BUFFER: return "frame buffers";
+    case AOM_MEM_TAG_MODE_INFO: return "mode info";
+    case AOM_MEM_TAG_TPL_STATS: return "TPL stats";
+    case AOM_MEM_TAG_LOOKAHEAD: return "lookahead";
+    case AOM_MEM_TAG_PC_TREE: return "context trees";
+    case AOM_MEM_TAG_THREAD_DATA: return "thread data";
+    case AOM_MEM_TAG_FIRSTPASS_STATS: return "first pass stats";
+    case AOM_MEM_TAG_LOOP_FILTER: return "LF/CDEF/LR";
+    default: break;
+  }
+  return "<Invalid memory tag>";
+}
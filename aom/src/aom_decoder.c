@@ -15,6 +15,7 @@
  */
 #include <string.h>
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_mem/aom_mem.h"
 
 #define SAVE_STATUS(ctx, var) (ctx ? (ctx->err = var) : var)
 
@@ -26,6 +27,14 @@ aom_codec_err_t aom_codec_dec_init_ver(aom_codec_ctx_t *ctx,
                                        aom_codec_iface_t *iface,
                                        const aom_codec_dec_cfg_t *cfg,
                                        aom_codec_flags_t flags, int ver) {
+  return aom_codec_dec_init_with_allocator_ver(ctx, iface, cfg, flags,
+                                               /*allocator=*/NULL, ver);
+}
+
+aom_codec_err_t aom_codec_dec_init_with_allocator_ver(
+    aom_codec_ctx_t *ctx, aom_codec_iface_t *iface,
+    const aom_codec_dec_cfg_t *cfg, aom_codec_flags_t flags,
+    const aom_codec_allocator_t *allocator, int ver) {
   aom_codec_err_t res;
 
   if (ver != AOM_DECODER_ABI_VERSION)
@@ -44,7 +53,22 @@ aom_codec_err_t aom_codec_dec_init_ver(aom_codec_ctx_t *ctx,
     ctx->init_flags = flags;
     ctx->config.dec = cfg;
 
+    aom_mem_accounting_t *mem_accounting = NULL;
+    if (flags & AOM_CODEC_USE_MEM_ACCOUNTING) {
+      mem_accounting = aom_mem_accounting_create(allocator);
+      if (!mem_accounting) return SAVE_STATUS(ctx, AOM_CODEC_MEM_ERROR);
+      allocator = aom_mem_accounting_get_allocator(mem_accounting);
+    }
+    const aom_codec_allocator_t *const prev_allocator =
+        aom_mem_set_allocator(allocator);
     res = ctx->iface->init(ctx);
+    if (ctx->priv) {
+      ctx->priv->allocator = allocator;
+      ctx->priv->mem_accounting = mem_accounting;
+    } else {
+      aom_mem_accounting_destroy(mem_accounting);
+    }
+    aom_mem_set_allocator(prev_allocator);
     if (res) {
       ctx->err_detail = ctx->priv ? ctx->priv->err_detail : NULL;
       aom_codec_destroy(ctx);
@@ -100,7 +124,10 @@ aom_codec_err_t aom_codec_decode(aom_codec_ctx_t *ctx, const uint8_t *data,
   else if (!ctx->iface || !ctx->priv)
     res = AOM_CODEC_ERROR;
   else {
+    const aom_codec_allocator_t *const prev_allocator =
+        aom_mem_set_allocator(ctx->priv->allocator);
     res = ctx->iface->dec.decode(get_alg_priv(ctx), data, data_sz, user_priv);
+    aom_mem_set_allocator(prev_allocator);
   }
 
   return SAVE_STATUS(ctx, res);
@@ -109,10 +136,14 @@ aom_codec_err_t aom_codec_decode(aom_codec_ctx_t *ctx, const uint8_t *data,
 aom_image_t *aom_codec_get_frame(aom_codec_ctx_t *ctx, aom_codec_iter_t *iter) {
   aom_image_t *img;
 
-  if (!ctx || !iter || !ctx->iface || !ctx->priv)
+  if (!ctx || !iter || !ctx->iface || !ctx->priv) {
     img = NULL;
-  else
+  } else {
+    const aom_codec_allocator_t *const prev_allocator =
+        aom_mem_set_allocator(ctx->priv->allocator);
     img = ctx->iface->dec.get_frame(get_alg_priv(ctx), iter);
+    aom_mem_set_allocator(prev_allocator);
+  }
 
   return img;
 }
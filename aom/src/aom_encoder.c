@@ -28,6 +28,7 @@
 
 #include "aom/aom_encoder.h"
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_mem/aom_mem.h"
 
 #define SAVE_STATUS(ctx, var) (ctx ? (ctx->err = var) : var)
 
@@ -39,6 +40,14 @@ aom_codec_err_t aom_codec_enc_init_ver(aom_codec_ctx_t *ctx,
                                        aom_codec_iface_t *iface,
                                        const aom_codec_enc_cfg_t *cfg,
                                        aom_codec_flags_t flags, int ver) {
+  return aom_codec_enc_init_with_allocator_ver(ctx, iface, cfg, flags,
+                                               /*allocator=*/NULL, ver);
+}
+
+aom_codec_err_t aom_codec_enc_init_with_allocator_ver(
+    aom_codec_ctx_t *ctx, aom_codec_iface_t *iface,
+    const aom_codec_enc_cfg_t *cfg, aom_codec_flags_t flags,
+    const aom_codec_allocator_t *allocator, int ver) {
   aom_codec_err_t res;
   // The value of AOM_ENCODER_ABI_VERSION in libaom v3.0.0 and v3.1.0 - v3.1.3.
   //
@@ -82,7 +91,22 @@ aom_codec_err_t aom_codec_enc_init_ver(aom_codec_ctx_t *ctx,
     ctx->priv = NULL;
     ctx->init_flags = flags;
     ctx->config.enc = cfg;
+    aom_mem_accounting_t *mem_accounting = NULL;
+    if (flags & AOM_CODEC_USE_MEM_ACCOUNTING) {
+      mem_accounting = aom_mem_accounting_create(allocator);
+      if (!mem_accounting) return SAVE_STATUS(ctx, AOM_CODEC_MEM_ERROR);
+      allocator = aom_mem_accounting_get_allocator(mem_accounting);
+    }
+    const aom_codec_allocator_t *const prev_allocator =
+        aom_mem_set_allocator(allocator);
     res = ctx->iface->init(ctx);
+    if (ctx->priv) {
+      ctx->priv->allocator = allocator;
+      ctx->priv->mem_accounting = mem_accounting;
+    } else {
+      aom_mem_accounting_destroy(mem_accounting);
+    }
+    aom_mem_set_allocator(prev_allocator);
 
     if (res) {
       // IMPORTANT: ctx->priv->err_detail must be null or point to a string
@@ -187,9 +211,12 @@ aom_codec_err_t aom_codec_encode(aom_codec_ctx_t *ctx, const aom_image_t *img,
     /* Execute in a normalized floating point environment, if the platform
      * requires it.
      */
+    const aom_codec_allocator_t *const prev_allocator =
+        aom_mem_set_allocator(ctx->priv->allocator);
     FLOATING_POINT_INIT
     res = ctx->iface->enc.encode(get_alg_priv(ctx), img, pts, duration, flags);
     FLOATING_POINT_RESTORE
+    aom_mem_set_allocator(prev_allocator);
   }
 
   return SAVE_STATUS(ctx, res);
@@ -206,8 +233,12 @@ const aom_codec_cx_pkt_t *aom_codec_get_cx_data(aom_codec_ctx_t *ctx,
       ctx->err = AOM_CODEC_ERROR;
     else if (!(ctx->iface->caps & AOM_CODEC_CAP_ENCODER))
       ctx->err = AOM_CODEC_INCAPABLE;
-    else
+    else {
+      const aom_codec_allocator_t *const prev_allocator =
+          aom_mem_set_allocator(ctx->priv->allocator);
       pkt = ctx->iface->enc.get_cx_data(get_alg_priv(ctx), iter);
+      aom_mem_set_allocator(prev_allocator);
+    }
   }
 
   if (pkt && pkt->kind == AOM_CODEC_CX_FRAME_PKT) {
@@ -271,8 +302,12 @@ const aom_image_t *aom_codec_get_preview_frame(aom_codec_ctx_t *ctx) {
       ctx->err = AOM_CODEC_INCAPABLE;
     else if (!ctx->iface->enc.get_preview)
       ctx->err = AOM_CODEC_INCAPABLE;
-    else
+    else {
+      const aom_codec_allocator_t *const prev_allocator =
+          aom_mem_set_allocator(ctx->priv->allocator);
       img = ctx->iface->enc.get_preview(get_alg_priv(ctx));
+      aom_mem_set_allocator(prev_allocator);
+    }
   }
 
   return img;
@@ -288,8 +323,12 @@ aom_fixed_buf_t *aom_codec_get_global_headers(aom_codec_ctx_t *ctx) {
       ctx->err = AOM_CODEC_INCAPABLE;
     else if (!ctx->iface->enc.get_glob_hdrs)
       ctx->err = AOM_CODEC_INCAPABLE;
-    else
+    else {
+      const aom_codec_allocator_t *const prev_allocator =
+          aom_mem_set_allocator(ctx->priv->allocator);
       buf = ctx->iface->enc.get_glob_hdrs(get_alg_priv(ctx));
+      aom_mem_set_allocator(prev_allocator);
+    }
   }
 
   return buf;
@@ -303,8 +342,12 @@ aom_codec_err_t aom_codec_enc_config_set(aom_codec_ctx_t *ctx,
     res = AOM_CODEC_INVALID_PARAM;
   else if (!(ctx->iface->caps & AOM_CODEC_CAP_ENCODER))
     res = AOM_CODEC_INCAPABLE;
-  else
+  else {
+    const aom_codec_allocator_t *const prev_allocator =
+        aom_mem_set_allocator(ctx->priv->allocator);
     res = ctx->iface->enc.cfg_set(get_alg_priv(ctx), cfg);
+    aom_mem_set_allocator(prev_allocator);
+  }
 
   return SAVE_STATUS(ctx, res);
 }
@@ -1195,6 +1195,9 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
   add_proto qw/void aom_avg_8x8_quad/, "const uint8_t *s, int p, int x16_idx, int y16_idx, int *avg";
   specialize qw/aom_avg_8x8_quad avx2 sse2 neon/;
 
+  add_proto qw/unsigned int aom_sad64x64_src_avg8x8/, "const uint8_t *src, int src_stride, const uint8_t *ref, int ref_stride, uint8_t *avg";
+  specialize qw/aom_sad64x64_src_avg8x8 avx2 sse2 neon/;
+
   add_proto qw/void aom_minmax_8x8/, "const uint8_t *s, int p, const uint8_t *d, int dp, int *min, int *max";
   specialize qw/aom_minmax_8x8 sse2 neon/;
 
@@ -55,6 +55,52 @@ void aom_avg_8x8_quad_neon(const uint8_t *s, int p, int x16_idx, int y16_idx,
   avg[3] = aom_avg_8x8_neon(s + (y16_idx + 8) * p + (x16_idx + 8), p);
 }
 
+unsigned int aom_sad64x64_src_avg8x8_neon(const uint8_t *src, int src_stride,
+                                          const uint8_t *ref, int ref_stride,
+                                          uint8_t *avg) {
+  uint16x8_t sad[4] = { vdupq_n_u16(0), vdupq_n_u16(0), vdupq_n_u16(0),
+                        vdupq_n_u16(0) };
+  for (int r8 = 0; r8 < 8; ++r8) {
+    // Lanes 0-3 of sum[k] accumulate 8x8 block 2 * k, lanes 4-7 block
+    // 2 * k + 1.
+    uint16x8_t sum[4] = { vdupq_n_u16(0), vdupq_n_u16(0), vdupq_n_u16(0),
+                          vdupq_n_u16(0) };
+    for (int r = 0; r < 8; ++r) {
+      for (int k = 0; k < 4; ++k) {
+        const uint8x16_t s = vld1q_u8(src + 16 * k);
+        const uint8x16_t d = vld1q_u8(ref + 16 * k);
+        sad[k] = vpadalq_u8(sad[k], vabdq_u8(s, d));
+        sum[k] = vpadalq_u8(sum[k], s);
+      }
+      src += src_stride;
+      ref += ref_stride;
+    }
+#if AOM_ARCH_AARCH64
+    const uint16x8_t sum01 = vpaddq_u16(sum[0], sum[1]);
+    const uint16x8_t sum23 = vpaddq_u16(sum[2], sum[3]);
+    const uint16x8_t blk_sum = vpaddq_u16(sum01, sum23);
+#else
+    const uint16x4_t sum0 =
+        vpadd_u16(vget_low_u16(sum[0]), vget_high_u16(sum[0]));
+    const uint16x4_t sum1 =
+        vpadd_u16(vget_low_u16(sum[1]), vget_high_u16(sum[1]));
+    const uint16x4_t sum2 =
+        vpadd_u16(vget_low_u16(sum[2]), vget_high_u16(sum[2]));
+    const uint16x4_t sum3 =
+        vpadd_u16(vget_low_u16(sum[3]), vget_high_u16(sum[3]));
+    const uint16x8_t blk_sum =
+        vcombine_u16(vpadd_u16(sum0, sum1), vpadd_u16(sum2, sum3));
+#endif
+    // (sum + 32) >> 6
+    vst1_u8(avg + 8 * r8, vrshrn_n_u16(blk_sum, 6));
+  }
+  uint32x4_t sad_u32 = vpaddlq_u16(sad[0]);
+  sad_u32 = vpadalq_u16(sad_u32, sad[1]);
+  sad_u32 = vpadalq_u16(sad_u32, sad[2]);
+  sad_u32 = vpadalq_u16(sad_u32, sad[3]);
+  return horizontal_add_u32x4(sad_u32);
+}
+
 int aom_satd_lp_neon(const int16_t *coeff, int length) {
   int16x8_t s0 = vld1q_s16(coeff);
   int16x8_t s1 = vld1q_s16(coeff + 8);
@@ -11,6 +11,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "config/aom_dsp_rtcd.h"
 #include "aom_ports/mem.h"
@@ -59,6 +60,28 @@ void aom_avg_8x8_quad_c(const uint8_t *s, int p, int x16_idx, int y16_idx,
   }
 }
 
+// Returns the SAD of the 64x64 block and writes the rounded average of each
+// 8x8 block of src to avg, in raster order.
+unsigned int aom_sad64x64_src_avg8x8_c(const uint8_t *src, int src_stride,
+                                       const uint8_t *ref, int ref_stride,
+                                       uint8_t *avg) {
+  unsigned int sad = 0;
+  int sum[8];
+  for (int r = 0; r < 64; ++r) {
+    if ((r & 7) == 0) memset(sum, 0, sizeof(sum));
+    for (int c = 0; c < 64; ++c) {
+      sad += abs(src[c] - ref[c]);
+      sum[c >> 3] += src[c];
+    }
+    if ((r & 7) == 7) {
+      for (int k = 0; k < 8; ++k) avg[(r >> 3) * 8 + k] = (sum[k] + 32) >> 6;
+    }
+    src += src_stride;
+    ref += ref_stride;
+  }
+  return sad;
+}
+
 #if CONFIG_AV1_HIGHBITDEPTH
 unsigned int aom_highbd_avg_8x8_c(const uint8_t *s8, int p) {
   int i, j;
@@ -35,6 +35,8 @@ extern "C" {
 struct aom_writer {
   unsigned int pos;
   uint8_t *buffer;
+  // The size of buffer.
+  size_t size;
   od_ec_enc ec;
   uint8_t allow_update_cdf;
 };
@@ -60,10 +62,11 @@ static inline void init_token_stats(TOKEN_STATS *token_stats) {
   token_stats->cost = 0;
 }
 
-void aom_start_encode(aom_writer *w, uint8_t *buffer);
+// Starts writing to buffer, which has room for size bytes.
+void aom_start_encode(aom_writer *w, uint8_t *buffer, size_t size);
 
-// Returns a negative number on error. Caller must check the return value and
-// handle error.
+// Returns a negative number on error, including when the coded data does not
+// fit in the buffer. Caller must check the return value and handle error.
 int aom_stop_encode(aom_writer *w);
 
 int aom_tell_size(aom_writer *w);
@@ -575,6 +575,43 @@ void aom_avg_8x8_quad_avx2(const uint8_t *s, int p, int x16_idx, int y16_idx,
   avg[3] = _mm_extract_epi32(hi, 2);
 }
 
+unsigned int aom_sad64x64_src_avg8x8_avx2(const uint8_t *src, int src_stride,
+                                          const uint8_t *ref, int ref_stride,
+                                          uint8_t *avg) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i rounding = _mm256_set1_epi32(32);
+  const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+  __m256i sad = zero;
+  for (int r8 = 0; r8 < 8; ++r8) {
+    // 64-bit lanes of sum0 hold 8x8 blocks 0-3, those of sum1 blocks 4-7.
+    __m256i sum0 = zero, sum1 = zero;
+    for (int r = 0; r < 8; ++r) {
+      const __m256i s0 = _mm256_loadu_si256((const __m256i *)src);
+      const __m256i s1 = _mm256_loadu_si256((const __m256i *)(src + 32));
+      const __m256i d0 = _mm256_loadu_si256((const __m256i *)ref);
+      const __m256i d1 = _mm256_loadu_si256((const __m256i *)(ref + 32));
+      sad = _mm256_add_epi32(sad, _mm256_sad_epu8(s0, d0));
+      sad = _mm256_add_epi32(sad, _mm256_sad_epu8(s1, d1));
+      sum0 = _mm256_add_epi32(sum0, _mm256_sad_epu8(s0, zero));
+      sum1 = _mm256_add_epi32(sum1, _mm256_sad_epu8(s1, zero));
+      src += src_stride;
+      ref += ref_stride;
+    }
+    // Interleave to 32-bit lanes { 0, 4, 1, 5, 2, 6, 3, 7 }, restore block
+    // order, then (sum + 32) >> 6.
+    __m256i sum = _mm256_or_si256(sum0, _mm256_slli_epi64(sum1, 32));
+    sum = _mm256_permutevar8x32_epi32(sum, order);
+    sum = _mm256_srli_epi32(_mm256_add_epi32(sum, rounding), 6);
+    const __m128i avg16 = _mm_packs_epi32(_mm256_castsi256_si128(sum),
+                                          _mm256_extracti128_si256(sum, 1));
+    _mm_storel_epi64((__m128i *)(avg + 8 * r8), _mm_packus_epi16(avg16, avg16));
+  }
+  const __m128i sad128 = _mm_add_epi32(_mm256_castsi256_si128(sad),
+                                       _mm256_extracti128_si256(sad, 1));
+  return (unsigned int)_mm_cvtsi128_si32(
+      _mm_add_epi32(sad128, _mm_srli_si128(sad128, 8)));
+}
+
 void aom_int_pro_row_avx2(int16_t *hbuf, const uint8_t *ref,
                           const int ref_stride, const int width,
                           const int height, int norm_factor) {
@@ -168,6 +168,39 @@ void aom_avg_8x8_quad_sse2(const uint8_t *s, int p, int x16_idx, int y16_idx,
   }
 }
 
+unsigned int aom_sad64x64_src_avg8x8_sse2(const uint8_t *src, int src_stride,
+                                          const uint8_t *ref, int ref_stride,
+                                          uint8_t *avg) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i rounding = _mm_set1_epi32(32);
+  __m128i sad = zero;
+  for (int r8 = 0; r8 < 8; ++r8) {
+    // Each 64-bit lane of sum[k] accumulates one 8x8 block of column k.
+    __m128i sum[4] = { zero, zero, zero, zero };
+    for (int r = 0; r < 8; ++r) {
+      for (int k = 0; k < 4; ++k) {
+        const __m128i s = _mm_loadu_si128((const __m128i *)(src + 16 * k));
+        const __m128i d = _mm_loadu_si128((const __m128i *)(ref + 16 * k));
+        sad = _mm_add_epi32(sad, _mm_sad_epu8(s, d));
+        sum[k] = _mm_add_epi32(sum[k], _mm_sad_epu8(s, zero));
+      }
+      src += src_stride;
+      ref += ref_stride;
+    }
+    // Gather the eight block sums, then (sum + 32) >> 6.
+    const __m128i sum01 = _mm_unpacklo_epi64(_mm_shuffle_epi32(sum[0], 0x08),
+                                             _mm_shuffle_epi32(sum[1], 0x08));
+    const __m128i sum23 = _mm_unpacklo_epi64(_mm_shuffle_epi32(sum[2], 0x08),
+                                             _mm_shuffle_epi32(sum[3], 0x08));
+    const __m128i avg01 = _mm_srli_epi32(_mm_add_epi32(sum01, rounding), 6);
+    const __m128i avg23 = _mm_srli_epi32(_mm_add_epi32(sum23, rounding), 6);
+    const __m128i avg16 = _mm_packs_epi32(avg01, avg23);
+    _mm_storel_epi64((__m128i *)(avg + 8 * r8), _mm_packus_epi16(avg16, avg16));
+  }
+  return (unsigned int)_mm_cvtsi128_si32(
+      _mm_add_epi32(sad, _mm_srli_si128(sad, 8)));
+}
+
 unsigned int aom_avg_4x4_sse2(const uint8_t *s, int p) {
   __m128i s0, s1, u0;
   unsigned int avg = 0;
@@ -9,12 +9,81 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+// Enable GNU extensions in glibc so that we can call posix_memalign() and
+// madvise(). This must be before any #include statements.
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "aom_mem.h"
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 #include "include/aom_mem_intrnl.h"
 #include "aom/aom_integer.h"
+#include "aom_util/aom_pthread.h"
+#include "config/aom_config.h"
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+#define HAVE_HUGE_PAGES 1
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+#else
+#define HAVE_HUGE_PAGES 0
+#endif
+
+#if !CONFIG_MULTITHREAD
+#define AOM_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define AOM_THREAD_LOCAL __declspec(thread)
+#else
+#define AOM_THREAD_LOCAL __thread
+#endif
+
+// Stored just below each block handed out, so that aom_free() can return the
+// block to the allocator it came from.
+typedef struct {
+  void *addr;
+  const aom_codec_allocator_t *allocator;
+  size_t size;
+  aom_mem_tag_t tag;
+} AllocationHeader;
+
+#define ADDRESS_STORAGE_SIZE sizeof(AllocationHeader)
+
+static AOM_THREAD_LOCAL const aom_codec_allocator_t *current_allocator;
+static AOM_THREAD_LOCAL aom_mem_tag_t current_tag;
+
+const aom_codec_allocator_t *aom_mem_set_allocator(
+    const aom_codec_allocator_t *allocator) {
+  const aom_codec_allocator_t *const prev = current_allocator;
+  current_allocator = allocator;
+  // A tag left set by an error longjmp() must not outlive the codec call.
+  current_tag = AOM_MEM_TAG_OTHER;
+  return prev;
+}
+
+aom_mem_tag_t aom_mem_set_tag(aom_mem_tag_t tag) {
+  const aom_mem_tag_t prev = current_tag;
+  current_tag = tag;
+  return prev;
+}
+
+// The subsystem tag set for the thread takes over untagged blocks and frame
+// buffers, so that e.g. the lookahead's frames are counted with it.
+static aom_mem_tag_t get_tag(aom_mem_tag_t tag) {
+  if (current_tag != AOM_MEM_TAG_OTHER &&
+      (tag == AOM_MEM_TAG_OTHER || tag == AOM_MEM_TAG_FRAME_BUFFER)) {
+    return current_tag;
+  }
+  return tag;
+}
+
+const aom_codec_allocator_t *aom_mem_get_allocator(void) {
+  return current_allocator;
+}
 
 static size_t GetAllocationPaddingSize(size_t align) {
   assert(align > 0);
@@ -37,46 +106,205 @@ static int check_size_argument_overflow(size_t nmemb, size_t size,
   return 1;
 }
 
-static size_t *GetMallocAddressLocation(void *const mem) {
-  return ((size_t *)mem) - 1;
+// The header may not be aligned for its type when align is small, so it is
+// copied in and out.
+static void SetAllocationHeader(void *const mem,
+                                const AllocationHeader *header) {
+  memcpy((unsigned char *)mem - ADDRESS_STORAGE_SIZE, header,
+         ADDRESS_STORAGE_SIZE);
 }
 
-static void SetActualMallocAddress(void *const mem,
-                                   const void *const malloc_addr) {
-  size_t *const malloc_addr_location = GetMallocAddressLocation(mem);
-  *malloc_addr_location = (size_t)malloc_addr;
+static void GetAllocationHeader(const void *const mem,
+                                AllocationHeader *header) {
+  memcpy(header, (const unsigned char *)mem - ADDRESS_STORAGE_SIZE,
+         ADDRESS_STORAGE_SIZE);
 }
 
-static void *GetActualMallocAddress(void *const mem) {
-  const size_t *const malloc_addr_location = GetMallocAddressLocation(mem);
-  return (void *)(*malloc_addr_location);
+#if HAVE_HUGE_PAGES
+// Large blocks of the tagged kinds are placed on 2 MB boundaries and advised
+// as huge pages, so that a 4K frame plane takes a handful of TLB entries
+// instead of thousands. Smaller blocks would waste most of a huge page.
+static int use_huge_pages(const aom_codec_allocator_t *allocator, size_t size,
+                          aom_mem_tag_t tag) {
+  return allocator != NULL && allocator->use_huge_pages &&
+         tag != AOM_MEM_TAG_OTHER && size >= HUGE_PAGE_SIZE;
 }
 
-void *aom_memalign(size_t align, size_t size) {
+static void *huge_page_alloc(size_t size) {
+  void *addr;
+  size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+  if (posix_memalign(&addr, HUGE_PAGE_SIZE, size)) return NULL;
+  // madvise() is only a hint; the block is usable if the kernel declines.
+  madvise(addr, size, MADV_HUGEPAGE);
+  return addr;
+}
+#endif  // HAVE_HUGE_PAGES
+
+// The built-in allocator. Its blocks are released with free().
+static void *system_alloc(const aom_codec_allocator_t *allocator, size_t size,
+                          aom_mem_tag_t tag) {
+#if HAVE_HUGE_PAGES
+  if (use_huge_pages(allocator, size, tag)) return huge_page_alloc(size);
+#else
+  (void)allocator;
+  (void)tag;
+#endif
+  return malloc(size);
+}
+
+void *aom_memalign_tagged(size_t align, size_t size, aom_mem_tag_t tag) {
   void *x = NULL;
   if (!check_size_argument_overflow(1, size, align)) return NULL;
-  const size_t aligned_size = size + GetAllocationPaddingSize(align);
-  void *const addr = malloc(aligned_size);
-  if (addr) {
-    x = aom_align_addr((unsigned char *)addr + ADDRESS_STORAGE_SIZE, align);
-    SetActualMallocAddress(x, addr);
+  AllocationHeader header = { NULL, current_allocator,
+                              size + GetAllocationPaddingSize(align),
+                              get_tag(tag) };
+  const aom_codec_allocator_t *const allocator = header.allocator;
+  if (allocator != NULL && allocator->alloc_cb != NULL) {
+    header.addr =
+        allocator->alloc_cb(allocator->cb_priv, header.size, header.tag);
+  } else {
+    header.addr = system_alloc(allocator, header.size, header.tag);
+  }
+  if (header.addr) {
+    x = aom_align_addr((unsigned char *)header.addr + ADDRESS_STORAGE_SIZE,
+                       align);
+    SetAllocationHeader(x, &header);
   }
   return x;
 }
 
-void *aom_malloc(size_t size) { return aom_memalign(DEFAULT_ALIGNMENT, size); }
+void *aom_memalign(size_t align, size_t size) {
+  return aom_memalign_tagged(align, size, AOM_MEM_TAG_OTHER);
+}
 
-void *aom_calloc(size_t num, size_t size) {
+void *aom_malloc_tagged(size_t size, aom_mem_tag_t tag) {
+  return aom_memalign_tagged(DEFAULT_ALIGNMENT, size, tag);
+}
+
+void *aom_malloc(size_t size) {
+  return aom_malloc_tagged(size, AOM_MEM_TAG_OTHER);
+}
+
+void *aom_calloc_tagged(size_t num, size_t size, aom_mem_tag_t tag) {
   if (!check_size_argument_overflow(num, size, DEFAULT_ALIGNMENT)) return NULL;
   const size_t total_size = num * size;
-  void *const x = aom_malloc(total_size);
+  void *const x = aom_malloc_tagged(total_size, tag);
   if (x) memset(x, 0, total_size);
   return x;
 }
 
+void *aom_calloc(size_t num, size_t size) {
+  return aom_calloc_tagged(num, size, AOM_MEM_TAG_OTHER);
+}
+
 void aom_free(void *memblk) {
   if (memblk) {
-    void *addr = GetActualMallocAddress(memblk);
-    free(addr);
+    AllocationHeader header;
+    GetAllocationHeader(memblk, &header);
+    const aom_codec_allocator_t *const allocator = header.allocator;
+    if (allocator != NULL && allocator->alloc_cb != NULL) {
+      allocator->free_cb(allocator->cb_priv, header.addr, header.size,
+                         header.tag);
+    } else {
+      free(header.addr);
+    }
   }
 }
+
+struct aom_mem_accounting {
+  // Counts each block, then passes it on to the wrapped allocator.
+  aom_codec_allocator_t allocator;
+  const aom_codec_allocator_t *wrapped;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex;
+#endif
+  aom_mem_usage_t usage;
+};
+
+static void *accounting_alloc(void *priv, size_t size, aom_mem_tag_t tag) {
+  aom_mem_accounting_t *const accounting = (aom_mem_accounting_t *)priv;
+  const aom_codec_allocator_t *const wrapped = accounting->wrapped;
+  void *const addr = wrapped != NULL && wrapped->alloc_cb != NULL
+                         ? wrapped->alloc_cb(wrapped->cb_priv, size, tag)
+                         : system_alloc(wrapped, size, tag);
+  if (addr == NULL) return NULL;
+
+  aom_mem_usage_t *const usage = &accounting->usage;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&accounting->mutex);
+#endif
+  usage->current_bytes[tag] += size;
+  if (usage->current_bytes[tag] > usage->peak_bytes[tag]) {
+    usage->peak_bytes[tag] = usage->current_bytes[tag];
+  }
+  usage->total_current_bytes += size;
+  if (usage->total_current_bytes > usage->total_peak_bytes) {
+    usage->total_peak_bytes = usage->total_current_bytes;
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&accounting->mutex);
+#endif
+  return addr;
+}
+
+static void accounting_free(void *priv, void *ptr, size_t size,
+                            aom_mem_tag_t tag) {
+  aom_mem_accounting_t *const accounting = (aom_mem_accounting_t *)priv;
+  const aom_codec_allocator_t *const wrapped = accounting->wrapped;
+  aom_mem_usage_t *const usage = &accounting->usage;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&accounting->mutex);
+#endif
+  usage->current_bytes[tag] -= size;
+  usage->total_current_bytes -= size;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&accounting->mutex);
+#endif
+  if (wrapped != NULL && wrapped->alloc_cb != NULL) {
+    wrapped->free_cb(wrapped->cb_priv, ptr, size, tag);
+  } else {
+    free(ptr);
+  }
+}
+
+aom_mem_accounting_t *aom_mem_accounting_create(
+    const aom_codec_allocator_t *allocator) {
+  aom_mem_accounting_t *const accounting =
+      (aom_mem_accounting_t *)calloc(1, sizeof(*accounting));
+  if (accounting == NULL) return NULL;
+#if CONFIG_MULTITHREAD
+  if (pthread_mutex_init(&accounting->mutex, NULL)) {
+    free(accounting);
+    return NULL;
+  }
+#endif
+  accounting->allocator.alloc_cb = accounting_alloc;
+  accounting->allocator.free_cb = accounting_free;
+  accounting->allocator.cb_priv = accounting;
+  accounting->wrapped = allocator;
+  return accounting;
+}
+
+void aom_mem_accounting_destroy(aom_mem_accounting_t *accounting) {
+  if (accounting == NULL) return;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&accounting->mutex);
+#endif
+  free(accounting);
+}
+
+const aom_codec_allocator_t *aom_mem_accounting_get_allocator(
+    aom_mem_accounting_t *accounting) {
+  return &accounting->allocator;
+}
+
+void aom_mem_accounting_get_usage(aom_mem_accounting_t *accounting,
+                                  aom_mem_usage_t *usage) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&accounting->mutex);
+#endif
+  *usage = accounting->usage;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&accounting->mutex);
+#endif
+}
@@ -12,6 +12,7 @@
 #ifndef AOM_AOM_MEM_AOM_MEM_H_
 #define AOM_AOM_MEM_AOM_MEM_H_
 
+#include "aom/aom_codec.h"
 #include "aom/aom_integer.h"
 #include "config/aom_config.h"
 
@@ -37,6 +38,36 @@ void *aom_malloc(size_t size);
 void *aom_calloc(size_t num, size_t size);
 void aom_free(void *memblk);
 
+// Tagged variants, for the allocations an aom_codec_allocator_t may want to
+// serve differently.
+void *aom_memalign_tagged(size_t align, size_t size, aom_mem_tag_t tag);
+void *aom_malloc_tagged(size_t size, aom_mem_tag_t tag);
+void *aom_calloc_tagged(size_t num, size_t size, aom_mem_tag_t tag);
+
+// Sets the allocator used by the calling thread and returns the previous one.
+// NULL selects malloc(). Memory is always freed by the allocator it came from,
+// whichever allocator is current when aom_free() is called.
+const aom_codec_allocator_t *aom_mem_set_allocator(
+    const aom_codec_allocator_t *allocator);
+const aom_codec_allocator_t *aom_mem_get_allocator(void);
+
+// Attributes the calling thread's untagged allocations and frame buffers to
+// tag, until the returned previous tag is restored. Subsystems set it around
+// their allocations so that the frame buffers they own are counted with them.
+aom_mem_tag_t aom_mem_set_tag(aom_mem_tag_t tag);
+
+// Opt-in accounting of the current and peak bytes per tag. It wraps allocator
+// (NULL for malloc()) in an allocator of its own, which the codec instance
+// then uses in its place. Destroy it only once all of its blocks are freed.
+typedef struct aom_mem_accounting aom_mem_accounting_t;
+aom_mem_accounting_t *aom_mem_accounting_create(
+    const aom_codec_allocator_t *allocator);
+void aom_mem_accounting_destroy(aom_mem_accounting_t *accounting);
+const aom_codec_allocator_t *aom_mem_accounting_get_allocator(
+    aom_mem_accounting_t *accounting);
+void aom_mem_accounting_get_usage(aom_mem_accounting_t *accounting,
+                                  aom_mem_usage_t *usage);
+
 static inline void *aom_memset16(void *dest, int val, size_t length) {
   size_t i;
   uint16_t *dest16 = (uint16_t *)dest;
@@ -14,8 +14,6 @@
 
 #include "config/aom_config.h"
 
-#define ADDRESS_STORAGE_SIZE sizeof(size_t)
-
 #ifndef DEFAULT_ALIGNMENT
 #if defined(VXWORKS)
 /*default addr alignment to use in calls to aom_* functions other than
@@ -129,7 +129,8 @@ static int realloc_frame_buffer_aligned(
 
       if (frame_size != (size_t)frame_size) return AOM_CODEC_MEM_ERROR;
 
-      ybf->buffer_alloc = (uint8_t *)aom_memalign(32, (size_t)frame_size);
+      ybf->buffer_alloc = (uint8_t *)aom_memalign_tagged(
+          32, (size_t)frame_size, AOM_MEM_TAG_FRAME_BUFFER);
       if (!ybf->buffer_alloc) return AOM_CODEC_MEM_ERROR;
 
       ybf->buffer_alloc_sz = (size_t)frame_size;
@@ -36,6 +36,9 @@ struct AVxWorkerImpl {
   pthread_mutex_t mutex_;
   pthread_cond_t condition_;
   pthread_t thread_;
+  // The allocator of the thread that started the worker, so that memory the
+  // hooks allocate comes from the same codec instance's allocator.
+  const aom_codec_allocator_t *allocator_;
 };
 
 //------------------------------------------------------------------------------
@@ -66,6 +69,7 @@ static THREADFN thread_loop(void *ptr) {
     pthread_setname_np(pthread_self(), thread_name);
   }
 #endif
+  aom_mem_set_allocator(worker->impl_->allocator_);
   pthread_mutex_lock(&worker->impl_->mutex_);
   for (;;) {
     while (worker->status_ == AVX_WORKER_STATUS_OK) {  // wait in idling mode
@@ -142,6 +146,7 @@ static int reset(AVxWorker *const worker) {
     if (worker->impl_ == NULL) {
       return 0;
     }
+    worker->impl_->allocator_ = aom_mem_get_allocator();
     if (pthread_mutex_init(&worker->impl_->mutex_, NULL)) {
       goto Error;
     }
@@ -105,6 +105,10 @@ static const arg_def_t outallarg = ARG_DEF(
     NULL, "all-layers", 0, "Output all decoded frames of a scalable bitstream");
 static const arg_def_t skipfilmgrain =
     ARG_DEF(NULL, "skip-film-grain", 0, "Skip film grain application");
+static const arg_def_t memreportarg = ARG_DEF(
+    NULL, "mem-report", 0, "Show the peak memory usage of each subsystem");
+static const arg_def_t stagetimingarg = ARG_DEF(
+    NULL, "stage-timing", 0, "Show the time spent in each decoder stage");
 
 static const arg_def_t *all_args[] = {
   &help,           &codecarg, &use_yv12,      &use_i420,
@@ -113,7 +117,7 @@ static const arg_def_t *all_args[] = {
   &threadsarg,     &rowmtarg, &verbosearg,    &scalearg,
   &fb_arg,         &md5arg,   &framestatsarg, &continuearg,
   &outbitdeptharg, &isannexb, &oppointarg,    &outallarg,
-  &skipfilmgrain,  NULL
+  &skipfilmgrain,  &memreportarg, &stagetimingarg, NULL
 };
 
 #if CONFIG_LIBYUV
@@ -240,25 +244,43 @@ static int raw_read_frame(struct AvxInputContext *input_ctx, uint8_t **buffer,
   return 0;
 }
 
+// Reads the next frame into *buf and points *data at it, or points *data at
+// the frame in the input file if it is mapped.
 static int read_frame(struct AvxDecInputContext *input, uint8_t **buf,
-                      size_t *bytes_in_buffer, size_t *buffer_size) {
+                      size_t *bytes_in_buffer, size_t *buffer_size,
+                      const uint8_t **data) {
+  int ret;
+  if (input->aom_input_ctx->mapped_data) {
+    if (input->aom_input_ctx->file_type == FILE_TYPE_IVF) {
+      return ivf_map_frame(input->aom_input_ctx, data, bytes_in_buffer, NULL);
+    }
+    if (input->aom_input_ctx->file_type == FILE_TYPE_OBU) {
+      return obudec_map_temporal_unit(input->obu_ctx, data, bytes_in_buffer);
+    }
+  }
   switch (input->aom_input_ctx->file_type) {
 #if CONFIG_WEBM_IO
     case FILE_TYPE_WEBM:
-      return webm_read_frame(input->webm_ctx, buf, bytes_in_buffer,
-                             buffer_size);
+      ret = webm_read_frame(input->webm_ctx, buf, bytes_in_buffer,
+                            buffer_size);
+      break;
 #endif
     case FILE_TYPE_RAW:
-      return raw_read_frame(input->aom_input_ctx, buf, bytes_in_buffer,
-                            buffer_size);
+      ret = raw_read_frame(input->aom_input_ctx, buf, bytes_in_buffer,
+                           buffer_size);
+      break;
     case FILE_TYPE_IVF:
-      return ivf_read_frame(input->aom_input_ctx, buf, bytes_in_buffer,
-                            buffer_size, NULL);
+      ret = ivf_read_frame(input->aom_input_ctx, buf, bytes_in_buffer,
+                           buffer_size, NULL);
+      break;
     case FILE_TYPE_OBU:
-      return obudec_read_temporal_unit(input->obu_ctx, buf, bytes_in_buffer,
-                                       buffer_size);
+      ret = obudec_read_temporal_unit(input->obu_ctx, buf, bytes_in_buffer,
+                                      buffer_size);
+      break;
     default: return 1;
   }
+  *data = *buf;
+  return ret;
 }
 
 static int file_is_raw(struct AvxInputContext *input) {
@@ -446,11 +468,13 @@ static int main_loop(int argc, const char **argv_) {
   int i;
   int ret = EXIT_FAILURE;
   uint8_t *buf = NULL;
+  const uint8_t *frame_data = NULL;
   size_t bytes_in_buffer = 0, buffer_size = 0;
   FILE *infile;
   int frame_in = 0, frame_out = 0, flipuv = 0, noblit = 0;
   int do_md5 = 0, progress = 0;
-  int stop_after = 0, summary = 0, quiet = 1;
+  int stop_after = 0, summary = 0, quiet = 1, mem_report = 0;
+  int stage_timing = 0;
   int arg_skip = 0;
   int keep_going = 0;
   uint64_t dx_time = 0;
@@ -563,6 +587,10 @@ static int main_loop(int argc, const char **argv_) {
       }
     } else if (arg_match(&arg, &summaryarg, argi)) {
       summary = 1;
+    } else if (arg_match(&arg, &memreportarg, argi)) {
+      mem_report = 1;
+    } else if (arg_match(&arg, &stagetimingarg, argi)) {
+      stage_timing = 1;
     } else if (arg_match(&arg, &threadsarg, argi)) {
       cfg.threads = arg_parse_uint(&arg);
 #if !CONFIG_MULTITHREAD
@@ -661,6 +689,13 @@ static int main_loop(int argc, const char **argv_) {
     return EXIT_FAILURE;
   }
 
+  // IVF frames and OBU temporal units are decoded straight from the file when
+  // it can be mapped.
+  if (input.aom_input_ctx->file_type == FILE_TYPE_IVF ||
+      input.aom_input_ctx->file_type == FILE_TYPE_OBU) {
+    input_map_file(input.aom_input_ctx);
+  }
+
   outfile_pattern = outfile_pattern ? outfile_pattern : "-";
   single_file = is_single_file(outfile_pattern);
 
@@ -707,7 +742,7 @@ static int main_loop(int argc, const char **argv_) {
 
   if (!interface) interface = get_aom_decoder_by_index(0);
 
-  dec_flags = 0;
+  dec_flags = mem_report ? AOM_CODEC_USE_MEM_ACCOUNTING : 0;
   if (aom_codec_dec_init(&decoder, interface, &cfg, dec_flags)) {
     fprintf(stderr, "Failed to initialize decoder: %s\n",
             aom_codec_error(&decoder));
@@ -748,9 +783,19 @@ static int main_loop(int argc, const char **argv_) {
     goto fail;
   }
 
+  if (AOM_CODEC_CONTROL_TYPECHECKED(&decoder, AV1D_SET_STAGE_TIMING,
+                                    stage_timing)) {
+    fprintf(stderr, "Failed to set stage timing: %s\n",
+            aom_codec_error(&decoder));
+    goto fail;
+  }
+
   if (arg_skip) fprintf(stderr, "Skipping first %d frames.\n", arg_skip);
   while (arg_skip) {
-    if (read_frame(&input, &buf, &bytes_in_buffer, &buffer_size)) break;
+    if (read_frame(&input, &buf, &bytes_in_buffer, &buffer_size,
+                   &frame_data)) {
+      break;
+    }
     arg_skip--;
   }
 
@@ -785,13 +830,14 @@ static int main_loop(int argc, const char **argv_) {
 
     frame_avail = 0;
     if (!stop_after || frame_in < stop_after) {
-      if (!read_frame(&input, &buf, &bytes_in_buffer, &buffer_size)) {
+      if (!read_frame(&input, &buf, &bytes_in_buffer, &buffer_size,
+                      &frame_data)) {
         frame_avail = 1;
         frame_in++;
 
         aom_usec_timer_start(&timer);
 
-        if (aom_codec_decode(&decoder, buf, bytes_in_buffer, NULL)) {
+        if (aom_codec_decode(&decoder, frame_data, bytes_in_buffer, NULL)) {
           const char *detail = aom_codec_error_detail(&decoder);
           aom_tools_warn("Failed to decode frame %d: %s", frame_in,
                          aom_codec_error(&decoder));
@@ -1013,6 +1059,26 @@ static int main_loop(int argc, const char **argv_) {
     fprintf(stderr, "\n");
   }
 
+  if (mem_report) {
+    aom_mem_usage_t usage;
+    if (AOM_CODEC_CONTROL_TYPECHECKED(&decoder, AV1D_GET_MEM_USAGE, &usage) ==
+        AOM_CODEC_OK) {
+      print_mem_usage("Decoder", &usage);
+    }
+  }
+
+  if (stage_timing) {
+    static const char *const stage_names[AOM_DEC_STAGE_COUNT] = {
+      "parse", "recon", "loop filter", "cdef", "superres", "loop restoration"
+    };
+    aom_dec_stage_timings_t timings;
+    if (AOM_CODEC_CONTROL_TYPECHECKED(&decoder, AV1D_GET_STAGE_TIMINGS,
+                                      &timings) == AOM_CODEC_OK) {
+      print_stage_timings("Decoder", stage_names, timings.total_us,
+                          AOM_DEC_STAGE_COUNT);
+    }
+  }
+
   if (frames_corrupted) {
     fprintf(stderr, "WARNING: %d frames corrupted.\n", frames_corrupted);
   } else {
@@ -1054,6 +1120,7 @@ fail2:
   }
   free(ext_fb_list.ext_fb);
 
+  input_unmap_file(input.aom_input_ctx);
   fclose(infile);
   if (framestats_file) fclose(framestats_file);
 
@@ -33,6 +33,7 @@
 #include "aom_ports/aom_timer.h"
 #include "aom_ports/mem_ops.h"
 #include "common/args.h"
+#include "common/async_io.h"
 #include "common/ivfenc.h"
 #include "common/tools_common.h"
 #include "common/warnings.h"
@@ -62,6 +63,12 @@ static size_t wrap_fwrite(const void *ptr, size_t size, size_t nmemb,
 }
 #define fwrite wrap_fwrite
 
+/* Number of input frames read ahead, and output packets written behind, on
+ * the I/O threads.
+ */
+#define ASYNC_INPUT_FRAMES 4
+#define ASYNC_OUTPUT_PACKETS 16
+
 static const char *exec_name;
 
 static AOM_TOOLS_FORMAT_PRINTF(3, 0) void warn_or_exit_on_errorv(
@@ -106,7 +113,15 @@ static int read_frame(struct AvxInputContext *input_ctx, aom_image_t *img) {
   int shortread = 0;
 
   if (input_ctx->file_type == FILE_TYPE_Y4M) {
-    if (y4m_input_fetch_frame(y4m, f, img) < 1) return 0;
+    if (input_ctx->mapped_data) {
+      if (y4m_input_map_frame(y4m, input_ctx->mapped_data,
+                              input_ctx->mapped_size, &input_ctx->mapped_pos,
+                              img) < 1) {
+        return 0;
+      }
+    } else if (y4m_input_fetch_frame(y4m, f, img) < 1) {
+      return 0;
+    }
   } else {
     shortread = read_yuv_frame(input_ctx, img);
   }
@@ -114,6 +129,49 @@ static int read_frame(struct AvxInputContext *input_ctx, aom_image_t *img) {
   return !shortread;
 }
 
+/* Reads the next input frame on the reader thread. The Y4M reader converts
+ * into a buffer of its own, so its frames are copied into the ring image
+ * unless they point into the mapped file.
+ */
+static int read_frame_async(void *priv, aom_image_t *img, int64_t *pos) {
+  struct AvxInputContext *const input_ctx = (struct AvxInputContext *)priv;
+
+  if (input_ctx->file_type == FILE_TYPE_Y4M) {
+    aom_image_t y4m_img;
+    if (!read_frame(input_ctx, &y4m_img)) return 0;
+    if (input_ctx->mapped_data && y4m_img.planes[0] != input_ctx->y4m.dst_buf) {
+      // The frame stays valid in the mapped file, so use it in place.
+      aom_img_free(img);
+      *img = y4m_img;
+      *pos = (int64_t)input_ctx->mapped_pos;
+      return 1;
+    }
+    if (!img->img_data_owner &&
+        !aom_img_alloc(img, y4m_img.fmt, y4m_img.d_w, y4m_img.d_h, 32)) {
+      fatal("Failed to allocate image.");
+    }
+    img->bit_depth = y4m_img.bit_depth;
+    const int bytes_per_sample = (img->fmt & AOM_IMG_FMT_HIGHBITDEPTH) ? 2 : 1;
+    for (int plane = 0; plane < 3; ++plane) {
+      const int w = aom_img_plane_width(img, plane) * bytes_per_sample;
+      const int h = aom_img_plane_height(img, plane);
+      for (int y = 0; y < h; ++y) {
+        memcpy(img->planes[plane] + y * img->stride[plane],
+               y4m_img.planes[plane] + y * y4m_img.stride[plane], w);
+      }
+    }
+  } else {
+    if (!img->img_data && !aom_img_alloc(img, input_ctx->fmt, input_ctx->width,
+                                         input_ctx->height, 32)) {
+      fatal("Failed to allocate image.");
+    }
+    if (!read_frame(input_ctx, img)) return 0;
+  }
+  *pos = input_ctx->mapped_data ? (int64_t)input_ctx->mapped_pos
+                                 : (int64_t)ftello(input_ctx->file);
+  return 1;
+}
+
 static int file_is_y4m(const char detect[4]) {
   if (memcmp(detect, "YUV4", 4) == 0) {
     return 1;
@@ -268,6 +326,9 @@ static const arg_def_t *const main_args[] = {
   &g_av1_codec_arg_defs.rate_hist_n,
   &g_av1_codec_arg_defs.disable_warnings,
   &g_av1_codec_arg_defs.disable_warning_prompt,
+  &g_av1_codec_arg_defs.huge_pages,
+  &g_av1_codec_arg_defs.mem_report,
+  &g_av1_codec_arg_defs.stage_timing,
   &g_av1_codec_arg_defs.recontest,
   NULL
 };
@@ -584,6 +645,12 @@ struct stream_state {
   int orig_write_webm;
   int orig_write_ivf;
   char tmp_out_fn[1000];
+  // An earlier stream whose first pass statistics this stream reuses, or
+  // NULL if it runs its own first pass.
+  struct stream_state *first_pass_source;
+  // Set once the first statistics of this stream matched those of
+  // first_pass_source, after which it stops running its first pass.
+  int first_pass_checked;
 };
 
 static void validate_positive_rational(const char *msg,
@@ -706,6 +773,12 @@ static void parse_global_config(struct AvxEncoderConfig *global, char ***argv) {
     } else if (arg_match(&arg, &g_av1_codec_arg_defs.disable_warning_prompt,
                          argi)) {
       global->disable_warning_prompt = 1;
+    } else if (arg_match(&arg, &g_av1_codec_arg_defs.huge_pages, argi)) {
+      global->use_huge_pages = 1;
+    } else if (arg_match(&arg, &g_av1_codec_arg_defs.mem_report, argi)) {
+      global->mem_report = 1;
+    } else if (arg_match(&arg, &g_av1_codec_arg_defs.stage_timing, argi)) {
+      global->stage_timing = 1;
     } else {
       argj++;
     }
@@ -787,6 +860,8 @@ static void open_input_file(struct AvxInputContext *input,
       input->fmt = input->y4m.aom_fmt;
       input->bit_depth = input->y4m.bit_depth;
       input->color_range = input->y4m.color_range;
+      // Frames that need no conversion are used straight from the file.
+      if (y4m_input_can_map(&input->y4m)) input_map_file(input);
     } else
       fatal("Unsupported Y4M stream.");
   } else if (input->detect.buf_read == 4 && fourcc_is_ivf(input->detect.buf)) {
@@ -797,6 +872,7 @@ static void open_input_file(struct AvxInputContext *input,
 }
 
 static void close_input_file(struct AvxInputContext *input) {
+  input_unmap_file(input);
   fclose(input->file);
   if (input->file_type == FILE_TYPE_Y4M) y4m_input_close(&input->y4m);
 }
@@ -1308,6 +1384,138 @@ static void set_stream_dimensions(struct stream_state *stream, unsigned int w,
   }
 }
 
+static int same_string(const char *a, const char *b) {
+  return a == b || (a && b && !strcmp(a, b));
+}
+
+// Returns the value that a config last sets for a key & value option, or
+// NULL.
+static const char *last_key_val(const struct stream_config *config,
+                                const char *name) {
+  const char *val = NULL;
+  for (int i = 0; i < config->arg_key_val_cnt; ++i) {
+    if (!strcmp(config->arg_key_vals[i][0], name))
+      val = config->arg_key_vals[i][1];
+  }
+  return val;
+}
+
+// Returns whether every key & value option of a is set the same way by b.
+// Later streams inherit the options of earlier ones, so the same key may be
+// listed more than once.
+static int key_vals_cover(const struct stream_config *a,
+                          const struct stream_config *b) {
+  for (int i = 0; i < a->arg_key_val_cnt; ++i) {
+    const char *name = a->arg_key_vals[i][0];
+    int found = 0;
+    for (int j = 0; j < b->arg_key_val_cnt && !found; ++j) {
+      found = !strcmp(b->arg_key_vals[j][0], name) &&
+              same_string(b->arg_key_vals[j][1], a->arg_key_vals[i][1]);
+    }
+    if (!found ||
+        !same_string(last_key_val(a, name), last_key_val(b, name))) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Returns whether two streams are expected to produce the same first pass
+// statistics, that is, whether they differ only in their target bitrate and
+// output settings. Both must keep their statistics in memory.
+// check_first_pass_sources() verifies this while the first pass runs.
+static int streams_share_first_pass(const struct stream_state *a,
+                                    const struct stream_state *b) {
+  const struct stream_config *ca = &a->config;
+  const struct stream_config *cb = &b->config;
+  struct aom_codec_enc_cfg cfg_b;
+  int i;
+
+  if (ca->stats_fn || cb->stats_fn) return 0;
+  if (ca->use_16bit_internal != cb->use_16bit_internal ||
+      ca->stereo_fmt != cb->stereo_fmt ||
+      ca->enable_rate_guide_deltaq != cb->enable_rate_guide_deltaq ||
+      !same_string(ca->film_grain_filename, cb->film_grain_filename) ||
+#if CONFIG_TUNE_VMAF
+      !same_string(ca->vmaf_model_path, cb->vmaf_model_path) ||
+#endif
+      !same_string(ca->partition_info_path, cb->partition_info_path) ||
+      !same_string(ca->rate_distribution_info, cb->rate_distribution_info)) {
+    return 0;
+  }
+
+  memcpy(&cfg_b, &cb->cfg, sizeof(cfg_b));
+  cfg_b.rc_target_bitrate = ca->cfg.rc_target_bitrate;
+  if (memcmp(&ca->cfg, &cfg_b, sizeof(cfg_b))) return 0;
+
+  if (ca->arg_ctrl_cnt != cb->arg_ctrl_cnt) return 0;
+  for (i = 0; i < ca->arg_ctrl_cnt; ++i) {
+    if (ca->arg_ctrls[i][0] != cb->arg_ctrls[i][0] ||
+        ca->arg_ctrls[i][1] != cb->arg_ctrls[i][1]) {
+      return 0;
+    }
+  }
+
+  return key_vals_cover(ca, cb) && key_vals_cover(cb, ca);
+}
+
+// Returns whether a stream encodes in the given pass, rather than reusing the
+// statistics of another stream.
+static int stream_runs_pass(const struct stream_state *stream, int pass) {
+  return pass || !stream->first_pass_source || !stream->first_pass_checked;
+}
+
+// Lets each stream reuse the first pass of the first earlier stream that
+// is expected to produce the same statistics, so that a ladder of bitrates at
+// one resolution runs its first pass once.
+static void find_first_pass_sources(struct stream_state *streams, int quiet) {
+  FOREACH_STREAM(stream, streams) {
+    stream->first_pass_source = NULL;
+    stream->first_pass_checked = 0;
+    for (struct stream_state *source = streams; source != stream;
+         source = source->next) {
+      if (!source->first_pass_source &&
+          streams_share_first_pass(source, stream)) {
+        stream->first_pass_source = source;
+        if (!quiet) {
+          fprintf(stderr, "Stream %d: reusing the first pass of stream %d\n",
+                  stream->index, source->index);
+        }
+        break;
+      }
+    }
+  }
+}
+
+// The number of first pass statistics packets that a stream compares with
+// those of its first_pass_source before it stops running its first pass.
+#define FIRST_PASS_CHECK_PACKETS 8
+
+// Compares the first pass statistics of each stream that reuses the first
+// pass of another stream with the statistics of that stream. Once
+// FIRST_PASS_CHECK_PACKETS packets match, the stream stops running its first
+// pass. If they differ, the stream runs its whole first pass.
+static void check_first_pass_sources(struct stream_state *streams) {
+  FOREACH_STREAM(stream, streams) {
+    const struct stream_state *source = stream->first_pass_source;
+    if (!source || stream->first_pass_checked ||
+        stream->frames_out < FIRST_PASS_CHECK_PACKETS) {
+      continue;
+    }
+    const aom_fixed_buf_t *own = &stream->stats.buf;
+    const aom_fixed_buf_t *shared = &source->stats.buf;
+    if (shared->sz >= own->sz && !memcmp(shared->buf, own->buf, own->sz)) {
+      stream->first_pass_checked = 1;
+      aom_codec_destroy(&stream->encoder);
+    } else {
+      aom_tools_warn(
+          "Stream %d: first pass differs from stream %d, not reusing it\n",
+          stream->index, source->index);
+      stream->first_pass_source = NULL;
+    }
+  }
+}
+
 static const char *file_type_to_string(enum VideoFileType t) {
   switch (t) {
     case FILE_TYPE_RAW: return "RAW";
@@ -1512,10 +1720,16 @@ static void initialize_encoder(struct stream_state *stream,
 
   flags |= (global->show_psnr >= 1) ? AOM_CODEC_USE_PSNR : 0;
   flags |= stream->config.use_16bit_internal ? AOM_CODEC_USE_HIGHBITDEPTH : 0;
+  flags |= global->mem_report ? AOM_CODEC_USE_MEM_ACCOUNTING : 0;
+
+  static const aom_codec_allocator_t huge_page_allocator = {
+    NULL, NULL, NULL, /*use_huge_pages=*/1
+  };
 
   /* Construct Encoder Context */
-  aom_codec_enc_init(&stream->encoder, global->codec, &stream->config.cfg,
-                     flags);
+  aom_codec_enc_init_with_allocator(
+      &stream->encoder, global->codec, &stream->config.cfg, flags,
+      global->use_huge_pages ? &huge_page_allocator : NULL);
   ctx_exit_on_error(&stream->encoder, "Failed to initialize encoder");
 
   for (i = 0; i < stream->config.arg_ctrl_cnt; i++) {
@@ -1536,6 +1750,11 @@ static void initialize_encoder(struct stream_state *stream,
     ctx_exit_on_error(&stream->encoder, "Failed to set codec option");
   }
 
+  if (global->stage_timing) {
+    AOM_CODEC_CONTROL_TYPECHECKED(&stream->encoder, AV1E_SET_STAGE_TIMING, 1);
+    ctx_exit_on_error(&stream->encoder, "Failed to enable stage timing");
+  }
+
 #if CONFIG_TUNE_VMAF
   if (stream->config.vmaf_model_path) {
     AOM_CODEC_CONTROL_TYPECHECKED(&stream->encoder, AV1E_SET_VMAF_MODEL_PATH,
@@ -1731,17 +1950,51 @@ static void update_quantizer_histogram(struct stream_state *stream) {
   }
 }
 
+/* Writes a frame packet to the output file of a stream. Runs on the writer
+ * thread.
+ */
+static void write_frame_pkt(void *priv, const aom_codec_cx_pkt_t *pkt) {
+  struct stream_state *const stream = (struct stream_state *)priv;
+  static size_t fsize = 0;
+  static FileOffset ivf_header_pos = 0;
+
+#if CONFIG_WEBM_IO
+  if (stream->config.write_webm) {
+    if (write_webm_block(&stream->webm_ctx, &stream->config.cfg, pkt) != 0) {
+      fatal("WebM writer failed.");
+    }
+  }
+#endif
+  if (!stream->config.write_webm) {
+    if (stream->config.write_ivf) {
+      if (pkt->data.frame.partition_id <= 0) {
+        ivf_header_pos = ftello(stream->file);
+        fsize = pkt->data.frame.sz;
+
+        ivf_write_frame_header(stream->file, pkt->data.frame.pts, fsize);
+      } else {
+        fsize += pkt->data.frame.sz;
+
+        const FileOffset currpos = ftello(stream->file);
+        fseeko(stream->file, ivf_header_pos, SEEK_SET);
+        ivf_write_frame_size(stream->file, fsize);
+        fseeko(stream->file, currpos, SEEK_SET);
+      }
+    }
+
+    (void)fwrite(pkt->data.frame.buf, 1, pkt->data.frame.sz, stream->file);
+  }
+}
+
 static void get_cx_data(struct stream_state *stream,
-                        struct AvxEncoderConfig *global, int *got_data) {
+                        struct AvxEncoderConfig *global,
+                        AvxAsyncWriter *writer, int *got_data) {
   const aom_codec_cx_pkt_t *pkt;
   const struct aom_codec_enc_cfg *cfg = &stream->config.cfg;
   aom_codec_iter_t iter = NULL;
 
   *got_data = 0;
   while ((pkt = aom_codec_get_cx_data(&stream->encoder, &iter))) {
-    static size_t fsize = 0;
-    static FileOffset ivf_header_pos = 0;
-
     switch (pkt->kind) {
       case AOM_CODEC_CX_FRAME_PKT:
         ++stream->frames_out;
@@ -1749,32 +2002,8 @@ static void get_cx_data(struct stream_state *stream,
           fprintf(stderr, " %6luF", (unsigned long)pkt->data.frame.sz);
 
         update_rate_histogram(stream->rate_hist, cfg, pkt);
-#if CONFIG_WEBM_IO
-        if (stream->config.write_webm) {
-          if (write_webm_block(&stream->webm_ctx, cfg, pkt) != 0) {
-            fatal("WebM writer failed.");
-          }
-        }
-#endif
-        if (!stream->config.write_webm) {
-          if (stream->config.write_ivf) {
-            if (pkt->data.frame.partition_id <= 0) {
-              ivf_header_pos = ftello(stream->file);
-              fsize = pkt->data.frame.sz;
-
-              ivf_write_frame_header(stream->file, pkt->data.frame.pts, fsize);
-            } else {
-              fsize += pkt->data.frame.sz;
-
-              const FileOffset currpos = ftello(stream->file);
-              fseeko(stream->file, ivf_header_pos, SEEK_SET);
-              ivf_write_frame_size(stream->file, fsize);
-              fseeko(stream->file, currpos, SEEK_SET);
-            }
-          }
-
-          (void)fwrite(pkt->data.frame.buf, 1, pkt->data.frame.sz,
-                       stream->file);
+        if (!aom_async_writer_write(writer, write_frame_pkt, stream, pkt)) {
+          fatal("Failed to queue output packet.");
         }
         stream->nbytes += pkt->data.raw.sz;
 
@@ -1983,7 +2212,7 @@ static int pass_need_downscale(int global_pass, int global_passes, int pass) {
 
 int main(int argc, const char **argv_) {
   int pass;
-  aom_image_t raw;
+  aom_image_t *img = NULL;
   aom_image_t raw_shift;
   int allocated_raw_shift = 0;
   int do_16bit_internal = 0;
@@ -2000,7 +2229,6 @@ int main(int argc, const char **argv_) {
   int profile_updated = 0;
 
   memset(&input, 0, sizeof(input));
-  memset(&raw, 0, sizeof(raw));
   exec_name = argv_[0];
 
   /* Setup default input stream settings */
@@ -2087,6 +2315,7 @@ int main(int argc, const char **argv_) {
     int64_t estimated_time_left = -1;
     int64_t average_rate = -1;
     int64_t lagged_count = 0;
+    int64_t input_pos = 0;
     const int need_downscale =
         pass_need_downscale(global.pass, global.passes, pass);
 
@@ -2124,6 +2353,12 @@ int main(int argc, const char **argv_) {
 
     open_input_file(&input, global.csp);
 
+    /* Convert Y4M chroma with as many threads as the first stream encodes
+     * with, so that the conversion keeps up with the encoder.
+     */
+    if (input.file_type == FILE_TYPE_Y4M && streams->config.cfg.g_threads > 1)
+      input.y4m.num_threads = (int)streams->config.cfg.g_threads;
+
     /* If the input file doesn't specify its w/h (raw files), try to get
      * the data from the first stream's configuration.
      */
@@ -2383,18 +2618,20 @@ int main(int argc, const char **argv_) {
     }
 
     if (pass == (global.pass ? global.pass - 1 : 0)) {
-      // The Y4M reader does its own allocation.
-      if (input.file_type != FILE_TYPE_Y4M) {
-        aom_img_alloc(&raw, input.fmt, input.width, input.height, 32);
-      }
       FOREACH_STREAM(stream, streams) {
         stream->rate_hist =
             init_rate_histogram(&stream->config.cfg, &global.framerate);
       }
     }
 
+    if (pass == 0 && global.passes == 2) {
+      find_first_pass_sources(streams, global.quiet);
+    }
+
     FOREACH_STREAM(stream, streams) { setup_pass(stream, &global, pass); }
-    FOREACH_STREAM(stream, streams) { initialize_encoder(stream, &global); }
+    FOREACH_STREAM(stream, streams) {
+      if (stream_runs_pass(stream, pass)) initialize_encoder(stream, &global);
+    }
     FOREACH_STREAM(stream, streams) {
       char *encoder_settings = NULL;
 #if CONFIG_WEBM_IO
@@ -2433,6 +2670,13 @@ int main(int argc, const char **argv_) {
       }
     }
 
+    AvxAsyncReader *const reader = aom_async_reader_create(
+        read_frame_async, &input, ASYNC_INPUT_FRAMES, global.limit);
+    if (!reader) fatal("Failed to create the input reader.");
+    AvxAsyncWriter *const writer =
+        aom_async_writer_create(ASYNC_OUTPUT_PACKETS);
+    if (!writer) fatal("Failed to create the output writer.");
+
     frame_avail = 1;
     got_data = 0;
 
@@ -2440,7 +2684,8 @@ int main(int argc, const char **argv_) {
       struct aom_usec_timer timer;
 
       if (!global.limit || frames_in < global.limit) {
-        frame_avail = read_frame(&input, &raw);
+        img = aom_async_reader_next(reader, &input_pos);
+        frame_avail = img != NULL;
 
         if (frame_avail) frames_in++;
         seen_frames =
@@ -2473,36 +2718,37 @@ int main(int argc, const char **argv_) {
       }
 
       if (frames_in > global.skip_frames) {
-        aom_image_t *frame_to_encode;
-        if (input_shift || (do_16bit_internal && input.bit_depth == 8)) {
+        aom_image_t *frame_to_encode = frame_avail ? img : NULL;
+        if (frame_to_encode &&
+            (input_shift || (do_16bit_internal && input.bit_depth == 8))) {
           assert(do_16bit_internal);
           // Input bit depth and stream bit depth do not match, so up
           // shift frame to stream bit depth
           if (!allocated_raw_shift) {
-            aom_img_alloc(&raw_shift, raw.fmt | AOM_IMG_FMT_HIGHBITDEPTH,
+            aom_img_alloc(&raw_shift, img->fmt | AOM_IMG_FMT_HIGHBITDEPTH,
                           input.width, input.height, 32);
             allocated_raw_shift = 1;
           }
-          aom_img_upshift(&raw_shift, &raw, input_shift);
+          aom_img_upshift(&raw_shift, img, input_shift);
           frame_to_encode = &raw_shift;
-        } else {
-          frame_to_encode = &raw;
         }
         aom_usec_timer_start(&timer);
         if (do_16bit_internal) {
-          assert(frame_to_encode->fmt & AOM_IMG_FMT_HIGHBITDEPTH);
+          assert(!frame_to_encode ||
+                 (frame_to_encode->fmt & AOM_IMG_FMT_HIGHBITDEPTH));
           FOREACH_STREAM(stream, streams) {
+            if (!stream_runs_pass(stream, pass)) continue;
             if (stream->config.use_16bit_internal)
-              encode_frame(stream, &global,
-                           frame_avail ? frame_to_encode : NULL, frames_in);
+              encode_frame(stream, &global, frame_to_encode, frames_in);
             else
               assert(0);
           }
         } else {
-          assert((frame_to_encode->fmt & AOM_IMG_FMT_HIGHBITDEPTH) == 0);
+          assert(!frame_to_encode ||
+                 (frame_to_encode->fmt & AOM_IMG_FMT_HIGHBITDEPTH) == 0);
           FOREACH_STREAM(stream, streams) {
-            encode_frame(stream, &global, frame_avail ? frame_to_encode : NULL,
-                         frames_in);
+            if (stream_runs_pass(stream, pass))
+              encode_frame(stream, &global, frame_to_encode, frames_in);
           }
         }
         aom_usec_timer_mark(&timer);
@@ -2512,12 +2758,14 @@ int main(int argc, const char **argv_) {
 
         got_data = 0;
         FOREACH_STREAM(stream, streams) {
-          get_cx_data(stream, &global, &got_data);
+          if (stream_runs_pass(stream, pass))
+            get_cx_data(stream, &global, writer, &got_data);
         }
+        if (pass == 0) check_first_pass_sources(streams);
 
         if (!got_data && input.length && streams != NULL &&
             !streams->frames_out) {
-          lagged_count = global.limit ? seen_frames : ftello(input.file);
+          lagged_count = global.limit ? seen_frames : input_pos;
         } else if (input.length) {
           int64_t remaining;
           int64_t rate;
@@ -2529,7 +2777,6 @@ int main(int argc, const char **argv_) {
             remaining = 1000 * (global.limit - global.skip_frames -
                                 seen_frames + lagged_count);
           } else {
-            const int64_t input_pos = ftello(input.file);
             const int64_t input_pos_lagged = input_pos - lagged_count;
             const int64_t input_limit = input.length;
 
@@ -2544,7 +2791,8 @@ int main(int argc, const char **argv_) {
 
         if (got_data && global.test_decode != TEST_DECODE_OFF) {
           FOREACH_STREAM(stream, streams) {
-            test_decode(stream, global.test_decode);
+            if (stream_runs_pass(stream, pass))
+              test_decode(stream, global.test_decode);
           }
         }
       }
@@ -2553,6 +2801,9 @@ int main(int argc, const char **argv_) {
       if (!global.quiet) fprintf(stderr, "\033[K");
     }
 
+    aom_async_reader_destroy(reader);
+    aom_async_writer_destroy(writer);
+
     if (stream_cnt > 1) fprintf(stderr, "\n");
 
     if (!global.quiet) {
@@ -2633,6 +2884,38 @@ int main(int argc, const char **argv_) {
       }
     }
 
+    if (global.mem_report) {
+      FOREACH_STREAM(stream, streams) {
+        aom_mem_usage_t usage;
+        if (aom_codec_control(&stream->encoder, AV1E_GET_MEM_USAGE, &usage) ==
+            AOM_CODEC_OK) {
+          char label[32];
+          snprintf(label, sizeof(label), "Stream %d pass %d", stream->index,
+                   pass + 1);
+          print_mem_usage(label, &usage);
+        }
+      }
+    }
+
+    if (global.stage_timing) {
+      static const char *const stage_names[AOM_ENC_STAGE_COUNT] = {
+        "first pass",         "temporal filter",    "tpl",
+        "motion search",      "rd",                 "loop filter search",
+        "cdef search",        "restoration search", "pack"
+      };
+      FOREACH_STREAM(stream, streams) {
+        aom_enc_stage_timings_t timings;
+        if (aom_codec_control(&stream->encoder, AV1E_GET_STAGE_TIMINGS,
+                              &timings) == AOM_CODEC_OK) {
+          char label[32];
+          snprintf(label, sizeof(label), "Stream %d pass %d", stream->index,
+                   pass + 1);
+          print_stage_timings(label, stage_names, timings.total_us,
+                              AOM_ENC_STAGE_COUNT);
+        }
+      }
+    }
+
     FOREACH_STREAM(stream, streams) { aom_codec_destroy(&stream->encoder); }
 
     if (global.test_decode != TEST_DECODE_OFF) {
@@ -2648,6 +2931,18 @@ int main(int argc, const char **argv_) {
       close_output_file(stream, get_fourcc_by_aom_encoder(global.codec));
     }
 
+    // Append the statistics that a stream did not compute itself to the
+    // ones it checked.
+    FOREACH_STREAM(stream, streams) {
+      if (!stream_runs_pass(stream, pass)) {
+        const aom_fixed_buf_t *const own = &stream->stats.buf;
+        const aom_fixed_buf_t *const shared =
+            &stream->first_pass_source->stats.buf;
+        stats_write(&stream->stats, (const char *)shared->buf + own->sz,
+                    shared->sz - own->sz);
+      }
+    }
+
     FOREACH_STREAM(stream, streams) {
       stats_close(&stream->stats, global.passes - 1);
     }
@@ -2688,7 +2983,6 @@ int main(int argc, const char **argv_) {
 #endif
 
   if (allocated_raw_shift) aom_img_free(&raw_shift);
-  aom_img_free(&raw);
   free(argv);
   free(streams);
   return res ? EXIT_FAILURE : EXIT_SUCCESS;
@@ -47,6 +47,9 @@ struct AvxEncoderConfig {
   int show_rate_hist_buckets;
   int disable_warnings;
   int disable_warning_prompt;
+  int use_huge_pages;
+  int mem_report;
+  int stage_timing;
   int experimental_bitstream;
   aom_chroma_sample_position_t csp;
   cfg_options_t encoder_config;
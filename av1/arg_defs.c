@@ -188,6 +188,13 @@ const av1_codec_arg_definitions_t g_av1_codec_arg_defs = {
   .disable_warning_prompt =
       ARG_DEF("y", "disable-warning-prompt", 0,
               "Display warnings, but do not prompt user to continue"),
+  .huge_pages = ARG_DEF(NULL, "huge-pages", 0,
+                        "Back large frame buffers and analysis arrays with "
+                        "transparent huge pages"),
+  .mem_report = ARG_DEF(NULL, "mem-report", 0,
+                        "Show the peak memory usage of each encoder subsystem"),
+  .stage_timing = ARG_DEF(NULL, "stage-timing", 0,
+                          "Show the time spent in each encoder stage"),
   .bitdeptharg =
       ARG_DEF_ENUM("b", "bit-depth", 1, "Bit depth for codec", bitdepth_enum),
   .inbitdeptharg = ARG_DEF(NULL, "input-bit-depth", 1, "Bit depth of input"),
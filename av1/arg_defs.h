@@ -59,6 +59,9 @@ typedef struct av1_codec_arg_definitions {
   arg_def_t rate_hist_n;
   arg_def_t disable_warnings;
   arg_def_t disable_warning_prompt;
+  arg_def_t huge_pages;
+  arg_def_t mem_report;
+  arg_def_t stage_timing;
   arg_def_t bitdeptharg;
   arg_def_t inbitdeptharg;
   arg_def_t input_chroma_subsampling_x;
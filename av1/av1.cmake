@@ -80,6 +80,8 @@ list(APPEND AOM_AV1_COMMON_SOURCES
             "${AOM_ROOT}/av1/common/scan.h"
             "${AOM_ROOT}/av1/common/seg_common.c"
             "${AOM_ROOT}/av1/common/seg_common.h"
+            "${AOM_ROOT}/av1/common/stage_timer.c"
+            "${AOM_ROOT}/av1/common/stage_timer.h"
             "${AOM_ROOT}/av1/common/thread_common.c"
             "${AOM_ROOT}/av1/common/thread_common.h"
             "${AOM_ROOT}/av1/common/tile_common.c"
@@ -253,8 +255,6 @@ list(APPEND AOM_AV1_ENCODER_SOURCES
             "${AOM_ROOT}/third_party/fastfeat/fast.h"
             "${AOM_ROOT}/third_party/fastfeat/fast_9.c"
             "${AOM_ROOT}/third_party/fastfeat/nonmax.c"
-            "${AOM_ROOT}/third_party/vector/vector.c"
-            "${AOM_ROOT}/third_party/vector/vector.h"
             "${AOM_ROOT}/av1/encoder/dwt.c"
             "${AOM_ROOT}/av1/encoder/dwt.h")
 
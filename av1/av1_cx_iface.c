@@ -529,6 +529,13 @@ struct aom_codec_alg_priv {
   AV1_PRIMARY *ppi;
   unsigned char *cx_data;
   size_t cx_data_sz;
+  // Where encoder_encode() assembles the current temporal unit: cx_data, or
+  // the buffer set with aom_codec_set_cx_data_buf(). NULL between calls.
+  unsigned char *out_data;
+  // The size of out_data.
+  size_t out_data_sz;
+  // The room a frame needs in the application's buffer to be written there.
+  size_t max_frame_sz;
   size_t pending_cx_data_sz;
   aom_image_t preview_img;
   aom_enc_frame_flags_t next_frame_flags;
@@ -544,6 +551,16 @@ struct aom_codec_alg_priv {
   int num_lap_buffers;
   STATS_BUFFER_CTX stats_buf_context;
   bool monochrome_on_init;
+  // Borrow input images instead of copying them. Set by
+  // AV1E_SET_ZERO_COPY_INPUT.
+  aom_zero_copy_input_t zero_copy_input;
+  // Write the compressed data straight into the application's output buffer.
+  // Set by AV1E_SET_ZERO_COPY_OUTPUT.
+  unsigned int zero_copy_output;
+  // Encoder stage timings, and their totals in nanoseconds. Updated by
+  // encoder_encode() when AV1E_SET_STAGE_TIMING is enabled.
+  aom_enc_stage_timings_t stage_timings;
+  int64_t stage_total_ns[AOM_ENC_STAGE_COUNT];
 };
 
 static inline int gcd(int64_t a, int b) {
@@ -2763,8 +2780,8 @@ static aom_codec_err_t create_stats_buffer(FIRSTPASS_STATS **frame_stats_buffer,
   aom_codec_err_t res = AOM_CODEC_OK;
 
   int size = get_stats_buf_size(num_lap_buffers, MAX_LAG_BUFFERS);
-  *frame_stats_buffer =
-      (FIRSTPASS_STATS *)aom_calloc(size, sizeof(FIRSTPASS_STATS));
+  *frame_stats_buffer = (FIRSTPASS_STATS *)aom_calloc_tagged(
+      size, sizeof(FIRSTPASS_STATS), AOM_MEM_TAG_FIRSTPASS_STATS);
   if (*frame_stats_buffer == NULL) return AOM_CODEC_MEM_ERROR;
 
   stats_buf_context->stats_in_start = *frame_stats_buffer;
@@ -3075,13 +3092,104 @@ static inline int get_src_border_in_pixels(AV1_COMP *cpi, BLOCK_SIZE sb_size) {
   return border_in_pixels;
 }
 
+// Sets the border of the encoder's frame buffers for the current
+// configuration and returns the border of its lookahead buffers.
+static int set_border_in_pixels(AV1_PRIMARY *ppi) {
+  AV1_COMP *const cpi = ppi->cpi;
+  AV1EncoderConfig *oxcf = &cpi->oxcf;
+  const BLOCK_SIZE sb_size =
+      av1_select_sb_size(oxcf, oxcf->frm_dim_cfg.width,
+                         oxcf->frm_dim_cfg.height, ppi->number_spatial_layers);
+  oxcf->border_in_pixels =
+      av1_get_enc_border_size(av1_is_resize_needed(oxcf),
+                              oxcf->kf_cfg.key_freq_max == 0, sb_size);
+  for (int i = 0; i < ppi->num_fp_contexts; i++) {
+    ppi->parallel_cpi[i]->oxcf.border_in_pixels = oxcf->border_in_pixels;
+  }
+  return get_src_border_in_pixels(cpi, sb_size);
+}
+
 // TODO(Mufaddal): Check feasibility of abstracting functions related to LAP
 // into a separate function.
-static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
-                                      const aom_image_t *img,
-                                      aom_codec_pts_t pts,
-                                      unsigned long duration,
-                                      aom_enc_frame_flags_t enc_flags) {
+// Moves the stage times of all the frame level encoder instances into
+// ctx->stage_timings.
+static void update_stage_timings(aom_codec_alg_priv_t *ctx) {
+  AV1_PRIMARY *const ppi = ctx->ppi;
+  if (!ppi->stage_timing) return;
+  for (int stage = 0; stage < AOM_ENC_STAGE_COUNT; ++stage) {
+    int64_t time_ns = 0;
+    for (int i = 0; i < ppi->num_fp_contexts; ++i) {
+      time_ns += ppi->parallel_cpi[i]->stage_time_ns[stage];
+      ppi->parallel_cpi[i]->stage_time_ns[stage] = 0;
+    }
+    if (ppi->cpi_lap != NULL) {
+      time_ns += ppi->cpi_lap->stage_time_ns[stage];
+      ppi->cpi_lap->stage_time_ns[stage] = 0;
+    }
+    ctx->stage_total_ns[stage] += time_ns;
+    ctx->stage_timings.frame_us[stage] = time_ns / 1000;
+    ctx->stage_timings.total_us[stage] = ctx->stage_total_ns[stage] / 1000;
+  }
+}
+
+// Size of the temporal delimiter OBU that starts each temporal unit: a one
+// byte header and a one byte payload size.
+#define TEMPORAL_DELIMITER_SIZE 2
+
+// Assembles the next temporal unit straight in the application's buffer if
+// AV1E_SET_ZERO_COPY_OUTPUT is enabled and the buffer has room for a frame, so
+// that aom_codec_get_cx_data() does not have to copy the packet. A temporal
+// unit that is already under way carries on where it started.
+static void select_output_buffer(aom_codec_alg_priv_t *ctx) {
+  const aom_fixed_buf_t *const dst = &ctx->base.enc.cx_data_dst_buf;
+  const size_t pad_before = ctx->base.enc.cx_data_pad_before;
+  ctx->out_data = ctx->cx_data;
+  ctx->out_data_sz = ctx->cx_data_sz;
+  // The encoder may use the space past the end of the packet, so there must
+  // be no padding to preserve there.
+  if (ctx->zero_copy_output && ctx->cx_data && dst->buf &&
+      !ctx->pending_cx_data_sz && !ctx->base.enc.cx_data_pad_after &&
+      pad_before <= dst->sz &&
+      dst->sz - pad_before >= ctx->max_frame_sz) {
+    ctx->out_data = (unsigned char *)dst->buf + pad_before;
+    ctx->out_data_sz = dst->sz - pad_before;
+  }
+}
+
+// Moves the temporal unit under way to the internal buffer.
+static void use_internal_output_buffer(aom_codec_alg_priv_t *ctx) {
+  if (ctx->out_data != ctx->cx_data && ctx->pending_cx_data_sz) {
+    memcpy(ctx->cx_data, ctx->out_data, ctx->pending_cx_data_sz);
+  }
+  ctx->out_data = ctx->cx_data;
+  ctx->out_data_sz = ctx->cx_data_sz;
+}
+
+// Returns whether the output buffer has room for another frame of the
+// temporal unit. When the application's buffer is left with less than
+// max_frame_sz bytes, the temporal unit moves to the internal buffer, which
+// must have half of its size left.
+static int has_room_for_frame(aom_codec_alg_priv_t *ctx) {
+  if (ctx->out_data != ctx->cx_data &&
+      ctx->out_data_sz - ctx->pending_cx_data_sz < ctx->max_frame_sz) {
+    use_internal_output_buffer(ctx);
+  }
+  if (ctx->out_data != ctx->cx_data) return 1;
+  return ctx->cx_data_sz - ctx->pending_cx_data_sz >= ctx->cx_data_sz / 2;
+}
+
+// Moves an unfinished temporal unit back to the internal buffer, as the
+// application's buffer may change before the next call.
+static void release_output_buffer(aom_codec_alg_priv_t *ctx) {
+  if (ctx->out_data) use_internal_output_buffer(ctx);
+  ctx->out_data = NULL;
+}
+
+static aom_codec_err_t encoder_encode_internal(aom_codec_alg_priv_t *ctx,
+                                               const aom_image_t *img,
+                                               aom_codec_pts_t pts,
+                                               unsigned long duration,
+                                               aom_enc_frame_flags_t enc_flags) {
   const size_t kMinCompressedSize = 8192;
   volatile aom_codec_err_t res = AOM_CODEC_OK;
   AV1_PRIMARY *const ppi = ctx->ppi;
@@ -3129,6 +3237,12 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
         return AOM_CODEC_MEM_ERROR;
       size_t data_sz = uncompressed_frame_sz * multiplier;
       if (data_sz < kMinCompressedSize) data_sz = kMinCompressedSize;
+      // A frame written to the application's buffer needs room for twice the
+      // uncompressed size, as above, and kMinCompressedSize more for the
+      // temporal delimiter, the Annex B length fields and small frames.
+      if (uncompressed_frame_sz > (SIZE_MAX - kMinCompressedSize) / 2)
+        return AOM_CODEC_MEM_ERROR;
+      ctx->max_frame_sz = 2 * uncompressed_frame_sz + kMinCompressedSize;
       if (ctx->cx_data == NULL || ctx->cx_data_sz < data_sz) {
         ctx->cx_data_sz = data_sz;
         free(ctx->cx_data);
@@ -3164,6 +3278,7 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
   // before it returns.
   if (setjmp(ppi->error.jmp)) {
     ppi->error.setjmp = 0;
+    release_output_buffer(ctx);
     res = update_error_state(ctx, &ppi->error);
     return res;
   }
@@ -3257,24 +3372,15 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
       if (!ppi->lookahead) {
         int lag_in_frames = cpi_lap != NULL ? cpi_lap->oxcf.gf_cfg.lag_in_frames
                                             : cpi->oxcf.gf_cfg.lag_in_frames;
-        AV1EncoderConfig *oxcf = &cpi->oxcf;
-        const BLOCK_SIZE sb_size = av1_select_sb_size(
-            oxcf, oxcf->frm_dim_cfg.width, oxcf->frm_dim_cfg.height,
-            ppi->number_spatial_layers);
-        oxcf->border_in_pixels =
-            av1_get_enc_border_size(av1_is_resize_needed(oxcf),
-                                    oxcf->kf_cfg.key_freq_max == 0, sb_size);
-        for (int i = 0; i < ppi->num_fp_contexts; i++) {
-          ppi->parallel_cpi[i]->oxcf.border_in_pixels = oxcf->border_in_pixels;
-        }
-
-        const int src_border_in_pixels = get_src_border_in_pixels(cpi, sb_size);
+        const int src_border_in_pixels = set_border_in_pixels(ppi);
         ppi->lookahead = av1_lookahead_init(
             cpi->oxcf.frm_dim_cfg.width, cpi->oxcf.frm_dim_cfg.height,
             subsampling_x, subsampling_y, use_highbitdepth, lag_in_frames,
             src_border_in_pixels, cpi->common.features.byte_alignment,
             ctx->num_lap_buffers, (cpi->oxcf.kf_cfg.key_freq_max == 0),
             cpi->alloc_pyramid);
+        if (ppi->lookahead)
+          av1_lookahead_set_zero_copy(ppi->lookahead, &ctx->zero_copy_input);
       }
       if (!ppi->lookahead)
         aom_internal_error(&ppi->error, AOM_CODEC_MEM_ERROR,
@@ -3300,14 +3406,16 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
       // Store the original flags in to the frame buffer. Will extract the
       // key frame flag when we actually encode this frame.
       if (av1_receive_raw_frame(cpi, flags | ctx->next_frame_flags, &sd,
-                                src_time_stamp, src_end_time_stamp)) {
+                                src_time_stamp, src_end_time_stamp,
+                                img->user_priv)) {
         res = update_error_state(ctx, cpi->common.error);
       }
       ctx->next_frame_flags = 0;
     }
 
-    cpi_data.cx_data = ctx->cx_data;
-    cpi_data.cx_data_sz = ctx->cx_data_sz;
+    select_output_buffer(ctx);
+    cpi_data.cx_data = ctx->out_data;
+    cpi_data.cx_data_sz = ctx->out_data_sz;
 
     /* Any pending invisible frames? */
     if (ctx->pending_cx_data_sz) {
@@ -3317,7 +3425,7 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
       /* TODO: this is a minimal check, the underlying codec doesn't respect
        * the buffer size anyway.
        */
-      if (cpi_data.cx_data_sz < ctx->cx_data_sz / 2) {
+      if (cpi_data.cx_data_sz < ctx->out_data_sz / 2) {
         aom_internal_error(&ppi->error, AOM_CODEC_ERROR,
                            "Compressed data buffer too small");
       }
@@ -3412,9 +3520,18 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
 
     // Get the next visible frame. Invisible frames get packed with the next
     // visible frame.
-    while (cpi_data.cx_data_sz >= ctx->cx_data_sz / 2 && !is_frame_visible) {
+    while (!is_frame_visible && has_room_for_frame(ctx)) {
       int simulate_parallel_frame = 0;
       int status = -1;
+      // Leave room for the temporal delimiter in front of the first frame of
+      // a temporal unit, so that the frame need not be moved to insert it.
+      const size_t td_room = ctx->out_data && !ctx->pending_cx_data_sz &&
+                                     !cpi->common.spatial_layer_id
+                                 ? TEMPORAL_DELIMITER_SIZE
+                                 : 0;
+      cpi_data.cx_data = ctx->out_data + ctx->pending_cx_data_sz + td_room;
+      cpi_data.cx_data_sz =
+          ctx->out_data_sz - ctx->pending_cx_data_sz - td_room;
       cpi->do_frame_data_update = true;
       cpi->ref_idx_to_skip = INVALID_IDX;
       cpi->ref_refresh_index = INVALID_IDX;
@@ -3482,6 +3599,8 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
         aom_internal_error(&ppi->error, AOM_CODEC_ERROR,
                            "cpi_data.cx_data buffer overflow");
       }
+      cpi_data.cx_data -= td_room;
+      cpi_data.cx_data_sz += td_room;
       const int write_temporal_delimiter =
           !cpi->common.spatial_layer_id && !ctx->pending_cx_data_sz;
 
@@ -3492,28 +3611,36 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
             aom_uleb_size_in_bytes(obu_payload_size);
 
         const size_t move_offset = obu_header_size + length_field_size;
-        assert(ctx->cx_data_sz == cpi_data.cx_data_sz);
-        if (move_offset > ctx->cx_data_sz - cpi_data.frame_size) {
-          aom_internal_error(&ppi->error, AOM_CODEC_ERROR,
-                             "ctx->cx_data buffer full");
+        assert(move_offset == TEMPORAL_DELIMITER_SIZE);
+        assert(ctx->out_data_sz == cpi_data.cx_data_sz);
+        if (td_room != move_offset) {
+          if (move_offset > ctx->out_data_sz - cpi_data.frame_size) {
+            aom_internal_error(&ppi->error, AOM_CODEC_ERROR,
+                               "ctx->cx_data buffer full");
+          }
+          memmove(ctx->out_data + move_offset, ctx->out_data,
+                  cpi_data.frame_size);
         }
-        memmove(ctx->cx_data + move_offset, ctx->cx_data, cpi_data.frame_size);
         obu_header_size = av1_write_obu_header(
             &ppi->level_params, &cpi->frame_header_count,
             OBU_TEMPORAL_DELIMITER,
-            ppi->seq_params.has_nonzero_operating_point_idc, 0, ctx->cx_data);
+            ppi->seq_params.has_nonzero_operating_point_idc, 0, ctx->out_data);
         if (obu_header_size != 1) {
           aom_internal_error(&ppi->error, AOM_CODEC_ERROR, NULL);
         }
 
         // OBUs are preceded/succeeded by an unsigned leb128 coded integer.
         if (av1_write_uleb_obu_size(obu_payload_size,
-                                    ctx->cx_data + obu_header_size,
+                                    ctx->out_data + obu_header_size,
                                     length_field_size) != AOM_CODEC_OK) {
           aom_internal_error(&ppi->error, AOM_CODEC_ERROR, NULL);
         }
 
         cpi_data.frame_size += move_offset;
+      } else if (td_room) {
+        // The encoder switched to another spatial layer; no delimiter needed.
+        memmove(cpi_data.cx_data, cpi_data.cx_data + td_room,
+                cpi_data.frame_size);
       }
 
       if (ctx->oxcf.save_as_annexb) {
@@ -3560,17 +3687,17 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
         //  B_PRIME (add TU size)
         size_t tu_size = ctx->pending_cx_data_sz;
         const size_t length_field_size = aom_uleb_size_in_bytes(tu_size);
-        if (tu_size > ctx->cx_data_sz) {
+        if (tu_size > ctx->out_data_sz) {
           aom_internal_error(&ppi->error, AOM_CODEC_ERROR,
                              "ctx->cx_data buffer overflow");
         }
-        if (length_field_size > ctx->cx_data_sz - tu_size) {
+        if (length_field_size > ctx->out_data_sz - tu_size) {
           aom_internal_error(&ppi->error, AOM_CODEC_ERROR,
                              "ctx->cx_data buffer full");
         }
-        memmove(ctx->cx_data + length_field_size, ctx->cx_data, tu_size);
-        if (av1_write_uleb_obu_size(tu_size, ctx->cx_data, length_field_size) !=
-            AOM_CODEC_OK) {
+        memmove(ctx->out_data + length_field_size, ctx->out_data, tu_size);
+        if (av1_write_uleb_obu_size(tu_size, ctx->out_data,
+                                    length_field_size) != AOM_CODEC_OK) {
           aom_internal_error(&ppi->error, AOM_CODEC_ERROR, NULL);
         }
         ctx->pending_cx_data_sz += length_field_size;
@@ -3578,8 +3705,14 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
 
       pkt.kind = AOM_CODEC_CX_FRAME_PKT;
 
-      pkt.data.frame.buf = ctx->cx_data;
+      pkt.data.frame.buf = ctx->out_data;
       pkt.data.frame.sz = ctx->pending_cx_data_sz;
+      if (ctx->out_data != ctx->cx_data) {
+        // aom_codec_get_cx_data() recognizes its buffer by the start of the
+        // padding, and moves past the whole packet.
+        pkt.data.frame.buf = ctx->out_data - ctx->base.enc.cx_data_pad_before;
+        pkt.data.frame.sz += ctx->base.enc.cx_data_pad_before;
+      }
       pkt.data.frame.partition_id = -1;
       pkt.data.frame.vis_frame_size = cpi_data.frame_size;
 
@@ -3604,12 +3737,34 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
 
       ctx->pending_cx_data_sz = 0;
     }
+    release_output_buffer(ctx);
   }
 
+  update_stage_timings(ctx);
   ppi->error.setjmp = 0;
   return res;
 }
 
+static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
+                                      const aom_image_t *img,
+                                      aom_codec_pts_t pts,
+                                      unsigned long duration,
+                                      aom_enc_frame_flags_t enc_flags) {
+  // With zero copy input, an image that never makes it into the lookahead
+  // queue is released here, as the queue only releases the images it holds.
+  const struct lookahead_ctx *lookahead = ctx->ppi->lookahead;
+  const int push_frame_count = lookahead ? lookahead->push_frame_count : 0;
+  const aom_codec_err_t res =
+      encoder_encode_internal(ctx, img, pts, duration, enc_flags);
+  lookahead = ctx->ppi->lookahead;
+  if (img != NULL && ctx->zero_copy_input.release_cb != NULL &&
+      (lookahead ? lookahead->push_frame_count : 0) == push_frame_count) {
+    ctx->zero_copy_input.release_cb(ctx->zero_copy_input.cb_priv,
+                                    img->user_priv);
+  }
+  return res;
+}
+
 static const aom_codec_cx_pkt_t *encoder_get_cxdata(aom_codec_alg_priv_t *ctx,
                                                     aom_codec_iter_t *iter) {
   return aom_codec_pkt_list_get(&ctx->pkt_list.head, iter);
@@ -4551,6 +4706,101 @@ static aom_codec_err_t ctrl_get_high_motion_content_screen_rtc(
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_rtc_frame_time_budget(
+    aom_codec_alg_priv_t *ctx, va_list args) {
+  const unsigned int budget_us = CAST(AV1E_SET_RTC_FRAME_TIME_BUDGET, args);
+  if (ctx->cfg.g_usage != AOM_USAGE_REALTIME) return AOM_CODEC_INCAPABLE;
+  RTC_TIME_BUDGET *const tb = &ctx->ppi->cpi->time_budget;
+  tb->budget_us = budget_us;
+  if (budget_us == 0) tb->speed_offset = 0;
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_rtc_time_budget_stats(
+    aom_codec_alg_priv_t *ctx, va_list args) {
+  aom_rtc_time_budget_stats_t *const stats =
+      va_arg(args, aom_rtc_time_budget_stats_t *);
+  if (stats == NULL) return AOM_CODEC_INVALID_PARAM;
+  const RTC_TIME_BUDGET *const tb = &ctx->ppi->cpi->time_budget;
+  stats->budget_us = (unsigned int)tb->budget_us;
+  stats->last_time_us = (unsigned int)AOMMIN(tb->last_time_us, UINT_MAX);
+  stats->avg_time_us = (unsigned int)AOMMIN(tb->avg_time_us, UINT_MAX);
+  stats->frame_count = tb->frame_count;
+  stats->over_budget_count = tb->over_budget_count;
+  stats->speed = tb->last_speed;
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_zero_copy_input(aom_codec_alg_priv_t *ctx,
+                                                va_list args) {
+  const aom_zero_copy_input_t *const zero_copy =
+      CAST(AV1E_SET_ZERO_COPY_INPUT, args);
+  if (ctx->ppi->lookahead != NULL) {
+    ERROR("AV1E_SET_ZERO_COPY_INPUT must be set before the first frame");
+  }
+  if (zero_copy == NULL) {
+    memset(&ctx->zero_copy_input, 0, sizeof(ctx->zero_copy_input));
+  } else {
+    ctx->zero_copy_input = *zero_copy;
+  }
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_zero_copy_output(aom_codec_alg_priv_t *ctx,
+                                                va_list args) {
+  const unsigned int zero_copy_output = CAST(AV1E_SET_ZERO_COPY_OUTPUT, args);
+  if (zero_copy_output > 1) return AOM_CODEC_INVALID_PARAM;
+  ctx->zero_copy_output = zero_copy_output;
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_input_border(aom_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  int *const arg = va_arg(args, int *);
+  if (arg == NULL) return AOM_CODEC_INVALID_PARAM;
+  AV1_PRIMARY *const ppi = ctx->ppi;
+  *arg = ppi->lookahead != NULL ? ppi->lookahead->buf->img.border
+                                : set_border_in_pixels(ppi);
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_mem_usage(aom_codec_alg_priv_t *ctx,
+                                          va_list args) {
+  aom_mem_usage_t *const usage = va_arg(args, aom_mem_usage_t *);
+  if (usage == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (ctx->base.mem_accounting == NULL) return AOM_CODEC_INCAPABLE;
+  aom_mem_accounting_get_usage(ctx->base.mem_accounting, usage);
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_stage_timing(aom_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  const unsigned int stage_timing = CAST(AV1E_SET_STAGE_TIMING, args);
+  if (stage_timing > 1) return AOM_CODEC_INVALID_PARAM;
+  AV1_PRIMARY *const ppi = ctx->ppi;
+  if (stage_timing && !ppi->stage_timing) {
+    // Start from zero, discarding any times left from an earlier run.
+    for (int i = 0; i < ppi->num_fp_contexts; ++i) {
+      av1_zero(ppi->parallel_cpi[i]->stage_time_ns);
+    }
+    if (ppi->cpi_lap != NULL) av1_zero(ppi->cpi_lap->stage_time_ns);
+    av1_zero(ctx->stage_timings);
+    av1_zero(ctx->stage_total_ns);
+  }
+  ppi->stage_timing = stage_timing;
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_stage_timings(aom_codec_alg_priv_t *ctx,
+                                              va_list args) {
+  aom_enc_stage_timings_t *const timings =
+      va_arg(args, aom_enc_stage_timings_t *);
+  if (timings == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (!ctx->ppi->stage_timing) return AOM_CODEC_INCAPABLE;
+  *timings = ctx->stage_timings;
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1_COPY_REFERENCE, ctrl_copy_reference },
   { AOME_USE_REFERENCE, ctrl_use_reference },
@@ -4719,6 +4969,14 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1E_GET_LUMA_CDEF_STRENGTH, ctrl_get_luma_cdef_strength },
   { AV1E_GET_HIGH_MOTION_CONTENT_SCREEN_RTC,
     ctrl_get_high_motion_content_screen_rtc },
+  { AV1E_SET_RTC_FRAME_TIME_BUDGET, ctrl_set_rtc_frame_time_budget },
+  { AV1E_GET_RTC_TIME_BUDGET_STATS, ctrl_get_rtc_time_budget_stats },
+  { AV1E_SET_ZERO_COPY_INPUT, ctrl_set_zero_copy_input },
+  { AV1E_GET_INPUT_BORDER, ctrl_get_input_border },
+  { AV1E_GET_MEM_USAGE, ctrl_get_mem_usage },
+  { AV1E_SET_STAGE_TIMING, ctrl_set_stage_timing },
+  { AV1E_GET_STAGE_TIMINGS, ctrl_get_stage_timings },
+  { AV1E_SET_ZERO_COPY_OUTPUT, ctrl_set_zero_copy_output },
 
   CTRL_MAP_END,
 };
@@ -22,6 +22,7 @@
 #include "aom/aom_image.h"
 #include "aom_dsp/bitreader_buffer.h"
 #include "aom_dsp/aom_dsp_common.h"
+#include "aom_mem/aom_mem.h"
 #include "aom_ports/mem.h"
 #include "aom_ports/mem_ops.h"
 #include "aom_util/aom_pthread.h"
@@ -81,6 +82,12 @@ struct aom_codec_alg_priv {
   aom_inspect_cb inspect_cb;
   void *inspect_ctx;
 #endif
+
+  // Decoder stage timings, and their totals in nanoseconds. Updated by
+  // decoder_decode() when AV1D_SET_STAGE_TIMING is enabled.
+  unsigned int stage_timing;
+  aom_dec_stage_timings_t stage_timings;
+  int64_t stage_total_ns[AOM_DEC_STAGE_COUNT];
 };
 
 static aom_codec_err_t decoder_init(aom_codec_ctx_t *ctx) {
@@ -544,6 +551,7 @@ static aom_codec_err_t decode_one(aom_codec_alg_priv_t *ctx,
   frame_worker_data->pbi->dec_tile_col = ctx->decode_tile_col;
   frame_worker_data->pbi->ext_tile_debug = ctx->ext_tile_debug;
   frame_worker_data->pbi->row_mt = ctx->row_mt;
+  frame_worker_data->pbi->stage_timing = ctx->stage_timing;
   frame_worker_data->pbi->ext_refs = ctx->ext_refs;
 
   frame_worker_data->pbi->is_annexb = ctx->is_annexb;
@@ -672,6 +680,21 @@ static aom_codec_err_t decoder_inspect(aom_codec_alg_priv_t *ctx,
   return res;
 }
 
+// Moves the stage times of the decoder into ctx->stage_timings.
+static void update_stage_timings(aom_codec_alg_priv_t *ctx) {
+  if (!ctx->stage_timing) return;
+  FrameWorkerData *const frame_worker_data =
+      (FrameWorkerData *)ctx->frame_worker->data1;
+  AV1Decoder *const pbi = frame_worker_data->pbi;
+  for (int stage = 0; stage < AOM_DEC_STAGE_COUNT; ++stage) {
+    const int64_t time_ns = pbi->stage_time_ns[stage];
+    pbi->stage_time_ns[stage] = 0;
+    ctx->stage_total_ns[stage] += time_ns;
+    ctx->stage_timings.frame_us[stage] = time_ns / 1000;
+    ctx->stage_timings.total_us[stage] = ctx->stage_total_ns[stage] / 1000;
+  }
+}
+
 static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
                                       const uint8_t *data, size_t data_sz,
                                       void *user_priv) {
@@ -747,6 +770,7 @@ static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
     }
   }
 
+  update_stage_timings(ctx);
   return res;
 }
 
@@ -1524,6 +1548,15 @@ static aom_codec_err_t ctrl_get_mi_info(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_get_mem_usage(aom_codec_alg_priv_t *ctx,
+                                          va_list args) {
+  aom_mem_usage_t *const usage = va_arg(args, aom_mem_usage_t *);
+  if (usage == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (ctx->base.mem_accounting == NULL) return AOM_CODEC_INCAPABLE;
+  aom_mem_accounting_get_usage(ctx->base.mem_accounting, usage);
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_err_t ctrl_set_invert_tile_order(aom_codec_alg_priv_t *ctx,
                                                   va_list args) {
   ctx->invert_tile_order = va_arg(args, int);
@@ -1666,6 +1699,28 @@ static aom_codec_err_t ctrl_set_row_mt(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_stage_timing(aom_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  const unsigned int stage_timing = va_arg(args, unsigned int);
+  if (stage_timing > 1) return AOM_CODEC_INVALID_PARAM;
+  if (stage_timing && !ctx->stage_timing) {
+    av1_zero(ctx->stage_timings);
+    av1_zero(ctx->stage_total_ns);
+  }
+  ctx->stage_timing = stage_timing;
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_stage_timings(aom_codec_alg_priv_t *ctx,
+                                              va_list args) {
+  aom_dec_stage_timings_t *const timings =
+      va_arg(args, aom_dec_stage_timings_t *);
+  if (timings == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (!ctx->stage_timing) return AOM_CODEC_INCAPABLE;
+  *timings = ctx->stage_timings;
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_COPY_REFERENCE, ctrl_copy_reference },
 
@@ -1685,6 +1740,7 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1D_SET_ROW_MT, ctrl_set_row_mt },
   { AV1D_SET_EXT_REF_PTR, ctrl_set_ext_ref_ptr },
   { AV1D_SET_SKIP_FILM_GRAIN, ctrl_set_skip_film_grain },
+  { AV1D_SET_STAGE_TIMING, ctrl_set_stage_timing },
 
   // Getters
   { AOMD_GET_FRAME_CORRUPTED, ctrl_get_frame_corrupted },
@@ -1715,6 +1771,8 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AOMD_GET_BASE_Q_IDX, ctrl_get_base_q_idx },
   { AOMD_GET_ORDER_HINT, ctrl_get_order_hint },
   { AV1D_GET_MI_INFO, ctrl_get_mi_info },
+  { AV1D_GET_MEM_USAGE, ctrl_get_mem_usage },
+  { AV1D_GET_STAGE_TIMINGS, ctrl_get_stage_timings },
   CTRL_MAP_END,
 };
 
@@ -150,8 +150,10 @@ static inline void alloc_cdef_linebuf(AV1_COMMON *const cm, uint16_t **linebuf,
   CdefInfo *cdef_info = &cm->cdef_info;
   for (int plane = 0; plane < num_planes; plane++) {
     if (linebuf[plane] == NULL)
-      CHECK_MEM_ERROR(cm, linebuf[plane],
-                      aom_malloc(cdef_info->allocated_linebuf_size[plane]));
+      CHECK_MEM_ERROR(
+          cm, linebuf[plane],
+          aom_malloc_tagged(cdef_info->allocated_linebuf_size[plane],
+                            AOM_MEM_TAG_LOOP_FILTER));
   }
 }
 
@@ -160,12 +162,14 @@ static inline void alloc_cdef_bufs(AV1_COMMON *const cm, uint16_t **colbuf,
   CdefInfo *cdef_info = &cm->cdef_info;
   if (*srcbuf == NULL)
     CHECK_MEM_ERROR(cm, *srcbuf,
-                    aom_memalign(16, cdef_info->allocated_srcbuf_size));
+                    aom_memalign_tagged(16, cdef_info->allocated_srcbuf_size,
+                                        AOM_MEM_TAG_LOOP_FILTER));
 
   for (int plane = 0; plane < num_planes; plane++) {
     if (colbuf[plane] == NULL)
       CHECK_MEM_ERROR(cm, colbuf[plane],
-                      aom_malloc(cdef_info->allocated_colbuf_size[plane]));
+                      aom_malloc_tagged(cdef_info->allocated_colbuf_size[plane],
+                                        AOM_MEM_TAG_LOOP_FILTER));
   }
 }
 
@@ -301,7 +305,8 @@ void av1_alloc_restoration_buffers(AV1_COMMON *cm, bool is_sgr_enabled) {
 
   if (cm->rst_tmpbuf == NULL && is_sgr_enabled) {
     CHECK_MEM_ERROR(cm, cm->rst_tmpbuf,
-                    (int32_t *)aom_memalign(16, RESTORATION_TMPBUF_SIZE));
+                    (int32_t *)aom_memalign_tagged(16, RESTORATION_TMPBUF_SIZE,
+                                                   AOM_MEM_TAG_LOOP_FILTER));
   }
 
   if (cm->rlbs == NULL) {
@@ -337,9 +342,11 @@ void av1_alloc_restoration_buffers(AV1_COMMON *cm, bool is_sgr_enabled) {
       aom_free(boundaries->stripe_boundary_below);
 
       CHECK_MEM_ERROR(cm, boundaries->stripe_boundary_above,
-                      (uint8_t *)aom_memalign(32, buf_size));
+                      (uint8_t *)aom_memalign_tagged(32, buf_size,
+                                                     AOM_MEM_TAG_LOOP_FILTER));
       CHECK_MEM_ERROR(cm, boundaries->stripe_boundary_below,
-                      (uint8_t *)aom_memalign(32, buf_size));
+                      (uint8_t *)aom_memalign_tagged(32, buf_size,
+                                                     AOM_MEM_TAG_LOOP_FILTER));
 
       boundaries->stripe_boundary_size = buf_size;
     }
@@ -466,17 +473,17 @@ static int alloc_mi(CommonModeInfoParams *mi_params) {
       mi_params->mi_grid_size < mi_grid_size) {
     mi_params->free_mi(mi_params);
 
-    mi_params->mi_alloc =
-        aom_calloc(alloc_mi_size, sizeof(*mi_params->mi_alloc));
+    mi_params->mi_alloc = aom_calloc_tagged(
+        alloc_mi_size, sizeof(*mi_params->mi_alloc), AOM_MEM_TAG_MODE_INFO);
     if (!mi_params->mi_alloc) return 1;
     mi_params->mi_alloc_size = alloc_mi_size;
 
-    mi_params->mi_grid_base = (MB_MODE_INFO **)aom_calloc(
-        mi_grid_size, sizeof(*mi_params->mi_grid_base));
+    mi_params->mi_grid_base = (MB_MODE_INFO **)aom_calloc_tagged(
+        mi_grid_size, sizeof(*mi_params->mi_grid_base), AOM_MEM_TAG_MODE_INFO);
     if (!mi_params->mi_grid_base) return 1;
 
-    mi_params->tx_type_map =
-        aom_calloc(mi_grid_size, sizeof(*mi_params->tx_type_map));
+    mi_params->tx_type_map = aom_calloc_tagged(
+        mi_grid_size, sizeof(*mi_params->tx_type_map), AOM_MEM_TAG_MODE_INFO);
     if (!mi_params->tx_type_map) return 1;
     mi_params->mi_grid_size = mi_grid_size;
   }
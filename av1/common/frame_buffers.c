@@ -73,7 +73,8 @@ int av1_get_frame_buffer(void *cb_priv, size_t min_size,
     // The data must be zeroed to fix a valgrind error from the C loop filter
     // due to access uninitialized memory in frame border. It could be
     // skipped if border were totally removed.
-    int_fb_list->int_fb[i].data = (uint8_t *)aom_calloc(1, min_size);
+    int_fb_list->int_fb[i].data =
+        (uint8_t *)aom_calloc_tagged(1, min_size, AOM_MEM_TAG_FRAME_BUFFER);
     if (!int_fb_list->int_fb[i].data) {
       int_fb_list->int_fb[i].size = 0;
       return -1;
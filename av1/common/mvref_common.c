@@ -907,17 +907,10 @@ static int get_block_position(AV1_COMMON *cm, int *mi_r, int *mi_c, int blk_row,
   return 1;
 }
 
-// Note: motion_filed_projection finds motion vectors of current frame's
-// reference frame, and projects them to current frame. To make it clear,
-// let's call current frame's reference frame as start frame.
-// Call Start frame's reference frames as reference frames.
-// Call ref_offset as frame distances between start frame and its reference
-// frames.
-static int motion_field_projection(AV1_COMMON *cm,
-                                   MV_REFERENCE_FRAME start_frame, int dir) {
-  TPL_MV_REF *tpl_mvs_base = cm->tpl_mvs;
-  int ref_offset[REF_FRAMES] = { 0 };
-
+// Returns 1 if the motion vectors of start_frame can be projected to the
+// current frame.
+static int motion_field_projection_allowed(const AV1_COMMON *cm,
+                                           MV_REFERENCE_FRAME start_frame) {
   const RefCntBuffer *const start_frame_buf =
       get_ref_frame_buf(cm, start_frame);
   if (start_frame_buf == NULL) return 0;
@@ -930,6 +923,28 @@ static int motion_field_projection(AV1_COMMON *cm,
       start_frame_buf->mi_cols != cm->mi_params.mi_cols)
     return 0;
 
+  return 1;
+}
+
+// Note: motion_filed_projection finds motion vectors of current frame's
+// reference frame, and projects them to current frame. To make it clear,
+// let's call current frame's reference frame as start frame.
+// Call Start frame's reference frames as reference frames.
+// Call ref_offset as frame distances between start frame and its reference
+// frames.
+// Only the 8x8 block rows in [start_blk_row, end_blk_row) of the start frame
+// are projected. As get_block_position() keeps a projection within its 64x64
+// block row, this only writes to the same rows of tpl_mvs.
+static void motion_field_projection(AV1_COMMON *cm,
+                                    MV_REFERENCE_FRAME start_frame, int dir,
+                                    int start_blk_row, int end_blk_row) {
+  TPL_MV_REF *tpl_mvs_base = cm->tpl_mvs;
+  int ref_offset[REF_FRAMES] = { 0 };
+
+  const RefCntBuffer *const start_frame_buf =
+      get_ref_frame_buf(cm, start_frame);
+  assert(motion_field_projection_allowed(cm, start_frame));
+
   const int start_frame_order_hint = start_frame_buf->order_hint;
   const unsigned int *const ref_order_hints =
       &start_frame_buf->ref_order_hints[0];
@@ -948,8 +963,9 @@ static int motion_field_projection(AV1_COMMON *cm,
   MV_REF *mv_ref_base = start_frame_buf->mvs;
   const int mvs_rows = (cm->mi_params.mi_rows + 1) >> 1;
   const int mvs_cols = (cm->mi_params.mi_cols + 1) >> 1;
+  end_blk_row = AOMMIN(end_blk_row, mvs_rows);
 
-  for (int blk_row = 0; blk_row < mvs_rows; ++blk_row) {
+  for (int blk_row = start_blk_row; blk_row < end_blk_row; ++blk_row) {
     for (int blk_col = 0; blk_col < mvs_cols; ++blk_col) {
       MV_REF *mv_ref = &mv_ref_base[blk_row * mvs_cols + blk_col];
       MV fwd_mv = mv_ref->mv.as_mv;
@@ -981,8 +997,6 @@ static int motion_field_projection(AV1_COMMON *cm,
       }
     }
   }
-
-  return 1;
 }
 
 // cm->ref_frame_side is calculated here, and will be used in
@@ -1008,22 +1022,16 @@ void av1_calculate_ref_frame_side(AV1_COMMON *cm) {
   }
 }
 
-void av1_setup_motion_field(AV1_COMMON *cm) {
+// Gets the reference frames whose motion vectors are projected to the
+// current frame, in projection order, and returns their count.
+static int get_motion_field_refs(const AV1_COMMON *cm,
+                                 MV_REFERENCE_FRAME refs[INTER_REFS_PER_FRAME],
+                                 int dirs[INTER_REFS_PER_FRAME]) {
   const OrderHintInfo *const order_hint_info = &cm->seq_params->order_hint_info;
-
-  if (!order_hint_info->enable_order_hint) return;
-
-  TPL_MV_REF *tpl_mvs_base = cm->tpl_mvs;
-  int size = ((cm->mi_params.mi_rows + MAX_MIB_SIZE) >> 1) *
-             (cm->mi_params.mi_stride >> 1);
-  for (int idx = 0; idx < size; ++idx) {
-    tpl_mvs_base[idx].mfmv0.as_int = INVALID_MV;
-    tpl_mvs_base[idx].ref_frame_offset = 0;
-  }
-
   const int cur_order_hint = cm->cur_frame->order_hint;
   const RefCntBuffer *ref_buf[INTER_REFS_PER_FRAME];
   int ref_order_hint[INTER_REFS_PER_FRAME];
+  int num_refs = 0;
 
   for (int ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ref_frame++) {
     const int ref_idx = ref_frame - LAST_FRAME;
@@ -1045,29 +1053,80 @@ void av1_setup_motion_field(AV1_COMMON *cm) {
 
     const int is_lst_overlay =
         (alt_of_lst_order_hint == ref_order_hint[GOLDEN_FRAME - LAST_FRAME]);
-    if (!is_lst_overlay) motion_field_projection(cm, LAST_FRAME, 2);
+    if (!is_lst_overlay && motion_field_projection_allowed(cm, LAST_FRAME)) {
+      refs[num_refs] = LAST_FRAME;
+      dirs[num_refs++] = 2;
+    }
     --ref_stamp;
   }
 
   if (get_relative_dist(order_hint_info,
                         ref_order_hint[BWDREF_FRAME - LAST_FRAME],
-                        cur_order_hint) > 0) {
-    if (motion_field_projection(cm, BWDREF_FRAME, 0)) --ref_stamp;
+                        cur_order_hint) > 0 &&
+      motion_field_projection_allowed(cm, BWDREF_FRAME)) {
+    refs[num_refs] = BWDREF_FRAME;
+    dirs[num_refs++] = 0;
+    --ref_stamp;
   }
 
   if (get_relative_dist(order_hint_info,
                         ref_order_hint[ALTREF2_FRAME - LAST_FRAME],
-                        cur_order_hint) > 0) {
-    if (motion_field_projection(cm, ALTREF2_FRAME, 0)) --ref_stamp;
+                        cur_order_hint) > 0 &&
+      motion_field_projection_allowed(cm, ALTREF2_FRAME)) {
+    refs[num_refs] = ALTREF2_FRAME;
+    dirs[num_refs++] = 0;
+    --ref_stamp;
   }
 
   if (get_relative_dist(order_hint_info,
                         ref_order_hint[ALTREF_FRAME - LAST_FRAME],
                         cur_order_hint) > 0 &&
-      ref_stamp >= 0)
-    if (motion_field_projection(cm, ALTREF_FRAME, 0)) --ref_stamp;
+      ref_stamp >= 0 && motion_field_projection_allowed(cm, ALTREF_FRAME)) {
+    refs[num_refs] = ALTREF_FRAME;
+    dirs[num_refs++] = 0;
+    --ref_stamp;
+  }
+
+  if (ref_stamp >= 0 && motion_field_projection_allowed(cm, LAST2_FRAME)) {
+    refs[num_refs] = LAST2_FRAME;
+    dirs[num_refs++] = 2;
+  }
+
+  return num_refs;
+}
+
+int av1_get_motion_field_rows(const AV1_COMMON *cm) {
+  return (cm->mi_params.mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+}
+
+void av1_setup_motion_field_rows(AV1_COMMON *cm, int start_row, int end_row) {
+  const OrderHintInfo *const order_hint_info = &cm->seq_params->order_hint_info;
+
+  if (!order_hint_info->enable_order_hint) return;
 
-  if (ref_stamp >= 0) motion_field_projection(cm, LAST2_FRAME, 2);
+  // Rows of tpl_mvs are in 8x8 units, 8 of them per 64x64 block row. The last
+  // row also covers the padding at the bottom of tpl_mvs.
+  const int tpl_stride = cm->mi_params.mi_stride >> 1;
+  const int start_blk_row = start_row << 3;
+  const int end_blk_row = end_row == av1_get_motion_field_rows(cm)
+                              ? (cm->mi_params.mi_rows + MAX_MIB_SIZE) >> 1
+                              : end_row << 3;
+  TPL_MV_REF *tpl_mvs_base = cm->tpl_mvs;
+  for (int idx = start_blk_row * tpl_stride; idx < end_blk_row * tpl_stride;
+       ++idx) {
+    tpl_mvs_base[idx].mfmv0.as_int = INVALID_MV;
+    tpl_mvs_base[idx].ref_frame_offset = 0;
+  }
+
+  MV_REFERENCE_FRAME refs[INTER_REFS_PER_FRAME];
+  int dirs[INTER_REFS_PER_FRAME];
+  const int num_refs = get_motion_field_refs(cm, refs, dirs);
+  for (int i = 0; i < num_refs; ++i)
+    motion_field_projection(cm, refs[i], dirs[i], start_blk_row, end_blk_row);
+}
+
+void av1_setup_motion_field(AV1_COMMON *cm) {
+  av1_setup_motion_field_rows(cm, 0, av1_get_motion_field_rows(cm));
 }
 
 static inline void record_samples(const MB_MODE_INFO *mbmi, int *pts,
@@ -203,6 +203,15 @@ void av1_setup_frame_sign_bias(AV1_COMMON *cm);
 void av1_setup_skip_mode_allowed(AV1_COMMON *cm);
 void av1_calculate_ref_frame_side(AV1_COMMON *cm);
 void av1_setup_motion_field(AV1_COMMON *cm);
+
+// Returns the number of 64x64 block rows the motion field setup can be split
+// into. Rows are independent of each other, so they can be set up in any
+// order or concurrently.
+int av1_get_motion_field_rows(const AV1_COMMON *cm);
+
+// Sets up the motion field for the 64x64 block rows [start_row, end_row).
+void av1_setup_motion_field_rows(AV1_COMMON *cm, int start_row, int end_row);
+
 void av1_set_frame_refs(AV1_COMMON *const cm, int *remapped_ref_idx,
                         int lst_map_idx, int gld_map_idx);
 
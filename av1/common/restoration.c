@@ -1079,11 +1079,13 @@ void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
 
   const int frame_width = frame->crop_widths[0];
   const int frame_height = frame->crop_heights[0];
-  if (aom_realloc_frame_buffer(
-          lr_ctxt->dst, frame_width, frame_height, seq_params->subsampling_x,
-          seq_params->subsampling_y, highbd, AOM_RESTORATION_FRAME_BORDER,
-          cm->features.byte_alignment, NULL, NULL, NULL, false,
-          0) != AOM_CODEC_OK)
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_LOOP_FILTER);
+  const int alloc_failed = aom_realloc_frame_buffer(
+      lr_ctxt->dst, frame_width, frame_height, seq_params->subsampling_x,
+      seq_params->subsampling_y, highbd, AOM_RESTORATION_FRAME_BORDER,
+      cm->features.byte_alignment, NULL, NULL, NULL, false, 0);
+  aom_mem_set_tag(prev_tag);
+  if (alloc_failed != AOM_CODEC_OK)
     aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
                        "Failed to allocate restoration dst buffer");
 
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+// clock_gettime() is not declared in strict C99 mode. This must be before any
+// #include statements.
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "config/aom_config.h"
+
+#include "av1/common/stage_timer.h"
+
+#if CONFIG_OS_SUPPORT
+#if defined(_WIN32)
+#undef NOMINMAX
+#define NOMINMAX
+#undef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <time.h>
+#endif
+#endif  // CONFIG_OS_SUPPORT
+
+int64_t av1_stage_timer_now(void) {
+#if !CONFIG_OS_SUPPORT
+  return 0;
+#elif defined(_WIN32)
+  LARGE_INTEGER now, freq;
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&freq);
+  // Split the conversion so that the multiplication cannot overflow.
+  const int64_t secs = now.QuadPart / freq.QuadPart;
+  const int64_t rem = now.QuadPart % freq.QuadPart;
+  return secs * 1000000000 + rem * 1000000000 / freq.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000000 + (int64_t)tv.tv_usec * 1000;
+#endif
+}
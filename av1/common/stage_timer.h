@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AV1_COMMON_STAGE_TIMER_H_
+#define AOM_AV1_COMMON_STAGE_TIMER_H_
+
+#include "aom/aom_integer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns a monotonic time stamp in nanoseconds. Used to time the encoder and
+// decoder stages at run time, see AV1E_SET_STAGE_TIMING and
+// AV1D_SET_STAGE_TIMING.
+int64_t av1_stage_timer_now(void);
+
+// Adds the time elapsed since start to *time_ns. Does nothing if enabled is
+// 0, in which case start may be anything.
+static inline void av1_stage_timer_add(int enabled, int64_t start,
+                                       int64_t *time_ns) {
+  if (enabled) *time_ns += av1_stage_timer_now() - start;
+}
+
+// Returns av1_stage_timer_now() if enabled is nonzero and 0 otherwise.
+static inline int64_t av1_stage_timer_start(int enabled) {
+  return enabled ? av1_stage_timer_now() : 0;
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AV1_COMMON_STAGE_TIMER_H_
@@ -23,6 +23,7 @@
 #include "av1/common/cdef.h"
 #include "av1/common/entropymode.h"
 #include "av1/common/enums.h"
+#include "av1/common/mvref_common.h"
 #include "av1/common/thread_common.h"
 #include "av1/common/reconinter.h"
 #include "av1/common/reconintra.h"
@@ -1247,6 +1248,84 @@ void av1_cdef_frame_mt(AV1_COMMON *const cm, MACROBLOCKD *const xd,
   sync_cdef_workers(workers, cm, num_workers);
 }
 
+// Data related to motion field setup multi-threading.
+typedef struct {
+#if CONFIG_MULTITHREAD
+  // Mutex lock used while dispatching jobs.
+  pthread_mutex_t mutex_;
+#endif  // CONFIG_MULTITHREAD
+  AV1_COMMON *cm;
+  // Index of the next 64x64 block row to be processed.
+  int next_row;
+  // Number of 64x64 block rows in the frame.
+  int num_rows;
+} AV1MotionFieldSync;
+
+// Checks if a job is available. If job is available, populates the row to be
+// processed and returns 1, else returns 0.
+static int get_motion_field_next_job(AV1MotionFieldSync *const mf_sync,
+                                     int *row) {
+  int do_next_row = 0;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&mf_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+  if (mf_sync->next_row < mf_sync->num_rows) {
+    *row = mf_sync->next_row++;
+    do_next_row = 1;
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&mf_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+  return do_next_row;
+}
+
+// Hook function for each thread in motion field setup multi-threading.
+static int motion_field_worker_hook(void *arg1, void *unused) {
+  (void)unused;
+  AV1MotionFieldSync *const mf_sync = (AV1MotionFieldSync *)arg1;
+  int row;
+  while (get_motion_field_next_job(mf_sync, &row))
+    av1_setup_motion_field_rows(mf_sync->cm, row, row + 1);
+  return 1;
+}
+
+// Implements multi-threading for av1_setup_motion_field(). Each job sets up
+// one 64x64 block row, which gives the same result as the single-threaded
+// setup.
+void av1_setup_motion_field_mt(AV1_COMMON *cm, AVxWorker *workers,
+                               int num_workers) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AV1MotionFieldSync mf_sync;
+  mf_sync.cm = cm;
+  mf_sync.next_row = 0;
+  mf_sync.num_rows = av1_get_motion_field_rows(cm);
+  num_workers = AOMMIN(num_workers, mf_sync.num_rows);
+  if (num_workers <= 1) {
+    av1_setup_motion_field(cm);
+    return;
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&mf_sync.mutex_, NULL);
+#endif  // CONFIG_MULTITHREAD
+
+  for (int i = num_workers - 1; i >= 0; i--) {
+    AVxWorker *const worker = &workers[i];
+    worker->hook = motion_field_worker_hook;
+    worker->data1 = &mf_sync;
+    worker->data2 = NULL;
+    worker->had_error = 0;
+    if (i == 0)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+  for (int i = num_workers - 1; i > 0; i--) winterface->sync(&workers[i]);
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&mf_sync.mutex_);
+#endif  // CONFIG_MULTITHREAD
+}
+
 int av1_get_intrabc_extra_top_right_sb_delay(const AV1_COMMON *cm) {
   // No additional top-right delay when intraBC tool is not enabled.
   if (!av1_allow_intrabc(cm)) return 0;
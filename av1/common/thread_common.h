@@ -202,6 +202,9 @@ void av1_loop_restoration_alloc(AV1LrSync *lr_sync, AV1_COMMON *cm,
 
 int av1_get_intrabc_extra_top_right_sb_delay(const AV1_COMMON *cm);
 
+void av1_setup_motion_field_mt(AV1_COMMON *cm, AVxWorker *workers,
+                               int num_workers);
+
 void av1_thread_loop_filter_rows(
     const YV12_BUFFER_CONFIG *const frame_buffer, AV1_COMMON *const cm,
     struct macroblockd_plane *planes, MACROBLOCKD *xd, int mi_row, int plane,
@@ -60,6 +60,7 @@
 #include "av1/common/restoration.h"
 #include "av1/common/scale.h"
 #include "av1/common/seg_common.h"
+#include "av1/common/stage_timer.h"
 #include "av1/common/thread_common.h"
 #include "av1/common/tile_common.h"
 #include "av1/common/warped_motion.h"
@@ -2662,8 +2663,11 @@ static inline void decode_tile_sb_row(AV1Decoder *pbi, ThreadData *const td,
 
     if (!row_mt_exit) {
       // Decoding of the super-block
+      const int64_t recon_start = av1_stage_timer_start(pbi->stage_timing);
       decode_partition(pbi, td, mi_row, mi_col, td->bit_reader,
                        cm->seq_params->sb_size, 0x2);
+      av1_stage_timer_add(pbi->stage_timing, recon_start,
+                          &td->dcb.recon_time_ns);
     }
 
     sync_write(&tile_data->dec_row_mt_sync, sb_row_in_tile, sb_col_in_tile,
@@ -2716,6 +2720,31 @@ static inline void set_decode_func_pointers(ThreadData *td,
   }
 }
 
+// Parses and then reconstructs a superblock in two passes, as the row based
+// multi-threaded decoder does, and adds the time of each pass to
+// td->dcb.parse_time_ns and td->dcb.recon_time_ns. Used instead of a single
+// parse and decode pass when stage timing is enabled, so that the clock is
+// read once per pass per superblock.
+static inline void decode_sb_and_time(AV1Decoder *pbi, ThreadData *const td,
+                                      int mi_row, int mi_col) {
+  AV1_COMMON *const cm = &pbi->common;
+  DecoderCodingBlock *const dcb = &td->dcb;
+  const BLOCK_SIZE sb_size = cm->seq_params->sb_size;
+
+  const int64_t parse_start = av1_stage_timer_now();
+  set_decode_func_pointers(td, 0x1);
+  decode_partition(pbi, td, mi_row, mi_col, td->bit_reader, sb_size, 0x1);
+  const int64_t recon_start = av1_stage_timer_now();
+  dcb->parse_time_ns += recon_start - parse_start;
+
+  // Rewind the coefficient buffer for the reconstruction pass.
+  set_cb_buffer(pbi, dcb, &td->cb_buffer_base, av1_num_planes(cm), 0, 0);
+  set_decode_func_pointers(td, 0x2);
+  decode_partition(pbi, td, mi_row, mi_col, td->bit_reader, sb_size, 0x2);
+  dcb->recon_time_ns += av1_stage_timer_now() - recon_start;
+  set_decode_func_pointers(td, 0x3);
+}
+
 static inline void decode_tile(AV1Decoder *pbi, ThreadData *const td,
                                int tile_row, int tile_col) {
   TileInfo tile_info;
@@ -2741,9 +2770,13 @@ static inline void decode_tile(AV1Decoder *pbi, ThreadData *const td,
          mi_col += cm->seq_params->mib_size) {
       set_cb_buffer(pbi, dcb, &td->cb_buffer_base, num_planes, 0, 0);
 
-      // Bit-stream parsing and decoding of the superblock
-      decode_partition(pbi, td, mi_row, mi_col, td->bit_reader,
-                       cm->seq_params->sb_size, 0x3);
+      if (pbi->stage_timing) {
+        decode_sb_and_time(pbi, td, mi_row, mi_col);
+      } else {
+        // Bit-stream parsing and decoding of the superblock
+        decode_partition(pbi, td, mi_row, mi_col, td->bit_reader,
+                         cm->seq_params->sb_size, 0x3);
+      }
 
       if (aom_reader_has_overflowed(td->bit_reader)) {
         aom_merge_corrupted_flag(&dcb->corrupted, 1);
@@ -3255,7 +3288,10 @@ static int row_mt_worker_hook(void *arg1, void *arg2) {
       pthread_mutex_unlock(pbi->row_mt_mutex_);
 #endif
       // decode tile
+      const int64_t parse_start = av1_stage_timer_start(pbi->stage_timing);
       parse_tile_row_mt(pbi, td, tile_data);
+      av1_stage_timer_add(pbi->stage_timing, parse_start,
+                          &td->dcb.parse_time_ns);
 #if CONFIG_MULTITHREAD
       pthread_mutex_lock(pbi->row_mt_mutex_);
 #endif
@@ -5222,7 +5258,12 @@ uint32_t av1_decode_frame_headers_and_setup(AV1Decoder *pbi,
   cm->mi_params.setup_mi(&cm->mi_params);
 
   av1_calculate_ref_frame_side(cm);
-  if (cm->features.allow_ref_frame_mvs) av1_setup_motion_field(cm);
+  if (cm->features.allow_ref_frame_mvs) {
+    if (pbi->num_workers > 1)
+      av1_setup_motion_field_mt(cm, pbi->tile_workers, pbi->num_workers);
+    else
+      av1_setup_motion_field(cm);
+  }
 
   av1_setup_block_planes(xd, cm->seq_params->subsampling_x,
                          cm->seq_params->subsampling_y, num_planes);
@@ -5261,6 +5302,24 @@ static inline void setup_frame_info(AV1Decoder *pbi) {
   }
 }
 
+static inline void move_dcb_stage_times(AV1Decoder *pbi,
+                                        DecoderCodingBlock *dcb) {
+  pbi->stage_time_ns[AOM_DEC_STAGE_PARSE] += dcb->parse_time_ns;
+  pbi->stage_time_ns[AOM_DEC_STAGE_RECON] += dcb->recon_time_ns;
+  dcb->parse_time_ns = 0;
+  dcb->recon_time_ns = 0;
+}
+
+// Moves the parse and reconstruction times of the tile decoding threads into
+// pbi->stage_time_ns. pbi->thread_data[0].td is pbi->td.
+static void move_tile_stage_times(AV1Decoder *pbi) {
+  move_dcb_stage_times(pbi, &pbi->td.dcb);
+  for (int i = 1; i < pbi->num_workers; ++i) {
+    ThreadData *const td = pbi->thread_data[i].td;
+    if (td != NULL) move_dcb_stage_times(pbi, &td->dcb);
+  }
+}
+
 void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
                                     const uint8_t *data_end,
                                     const uint8_t **p_data_end, int start_tile,
@@ -5283,6 +5342,7 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
     *p_data_end = decode_tiles_mt(pbi, data, data_end, start_tile, end_tile);
   else
     *p_data_end = decode_tiles(pbi, data, data_end, start_tile, end_tile);
+  if (pbi->stage_timing) move_tile_stage_times(pbi);
 
   // If the bit stream is monochrome, set the U and V buffers to a constant.
   if (num_planes < 3) {
@@ -5298,10 +5358,15 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
   av1_alloc_cdef_sync(cm, &pbi->cdef_sync, pbi->num_workers);
 
   if (!cm->features.allow_intrabc && !tiles->single_tile_decoding) {
+    const int stage_timing = pbi->stage_timing;
+    int64_t *const stage_time_ns = pbi->stage_time_ns;
     if (cm->lf.filter_level[0] || cm->lf.filter_level[1]) {
+      const int64_t lf_start = av1_stage_timer_start(stage_timing);
       av1_loop_filter_frame_mt(&cm->cur_frame->buf, cm, &pbi->dcb.xd, 0,
                                num_planes, 0, pbi->tile_workers,
                                pbi->num_workers, &pbi->lf_row_sync, 0);
+      av1_stage_timer_add(stage_timing, lf_start,
+                          &stage_time_ns[AOM_DEC_STAGE_LOOP_FILTER]);
     }
 
     const int do_cdef =
@@ -5323,6 +5388,7 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
                                                  cm, 0);
 
       if (do_cdef) {
+        const int64_t cdef_start = av1_stage_timer_start(stage_timing);
         if (pbi->num_workers > 1) {
           av1_cdef_frame_mt(cm, &pbi->dcb.xd, pbi->cdef_worker,
                             pbi->tile_workers, &pbi->cdef_sync,
@@ -5332,11 +5398,17 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
           av1_cdef_frame(&pbi->common.cur_frame->buf, cm, &pbi->dcb.xd,
                          av1_cdef_init_fb_row);
         }
+        av1_stage_timer_add(stage_timing, cdef_start,
+                            &stage_time_ns[AOM_DEC_STAGE_CDEF]);
       }
 
+      const int64_t superres_start = av1_stage_timer_start(stage_timing);
       superres_post_decode(pbi);
+      av1_stage_timer_add(stage_timing, superres_start,
+                          &stage_time_ns[AOM_DEC_STAGE_SUPERRES]);
 
       if (do_loop_restoration) {
+        const int64_t lr_start = av1_stage_timer_start(stage_timing);
         av1_loop_restoration_save_boundary_lines(&pbi->common.cur_frame->buf,
                                                  cm, 1);
         if (pbi->num_workers > 1) {
@@ -5349,11 +5421,14 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
                                             cm, optimized_loop_restoration,
                                             &pbi->lr_ctxt);
         }
+        av1_stage_timer_add(stage_timing, lr_start,
+                            &stage_time_ns[AOM_DEC_STAGE_LOOP_RESTORATION]);
       }
     } else {
       // In no cdef and no superres case. Provide an optimized version of
       // loop_restoration_filter.
       if (do_loop_restoration) {
+        const int64_t lr_start = av1_stage_timer_start(stage_timing);
         if (pbi->num_workers > 1) {
           av1_loop_restoration_filter_frame_mt(
               (YV12_BUFFER_CONFIG *)xd->cur_buf, cm, optimized_loop_restoration,
@@ -5364,6 +5439,8 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
                                             cm, optimized_loop_restoration,
                                             &pbi->lr_ctxt);
         }
+        av1_stage_timer_add(stage_timing, lr_start,
+                            &stage_time_ns[AOM_DEC_STAGE_LOOP_RESTORATION]);
       }
     }
   }
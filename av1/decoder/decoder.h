@@ -15,6 +15,7 @@
 #include "config/aom_config.h"
 
 #include "aom/aom_codec.h"
+#include "aom/aomdx.h"
 #include "aom_dsp/bitreader.h"
 #include "aom_scale/yv12config.h"
 #include "aom_util/aom_thread.h"
@@ -81,6 +82,16 @@ typedef struct DecoderCodingBlock {
    * in xd->ref_mv_stack[i].
    */
   uint8_t ref_mv_count[MODE_CTX_REF_FRAMES];
+  /*!
+   * Nanoseconds spent by this thread parsing and reconstructing superblocks,
+   * when stage timing is enabled. Moved into AV1Decoder::stage_time_ns after
+   * each tile group.
+   */
+  int64_t parse_time_ns;
+  /*!
+   * See parse_time_ns.
+   */
+  int64_t recon_time_ns;
 } DecoderCodingBlock;
 
 /*!\cond */
@@ -369,6 +380,17 @@ typedef struct AV1Decoder {
    * Number of spatial layers: may be > 1 for SVC (scalable vector coding).
    */
   unsigned int number_spatial_layers;
+
+  /*!
+   * Set by AV1D_SET_STAGE_TIMING to time the decoder stages into
+   * stage_time_ns.
+   */
+  int stage_timing;
+
+  /*!
+   * Nanoseconds spent in each aom_dec_stage_t by the current frame.
+   */
+  int64_t stage_time_ns[AOM_DEC_STAGE_COUNT];
 } AV1Decoder;
 
 // Returns 0 on success. Sets pbi->common.error.error_code to a nonzero error
@@ -3500,9 +3500,12 @@ static inline void write_bitstream_level(AV1_LEVEL seq_level_idx,
 
 uint32_t av1_write_sequence_header_obu(const SequenceHeader *seq_params,
                                        uint8_t *const dst, size_t dst_size) {
-  // TODO: bug 42302568 - Use dst_size.
-  (void)dst_size;
-  struct aom_write_bit_buffer wb = { dst, 0 };
+  // The bit writer does not check for the end of its buffer, so write to a
+  // buffer that is large enough for any sequence header, and copy the result
+  // to dst if it fits. The 32 operating points with decoder model parameters
+  // take at most 356 bytes, the rest of the header less than 64.
+  uint8_t buf[512];
+  struct aom_write_bit_buffer wb = { buf, 0 };
   uint32_t size = 0;
 
   write_profile(seq_params->profile, &wb);
@@ -3573,6 +3576,9 @@ uint32_t av1_write_sequence_header_obu(const SequenceHeader *seq_params,
   add_trailing_bits(&wb);
 
   size = aom_wb_bytes_written(&wb);
+  assert(size <= sizeof(buf));
+  if (size > dst_size) return 0;
+  memcpy(dst, buf, size);
   return size;
 }
 
@@ -3684,8 +3690,9 @@ static void write_large_scale_tile_obu_size(
 
 // Store information on each large scale tile in the OBU header.
 static void write_large_scale_tile_obu(
-    AV1_COMP *const cpi, uint8_t *const dst, LargeTileFrameOBU *const lst_obu,
-    int *const largest_tile_id, uint32_t *total_size, const int have_tiles,
+    AV1_COMP *const cpi, uint8_t *const dst, size_t dst_size,
+    LargeTileFrameOBU *const lst_obu, int *const largest_tile_id,
+    uint32_t *total_size, const int have_tiles,
     unsigned int *const max_tile_size, unsigned int *const max_tile_col_size) {
   AV1_COMMON *const cm = &cpi->common;
   const CommonTileParams *const tiles = &cm->tiles;
@@ -3723,7 +3730,12 @@ static void write_large_scale_tile_obu(
       mode_bc.allow_update_cdf = !tiles->large_scale;
       mode_bc.allow_update_cdf =
           mode_bc.allow_update_cdf && !cm->features.disable_cdf_update;
-      aom_start_encode(&mode_bc, buf->data + data_offset);
+      const size_t tile_offset = buf->data + data_offset - dst;
+      if (tile_offset > dst_size) {
+        aom_internal_error(cm->error, AOM_CODEC_ERROR, "Output buffer full");
+      }
+      aom_start_encode(&mode_bc, buf->data + data_offset,
+                       dst_size - tile_offset);
       write_modes(cpi, &cpi->td, &tile_info, &mode_bc, tile_row, tile_col);
       if (aom_stop_encode(&mode_bc) < 0) {
         aom_internal_error(cm->error, AOM_CODEC_ERROR, "Error writing modes");
@@ -3779,7 +3791,7 @@ static void write_large_scale_tile_obu(
 
 // Packs information in the obu header for large scale tiles.
 static inline uint32_t pack_large_scale_tiles_in_tg_obus(
-    AV1_COMP *const cpi, uint8_t *const dst,
+    AV1_COMP *const cpi, uint8_t *const dst, size_t dst_size,
     struct aom_write_bit_buffer *saved_wb, uint8_t obu_extension_header,
     int *const largest_tile_id) {
   AV1_COMMON *const cm = &cpi->common;
@@ -3795,8 +3807,9 @@ static inline uint32_t pack_large_scale_tiles_in_tg_obus(
   total_size += init_large_scale_tile_obu_header(
       cpi, &data, saved_wb, obu_extension_header, &lst_obu);
 
-  write_large_scale_tile_obu(cpi, dst, &lst_obu, largest_tile_id, &total_size,
-                             have_tiles, &max_tile_size, &max_tile_col_size);
+  write_large_scale_tile_obu(cpi, dst, dst_size, &lst_obu, largest_tile_id,
+                             &total_size, have_tiles, &max_tile_size,
+                             &max_tile_col_size);
 
   write_large_scale_tile_obu_size(tiles, dst, data, saved_wb, &lst_obu,
                                   have_tiles, &total_size, max_tile_size,
@@ -3861,9 +3874,14 @@ void av1_pack_tile_info(AV1_COMP *const cpi, ThreadData *const td,
 
   // The last tile of the tile group does not have a header.
   if (!pack_bs_params->is_last_tile_in_tg) *total_size += 4;
+  if (*total_size > pack_bs_params->tile_buf_size) {
+    aom_internal_error(td->mb.e_mbd.error_info, AOM_CODEC_ERROR,
+                       "Output buffer full");
+  }
 
   // Pack tile data
-  aom_start_encode(&mode_bc, pack_bs_params->dst + *total_size);
+  aom_start_encode(&mode_bc, pack_bs_params->dst + *total_size,
+                   pack_bs_params->tile_buf_size - *total_size);
   write_modes(cpi, td, &tile_info, &mode_bc, tile_row, tile_col);
   if (aom_stop_encode(&mode_bc) < 0) {
     aom_internal_error(td->mb.e_mbd.error_info, AOM_CODEC_ERROR,
@@ -3884,11 +3902,19 @@ void av1_pack_tile_info(AV1_COMP *const cpi, ThreadData *const td,
 void av1_write_last_tile_info(
     AV1_COMP *const cpi, const FrameHeaderInfo *fh_info,
     struct aom_write_bit_buffer *saved_wb, size_t *curr_tg_data_size,
-    uint8_t *curr_tg_start, uint32_t *const total_size,
+    uint8_t *curr_tg_start, size_t curr_tg_buf_size, uint32_t *const total_size,
     uint8_t **tile_data_start, int *const largest_tile_id,
     int *const is_first_tg, uint32_t obu_header_size, uint8_t obu_extn_header) {
   // write current tile group size
   const size_t obu_payload_size = *curr_tg_data_size - obu_header_size;
+  const int add_frame_header =
+      !(*is_first_tg) && cpi->common.features.error_resilient_mode;
+  if (*curr_tg_data_size + aom_uleb_size_in_bytes(obu_payload_size) +
+          (add_frame_header ? fh_info->total_length : 0) >
+      curr_tg_buf_size) {
+    aom_internal_error(cpi->common.error, AOM_CODEC_ERROR,
+                       "av1_write_last_tile_info: output buffer full");
+  }
   const size_t length_field_size =
       obu_memmove_unsafe(obu_header_size, obu_payload_size, curr_tg_start);
   if (av1_write_uleb_obu_size_unsafe(
@@ -3905,7 +3931,7 @@ void av1_write_last_tile_info(
     saved_wb->bit_buffer += length_field_size;
   }
 
-  if (!(*is_first_tg) && cpi->common.features.error_resilient_mode) {
+  if (add_frame_header) {
     // Make room for a duplicate Frame Header OBU.
     memmove(curr_tg_start + fh_info->total_length, curr_tg_start,
             *curr_tg_data_size);
@@ -3957,11 +3983,11 @@ void av1_accumulate_pack_bs_thread_data(AV1_COMP *const cpi,
 
 // Store information related to each default tile in the OBU header.
 static void write_tile_obu(
-    AV1_COMP *const cpi, uint8_t *const dst, uint32_t *total_size,
-    struct aom_write_bit_buffer *saved_wb, uint8_t obu_extn_header,
-    const FrameHeaderInfo *fh_info, int *const largest_tile_id,
-    unsigned int *max_tile_size, uint32_t *const obu_header_size,
-    uint8_t **tile_data_start) {
+    AV1_COMP *const cpi, uint8_t *const dst, size_t dst_size,
+    uint32_t *total_size, struct aom_write_bit_buffer *saved_wb,
+    uint8_t obu_extn_header, const FrameHeaderInfo *fh_info,
+    int *const largest_tile_id, unsigned int *max_tile_size,
+    uint32_t *const obu_header_size, uint8_t **tile_data_start) {
   AV1_COMMON *const cm = &cpi->common;
   MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
   const CommonTileParams *const tiles = &cm->tiles;
@@ -3998,6 +4024,7 @@ static void write_tile_obu(
       // info.
       PackBSParams pack_bs_params;
       pack_bs_params.dst = dst;
+      pack_bs_params.tile_buf_size = dst_size;
       pack_bs_params.curr_tg_hdr_size = 0;
       pack_bs_params.is_last_tile_in_tg = is_last_tile_in_tg;
       pack_bs_params.new_tg = new_tg;
@@ -4031,10 +4058,10 @@ static void write_tile_obu(
       }
 
       if (is_last_tile_in_tg)
-        av1_write_last_tile_info(cpi, fh_info, saved_wb, &curr_tg_data_size,
-                                 tile_data_curr, total_size, tile_data_start,
-                                 largest_tile_id, &is_first_tg,
-                                 *obu_header_size, obu_extn_header);
+        av1_write_last_tile_info(
+            cpi, fh_info, saved_wb, &curr_tg_data_size, tile_data_curr,
+            dst_size - (tile_data_curr - dst), total_size, tile_data_start,
+            largest_tile_id, &is_first_tg, *obu_header_size, obu_extn_header);
       *total_size += (uint32_t)pack_bs_params.buf.size;
     }
   }
@@ -4131,7 +4158,7 @@ static int calc_pack_bs_mt_workers(const TileDataEnc *tile_data, int num_tiles,
 }
 
 static inline uint32_t pack_tiles_in_tg_obus(
-    AV1_COMP *const cpi, uint8_t *const dst,
+    AV1_COMP *const cpi, uint8_t *const dst, size_t dst_size,
     struct aom_write_bit_buffer *saved_wb, uint8_t obu_extension_header,
     const FrameHeaderInfo *fh_info, int *const largest_tile_id) {
   const CommonTileParams *const tiles = &cpi->common.tiles;
@@ -4148,13 +4175,14 @@ static inline uint32_t pack_tiles_in_tg_obus(
       cpi->mt_info.pack_bs_mt_enabled);
 
   if (num_workers > 1) {
-    av1_write_tile_obu_mt(cpi, dst, &total_size, saved_wb, obu_extension_header,
-                          fh_info, largest_tile_id, &max_tile_size,
-                          &obu_header_size, &tile_data_start, num_workers);
+    av1_write_tile_obu_mt(cpi, dst, dst_size, &total_size, saved_wb,
+                          obu_extension_header, fh_info, largest_tile_id,
+                          &max_tile_size, &obu_header_size, &tile_data_start,
+                          num_workers);
   } else {
-    write_tile_obu(cpi, dst, &total_size, saved_wb, obu_extension_header,
-                   fh_info, largest_tile_id, &max_tile_size, &obu_header_size,
-                   &tile_data_start);
+    write_tile_obu(cpi, dst, dst_size, &total_size, saved_wb,
+                   obu_extension_header, fh_info, largest_tile_id,
+                   &max_tile_size, &obu_header_size, &tile_data_start);
   }
 
   if (num_tiles > 1)
@@ -4169,8 +4197,6 @@ static uint32_t write_tiles_in_tg_obus(AV1_COMP *const cpi, uint8_t *const dst,
                                        uint8_t obu_extension_header,
                                        const FrameHeaderInfo *fh_info,
                                        int *const largest_tile_id) {
-  // TODO: bug 42302568 - Use dst_size.
-  (void)dst_size;
   AV1_COMMON *const cm = &cpi->common;
   const CommonTileParams *const tiles = &cm->tiles;
   *largest_tile_id = 0;
@@ -4189,10 +4215,10 @@ static uint32_t write_tiles_in_tg_obus(AV1_COMP *const cpi, uint8_t *const dst,
 
   if (tiles->large_scale)
     return pack_large_scale_tiles_in_tg_obus(
-        cpi, dst, saved_wb, obu_extension_header, largest_tile_id);
+        cpi, dst, dst_size, saved_wb, obu_extension_header, largest_tile_id);
 
-  return pack_tiles_in_tg_obus(cpi, dst, saved_wb, obu_extension_header,
-                               fh_info, largest_tile_id);
+  return pack_tiles_in_tg_obus(cpi, dst, dst_size, saved_wb,
+                               obu_extension_header, fh_info, largest_tile_id);
 }
 
 // Returns the number of bytes written on success. Returns 0 on failure.
@@ -4270,8 +4296,8 @@ static size_t av1_write_metadata_array(AV1_COMP *const cpi, uint8_t *dst,
   return total_bytes_written;
 }
 
-int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t dst_size,
-                       size_t *size, int *const largest_tile_id) {
+static int pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t dst_size,
+                          size_t *size, int *const largest_tile_id) {
   uint8_t *data = dst;
   size_t data_size = dst_size;
   AV1_COMMON *const cm = &cpi->common;
@@ -4309,6 +4335,9 @@ int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t dst_size,
     assert(obu_header_size <= 2);
     obu_payload_size = av1_write_sequence_header_obu(
         cm->seq_params, data + obu_header_size, data_size - obu_header_size);
+    if (obu_payload_size == 0) {
+      return AOM_CODEC_ERROR;
+    }
     const size_t length_field_size =
         obu_memmove(obu_header_size, obu_payload_size, data, data_size);
     if (length_field_size == 0) {
@@ -4391,3 +4420,11 @@ int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t dst_size,
   (void)data_size;
   return AOM_CODEC_OK;
 }
+
+int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t dst_size,
+                       size_t *size, int *const largest_tile_id) {
+  const int64_t stage_start = stage_timer_start(cpi);
+  const int ret = pack_bitstream(cpi, dst, dst_size, size, largest_tile_id);
+  stage_timer_end(cpi, stage_start, AOM_ENC_STAGE_PACK);
+  return ret;
+}
@@ -114,7 +114,7 @@ void av1_pack_tile_info(struct AV1_COMP *const cpi, struct ThreadData *const td,
 void av1_write_last_tile_info(
     struct AV1_COMP *const cpi, const FrameHeaderInfo *fh_info,
     struct aom_write_bit_buffer *saved_wb, size_t *curr_tg_data_size,
-    uint8_t *curr_tg_start, uint32_t *const total_size,
+    uint8_t *curr_tg_start, size_t curr_tg_buf_size, uint32_t *const total_size,
     uint8_t **tile_data_start, int *const largest_tile_id,
     int *const is_first_tg, uint32_t obu_header_size, uint8_t obu_extn_header);
 
@@ -782,6 +782,18 @@ typedef struct {
   //! Points to the nmv_cost_hp in use.
   int **mv_cost_stack;
   /**@}*/
+
+  /*! \brief The mv components that the tables were last built from.
+   *
+   * Index 0 refers to \ref nmv_cost_alloc and index 1 to
+   * \ref nmv_cost_hp_alloc. A table is only rebuilt when its component or
+   * precision changes.
+   */
+  nmv_component cost_comps[2][2];
+  //! The precision that each table in \ref cost_comps was built with.
+  int cost_precision[2][2];
+  //! Whether the entry in \ref cost_comps is valid.
+  uint8_t cost_comps_valid[2][2];
 } MvCosts;
 
 /*! \brief Holds mv costs for intrabc.
@@ -801,6 +813,35 @@ typedef struct {
   int *dv_costs[2];
 } IntraBCMVCosts;
 
+/*! \brief Copy of the coefficient CDFs the coefficient costs were computed
+ * from.
+ *
+ * Used to rebuild only the cost tables whose CDFs changed since the previous
+ * update.
+ */
+typedef struct {
+  /**@{*/
+  /*! CDFs with the same layout as in FRAME_CONTEXT. */
+  aom_cdf_prob txb_skip_cdf[TX_SIZES][TXB_SKIP_CONTEXTS][CDF_SIZE(2)];
+  aom_cdf_prob eob_extra_cdf[TX_SIZES][PLANE_TYPES][EOB_COEF_CONTEXTS]
+                            [CDF_SIZE(2)];
+  aom_cdf_prob dc_sign_cdf[PLANE_TYPES][DC_SIGN_CONTEXTS][CDF_SIZE(2)];
+  aom_cdf_prob eob_flag_cdf16[PLANE_TYPES][2][CDF_SIZE(5)];
+  aom_cdf_prob eob_flag_cdf32[PLANE_TYPES][2][CDF_SIZE(6)];
+  aom_cdf_prob eob_flag_cdf64[PLANE_TYPES][2][CDF_SIZE(7)];
+  aom_cdf_prob eob_flag_cdf128[PLANE_TYPES][2][CDF_SIZE(8)];
+  aom_cdf_prob eob_flag_cdf256[PLANE_TYPES][2][CDF_SIZE(9)];
+  aom_cdf_prob eob_flag_cdf512[PLANE_TYPES][2][CDF_SIZE(10)];
+  aom_cdf_prob eob_flag_cdf1024[PLANE_TYPES][2][CDF_SIZE(11)];
+  aom_cdf_prob coeff_base_eob_cdf[TX_SIZES][PLANE_TYPES][SIG_COEF_CONTEXTS_EOB]
+                                 [CDF_SIZE(3)];
+  aom_cdf_prob coeff_base_cdf[TX_SIZES][PLANE_TYPES][SIG_COEF_CONTEXTS]
+                             [CDF_SIZE(4)];
+  aom_cdf_prob coeff_br_cdf[TX_SIZES][PLANE_TYPES][LEVEL_CONTEXTS]
+                           [CDF_SIZE(BR_CDF_SIZE)];
+  /**@}*/
+} CoeffCdfs;
+
 /*! \brief Holds the costs needed to encode the coefficients
  */
 typedef struct {
@@ -808,6 +849,12 @@ typedef struct {
   LV_MAP_COEFF_COST coeff_costs[TX_SIZES][PLANE_TYPES];
   //! Costs for coding the eobs.
   LV_MAP_EOB_COST eob_costs[7][2];
+  //! The CDFs that the cost tables were computed from.
+  CoeffCdfs cdfs;
+  //! Whether the entry in \ref coeff_costs matches \ref cdfs.
+  uint8_t coeff_costs_valid[TX_SIZES][PLANE_TYPES];
+  //! Whether the entry in \ref eob_costs matches \ref cdfs.
+  uint8_t eob_costs_valid[7][2];
 } CoeffCosts;
 
 /*!\cond */
@@ -1395,6 +1442,13 @@ typedef struct macroblock {
    */
   int palette_pixels;
 
+  /*!\brief Nanoseconds spent by this thread in av1_encode_sb_row() and, of
+   * those, in motion search, when stage timing is enabled.
+   */
+  int64_t sb_row_time_ns;
+  /*!\brief See sb_row_time_ns. */
+  int64_t me_time_ns;
+
   /*!\brief Pointer to the structure which stores the statistics used by
    * sb-level multi-pass encoding.
    */
@@ -9,6 +9,7 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include "aom_mem/aom_mem.h"
 #include "av1/encoder/context_tree.h"
 #include "av1/encoder/encoder.h"
 #include "av1/encoder/rd.h"
@@ -44,12 +45,16 @@ void av1_setup_shared_coeff_buffer(const SequenceHeader *const seq_params,
   for (int i = 0; i < num_planes; i++) {
     const int max_num_pix =
         (i == AOM_PLANE_Y) ? max_sb_square_y : max_sb_square_uv;
-    AOM_CHECK_MEM_ERROR(error, shared_bufs->coeff_buf[i],
-                        aom_memalign(32, max_num_pix * sizeof(tran_low_t)));
-    AOM_CHECK_MEM_ERROR(error, shared_bufs->qcoeff_buf[i],
-                        aom_memalign(32, max_num_pix * sizeof(tran_low_t)));
-    AOM_CHECK_MEM_ERROR(error, shared_bufs->dqcoeff_buf[i],
-                        aom_memalign(32, max_num_pix * sizeof(tran_low_t)));
+    const size_t buf_size = max_num_pix * sizeof(tran_low_t);
+    AOM_CHECK_MEM_ERROR(
+        error, shared_bufs->coeff_buf[i],
+        aom_memalign_tagged(32, buf_size, AOM_MEM_TAG_PC_TREE));
+    AOM_CHECK_MEM_ERROR(
+        error, shared_bufs->qcoeff_buf[i],
+        aom_memalign_tagged(32, buf_size, AOM_MEM_TAG_PC_TREE));
+    AOM_CHECK_MEM_ERROR(
+        error, shared_bufs->dqcoeff_buf[i],
+        aom_memalign_tagged(32, buf_size, AOM_MEM_TAG_PC_TREE));
   }
 }
 
@@ -77,7 +82,8 @@ PICK_MODE_CONTEXT *av1_alloc_pmc(const struct AV1_COMP *const cpi,
   }
   error.setjmp = 1;
 
-  AOM_CHECK_MEM_ERROR(&error, ctx, aom_calloc(1, sizeof(*ctx)));
+  AOM_CHECK_MEM_ERROR(&error, ctx,
+                      aom_calloc_tagged(1, sizeof(*ctx), AOM_MEM_TAG_PC_TREE));
   ctx->rd_mode_is_ready = 0;
 
   const int num_planes = av1_num_planes(cm);
@@ -85,20 +91,25 @@ PICK_MODE_CONTEXT *av1_alloc_pmc(const struct AV1_COMP *const cpi,
   const int num_blk = num_pix / 16;
 
   AOM_CHECK_MEM_ERROR(&error, ctx->blk_skip,
-                      aom_calloc(num_blk, sizeof(*ctx->blk_skip)));
+                      aom_calloc_tagged(num_blk, sizeof(*ctx->blk_skip),
+                                        AOM_MEM_TAG_PC_TREE));
   AOM_CHECK_MEM_ERROR(&error, ctx->tx_type_map,
-                      aom_calloc(num_blk, sizeof(*ctx->tx_type_map)));
+                      aom_calloc_tagged(num_blk, sizeof(*ctx->tx_type_map),
+                                        AOM_MEM_TAG_PC_TREE));
   ctx->num_4x4_blk = num_blk;
 
   for (int i = 0; i < num_planes; ++i) {
     ctx->coeff[i] = shared_bufs->coeff_buf[i];
     ctx->qcoeff[i] = shared_bufs->qcoeff_buf[i];
     ctx->dqcoeff[i] = shared_bufs->dqcoeff_buf[i];
-    AOM_CHECK_MEM_ERROR(&error, ctx->eobs[i],
-                        aom_memalign(32, num_blk * sizeof(*ctx->eobs[i])));
+    AOM_CHECK_MEM_ERROR(
+        &error, ctx->eobs[i],
+        aom_memalign_tagged(32, num_blk * sizeof(*ctx->eobs[i]),
+                            AOM_MEM_TAG_PC_TREE));
     AOM_CHECK_MEM_ERROR(
         &error, ctx->txb_entropy_ctx[i],
-        aom_memalign(32, num_blk * sizeof(*ctx->txb_entropy_ctx[i])));
+        aom_memalign_tagged(32, num_blk * sizeof(*ctx->txb_entropy_ctx[i]),
+                            AOM_MEM_TAG_PC_TREE));
   }
 
   if (num_pix <= MAX_PALETTE_SQUARE) {
@@ -106,7 +117,8 @@ PICK_MODE_CONTEXT *av1_alloc_pmc(const struct AV1_COMP *const cpi,
       if (cm->features.allow_screen_content_tools) {
         AOM_CHECK_MEM_ERROR(
             &error, ctx->color_index_map[i],
-            aom_memalign(32, num_pix * sizeof(*ctx->color_index_map[i])));
+            aom_memalign_tagged(32, num_pix * sizeof(*ctx->color_index_map[i]),
+                                AOM_MEM_TAG_PC_TREE));
       } else {
         ctx->color_index_map[i] = NULL;
       }
@@ -151,7 +163,8 @@ void av1_free_pmc(PICK_MODE_CONTEXT *ctx, int num_planes) {
 }
 
 PC_TREE *av1_alloc_pc_tree_node(BLOCK_SIZE bsize) {
-  PC_TREE *pc_tree = aom_calloc(1, sizeof(*pc_tree));
+  PC_TREE *pc_tree =
+      aom_calloc_tagged(1, sizeof(*pc_tree), AOM_MEM_TAG_PC_TREE);
   if (pc_tree == NULL) return NULL;
 
   pc_tree->partitioning = PARTITION_NONE;
@@ -265,8 +278,8 @@ int av1_setup_sms_tree(AV1_COMP *const cpi, ThreadData *td) {
   int nodes;
 
   aom_free(td->sms_tree);
-  td->sms_tree =
-      (SIMPLE_MOTION_DATA_TREE *)aom_calloc(tree_nodes, sizeof(*td->sms_tree));
+  td->sms_tree = (SIMPLE_MOTION_DATA_TREE *)aom_calloc_tagged(
+      tree_nodes, sizeof(*td->sms_tree), AOM_MEM_TAG_PC_TREE);
   if (!td->sms_tree) return -1;
   this_sms = &td->sms_tree[0];
 
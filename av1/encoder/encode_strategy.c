@@ -1511,7 +1511,7 @@ int av1_encode_strategy(AV1_COMP *const cpi, size_t *const size,
   // Per-frame encode speed.  In theory this can vary, but things may have
   // been written assuming speed-level will not change within a sequence, so
   // this parameter should be used with caution.
-  frame_params.speed = oxcf->speed;
+  frame_params.speed = oxcf->speed + cpi->time_budget.applied_speed_offset;
 
 #if !CONFIG_REALTIME_ONLY
   // Set forced key frames when necessary. For two-pass encoding / lap mode,
@@ -152,7 +152,7 @@ static const uint16_t AV1_HIGH_VAR_OFFS_12[MAX_SB_SIZE] = {
 // For the given bit depth, returns a constant array used to assist the
 // calculation of source block variance, which will then be used to decide
 // adaptive quantizers.
-static const uint8_t *get_var_offs(int use_hbd, int bd) {
+const uint8_t *av1_get_var_offs(int use_hbd, int bd) {
 #if CONFIG_AV1_HIGHBITDEPTH
   if (use_hbd) {
     assert(bd == 8 || bd == 10 || bd == 12);
@@ -193,7 +193,7 @@ unsigned int av1_get_perpixel_variance(const AV1_COMP *cpi,
       get_plane_block_size(bsize, subsampling_x, subsampling_y);
   unsigned int sse;
   const unsigned int var = cpi->ppi->fn_ptr[plane_bsize].vf(
-      ref->buf, ref->stride, get_var_offs(use_hbd, xd->bd), 0, &sse);
+      ref->buf, ref->stride, av1_get_var_offs(use_hbd, xd->bd), 0, &sse);
   return ROUND_POWER_OF_TWO(var, num_pels_log2_lookup[plane_bsize]);
 }
 
@@ -1145,6 +1145,7 @@ static inline void encode_sb_row(AV1_COMP *cpi, ThreadData *td,
   const int mib_size_log2 = cm->seq_params->mib_size_log2;
   const int sb_row = (mi_row - tile_info->mi_row_start) >> mib_size_log2;
   const int use_nonrd_mode = cpi->sf.rt_sf.use_nonrd_pick_mode;
+  const int cdf_group_mask = av1_get_cdf_group_mask(cm);
 
 #if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, encode_sb_row_time);
@@ -1194,10 +1195,10 @@ static inline void encode_sb_row(AV1_COMP *cpi, ThreadData *td,
         int wt_tr = AVG_CDF_WEIGHT_TOP_RIGHT;
         if (tile_info->mi_col_end > (mi_col + mib_size))
           av1_avg_cdf_symbols(xd->tile_ctx, x->row_ctx + sb_col_in_tile,
-                              wt_left, wt_tr);
+                              wt_left, wt_tr, cdf_group_mask);
         else
           av1_avg_cdf_symbols(xd->tile_ctx, x->row_ctx + sb_col_in_tile - 1,
-                              wt_left, wt_tr);
+                              wt_left, wt_tr, cdf_group_mask);
       }
     }
 
@@ -1259,13 +1260,16 @@ static inline void encode_sb_row(AV1_COMP *cpi, ThreadData *td,
       encode_rd_sb(cpi, td, tile_data, tp, mi_row, mi_col, seg_skip);
     }
 
-    // Update the top-right context in row_mt coding
+    // Update the top-right context in row_mt coding. The first entry is used
+    // to restore the whole context at the start of the next SB row, while the
+    // others are only averaged, so the CDF groups that the frame cannot adapt
+    // need not be saved.
     if (update_cdf && (tile_info->mi_row_end > (mi_row + mib_size))) {
-      if (sb_cols_in_tile == 1)
+      if (sb_cols_in_tile == 1 || sb_col_in_tile == 1)
         memcpy(x->row_ctx, xd->tile_ctx, sizeof(*xd->tile_ctx));
-      else if (sb_col_in_tile >= 1)
-        memcpy(x->row_ctx + sb_col_in_tile - 1, xd->tile_ctx,
-               sizeof(*xd->tile_ctx));
+      else if (sb_col_in_tile > 1)
+        av1_copy_cdf_groups(x->row_ctx + sb_col_in_tile - 1, xd->tile_ctx,
+                            cdf_group_mask);
     }
     enc_row_mt->sync_write_ptr(row_mt_sync, sb_row, sb_col_in_tile,
                                sb_cols_in_tile);
@@ -1441,11 +1445,16 @@ void av1_encode_sb_row(AV1_COMP *cpi, ThreadData *td, int tile_row,
   const TileInfo *const tile_info = &this_tile->tile_info;
   TokenExtra *tok = NULL;
 
+  const int64_t stage_start = av1_stage_timer_start(cpi->ppi->stage_timing);
+
   get_token_start(cpi, tile_info, tile_row, tile_col, mi_row, &tok);
 
   encode_sb_row(cpi, td, this_tile, mi_row, &tok);
 
   populate_token_count(cpi, tile_info, tile_row, tile_col, mi_row, tok);
+
+  av1_stage_timer_add(cpi->ppi->stage_timing, stage_start,
+                      &td->mb.sb_row_time_ns);
 }
 
 /*!\brief Encode a tile
@@ -1516,10 +1525,13 @@ static inline void encode_tiles(AV1_COMP *cpi) {
       cpi->td.mb.tile_pb_ctx = &this_tile->tctx;
       av1_init_rtc_counters(&cpi->td.mb);
       cpi->td.mb.palette_pixels = 0;
+      cpi->td.mb.sb_row_time_ns = 0;
+      cpi->td.mb.me_time_ns = 0;
       av1_encode_tile(cpi, &cpi->td, tile_row, tile_col);
       if (!frame_is_intra_only(&cpi->common))
         av1_accumulate_rtc_counters(cpi, &cpi->td.mb);
       cpi->palette_pixel_num += cpi->td.mb.palette_pixels;
+      accumulate_stage_times(cpi, &cpi->td.mb);
       cpi->intrabc_used |= cpi->td.intrabc_used;
       cpi->deltaq_used |= cpi->td.deltaq_used;
     }
@@ -1746,19 +1758,6 @@ static void populate_thresh_to_force_zeromv_skip(AV1_COMP *cpi) {
   }
 }
 
-static void free_block_hash_buffers(uint32_t *block_hash_values[2][2],
-                                    int8_t *is_block_same[2][3]) {
-  for (int k = 0; k < 2; ++k) {
-    for (int j = 0; j < 2; ++j) {
-      aom_free(block_hash_values[k][j]);
-    }
-
-    for (int j = 0; j < 3; ++j) {
-      aom_free(is_block_same[k][j]);
-    }
-  }
-}
-
 /*!\brief Determines delta_q_res value for Variance Boost modulation.
  */
 static int aom_get_variance_boost_delta_q_res(int qindex) {
@@ -1864,67 +1863,17 @@ static inline void encode_frame_internal(AV1_COMP *cpi) {
     // TODO(any): move this outside of the recoding loop to avoid recalculating
     // the hash table.
     // add to hash table
-    const int pic_width = cpi->source->y_crop_width;
-    const int pic_height = cpi->source->y_crop_height;
-    uint32_t *block_hash_values[2][2] = { { NULL } };
-    int8_t *is_block_same[2][3] = { { NULL } };
-    int k, j;
-    bool error = false;
-
-    for (k = 0; k < 2 && !error; ++k) {
-      for (j = 0; j < 2; ++j) {
-        block_hash_values[k][j] = (uint32_t *)aom_malloc(
-            sizeof(*block_hash_values[0][0]) * pic_width * pic_height);
-        if (!block_hash_values[k][j]) {
-          error = true;
-          break;
-        }
-      }
-
-      for (j = 0; j < 3 && !error; ++j) {
-        is_block_same[k][j] = (int8_t *)aom_malloc(
-            sizeof(*is_block_same[0][0]) * pic_width * pic_height);
-        if (!is_block_same[k][j]) error = true;
-      }
-    }
-
     av1_hash_table_init(intrabc_hash_info);
-    if (error ||
-        !av1_hash_table_create(&intrabc_hash_info->intrabc_hash_table)) {
-      free_block_hash_buffers(block_hash_values, is_block_same);
-      aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
-                         "Error allocating intrabc_hash_table and buffers");
-    }
     hash_table_created = 1;
-    av1_generate_block_2x2_hash_value(intrabc_hash_info, cpi->source,
-                                      block_hash_values[0], is_block_same[0]);
     // Hash data generated for screen contents is used for intraBC ME
     const int min_alloc_size = block_size_wide[mi_params->mi_alloc_bsize];
     const int max_sb_size =
         (1 << (cm->seq_params->mib_size_log2 + MI_SIZE_LOG2));
-    int src_idx = 0;
-    for (int size = 4; size <= max_sb_size; size *= 2, src_idx = !src_idx) {
-      const int dst_idx = !src_idx;
-      av1_generate_block_hash_value(
-          intrabc_hash_info, cpi->source, size, block_hash_values[src_idx],
-          block_hash_values[dst_idx], is_block_same[src_idx],
-          is_block_same[dst_idx]);
-      if (size >= min_alloc_size) {
-        if (!av1_add_to_hash_map_by_row_with_precal_data(
-                &intrabc_hash_info->intrabc_hash_table,
-                block_hash_values[dst_idx], is_block_same[dst_idx][2],
-                pic_width, pic_height, size)) {
-          error = true;
-          break;
-        }
-      }
-    }
-
-    free_block_hash_buffers(block_hash_values, is_block_same);
-
-    if (error) {
+    if (!av1_hash_table_build(intrabc_hash_info,
+                              &intrabc_hash_info->intrabc_hash_table,
+                              cpi->source, min_alloc_size, max_sb_size)) {
       aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
-                         "Error adding data to intrabc_hash_table");
+                         "Error allocating intrabc_hash_table and buffers");
     }
   }
 
@@ -2050,7 +1999,14 @@ static inline void encode_frame_internal(AV1_COMP *cpi) {
   start_timing(cpi, av1_setup_motion_field_time);
 #endif
   av1_calculate_ref_frame_side(cm);
-  if (features->allow_ref_frame_mvs) av1_setup_motion_field(cm);
+  if (features->allow_ref_frame_mvs) {
+    const int num_workers =
+        AOMMIN(mt_info->num_mod_workers[MOD_MFP], mt_info->num_workers);
+    if (num_workers > 1)
+      av1_setup_motion_field_mt(cm, mt_info->workers, num_workers);
+    else
+      av1_setup_motion_field(cm);
+  }
 #if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, av1_setup_motion_field_time);
 #endif
@@ -1106,13 +1106,9 @@ static void avg_nmv(nmv_context *nmv_left, nmv_context *nmv_tr, int wt_left,
   }
 }
 
-// In case of row-based multi-threading of encoder, since we always
-// keep a top - right sync, we can average the top - right SB's CDFs and
-// the left SB's CDFs and use the same for current SB's encoding to
-// improve the performance. This function facilitates the averaging
-// of CDF and used only when row-mt is enabled in encoder.
-void av1_avg_cdf_symbols(FRAME_CONTEXT *ctx_left, FRAME_CONTEXT *ctx_tr,
-                         int wt_left, int wt_tr) {
+static void avg_coeff_cdf_symbols(FRAME_CONTEXT *ctx_left,
+                                  FRAME_CONTEXT *ctx_tr, int wt_left,
+                                  int wt_tr) {
   AVERAGE_CDF(ctx_left->txb_skip_cdf, ctx_tr->txb_skip_cdf, 2);
   AVERAGE_CDF(ctx_left->eob_extra_cdf, ctx_tr->eob_extra_cdf, 2);
   AVERAGE_CDF(ctx_left->dc_sign_cdf, ctx_tr->dc_sign_cdf, 2);
@@ -1126,6 +1122,11 @@ void av1_avg_cdf_symbols(FRAME_CONTEXT *ctx_left, FRAME_CONTEXT *ctx_tr,
   AVERAGE_CDF(ctx_left->coeff_base_eob_cdf, ctx_tr->coeff_base_eob_cdf, 3);
   AVERAGE_CDF(ctx_left->coeff_base_cdf, ctx_tr->coeff_base_cdf, 4);
   AVERAGE_CDF(ctx_left->coeff_br_cdf, ctx_tr->coeff_br_cdf, BR_CDF_SIZE);
+}
+
+static void avg_inter_mode_cdf_symbols(FRAME_CONTEXT *ctx_left,
+                                       FRAME_CONTEXT *ctx_tr, int wt_left,
+                                       int wt_tr) {
   AVERAGE_CDF(ctx_left->newmv_cdf, ctx_tr->newmv_cdf, 2);
   AVERAGE_CDF(ctx_left->zeromv_cdf, ctx_tr->zeromv_cdf, 2);
   AVERAGE_CDF(ctx_left->refmv_cdf, ctx_tr->refmv_cdf, 2);
@@ -1141,6 +1142,11 @@ void av1_avg_cdf_symbols(FRAME_CONTEXT *ctx_left, FRAME_CONTEXT *ctx_tr,
               INTERINTRA_MODES);
   AVERAGE_CDF(ctx_left->motion_mode_cdf, ctx_tr->motion_mode_cdf, MOTION_MODES);
   AVERAGE_CDF(ctx_left->obmc_cdf, ctx_tr->obmc_cdf, 2);
+}
+
+static void avg_palette_cdf_symbols(FRAME_CONTEXT *ctx_left,
+                                    FRAME_CONTEXT *ctx_tr, int wt_left,
+                                    int wt_tr) {
   AVERAGE_CDF(ctx_left->palette_y_size_cdf, ctx_tr->palette_y_size_cdf,
               PALETTE_SIZES);
   AVERAGE_CDF(ctx_left->palette_uv_size_cdf, ctx_tr->palette_uv_size_cdf,
@@ -1156,12 +1162,22 @@ void av1_avg_cdf_symbols(FRAME_CONTEXT *ctx_left, FRAME_CONTEXT *ctx_tr,
   }
   AVERAGE_CDF(ctx_left->palette_y_mode_cdf, ctx_tr->palette_y_mode_cdf, 2);
   AVERAGE_CDF(ctx_left->palette_uv_mode_cdf, ctx_tr->palette_uv_mode_cdf, 2);
+}
+
+static void avg_inter_ref_cdf_symbols(FRAME_CONTEXT *ctx_left,
+                                      FRAME_CONTEXT *ctx_tr, int wt_left,
+                                      int wt_tr) {
   AVERAGE_CDF(ctx_left->comp_inter_cdf, ctx_tr->comp_inter_cdf, 2);
   AVERAGE_CDF(ctx_left->single_ref_cdf, ctx_tr->single_ref_cdf, 2);
   AVERAGE_CDF(ctx_left->comp_ref_type_cdf, ctx_tr->comp_ref_type_cdf, 2);
   AVERAGE_CDF(ctx_left->uni_comp_ref_cdf, ctx_tr->uni_comp_ref_cdf, 2);
   AVERAGE_CDF(ctx_left->comp_ref_cdf, ctx_tr->comp_ref_cdf, 2);
   AVERAGE_CDF(ctx_left->comp_bwdref_cdf, ctx_tr->comp_bwdref_cdf, 2);
+}
+
+static void avg_other_cdf_symbols(FRAME_CONTEXT *ctx_left,
+                                  FRAME_CONTEXT *ctx_tr, int wt_left,
+                                  int wt_tr) {
   AVERAGE_CDF(ctx_left->txfm_partition_cdf, ctx_tr->txfm_partition_cdf, 2);
   AVERAGE_CDF(ctx_left->compound_index_cdf, ctx_tr->compound_index_cdf, 2);
   AVERAGE_CDF(ctx_left->comp_group_idx_cdf, ctx_tr->comp_group_idx_cdf, 2);
@@ -1230,6 +1246,71 @@ void av1_avg_cdf_symbols(FRAME_CONTEXT *ctx_left, FRAME_CONTEXT *ctx_tr,
               CFL_ALPHABET_SIZE);
 }
 
+// Byte offsets of the CDF groups in FRAME_CONTEXT. The last entry marks the
+// end of the last group.
+static const size_t cdf_group_offsets[CDF_GROUPS + 1] = {
+  0,
+  offsetof(FRAME_CONTEXT, newmv_cdf),
+  offsetof(FRAME_CONTEXT, palette_y_size_cdf),
+  offsetof(FRAME_CONTEXT, comp_inter_cdf),
+  offsetof(FRAME_CONTEXT, txfm_partition_cdf),
+  sizeof(FRAME_CONTEXT),
+};
+
+int av1_get_cdf_group_mask(const AV1_COMMON *const cm) {
+  int group_mask = (1 << CDF_GROUP_COEFF) | (1 << CDF_GROUP_OTHERS);
+  if (!frame_is_intra_only(cm)) {
+    group_mask |= (1 << CDF_GROUP_INTER_MODE) | (1 << CDF_GROUP_INTER_REF);
+  }
+  if (cm->features.allow_screen_content_tools) {
+    group_mask |= 1 << CDF_GROUP_PALETTE;
+  }
+  return group_mask;
+}
+
+void av1_copy_cdf_groups(FRAME_CONTEXT *dst, const FRAME_CONTEXT *src,
+                         int group_mask) {
+  int group = 0;
+  while (group < CDF_GROUPS) {
+    if (!(group_mask & (1 << group))) {
+      ++group;
+      continue;
+    }
+    // Merge the adjacent groups into a single copy.
+    const int start = group;
+    while (group < CDF_GROUPS && (group_mask & (1 << group))) ++group;
+    memcpy((uint8_t *)dst + cdf_group_offsets[start],
+           (const uint8_t *)src + cdf_group_offsets[start],
+           cdf_group_offsets[group] - cdf_group_offsets[start]);
+  }
+}
+
+// In case of row-based multi-threading of encoder, since we always
+// keep a top - right sync, we can average the top - right SB's CDFs and
+// the left SB's CDFs and use the same for current SB's encoding to
+// improve the performance. This function facilitates the averaging
+// of CDF and used only when row-mt is enabled in encoder. Only the groups
+// given in group_mask are averaged, as averaging two identical CDFs is a
+// no-op.
+void av1_avg_cdf_symbols(FRAME_CONTEXT *ctx_left, FRAME_CONTEXT *ctx_tr,
+                         int wt_left, int wt_tr, int group_mask) {
+  if (group_mask & (1 << CDF_GROUP_COEFF)) {
+    avg_coeff_cdf_symbols(ctx_left, ctx_tr, wt_left, wt_tr);
+  }
+  if (group_mask & (1 << CDF_GROUP_INTER_MODE)) {
+    avg_inter_mode_cdf_symbols(ctx_left, ctx_tr, wt_left, wt_tr);
+  }
+  if (group_mask & (1 << CDF_GROUP_PALETTE)) {
+    avg_palette_cdf_symbols(ctx_left, ctx_tr, wt_left, wt_tr);
+  }
+  if (group_mask & (1 << CDF_GROUP_INTER_REF)) {
+    avg_inter_ref_cdf_symbols(ctx_left, ctx_tr, wt_left, wt_tr);
+  }
+  if (group_mask & (1 << CDF_GROUP_OTHERS)) {
+    avg_other_cdf_symbols(ctx_left, ctx_tr, wt_left, wt_tr);
+  }
+}
+
 // Check neighbor blocks' motion information.
 static int check_neighbor_blocks(MB_MODE_INFO **mi, int mi_stride,
                                  const TileInfo *const tile_info, int mi_row,
@@ -1423,6 +1504,19 @@ void av1_source_content_sb(AV1_COMP *cpi, MACROBLOCK *x, TileDataEnc *tile_data,
         last_src += last_src_stride;
       }
     }
+    // The source 8x8 averages stored by the scene detection no longer match
+    // the filtered block.
+    SRC_BLK_STATS *const blk_stats = &cpi->src_blk_stats;
+    if (blk_stats->source == cpi->source) {
+      const int row_end =
+          AOMMIN((mi_row + mi_size_high[bsize] + 15) >> 4, blk_stats->rows);
+      const int col_end =
+          AOMMIN((mi_col + mi_size_wide[bsize] + 15) >> 4, blk_stats->cols);
+      for (int r = mi_row >> 4; r < row_end; ++r) {
+        for (int c = mi_col >> 4; c < col_end; ++c)
+          blk_stats->valid[c + r * blk_stats->cols] = 0;
+      }
+    }
   }
 }
 
@@ -404,8 +404,30 @@ void av1_update_picked_ref_frames_mask(MACROBLOCK *const x, int ref_type,
                                        BLOCK_SIZE bsize, int mib_size,
                                        int mi_row, int mi_col);
 
+// Groups of CDFs in FRAME_CONTEXT. Each group is a contiguous range of the
+// struct, so that it can be copied or averaged independently of the others.
+enum {
+  CDF_GROUP_COEFF,       // Coefficient coding CDFs.
+  CDF_GROUP_INTER_MODE,  // Inter mode, compound and motion mode CDFs.
+  CDF_GROUP_PALETTE,     // Palette size, mode and color index CDFs.
+  CDF_GROUP_INTER_REF,   // Reference frame selection CDFs.
+  CDF_GROUP_OTHERS,      // All the remaining CDFs.
+  CDF_GROUPS
+} UENUM1BYTE(CDF_GROUP);
+
+#define CDF_GROUP_MASK_ALL ((1 << CDF_GROUPS) - 1)
+
+// Returns the mask of the CDF groups that can be adapted while encoding the
+// current frame. The other groups keep the values they had at the start of
+// the tile.
+int av1_get_cdf_group_mask(const AV1_COMMON *const cm);
+
+// Copies the CDF groups given in group_mask from src to dst.
+void av1_copy_cdf_groups(FRAME_CONTEXT *dst, const FRAME_CONTEXT *src,
+                         int group_mask);
+
 void av1_avg_cdf_symbols(FRAME_CONTEXT *ctx_left, FRAME_CONTEXT *ctx_tr,
-                         int wt_left, int wt_tr);
+                         int wt_left, int wt_tr, int group_mask);
 
 void av1_source_content_sb(AV1_COMP *cpi, MACROBLOCK *x, TileDataEnc *tile_data,
                            int mi_row, int mi_col);
@@ -1916,6 +1916,153 @@ void av1_set_mv_search_params(AV1_COMP *cpi) {
   }
 }
 
+// These threshold values are selected experimentally.
+#define SC_DETECT_COLOR_THRESH 4
+#define SC_DETECT_VAR_THRESH 0
+
+// The sampled screen content detection scans one block out of this many.
+#define SC_DETECT_SAMPLE_STEP 4
+
+void av1_scan_screen_content_blocks(const ScreenContentSource *source,
+                                    int row_start, int row_end, int row_step,
+                                    int sample_step, int in_sample,
+                                    ScreenContentStats *stats) {
+  const int blk_w = SC_DETECT_BLOCK_SIZE;
+  const int blk_h = SC_DETECT_BLOCK_SIZE;
+  const int num_cols = source->width / blk_w;
+  for (int row = row_start; row < row_end; row += row_step) {
+    for (int col = 0; col < num_cols; ++col) {
+      if (sample_step > 1 && ((row + col) % sample_step == 0) != in_sample)
+        continue;
+      int count_buf[1 << 8];  // Maximum (1 << 8) bins for hbd path.
+      const uint8_t *const this_src =
+          source->src + row * blk_h * source->stride + col * blk_w;
+      int n_colors;
+      if (source->use_hbd)
+        av1_count_colors_highbd(this_src, source->stride, blk_w, blk_h,
+                                source->bit_depth, SC_DETECT_COLOR_THRESH,
+                                NULL, count_buf, &n_colors, NULL);
+      else
+        av1_count_colors(this_src, source->stride, blk_w, blk_h,
+                         SC_DETECT_COLOR_THRESH, count_buf, &n_colors);
+      ++stats->num_blocks;
+      if (n_colors > 1 && n_colors <= SC_DETECT_COLOR_THRESH) {
+        ++stats->counts_1;
+        unsigned int sse;
+        const unsigned int var = ROUND_POWER_OF_TWO(
+            source->vf(this_src, source->stride, source->var_offs, 0, &sse),
+            num_pels_log2_lookup[BLOCK_16X16]);
+        if (var > SC_DETECT_VAR_THRESH) ++stats->counts_2;
+      }
+    }
+  }
+}
+
+// Makes the screen content decisions from the statistics of all the blocks of
+// a width x height frame.
+static void get_screen_content_decision(const ScreenContentStats *stats,
+                                        int width, int height,
+                                        ScreenContentDecision *decision) {
+  const int64_t area = (int64_t)width * height;
+  const int64_t blk_area = SC_DETECT_BLOCK_SIZE * SC_DETECT_BLOCK_SIZE;
+  const int64_t counts_1 = stats->counts_1;
+  const int64_t counts_2 = stats->counts_2;
+  // The threshold values are selected experimentally.
+  decision->allow_screen_content_tools = counts_1 * blk_area * 10 > area;
+  // IntraBC would force loop filters off, so we use more strict rules that also
+  // requires that the block has high variance.
+  decision->allow_intrabc = decision->allow_screen_content_tools &&
+                            counts_2 * blk_area * 12 > area;
+  decision->is_screen_content_type =
+      decision->allow_intrabc ||
+      (counts_1 * blk_area * 10 > area * 4 && counts_2 * blk_area * 30 > area);
+}
+
+// Returns 1 if the count estimated as est with standard deviation sd is
+// unlikely to be on the other side of the decision threshold
+// count * blk_area * num > area * den.
+static int is_sc_estimate_conclusive(double est, double sd, int64_t area,
+                                     int num, int den) {
+  const double blk_area = SC_DETECT_BLOCK_SIZE * SC_DETECT_BLOCK_SIZE;
+  const double threshold = (double)area * den / (blk_area * num);
+  // Three standard deviations.
+  return fabs(est - threshold) > 3.0 * sd;
+}
+
+// Extrapolates the statistics of a sample of the blocks of a width x height
+// frame to the whole frame. Returns 1 if every decision made from the
+// estimate is far enough from its threshold to be trusted, otherwise 0, in
+// which case the remaining blocks need to be scanned.
+static int estimate_screen_content_stats(const ScreenContentStats *sample,
+                                         int width, int height,
+                                         ScreenContentStats *estimate) {
+  // Too few samples for the normal approximation below.
+  const int min_sample_blocks = 64;
+  const int64_t total = (int64_t)(width / SC_DETECT_BLOCK_SIZE) *
+                        (height / SC_DETECT_BLOCK_SIZE);
+  const int64_t n = sample->num_blocks;
+  if (n < min_sample_blocks || n >= total) return 0;
+
+  const double scale = (double)total / n;
+  estimate->num_blocks = total;
+  estimate->counts_1 = (int64_t)(sample->counts_1 * scale + 0.5);
+  estimate->counts_2 = (int64_t)(sample->counts_2 * scale + 0.5);
+
+  // Standard deviation of the estimated counts, with the finite population
+  // correction. The proportions are shrunk towards 1/2 so that a sample
+  // without any (or only) few-color blocks is not taken as exact.
+  const double fpc = (double)(total - n) / (total - 1);
+  const double p1 = (sample->counts_1 + 1.0) / (n + 2.0);
+  const double p2 = (sample->counts_2 + 1.0) / (n + 2.0);
+  const double sd1 = total * sqrt(p1 * (1.0 - p1) / n * fpc);
+  const double sd2 = total * sqrt(p2 * (1.0 - p2) / n * fpc);
+  const double est1 = sample->counts_1 * scale;
+  const double est2 = sample->counts_2 * scale;
+
+  // The thresholds used in get_screen_content_decision().
+  const int64_t area = (int64_t)width * height;
+  return is_sc_estimate_conclusive(est1, sd1, area, 10, 1) &&
+         is_sc_estimate_conclusive(est1, sd1, area, 10, 4) &&
+         is_sc_estimate_conclusive(est2, sd2, area, 12, 1) &&
+         is_sc_estimate_conclusive(est2, sd2, area, 30, 1);
+}
+
+static void scan_screen_content_blocks(AV1_COMP *cpi,
+                                       const ScreenContentSource *source,
+                                       int sample_step, int in_sample,
+                                       ScreenContentStats *stats) {
+  const int num_rows = source->height / SC_DETECT_BLOCK_SIZE;
+  if (cpi != NULL && av1_get_num_sc_detection_workers(cpi, num_rows) > 1) {
+    av1_scan_screen_content_blocks_mt(cpi, source, sample_step, in_sample,
+                                      stats);
+  } else {
+    av1_scan_screen_content_blocks(source, 0, num_rows, 1, sample_step,
+                                   in_sample, stats);
+  }
+}
+
+void av1_detect_screen_content(AV1_COMP *cpi,
+                               const ScreenContentSource *source,
+                               SC_DETECTION_METHOD method,
+                               ScreenContentDecision *decision) {
+  ScreenContentStats stats = { 0, 0, 0 };
+  if (method == SC_DETECT_SAMPLED) {
+    ScreenContentStats sample = { 0, 0, 0 };
+    scan_screen_content_blocks(cpi, source, SC_DETECT_SAMPLE_STEP, 1, &sample);
+    if (!estimate_screen_content_stats(&sample, source->width, source->height,
+                                       &stats)) {
+      // The sample is not conclusive. Scan the remaining blocks.
+      stats = sample;
+      scan_screen_content_blocks(cpi, source, SC_DETECT_SAMPLE_STEP, 0,
+                                 &stats);
+    }
+  } else {
+    scan_screen_content_blocks(cpi, source, 1, 1, &stats);
+  }
+
+  get_screen_content_decision(&stats, source->width, source->height, decision);
+}
+
 void av1_set_screen_content_options(AV1_COMP *cpi, FeatureFlags *features) {
   const AV1_COMMON *const cm = &cpi->common;
   const MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
@@ -1952,57 +2099,26 @@ void av1_set_screen_content_options(AV1_COMP *cpi, FeatureFlags *features) {
 
   // Estimate if the source frame is screen content, based on the portion of
   // blocks that have few luma colors.
-  const uint8_t *src = cpi->unfiltered_source->y_buffer;
-  assert(src != NULL);
-  const int use_hbd = cpi->unfiltered_source->flags & YV12_FLAG_HIGHBITDEPTH;
-  const int stride = cpi->unfiltered_source->y_stride;
-  const int width = cpi->unfiltered_source->y_width;
-  const int height = cpi->unfiltered_source->y_height;
-  const int64_t area = (int64_t)width * height;
-  const int bd = cm->seq_params->bit_depth;
-  const int blk_w = 16;
-  const int blk_h = 16;
-  // These threshold values are selected experimentally.
-  const int color_thresh = 4;
-  const unsigned int var_thresh = 0;
-  // Counts of blocks with no more than color_thresh colors.
-  int64_t counts_1 = 0;
-  // Counts of blocks with no more than color_thresh colors and variance larger
-  // than var_thresh.
-  int64_t counts_2 = 0;
-
-  for (int r = 0; r + blk_h <= height; r += blk_h) {
-    for (int c = 0; c + blk_w <= width; c += blk_w) {
-      int count_buf[1 << 8];  // Maximum (1 << 8) bins for hbd path.
-      const uint8_t *const this_src = src + r * stride + c;
-      int n_colors;
-      if (use_hbd)
-        av1_count_colors_highbd(this_src, stride, blk_w, blk_h, bd, NULL,
-                                count_buf, &n_colors, NULL);
-      else
-        av1_count_colors(this_src, stride, blk_w, blk_h, count_buf, &n_colors);
-      if (n_colors > 1 && n_colors <= color_thresh) {
-        ++counts_1;
-        struct buf_2d buf;
-        buf.stride = stride;
-        buf.buf = (uint8_t *)this_src;
-        const unsigned int var = av1_get_perpixel_variance(
-            cpi, xd, &buf, BLOCK_16X16, AOM_PLANE_Y, use_hbd);
-        if (var > var_thresh) ++counts_2;
-      }
-    }
-  }
-
-  // The threshold values are selected experimentally.
-  features->allow_screen_content_tools = counts_1 * blk_h * blk_w * 10 > area;
-  // IntraBC would force loop filters off, so we use more strict rules that also
-  // requires that the block has high variance.
-  features->allow_intrabc = features->allow_screen_content_tools &&
-                            counts_2 * blk_h * blk_w * 12 > area;
+  const YV12_BUFFER_CONFIG *const source = cpi->unfiltered_source;
+  assert(source->y_buffer != NULL);
+  const int use_hbd = source->flags & YV12_FLAG_HIGHBITDEPTH;
+  const ScreenContentSource sc_source = {
+    source->y_buffer,
+    source->y_stride,
+    source->y_width,
+    source->y_height,
+    use_hbd,
+    cm->seq_params->bit_depth,
+    cpi->ppi->fn_ptr[BLOCK_16X16].vf,
+    av1_get_var_offs(use_hbd, xd->bd),
+  };
+  ScreenContentDecision decision;
+  av1_detect_screen_content(cpi, &sc_source, cpi->sf.hl_sf.sc_detection_method,
+                            &decision);
+  features->allow_screen_content_tools = decision.allow_screen_content_tools;
+  features->allow_intrabc = decision.allow_intrabc;
   cpi->use_screen_content_tools = features->allow_screen_content_tools;
-  cpi->is_screen_content_type =
-      features->allow_intrabc || (counts_1 * blk_h * blk_w * 10 > area * 4 &&
-                                  counts_2 * blk_h * blk_w * 30 > area);
+  cpi->is_screen_content_type = decision.is_screen_content_type;
 }
 
 static void init_motion_estimation(AV1_COMP *cpi) {
@@ -2090,6 +2206,7 @@ aom_codec_err_t av1_check_initial_width(AV1_COMP *cpi, int use_highbitdepth,
 
     av1_set_speed_features_framesize_independent(cpi, cpi->oxcf.speed);
     av1_set_speed_features_framesize_dependent(cpi, cpi->oxcf.speed);
+    cpi->time_budget.applied_speed_offset = 0;
 
     if (!is_stat_generation_stage(cpi)) {
 #if !CONFIG_REALTIME_ONLY
@@ -2302,7 +2419,9 @@ static void cdef_restoration_frame(AV1_COMP *cpi, AV1_COMMON *cm,
 #endif
     const int num_workers = cpi->mt_info.num_mod_workers[MOD_CDEF];
     // Find CDEF parameters
+    const int64_t stage_start = stage_timer_start(cpi);
     av1_cdef_search(cpi);
+    stage_timer_end(cpi, stage_start, AOM_ENC_STAGE_CDEF_SEARCH);
 
     // Apply the filter
     if ((skip_apply_postproc_filters & SKIP_APPLY_CDEF) == 0) {
@@ -2339,7 +2458,9 @@ static void cdef_restoration_frame(AV1_COMP *cpi, AV1_COMMON *cm,
     MultiThreadInfo *const mt_info = &cpi->mt_info;
     const int num_workers = mt_info->num_mod_workers[MOD_LR];
     av1_loop_restoration_save_boundary_lines(&cm->cur_frame->buf, cm, 1);
+    const int64_t stage_start = stage_timer_start(cpi);
     av1_pick_filter_restoration(cpi->source, cpi);
+    stage_timer_end(cpi, stage_start, AOM_ENC_STAGE_RESTORATION_SEARCH);
     if ((skip_apply_postproc_filters & SKIP_APPLY_RESTORATION) == 0 &&
         (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
          cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
@@ -2406,7 +2527,9 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
   start_timing(cpi, loop_filter_time);
 #endif
   if (use_loopfilter) {
+    const int64_t stage_start = stage_timer_start(cpi);
     av1_pick_filter_level(cpi->source, cpi, cpi->sf.lpf_sf.lpf_pick);
+    stage_timer_end(cpi, stage_start, AOM_ENC_STAGE_LOOP_FILTER_SEARCH);
     struct loopfilter *lf = &cm->lf;
     if ((lf->filter_level[0] || lf->filter_level[1]) &&
         (skip_apply_postproc_filters & SKIP_APPLY_LOOPFILTER) == 0) {
@@ -2464,6 +2587,14 @@ static void update_motion_stat(AV1_COMP *const cpi) {
   }
 }
 
+// Returns whether the encoder may filter cpi->source in place.
+static inline bool source_filtered_in_place(const AV1_COMP *cpi) {
+#if CONFIG_AV1_TEMPORAL_DENOISING
+  if (cpi->oxcf.noise_sensitivity > 0) return true;
+#endif
+  return cpi->sf.rt_sf.use_rtc_tf != 0;
+}
+
 /*!\brief Encode a frame without the recode loop, usually used in one-pass
  * encoding and realtime coding.
  *
@@ -2634,7 +2765,7 @@ static int encode_without_recode(AV1_COMP *cpi) {
   av1_set_quantizer(cm, q_cfg->qm_minlevel, q_cfg->qm_maxlevel, q,
                     q_cfg->enable_chroma_deltaq, q_cfg->enable_hdr_deltaq,
                     cpi->oxcf.mode == ALLINTRA, cpi->oxcf.tune_cfg.tuning);
-  av1_set_speed_features_qindex_dependent(cpi, cpi->oxcf.speed);
+  av1_set_speed_features_qindex_dependent(cpi, cpi->speed);
   av1_init_quantizer(&cpi->enc_quant_dequant_params, &cm->quant_params,
                      cm->seq_params->bit_depth);
   av1_set_variance_partition_thresholds(cpi, q, 0);
@@ -2649,7 +2780,7 @@ static int encode_without_recode(AV1_COMP *cpi) {
       av1_set_quantizer(cm, q_cfg->qm_minlevel, q_cfg->qm_maxlevel, q,
                         q_cfg->enable_chroma_deltaq, q_cfg->enable_hdr_deltaq,
                         cpi->oxcf.mode == ALLINTRA, cpi->oxcf.tune_cfg.tuning);
-      av1_set_speed_features_qindex_dependent(cpi, cpi->oxcf.speed);
+      av1_set_speed_features_qindex_dependent(cpi, cpi->speed);
       av1_init_quantizer(&cpi->enc_quant_dequant_params, &cm->quant_params,
                          cm->seq_params->bit_depth);
       av1_set_variance_partition_thresholds(cpi, q, 0);
@@ -2673,6 +2804,12 @@ static int encode_without_recode(AV1_COMP *cpi) {
   segfeatures_copy(&cm->cur_frame->seg, &cm->seg);
   cm->cur_frame->seg.enabled = cm->seg.enabled;
 
+  // The rtc temporal filter and the denoiser write to the source. A source
+  // borrowed from the application is copied first, so they never touch the
+  // application's image.
+  if (cpi->source == unscaled && source_filtered_in_place(cpi))
+    av1_lookahead_unborrow(cpi->ppi->lookahead, unscaled);
+
   // This is for rtc temporal filtering case.
   if (is_psnr_calc_enabled(cpi) && cpi->sf.rt_sf.use_rtc_tf) {
     const SequenceHeader *seq_params = cm->seq_params;
@@ -3567,6 +3704,51 @@ static void calculate_frame_avg_haar_energy(AV1_COMP *cpi) {
 }
 #endif
 
+// Builds the hash table used by inter hash motion search from the source of the
+// current frame, if it is going to be used as a reference. Each buffer held in
+// a reference slot keeps its table, so all the active references have one.
+static void update_ref_frame_hash(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  const int refresh_frame_flags = cm->current_frame.refresh_frame_flags;
+  // Drop the tables of the buffers this frame removes from the reference
+  // slots. Their buffers may be released and reused.
+  REF_FRAME_HASH *free_hash = NULL;
+  for (int i = 0; i < REF_FRAMES; i++) {
+    REF_FRAME_HASH *const ref_hash = &cpi->ref_frame_hash[i];
+    int kept = 0;
+    for (int slot = 0; slot < REF_FRAMES && ref_hash->buf != NULL; slot++) {
+      if (!(refresh_frame_flags & (1 << slot)) &&
+          cm->ref_frame_map[slot] == ref_hash->buf)
+        kept = 1;
+    }
+    if (!kept) {
+      ref_hash->buf = NULL;
+      if (free_hash == NULL) free_hash = ref_hash;
+    }
+  }
+
+  if (!cpi->sf.mv_sf.use_inter_hash_me ||
+      !cm->features.allow_screen_content_tools || refresh_frame_flags == 0 ||
+      av1_superres_scaled(cm) || cpi->source->y_crop_width != cm->width ||
+      cpi->source->y_crop_height != cm->height)
+    return;
+
+  // The slots hold at most REF_FRAMES buffers, and at least one of them is
+  // being replaced.
+  assert(free_hash != NULL);
+  IntraBCHashInfo *const hash_info = &cpi->td.mb.intrabc_hash_info;
+  av1_hash_crc_init(hash_info);
+  if (!av1_hash_table_build(hash_info, &free_hash->table, cpi->source,
+                            REF_HASH_MIN_BLOCK_SIZE,
+                            REF_HASH_MAX_BLOCK_SIZE)) {
+    aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
+                       "Error allocating reference frame hash table");
+  }
+  free_hash->buf = cm->cur_frame;
+  free_hash->width = cm->width;
+  free_hash->height = cm->height;
+}
+
 /*!\brief Run the final pass encoding for 1-pass/2-pass encoding mode, and pack
  * the bitstream
  *
@@ -3906,6 +4088,8 @@ static int encode_frame_to_data_rate(AV1_COMP *cpi, size_t *size, uint8_t *dest,
     cpi->superres_mode = orig_superres_mode;  // restore
   }
 
+  update_ref_frame_hash(cpi);
+
   // Update reference frame ids for reference frames this frame will overwrite
   if (seq_params->frame_id_numbers_present_flag) {
     for (int i = 0; i < REF_FRAMES; i++) {
@@ -4043,10 +4227,12 @@ int av1_encode(AV1_COMP *const cpi, uint8_t *const dest, size_t dest_size,
 
   if (is_stat_generation_stage(cpi)) {
 #if !CONFIG_REALTIME_ONLY
+    const int64_t stage_start = stage_timer_start(cpi);
     if (cpi->oxcf.q_cfg.use_fixed_qp_offsets)
       av1_noop_first_pass_frame(cpi, frame_input->ts_duration);
     else
       av1_first_pass(cpi, frame_input->ts_duration);
+    stage_timer_end(cpi, stage_start, AOM_ENC_STAGE_FIRST_PASS);
 #endif
   } else if (cpi->oxcf.pass == AOM_RC_ONE_PASS ||
              cpi->oxcf.pass >= AOM_RC_SECOND_PASS) {
@@ -4098,7 +4284,7 @@ static int apply_denoise_2d(AV1_COMP *cpi, const YV12_BUFFER_CONFIG *sd,
 
 int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
                           const YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time) {
+                          int64_t end_time, void *user_priv) {
   AV1_COMMON *const cm = &cpi->common;
   const SequenceHeader *const seq_params = cm->seq_params;
   int res = 0;
@@ -4159,7 +4345,8 @@ int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
 #endif  //  CONFIG_DENOISE
 
   if (av1_lookahead_push(cpi->ppi->lookahead, sd, time_stamp, end_time,
-                         use_highbitdepth, cpi->alloc_pyramid, frame_flags)) {
+                         use_highbitdepth, cpi->alloc_pyramid, frame_flags,
+                         user_priv)) {
     aom_set_error(cm->error, AOM_CODEC_ERROR, "av1_lookahead_push() failed");
     res = -1;
   }
@@ -4706,6 +4893,55 @@ void av1_post_encode_updates(AV1_COMP *const cpi,
 #endif
 }
 
+// Highest speed the encode time budget may raise oxcf->speed to. The nonrd
+// pick mode is used from speed 7, and switching between it and the rd pick
+// mode is not done per frame, so the speed never crosses that boundary.
+static inline int rtc_time_budget_max_speed(const AV1_COMP *cpi) {
+  return cpi->oxcf.speed >= 7 ? 11 : AOMMAX(cpi->oxcf.speed, 6);
+}
+
+// Resets the framesize independent speed features if the speed offset for
+// the next frame differs from the one they were set for.
+static void rtc_time_budget_set_speed_features(AV1_COMP *cpi) {
+  RTC_TIME_BUDGET *const tb = &cpi->time_budget;
+  // oxcf->speed may have been changed since the offset was decided.
+  tb->speed_offset = clamp(tb->speed_offset, 0,
+                           rtc_time_budget_max_speed(cpi) - cpi->oxcf.speed);
+  if (tb->speed_offset == tb->applied_speed_offset) return;
+  av1_set_speed_features_framesize_independent(
+      cpi, cpi->oxcf.speed + tb->speed_offset);
+  tb->applied_speed_offset = tb->speed_offset;
+}
+
+// Updates the statistics with the encode time of the last frame and decides
+// the speed offset for the next frame.
+static void rtc_time_budget_update(AV1_COMP *cpi, int64_t time_us) {
+  RTC_TIME_BUDGET *const tb = &cpi->time_budget;
+  tb->last_time_us = time_us;
+  tb->frame_count++;
+  if (time_us > tb->budget_us) tb->over_budget_count++;
+  // Key frames are always much slower to encode, and do not predict the
+  // time of the following frames.
+  if (frame_is_intra_only(&cpi->common)) return;
+  tb->avg_time_us = tb->avg_time_us == 0
+                        ? time_us
+                        : (3 * tb->avg_time_us + time_us + 2) >> 2;
+  const int max_offset = rtc_time_budget_max_speed(cpi) - cpi->oxcf.speed;
+  if (time_us > tb->budget_us || 10 * tb->avg_time_us > 9 * tb->budget_us) {
+    tb->speed_offset = AOMMIN(tb->speed_offset + 1, max_offset);
+    tb->frames_under_budget = 0;
+  } else if (10 * tb->avg_time_us < 6 * tb->budget_us) {
+    // Step back down only after the smoothed time has stayed well under
+    // budget for a while, to avoid oscillating between two speeds.
+    if (++tb->frames_under_budget >= 8 && tb->speed_offset > 0) {
+      tb->speed_offset--;
+      tb->frames_under_budget = 0;
+    }
+  } else {
+    tb->frames_under_budget = 0;
+  }
+}
+
 int av1_get_compressed_data(AV1_COMP *cpi, AV1_COMP_DATA *const cpi_data) {
   const AV1EncoderConfig *const oxcf = &cpi->oxcf;
   AV1_COMMON *const cm = &cpi->common;
@@ -4750,11 +4986,13 @@ int av1_get_compressed_data(AV1_COMP *cpi, AV1_COMP_DATA *const cpi_data) {
   cpi->is_dropped_frame = false;
   cm->showable_frame = 0;
   cpi_data->frame_size = 0;
-  cpi->available_bs_size = cpi_data->cx_data_sz;
 #if CONFIG_INTERNAL_STATS
   struct aom_usec_timer cmptimer;
   aom_usec_timer_start(&cmptimer);
 #endif
+  struct aom_usec_timer budget_timer;
+  if (cpi->time_budget.budget_us > 0) aom_usec_timer_start(&budget_timer);
+  rtc_time_budget_set_speed_features(cpi);
   av1_set_high_precision_mv(cpi, 1, 0);
 
   // Normal defaults
@@ -4789,9 +5027,9 @@ int av1_get_compressed_data(AV1_COMP *cpi, AV1_COMP_DATA *const cpi_data) {
   // Note: Use "cpi->frame_component_time[0] > 100 us" to avoid showing of
   // show_existing_frame and lag-in-frames.
   if ((cpi->oxcf.pass == 2 || cpi->oxcf.pass == 0) &&
-      cpi->frame_component_time[0] > 100) {
+      cpi->frame_component_time[0] > 100 * 1000) {
     int i;
-    uint64_t frame_total = 0, total = 0;
+    int64_t frame_total = 0, total = 0;
     const GF_GROUP *const gf_group = &cpi->ppi->gf_group;
     FRAME_UPDATE_TYPE frame_update_type =
         get_frame_update_type(gf_group, cpi->gf_frame_index);
@@ -4812,10 +5050,10 @@ int av1_get_compressed_data(AV1_COMP *cpi, AV1_COMP_DATA *const cpi_data) {
       fprintf(stderr,
               " %50s:  %15" PRId64 " us [%6.2f%%] (total: %15" PRId64
               " us [%6.2f%%])\n",
-              get_component_name(i), cpi->frame_component_time[i],
+              get_component_name(i), cpi->frame_component_time[i] / 1000,
               (float)((float)cpi->frame_component_time[i] * 100.0 /
                       (float)frame_total),
-              cpi->component_time[i],
+              cpi->component_time[i] / 1000,
               (float)((float)cpi->component_time[i] * 100.0 / (float)total));
       cpi->frame_component_time[i] = 0;
     }
@@ -4838,6 +5076,13 @@ int av1_get_compressed_data(AV1_COMP *cpi, AV1_COMP_DATA *const cpi_data) {
   aom_usec_timer_mark(&cmptimer);
   cpi->time_compress_data += aom_usec_timer_elapsed(&cmptimer);
 #endif  // CONFIG_INTERNAL_STATS
+  if (!cm->show_existing_frame) {
+    cpi->time_budget.last_speed = cpi->speed;
+    if (cpi->time_budget.budget_us > 0) {
+      aom_usec_timer_mark(&budget_timer);
+      rtc_time_budget_update(cpi, aom_usec_timer_elapsed(&budget_timer));
+    }
+  }
 
 #if CONFIG_SPEED_STATS
   if (!is_stat_generation_stage(cpi) && !cm->show_existing_frame) {
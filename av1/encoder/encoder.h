@@ -30,6 +30,7 @@
 #include "av1/common/enums.h"
 #include "av1/common/reconintra.h"
 #include "av1/common/resize.h"
+#include "av1/common/stage_timer.h"
 #include "av1/common/thread_common.h"
 #include "av1/common/timing.h"
 
@@ -208,6 +209,7 @@ typedef enum {
   MOD_PACK_BS,      // Pack bitstream
   MOD_FRAME_ENC,    // Frame Parallel encode
   MOD_AI,           // All intra
+  MOD_MFP,          // Motion field projection
   NUM_MT_MODULES
 } MULTI_THREADED_MODULES;
 
@@ -2524,6 +2526,68 @@ typedef struct RTC_REF {
    */
   bool bias_recovery_frame;
 } RTC_REF;
+
+typedef struct {
+  /*!
+   * Encode time budget per frame in microseconds, 0 if disabled.
+   */
+  int64_t budget_us;
+  /*!
+   * Offset added to oxcf->speed for the next frame.
+   */
+  int speed_offset;
+  /*!
+   * Offset the framesize independent speed features are currently set for.
+   */
+  int applied_speed_offset;
+  /*!
+   * Smoothed encode time of non key frames, in microseconds.
+   */
+  int64_t avg_time_us;
+  /*!
+   * Number of consecutive frames whose smoothed time is well under budget.
+   */
+  int frames_under_budget;
+  /*!
+   * Statistics reported by AV1E_GET_RTC_TIME_BUDGET_STATS.
+   */
+  int64_t last_time_us;
+  unsigned int frame_count;
+  unsigned int over_budget_count;
+  int last_speed;
+} RTC_TIME_BUDGET;
+/*!\endcond */
+
+/*!\cond */
+// Source statistics gathered by the real-time scene detection scan, for reuse
+// by later stages of the same frame.
+typedef struct {
+  // Source frame the statistics were computed on; NULL if none are valid.
+  const YV12_BUFFER_CONFIG *source;
+  // Number of 64x64 block columns and rows the buffers are allocated for.
+  int cols;
+  int rows;
+  // Rounded average of each 8x8 luma block: 64 entries per 64x64 block, in
+  // raster order within the block.
+  uint8_t *avg_8x8;
+  // Set for the 64x64 blocks whose averages were computed.
+  uint8_t *valid;
+} SRC_BLK_STATS;
+
+// Range of the square block sizes in the reference frame hash table.
+#define REF_HASH_MIN_BLOCK_SIZE 8
+#define REF_HASH_MAX_BLOCK_SIZE 64
+
+// Hash table of the source of a reference frame, used to look up exact block
+// matches in inter motion search of screen content.
+typedef struct {
+  // Buffer of the reference frame the table was built for; NULL if none.
+  const RefCntBuffer *buf;
+  // Frame size the table was built at.
+  int width;
+  int height;
+  hash_table table;
+} REF_FRAME_HASH;
 /*!\endcond */
 
 /*!
@@ -2870,6 +2934,12 @@ typedef struct AV1_PRIMARY {
    * when --deltaq-mode=3.
    */
   AV1EncRowMultiThreadSync intra_row_mt_sync;
+
+  /*!
+   * Set by AV1E_SET_STAGE_TIMING to time the encoder stages into
+   * AV1_COMP::stage_time_ns.
+   */
+  int stage_timing;
 } AV1_PRIMARY;
 
 /*!
@@ -3099,6 +3169,12 @@ typedef struct AV1_COMP {
    */
   int speed;
 
+  /*!
+   * Per-frame encode time budget for real-time mode, which raises the speed
+   * above oxcf.speed while encoding is slower than the budget.
+   */
+  RTC_TIME_BUDGET time_budget;
+
   /*!
    * sf contains fine-grained config set internally based on speed.
    */
@@ -3304,6 +3380,12 @@ typedef struct AV1_COMP {
    */
   int intrabc_used;
 
+  /*!
+   * Hash tables of the buffers in the reference slots, for inter hash motion
+   * search. Entries with a NULL buffer are unused.
+   */
+  REF_FRAME_HASH ref_frame_hash[REF_FRAMES];
+
   /*!
    * Mark which ref frames can be skipped for encoding current frame during RDO.
    */
@@ -3363,18 +3445,20 @@ typedef struct AV1_COMP {
 
 #if CONFIG_COLLECT_COMPONENT_TIMING
   /*!
-   * component_time[] are initialized to zero while encoder starts.
+   * component_time[] are initialized to zero while encoder starts. In
+   * nanoseconds.
    */
-  uint64_t component_time[kTimingComponents];
+  int64_t component_time[kTimingComponents];
   /*!
-   * Stores timing for individual components between calls of start_timing()
-   * and end_timing().
+   * Stores the av1_stage_timer_now() time stamp of the last start_timing()
+   * call for individual components.
    */
-  struct aom_usec_timer component_timer[kTimingComponents];
+  int64_t component_start_ns[kTimingComponents];
   /*!
    * frame_component_time[] are initialized to zero at beginning of each frame.
+   * In nanoseconds.
    */
-  uint64_t frame_component_time[kTimingComponents];
+  int64_t frame_component_time[kTimingComponents];
 #endif
 
   /*!
@@ -3480,11 +3564,6 @@ typedef struct AV1_COMP {
    */
   int sb_counter;
 
-  /*!
-   * Available bitstream buffer size in bytes
-   */
-  size_t available_bs_size;
-
   /*!
    * The controller of the external partition model.
    * It is used to do partition type selection based on external models.
@@ -3615,6 +3694,11 @@ typedef struct AV1_COMP {
    */
   uint64_t *src_sad_blk_64x64;
 
+  /*!
+   * Source 8x8 block averages produced alongside src_sad_blk_64x64.
+   */
+  SRC_BLK_STATS src_blk_stats;
+
   /*!
    * SSE between the current frame and the reconstructed last frame
    * It is only used for CBR mode.
@@ -3674,6 +3758,12 @@ typedef struct AV1_COMP {
    * so scaling is not needed for last_source.
    */
   int scaled_last_source_available;
+
+  /*!
+   * Nanoseconds spent in each aom_enc_stage_t since the last call to
+   * aom_codec_encode(), when AV1_PRIMARY::stage_timing is set.
+   */
+  int64_t stage_time_ns[AOM_ENC_STAGE_COUNT];
 } AV1_COMP;
 
 /*!
@@ -3803,15 +3893,17 @@ int av1_init_parallel_frame_context(const AV1_COMP_DATA *const first_cpi_data,
  * \param[in,out] sd             Contain raw frame data
  * \param[in]     time_stamp     Time stamp of the frame
  * \param[in]     end_time_stamp End time stamp
+ * \param[in]     user_priv      Passed to the release callback of zero copy
  *
  * \return Returns a value to indicate if the frame data is received
  * successfully.
  * \note The caller can assume that a copy of this frame is made and not just a
- * copy of the pointer.
+ * copy of the pointer, unless zero copy input is enabled (see
+ * av1_lookahead_set_zero_copy()).
  */
 int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
                           const YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time_stamp);
+                          int64_t end_time_stamp, void *user_priv);
 
 /*!\brief Encode a frame
  *
@@ -3886,6 +3978,58 @@ void av1_alloc_mb_wiener_var_pred_buf(AV1_COMMON *cm, ThreadData *td);
 
 void av1_dealloc_mb_wiener_var_pred_buf(ThreadData *td);
 
+// Luma plane description used by the screen content detection.
+typedef struct {
+  // Top-left luma sample. Uses CONVERT_TO_BYTEPTR() for high bitdepth.
+  const uint8_t *src;
+  int stride;
+  int width;
+  int height;
+  int use_hbd;
+  int bit_depth;
+  // 16x16 variance function matching the bit depth.
+  aom_variance_fn_t vf;
+  // Flat block passed as the reference of vf.
+  const uint8_t *var_offs;
+} ScreenContentSource;
+
+// Block counts gathered by the screen content detection.
+typedef struct {
+  // Number of blocks with few colors.
+  int64_t counts_1;
+  // Number of blocks with few colors and variance larger than the threshold.
+  int64_t counts_2;
+  // Number of blocks scanned.
+  int64_t num_blocks;
+} ScreenContentStats;
+
+// Screen content decisions made from ScreenContentStats.
+typedef struct {
+  int allow_screen_content_tools;
+  int allow_intrabc;
+  int is_screen_content_type;
+} ScreenContentDecision;
+
+// Size of the blocks scanned by the screen content detection.
+#define SC_DETECT_BLOCK_SIZE 16
+
+// Accumulates into stats the screen content statistics of block rows
+// [row_start, row_end), visiting every row_step-th row. If sample_step is
+// larger than 1, only the blocks (r, c) for which ((r + c) % sample_step == 0)
+// equals in_sample are scanned.
+void av1_scan_screen_content_blocks(const ScreenContentSource *source,
+                                    int row_start, int row_end, int row_step,
+                                    int sample_step, int in_sample,
+                                    ScreenContentStats *stats);
+
+// Makes the screen content decisions for source with the given detection
+// method. The blocks are scanned on the encoder workers of cpi when there are
+// any. cpi may be NULL, in which case the scan runs on the calling thread.
+void av1_detect_screen_content(struct AV1_COMP *cpi,
+                               const ScreenContentSource *source,
+                               SC_DETECTION_METHOD method,
+                               ScreenContentDecision *decision);
+
 // Set screen content options.
 // This function estimates whether to use screen content tools, by counting
 // the portion of blocks that have few luma colors.
@@ -3897,6 +4041,8 @@ void av1_dealloc_mb_wiener_var_pred_buf(ThreadData *td);
 // However, the estimation is not accurate and may misclassify videos.
 // A slower but more accurate approach that determines whether to use screen
 // content tools is employed later. See av1_determine_sc_tools_with_encoding().
+// Depending on sf.hl_sf.sc_detection_method, only a sample of the blocks may be
+// scanned. The scan uses the encoder workers when there are any.
 void av1_set_screen_content_options(struct AV1_COMP *cpi,
                                     FeatureFlags *features);
 
@@ -3982,6 +4128,25 @@ static inline int64_t ticks_to_timebase_units(
   return (n * timestamp_ratio->den + round) / timestamp_ratio->num;
 }
 
+// Returns the start time of an encoder stage, or 0 if stage timing is off.
+static inline int64_t stage_timer_start(const AV1_COMP *cpi) {
+  return av1_stage_timer_start(cpi->ppi->stage_timing);
+}
+
+// Adds the time elapsed since start to the given encoder stage.
+static inline void stage_timer_end(AV1_COMP *cpi, int64_t start,
+                                   aom_enc_stage_t stage) {
+  av1_stage_timer_add(cpi->ppi->stage_timing, start,
+                      &cpi->stage_time_ns[stage]);
+}
+
+// Adds the superblock row and motion search times of a thread to the
+// AOM_ENC_STAGE_RD and AOM_ENC_STAGE_MOTION_SEARCH stages.
+static inline void accumulate_stage_times(AV1_COMP *cpi, const MACROBLOCK *x) {
+  cpi->stage_time_ns[AOM_ENC_STAGE_MOTION_SEARCH] += x->me_time_ns;
+  cpi->stage_time_ns[AOM_ENC_STAGE_RD] += x->sb_row_time_ns - x->me_time_ns;
+}
+
 static inline int frame_is_kf_gf_arf(const AV1_COMP *cpi) {
   const GF_GROUP *const gf_group = &cpi->ppi->gf_group;
   const FRAME_UPDATE_TYPE update_type =
@@ -3998,6 +4163,24 @@ static inline int av1_use_hash_me(const AV1_COMP *const cpi) {
           frame_is_intra_only(&cpi->common));
 }
 
+// Returns the hash table of the given reference frame, or NULL if it has none.
+static inline const hash_table *av1_get_ref_frame_hash_table(
+    const AV1_COMP *const cpi, MV_REFERENCE_FRAME ref_frame) {
+  const AV1_COMMON *const cm = &cpi->common;
+  if (!cpi->sf.mv_sf.use_inter_hash_me ||
+      !cm->features.allow_screen_content_tools)
+    return NULL;
+  const RefCntBuffer *const buf = get_ref_frame_buf(cm, ref_frame);
+  if (buf == NULL) return NULL;
+  for (int i = 0; i < REF_FRAMES; i++) {
+    const REF_FRAME_HASH *const ref_hash = &cpi->ref_frame_hash[i];
+    if (ref_hash->buf == buf && ref_hash->width == cm->width &&
+        ref_hash->height == cm->height)
+      return &ref_hash->table;
+  }
+  return NULL;
+}
+
 static inline const YV12_BUFFER_CONFIG *get_ref_frame_yv12_buf(
     const AV1_COMMON *const cm, MV_REFERENCE_FRAME ref_frame) {
   const RefCntBuffer *const buf = get_ref_frame_buf(cm, ref_frame);
@@ -4497,13 +4680,15 @@ static inline int av1_get_bsize_idx_for_part_stats(BLOCK_SIZE bsize) {
 #endif  // CONFIG_COLLECT_PARTITION_STATS
 
 #if CONFIG_COLLECT_COMPONENT_TIMING
+// The component timers use the same clock as the run time stage timers (see
+// AV1E_SET_STAGE_TIMING), and only add the finer grained components that are
+// too costly to time in normal builds.
 static inline void start_timing(AV1_COMP *cpi, int component) {
-  aom_usec_timer_start(&cpi->component_timer[component]);
+  cpi->component_start_ns[component] = av1_stage_timer_now();
 }
 static inline void end_timing(AV1_COMP *cpi, int component) {
-  aom_usec_timer_mark(&cpi->component_timer[component]);
-  cpi->frame_component_time[component] +=
-      aom_usec_timer_elapsed(&cpi->component_timer[component]);
+  av1_stage_timer_add(1, cpi->component_start_ns[component],
+                      &cpi->frame_component_time[component]);
 }
 static inline char const *get_frame_type_enum(int type) {
   switch (type) {
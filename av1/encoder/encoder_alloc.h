@@ -47,7 +47,8 @@ static inline void alloc_context_buffers_ext(
     dealloc_context_buffers_ext(mbmi_ext_info);
     CHECK_MEM_ERROR(
         cm, mbmi_ext_info->frame_base,
-        aom_malloc(new_ext_mi_size * sizeof(*mbmi_ext_info->frame_base)));
+        aom_malloc_tagged(new_ext_mi_size * sizeof(*mbmi_ext_info->frame_base),
+                          AOM_MEM_TAG_MODE_INFO));
     mbmi_ext_info->alloc_size = new_ext_mi_size;
   }
   // The stride needs to be updated regardless of whether new allocation
@@ -258,6 +259,10 @@ static inline void dealloc_compressor_data(AV1_COMP *cpi) {
     }
 
   av1_hash_table_destroy(&cpi->td.mb.intrabc_hash_info.intrabc_hash_table);
+  for (int i = 0; i < REF_FRAMES; i++) {
+    av1_hash_table_destroy(&cpi->ref_frame_hash[i].table);
+    cpi->ref_frame_hash[i].buf = NULL;
+  }
 
   aom_free(cm->tpl_mvs);
   cm->tpl_mvs = NULL;
@@ -363,6 +368,10 @@ static inline void dealloc_compressor_data(AV1_COMP *cpi) {
   aom_free(cpi->src_sad_blk_64x64);
   cpi->src_sad_blk_64x64 = NULL;
 
+  aom_free(cpi->src_blk_stats.avg_8x8);
+  aom_free(cpi->src_blk_stats.valid);
+  av1_zero(cpi->src_blk_stats);
+
   aom_free(cpi->mb_weber_stats);
   cpi->mb_weber_stats = NULL;
 
@@ -12,6 +12,7 @@
 #include <assert.h>
 #include <stdbool.h>
 
+#include "aom_mem/aom_mem.h"
 #include "aom_util/aom_pthread.h"
 
 #include "av1/common/warped_motion.h"
@@ -963,6 +964,8 @@ void av1_init_tile_thread_data(AV1_PRIMARY *ppi, int is_first_pass) {
   int num_workers = p_mt_info->num_workers;
   int num_enc_workers = av1_get_num_mod_workers_for_alloc(p_mt_info, MOD_ENC);
   assert(num_enc_workers <= num_workers);
+  // An error longjmps out of here; the codec entry point resets the tag.
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_THREAD_DATA);
   for (int i = num_workers - 1; i >= 0; i--) {
     EncWorkerData *const thread_data = &p_mt_info->tile_thr_data[i];
 
@@ -1071,6 +1074,7 @@ void av1_init_tile_thread_data(AV1_PRIMARY *ppi, int is_first_pass) {
       }
     }
   }
+  aom_mem_set_tag(prev_tag);
 
   // Record the number of workers in encode stage multi-threading for which
   // allocation is done.
@@ -1525,6 +1529,7 @@ static inline void accumulate_counters_enc_workers(AV1_COMP *cpi,
     if (!frame_is_intra_only(&cpi->common))
       av1_accumulate_rtc_counters(cpi, &thread_data->td->mb);
     cpi->palette_pixel_num += thread_data->td->mb.palette_pixels;
+    accumulate_stage_times(cpi, &thread_data->td->mb);
     if (thread_data->td != &cpi->td) {
       // Keep these conditional expressions in sync with the corresponding ones
       // in prepare_enc_workers().
@@ -1629,6 +1634,8 @@ static inline void prepare_enc_workers(AV1_COMP *cpi, AVxWorkerHook hook,
     av1_init_rtc_counters(&thread_data->td->mb);
 
     thread_data->td->mb.palette_pixels = 0;
+    thread_data->td->mb.sb_row_time_ns = 0;
+    thread_data->td->mb.me_time_ns = 0;
 
     if (thread_data->td->counts != &cpi->counts) {
       memcpy(thread_data->td->counts, &cpi->counts, sizeof(cpi->counts));
@@ -1878,7 +1885,9 @@ static void lpf_pipeline_mt_init(AV1_COMP *cpi, int num_workers) {
   assert(method == LPF_PICK_FROM_Q);
   assert(cpi->oxcf.algo_cfg.loopfilter_control != LOOPFILTER_SELECTIVELY);
 
+  const int64_t stage_start = stage_timer_start(cpi);
   av1_pick_filter_level(cpi->source, cpi, method);
+  stage_timer_end(cpi, stage_start, AOM_ENC_STAGE_LOOP_FILTER_SEARCH);
 
   struct loopfilter *lf = &cm->lf;
   const int plane_start = 0;
@@ -2932,6 +2941,7 @@ static inline size_t get_bs_chunk_size(int tg_or_tile_size,
 
 // Initializes params required for pack bitstream tile.
 static void init_tile_pack_bs_params(AV1_COMP *const cpi, uint8_t *const dst,
+                                     size_t dst_size,
                                      struct aom_write_bit_buffer *saved_wb,
                                      PackBSParams *const pack_bs_params_arr,
                                      uint8_t obu_extn_header) {
@@ -2984,9 +2994,9 @@ static void init_tile_pack_bs_params(AV1_COMP *const cpi, uint8_t *const dst,
     }
   }
 
-  assert(cpi->available_bs_size > 0);
+  assert(dst_size > 0);
   size_t tg_buf_size[MAX_TILES] = { 0 };
-  size_t max_buf_size = cpi->available_bs_size;
+  size_t max_buf_size = dst_size;
   size_t remain_buf_size = max_buf_size;
   const int frame_size_mi = cm->mi_params.mi_rows * cm->mi_params.mi_cols;
 
@@ -3153,10 +3163,10 @@ static void prepare_pack_bs_workers(AV1_COMP *const cpi,
 // Accumulates data after pack bitsteam processing.
 static void accumulate_pack_bs_data(
     AV1_COMP *const cpi, const PackBSParams *const pack_bs_params_arr,
-    uint8_t *const dst, uint32_t *total_size, const FrameHeaderInfo *fh_info,
-    int *const largest_tile_id, unsigned int *max_tile_size,
-    uint32_t *const obu_header_size, uint8_t **tile_data_start,
-    const int num_workers) {
+    uint8_t *const dst, size_t dst_size, uint32_t *total_size,
+    const FrameHeaderInfo *fh_info, int *const largest_tile_id,
+    unsigned int *max_tile_size, uint32_t *const obu_header_size,
+    uint8_t **tile_data_start, const int num_workers) {
   const AV1_COMMON *const cm = &cpi->common;
   const CommonTileParams *const tiles = &cm->tiles;
   const int tile_count = tiles->cols * tiles->rows;
@@ -3195,8 +3205,9 @@ static void accumulate_pack_bs_data(
     if (pack_bs_params->is_last_tile_in_tg)
       av1_write_last_tile_info(
           cpi, fh_info, pack_bs_params->saved_wb, &curr_tg_data_size,
-          curr_tg_start, &tile_size, tile_data_start, largest_tile_id,
-          &is_first_tg, *obu_header_size, pack_bs_params->obu_extn_header);
+          curr_tg_start, dst_size - (curr_tg_start - dst), &tile_size,
+          tile_data_start, largest_tile_id, &is_first_tg, *obu_header_size,
+          pack_bs_params->obu_extn_header);
     src_offset += pack_bs_params->tile_buf_size;
     dst_offset += tile_size;
     *total_size += tile_size;
@@ -3211,11 +3222,12 @@ static void accumulate_pack_bs_data(
 }
 
 void av1_write_tile_obu_mt(
-    AV1_COMP *const cpi, uint8_t *const dst, uint32_t *total_size,
-    struct aom_write_bit_buffer *saved_wb, uint8_t obu_extn_header,
-    const FrameHeaderInfo *fh_info, int *const largest_tile_id,
-    unsigned int *max_tile_size, uint32_t *const obu_header_size,
-    uint8_t **tile_data_start, const int num_workers) {
+    AV1_COMP *const cpi, uint8_t *const dst, size_t dst_size,
+    uint32_t *total_size, struct aom_write_bit_buffer *saved_wb,
+    uint8_t obu_extn_header, const FrameHeaderInfo *fh_info,
+    int *const largest_tile_id, unsigned int *max_tile_size,
+    uint32_t *const obu_header_size, uint8_t **tile_data_start,
+    const int num_workers) {
   MultiThreadInfo *const mt_info = &cpi->mt_info;
 
   PackBSParams pack_bs_params[MAX_TILES];
@@ -3224,14 +3236,15 @@ void av1_write_tile_obu_mt(
   for (int tile_idx = 0; tile_idx < MAX_TILES; tile_idx++)
     pack_bs_params[tile_idx].total_size = &tile_size[tile_idx];
 
-  init_tile_pack_bs_params(cpi, dst, saved_wb, pack_bs_params, obu_extn_header);
+  init_tile_pack_bs_params(cpi, dst, dst_size, saved_wb, pack_bs_params,
+                           obu_extn_header);
   prepare_pack_bs_workers(cpi, pack_bs_params, pack_bs_worker_hook,
                           num_workers);
   launch_workers(mt_info, num_workers);
   sync_enc_workers(mt_info, &cpi->common, num_workers);
-  accumulate_pack_bs_data(cpi, pack_bs_params, dst, total_size, fh_info,
-                          largest_tile_id, max_tile_size, obu_header_size,
-                          tile_data_start, num_workers);
+  accumulate_pack_bs_data(cpi, pack_bs_params, dst, dst_size, total_size,
+                          fh_info, largest_tile_id, max_tile_size,
+                          obu_header_size, tile_data_start, num_workers);
 }
 
 // Deallocate memory for CDEF search multi-thread synchronization.
@@ -3371,6 +3384,81 @@ void av1_cdef_mse_calc_frame_mt(AV1_COMP *cpi) {
   sync_enc_workers(mt_info, &cpi->common, num_workers);
 }
 
+// Screen content detection job of one worker.
+typedef struct {
+  const ScreenContentSource *source;
+  int num_workers;
+  int sample_step;
+  int in_sample;
+  ScreenContentStats stats;
+} ScreenContentJob;
+
+// Hook function for each thread in screen content detection
+// multi-threading. Worker i scans the block rows i, i + num_workers, ...
+static int sc_detection_worker_hook(void *arg1, void *arg2) {
+  EncWorkerData *const thread_data = (EncWorkerData *)arg1;
+  ScreenContentJob *const job = (ScreenContentJob *)arg2;
+  const int num_rows = job->source->height / SC_DETECT_BLOCK_SIZE;
+  av1_scan_screen_content_blocks(job->source, thread_data->start, num_rows,
+                                 job->num_workers, job->sample_step,
+                                 job->in_sample, &job->stats);
+  return 1;
+}
+
+// Computes num_workers for screen content detection multi-threading. The
+// detection runs before the frame is encoded, so it can use the workers of
+// the first pass or of the encode stage.
+int av1_get_num_sc_detection_workers(const AV1_COMP *cpi, int num_rows) {
+  const MULTI_THREADED_MODULES mod =
+      cpi->oxcf.pass == AOM_RC_FIRST_PASS ? MOD_FP : MOD_ENC;
+  return AOMMIN(cpi->mt_info.num_mod_workers[mod], num_rows);
+}
+
+// Implements multi-threading for the block scan of the screen content
+// detection. The statistics of all workers are added to stats.
+void av1_scan_screen_content_blocks_mt(AV1_COMP *cpi,
+                                       const ScreenContentSource *source,
+                                       int sample_step, int in_sample,
+                                       ScreenContentStats *stats) {
+  MultiThreadInfo *const mt_info = &cpi->mt_info;
+  const int num_rows = source->height / SC_DETECT_BLOCK_SIZE;
+  const int num_workers = av1_get_num_sc_detection_workers(cpi, num_rows);
+  assert(num_workers <= MAX_NUM_THREADS);
+  ScreenContentJob jobs[MAX_NUM_THREADS];
+
+  for (int i = num_workers - 1; i >= 0; i--) {
+    AVxWorker *const worker = &mt_info->workers[i];
+    EncWorkerData *const thread_data = &mt_info->tile_thr_data[i];
+    ScreenContentJob *const job = &jobs[i];
+    job->source = source;
+    job->num_workers = num_workers;
+    job->sample_step = sample_step;
+    job->in_sample = in_sample;
+    av1_zero(job->stats);
+
+    thread_data->cpi = cpi;
+    thread_data->start = i;
+    thread_data->thread_id = i;
+    if (i == 0) {
+      thread_data->td = &cpi->td;
+    } else {
+      thread_data->td = thread_data->original_td;
+    }
+
+    worker->hook = sc_detection_worker_hook;
+    worker->data1 = thread_data;
+    worker->data2 = job;
+  }
+  launch_workers(mt_info, num_workers);
+  sync_enc_workers(mt_info, &cpi->common, num_workers);
+
+  for (int i = 0; i < num_workers; i++) {
+    stats->counts_1 += jobs[i].stats.counts_1;
+    stats->counts_2 += jobs[i].stats.counts_2;
+    stats->num_blocks += jobs[i].stats.num_blocks;
+  }
+}
+
 // Computes num_workers for temporal filter multi-threading.
 static inline int compute_num_tf_workers(const AV1_COMP *cpi) {
   // For single-pass encode, using no. of workers as per tf block size was not
@@ -3398,6 +3486,11 @@ static inline int compute_num_lf_workers(AV1_COMP *cpi) {
   return compute_num_enc_workers(cpi, cpi->oxcf.max_threads);
 }
 
+// Computes num_workers for motion field projection multi-threading.
+static inline int compute_num_mfp_workers(AV1_COMP *cpi) {
+  return compute_num_enc_workers(cpi, cpi->oxcf.max_threads);
+}
+
 // Computes num_workers for cdef multi-threading.
 static inline int compute_num_cdef_workers(AV1_COMP *cpi) {
   return compute_num_enc_workers(cpi, cpi->oxcf.max_threads);
@@ -3460,6 +3553,7 @@ static int compute_num_mod_workers(AV1_COMP *cpi,
         num_mod_workers = 0;
       }
       break;
+    case MOD_MFP: num_mod_workers = compute_num_mfp_workers(cpi); break;
     default: assert(0); break;
   }
   return (num_mod_workers);
@@ -82,6 +82,13 @@ void av1_tf_do_filtering_mt(AV1_COMP *cpi);
 
 void av1_tf_mt_dealloc(AV1TemporalFilterSync *tf_sync);
 
+int av1_get_num_sc_detection_workers(const AV1_COMP *cpi, int num_rows);
+
+void av1_scan_screen_content_blocks_mt(AV1_COMP *cpi,
+                                       const ScreenContentSource *source,
+                                       int sample_step, int in_sample,
+                                       ScreenContentStats *stats);
+
 void av1_compute_num_workers_for_mt(AV1_COMP *cpi);
 
 int av1_get_max_num_workers(const AV1_COMP *cpi);
@@ -112,11 +119,12 @@ void av1_cdef_mse_calc_frame_mt(AV1_COMP *cpi);
 void av1_cdef_mt_dealloc(AV1CdefSync *cdef_sync);
 
 void av1_write_tile_obu_mt(
-    AV1_COMP *const cpi, uint8_t *const dst, uint32_t *total_size,
-    struct aom_write_bit_buffer *saved_wb, uint8_t obu_extn_header,
-    const FrameHeaderInfo *fh_info, int *const largest_tile_id,
-    unsigned int *max_tile_size, uint32_t *const obu_header_size,
-    uint8_t **tile_data_start, const int num_workers);
+    AV1_COMP *const cpi, uint8_t *const dst, size_t dst_size,
+    uint32_t *total_size, struct aom_write_bit_buffer *saved_wb,
+    uint8_t obu_extn_header, const FrameHeaderInfo *fh_info,
+    int *const largest_tile_id, unsigned int *max_tile_size,
+    uint32_t *const obu_header_size, uint8_t **tile_data_start,
+    const int num_workers);
 
 int av1_compute_num_fp_contexts(AV1_PRIMARY *ppi, AV1EncoderConfig *oxcf);
 
@@ -33,7 +33,8 @@ static void copy_and_extend_plane(const uint8_t *src, int src_pitch,
   for (i = 0; i < h; i++) {
     memset(dst_ptr1, src_ptr1[0], extend_left);
     if (chroma_step == 1) {
-      memcpy(dst_ptr1 + extend_left, src_ptr1, w);
+      // src == dst when extending in place.
+      if (src != dst) memcpy(dst_ptr1 + extend_left, src_ptr1, w);
     } else {
       for (int j = 0; j < w; j++) {
         dst_ptr1[extend_left + j] = src_ptr1[chroma_step * j];
@@ -82,7 +83,8 @@ static void highbd_copy_and_extend_plane(const uint8_t *src8, int src_pitch,
 
   for (i = 0; i < h; i++) {
     aom_memset16(dst_ptr1, src_ptr1[0], extend_left);
-    memcpy(dst_ptr1 + extend_left, src_ptr1, w * sizeof(src_ptr1[0]));
+    if (src != dst)
+      memcpy(dst_ptr1 + extend_left, src_ptr1, w * sizeof(src_ptr1[0]));
     aom_memset16(dst_ptr2, src_ptr2[0], extend_right);
     src_ptr1 += src_pitch;
     src_ptr2 += src_pitch;
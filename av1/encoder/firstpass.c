@@ -1047,12 +1047,15 @@ static FRAME_STATS accumulate_frame_stats(FRAME_STATS *mb_stats, int mb_rows,
 static void setup_firstpass_data(AV1_COMMON *const cm,
                                  FirstPassData *firstpass_data,
                                  const int unit_rows, const int unit_cols) {
-  CHECK_MEM_ERROR(cm, firstpass_data->raw_motion_err_list,
-                  aom_calloc(unit_rows * unit_cols,
-                             sizeof(*firstpass_data->raw_motion_err_list)));
   CHECK_MEM_ERROR(
-      cm, firstpass_data->mb_stats,
-      aom_calloc(unit_rows * unit_cols, sizeof(*firstpass_data->mb_stats)));
+      cm, firstpass_data->raw_motion_err_list,
+      aom_calloc_tagged(unit_rows * unit_cols,
+                        sizeof(*firstpass_data->raw_motion_err_list),
+                        AOM_MEM_TAG_FIRSTPASS_STATS));
+  CHECK_MEM_ERROR(cm, firstpass_data->mb_stats,
+                  aom_calloc_tagged(unit_rows * unit_cols,
+                                    sizeof(*firstpass_data->mb_stats),
+                                    AOM_MEM_TAG_FIRSTPASS_STATS));
   for (int j = 0; j < unit_rows; j++) {
     for (int i = 0; i < unit_cols; i++) {
       firstpass_data->mb_stats[j * unit_cols + i].image_data_start_row =
@@ -11,16 +11,22 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "config/av1_rtcd.h"
 
+#include "aom_mem/aom_mem.h"
+
 #include "av1/encoder/block.h"
 #include "av1/encoder/hash.h"
 #include "av1/encoder/hash_motion.h"
 
 #define kSrcBits 16
 #define kBlockSizeBits 3
-#define kMaxAddr (1 << (kSrcBits + kBlockSizeBits))
+// One run of offsets per block size, with one extra offset at the end of each
+// run so that the runs of block sizes with no blocks stay all zero.
+#define kOffsetsPerSize ((1 << kSrcBits) + 1)
+#define kNumOffsets (kOffsetsPerSize << kBlockSizeBits)
 
 // TODO(youzhou@microsoft.com): is higher than 8 bits screen content supported?
 // If yes, fix this function
@@ -93,81 +99,73 @@ static int hash_block_size_to_index(int block_size) {
   }
 }
 
-void av1_hash_table_init(IntraBCHashInfo *intrabc_hash_info) {
+void av1_hash_crc_init(IntraBCHashInfo *intrabc_hash_info) {
   if (!intrabc_hash_info->g_crc_initialized) {
     av1_crc_calculator_init(&intrabc_hash_info->crc_calculator1, 24, 0x5D6DCB);
     av1_crc_calculator_init(&intrabc_hash_info->crc_calculator2, 24, 0x864CFB);
     intrabc_hash_info->g_crc_initialized = 1;
   }
-  intrabc_hash_info->intrabc_hash_table.p_lookup_table = NULL;
 }
 
-static void clear_all(hash_table *p_hash_table) {
-  if (p_hash_table->p_lookup_table == NULL) {
-    return;
-  }
-  for (int i = 0; i < kMaxAddr; i++) {
-    if (p_hash_table->p_lookup_table[i] != NULL) {
-      aom_vector_destroy(p_hash_table->p_lookup_table[i]);
-      aom_free(p_hash_table->p_lookup_table[i]);
-      p_hash_table->p_lookup_table[i] = NULL;
-    }
-  }
+void av1_hash_table_init(IntraBCHashInfo *intrabc_hash_info) {
+  av1_hash_crc_init(intrabc_hash_info);
+  av1_zero(intrabc_hash_info->intrabc_hash_table);
 }
 
 void av1_hash_table_destroy(hash_table *p_hash_table) {
-  clear_all(p_hash_table);
-  aom_free(p_hash_table->p_lookup_table);
-  p_hash_table->p_lookup_table = NULL;
+  aom_free(p_hash_table->offsets);
+  aom_free(p_hash_table->entries);
+  av1_zero(*p_hash_table);
 }
 
 bool av1_hash_table_create(hash_table *p_hash_table) {
-  if (p_hash_table->p_lookup_table != NULL) {
-    clear_all(p_hash_table);
+  p_hash_table->num_entries = 0;
+  if (p_hash_table->offsets != NULL) {
+    memset(p_hash_table->offsets, 0,
+           kNumOffsets * sizeof(p_hash_table->offsets[0]));
     return true;
   }
-  p_hash_table->p_lookup_table =
-      (Vector **)aom_calloc(kMaxAddr, sizeof(p_hash_table->p_lookup_table[0]));
-  if (!p_hash_table->p_lookup_table) return false;
+  p_hash_table->offsets =
+      (uint32_t *)aom_calloc(kNumOffsets, sizeof(p_hash_table->offsets[0]));
+  if (!p_hash_table->offsets) return false;
   return true;
 }
 
-static bool hash_table_add_to_table(hash_table *p_hash_table,
-                                    uint32_t hash_value,
-                                    block_hash *curr_block_hash) {
-  if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-    p_hash_table->p_lookup_table[hash_value] =
-        aom_malloc(sizeof(p_hash_table->p_lookup_table[0][0]));
-    if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-      return false;
-    }
-    if (aom_vector_setup(p_hash_table->p_lookup_table[hash_value], 10,
-                         sizeof(curr_block_hash[0])) == VECTOR_ERROR)
-      return false;
-    if (aom_vector_push_back(p_hash_table->p_lookup_table[hash_value],
-                             curr_block_hash) == VECTOR_ERROR)
-      return false;
-  } else {
-    if (aom_vector_push_back(p_hash_table->p_lookup_table[hash_value],
-                             curr_block_hash) == VECTOR_ERROR)
-      return false;
+// Returns the offsets of the hash value within the run of its block size.
+static inline const uint32_t *get_hash_offsets(const hash_table *p_hash_table,
+                                               uint32_t hash_value) {
+  return p_hash_table->offsets + (hash_value >> kSrcBits) * kOffsetsPerSize +
+         (hash_value & ((1 << kSrcBits) - 1));
+}
+
+static bool hash_table_reserve(hash_table *p_hash_table, uint32_t size) {
+  if (size <= p_hash_table->max_entries) return true;
+  uint32_t max_entries = AOMMAX(p_hash_table->max_entries * 2, 1024);
+  if (max_entries < size) max_entries = size;
+  block_hash *const entries =
+      (block_hash *)aom_malloc(max_entries * sizeof(*entries));
+  if (!entries) return false;
+  if (p_hash_table->num_entries > 0) {
+    memcpy(entries, p_hash_table->entries,
+           p_hash_table->num_entries * sizeof(*entries));
   }
+  aom_free(p_hash_table->entries);
+  p_hash_table->entries = entries;
+  p_hash_table->max_entries = max_entries;
   return true;
 }
 
 int32_t av1_hash_table_count(const hash_table *p_hash_table,
                              uint32_t hash_value) {
-  if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-    return 0;
-  } else {
-    return (int32_t)(p_hash_table->p_lookup_table[hash_value]->size);
-  }
+  if (p_hash_table->offsets == NULL) return 0;
+  const uint32_t *const offsets = get_hash_offsets(p_hash_table, hash_value);
+  return (int32_t)(offsets[1] - offsets[0]);
 }
 
-Iterator av1_hash_get_first_iterator(hash_table *p_hash_table,
-                                     uint32_t hash_value) {
+const block_hash *av1_hash_get_first_entry(const hash_table *p_hash_table,
+                                           uint32_t hash_value) {
   assert(av1_hash_table_count(p_hash_table, hash_value) > 0);
-  return aom_vector_begin(p_hash_table->p_lookup_table[hash_value]);
+  return p_hash_table->entries + get_hash_offsets(p_hash_table, hash_value)[0];
 }
 
 void av1_generate_block_2x2_hash_value(IntraBCHashInfo *intrabc_hash_info,
@@ -308,31 +306,119 @@ bool av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
   const int8_t *src_is_added = pic_is_same;
   const uint32_t *src_hash[2] = { pic_hash[0], pic_hash[1] };
 
-  int add_value = hash_block_size_to_index(block_size);
-  assert(add_value >= 0);
-  add_value <<= kSrcBits;
+  const int size_idx = hash_block_size_to_index(block_size);
+  assert(size_idx >= 0);
   const int crc_mask = (1 << kSrcBits) - 1;
+  // offsets[0] is the start of the run of this block size and offsets[h + 1]
+  // is first used to count the blocks with crc value h, then as the write
+  // position of crc value h. Once all blocks are written, offsets[h + 1] is
+  // the end of crc value h, i.e. the start of crc value h + 1.
+  uint32_t *const offsets = p_hash_table->offsets + size_idx * kOffsetsPerSize;
+
+  // The counts do not depend on the scan order, so scan in raster order.
+  for (int y_pos = 0; y_pos < y_end; y_pos++) {
+    const int8_t *const is_added = src_is_added + y_pos * pic_width;
+    const uint32_t *const hash = src_hash[0] + y_pos * pic_width;
+    for (int x_pos = 0; x_pos < x_end; x_pos++) {
+      if (is_added[x_pos]) ++offsets[(hash[x_pos] & crc_mask) + 1];
+    }
+  }
+
+  uint32_t start = p_hash_table->num_entries;
+  offsets[0] = start;
+  for (int i = 1; i < kOffsetsPerSize; i++) {
+    const uint32_t count = offsets[i];
+    offsets[i] = start;
+    start += count;
+  }
+  if (!hash_table_reserve(p_hash_table, start)) return false;
+  p_hash_table->num_entries = start;
 
+  // Blocks with the same hash value are stored in x-major order, which is the
+  // order av1_intrabc_hash_search() prefers among equal cost candidates.
+  block_hash *const entries = p_hash_table->entries;
   for (int x_pos = 0; x_pos < x_end; x_pos++) {
     for (int y_pos = 0; y_pos < y_end; y_pos++) {
       const int pos = y_pos * pic_width + x_pos;
       // valid data
       if (src_is_added[pos]) {
-        block_hash curr_block_hash;
-        curr_block_hash.x = x_pos;
-        curr_block_hash.y = y_pos;
+        block_hash *const curr_block_hash =
+            &entries[offsets[(src_hash[0][pos] & crc_mask) + 1]++];
+        curr_block_hash->x = x_pos;
+        curr_block_hash->y = y_pos;
+        curr_block_hash->hash_value2 = src_hash[1][pos];
+      }
+    }
+  }
+  return true;
+}
 
-        const uint32_t hash_value1 = (src_hash[0][pos] & crc_mask) + add_value;
-        curr_block_hash.hash_value2 = src_hash[1][pos];
+static void free_block_hash_buffers(uint32_t *block_hash_values[2][2],
+                                    int8_t *is_block_same[2][3]) {
+  for (int k = 0; k < 2; ++k) {
+    for (int j = 0; j < 2; ++j) {
+      aom_free(block_hash_values[k][j]);
+    }
 
-        if (!hash_table_add_to_table(p_hash_table, hash_value1,
-                                     &curr_block_hash)) {
-          return false;
-        }
+    for (int j = 0; j < 3; ++j) {
+      aom_free(is_block_same[k][j]);
+    }
+  }
+}
+
+bool av1_hash_table_build(IntraBCHashInfo *intrabc_hash_info,
+                          hash_table *p_hash_table,
+                          const YV12_BUFFER_CONFIG *picture,
+                          int min_block_size, int max_block_size) {
+  const int pic_width = picture->y_crop_width;
+  const int pic_height = picture->y_crop_height;
+  uint32_t *block_hash_values[2][2] = { { NULL } };
+  int8_t *is_block_same[2][3] = { { NULL } };
+  bool error = false;
+
+  for (int k = 0; k < 2 && !error; ++k) {
+    for (int j = 0; j < 2; ++j) {
+      block_hash_values[k][j] = (uint32_t *)aom_malloc(
+          sizeof(*block_hash_values[0][0]) * pic_width * pic_height);
+      if (!block_hash_values[k][j]) {
+        error = true;
+        break;
       }
     }
+
+    for (int j = 0; j < 3 && !error; ++j) {
+      is_block_same[k][j] = (int8_t *)aom_malloc(
+          sizeof(*is_block_same[0][0]) * pic_width * pic_height);
+      if (!is_block_same[k][j]) error = true;
+    }
   }
-  return true;
+
+  if (error || !av1_hash_table_create(p_hash_table)) {
+    free_block_hash_buffers(block_hash_values, is_block_same);
+    return false;
+  }
+
+  av1_generate_block_2x2_hash_value(intrabc_hash_info, picture,
+                                    block_hash_values[0], is_block_same[0]);
+  int src_idx = 0;
+  for (int size = 4; size <= max_block_size; size *= 2, src_idx = !src_idx) {
+    const int dst_idx = !src_idx;
+    av1_generate_block_hash_value(
+        intrabc_hash_info, picture, size, block_hash_values[src_idx],
+        block_hash_values[dst_idx], is_block_same[src_idx],
+        is_block_same[dst_idx]);
+    if (size >= min_block_size) {
+      if (!av1_add_to_hash_map_by_row_with_precal_data(
+              p_hash_table, block_hash_values[dst_idx],
+              is_block_same[dst_idx][2], pic_width, pic_height, size)) {
+        error = true;
+        break;
+      }
+    }
+  }
+
+  free_block_hash_buffers(block_hash_values, is_block_same);
+  return !error;
 }
 
 int av1_hash_is_horizontal_perfect(const YV12_BUFFER_CONFIG *picture,
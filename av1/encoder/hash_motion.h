@@ -19,7 +19,7 @@
 #include "aom/aom_integer.h"
 #include "aom_scale/yv12config.h"
 #include "av1/encoder/hash.h"
-#include "third_party/vector/vector.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -36,8 +36,16 @@ typedef struct _block_hash {
   uint32_t hash_value2;
 } block_hash;
 
+// A flat hash table: the blocks of all hash values are stored back to back
+// in entries[], grouped by hash value. Each block size owns one run of
+// (1 << 16) + 1 offsets, and the blocks with hash value h are
+// entries[o[h & 0xffff]] .. entries[o[(h & 0xffff) + 1] - 1], where o is the
+// run of the block size of h.
 typedef struct _hash_table {
-  Vector **p_lookup_table;
+  uint32_t *offsets;
+  block_hash *entries;
+  uint32_t num_entries;
+  uint32_t max_entries;
 } hash_table;
 
 struct intrabc_hash_info;
@@ -55,13 +63,16 @@ typedef struct intrabc_hash_info {
   int g_crc_initialized;
 } IntraBCHashInfo;
 
+void av1_hash_crc_init(IntraBCHashInfo *intra_bc_hash_info);
 void av1_hash_table_init(IntraBCHashInfo *intra_bc_hash_info);
 void av1_hash_table_destroy(hash_table *p_hash_table);
 bool av1_hash_table_create(hash_table *p_hash_table);
 int32_t av1_hash_table_count(const hash_table *p_hash_table,
                              uint32_t hash_value);
-Iterator av1_hash_get_first_iterator(hash_table *p_hash_table,
-                                     uint32_t hash_value);
+// Returns the first of the av1_hash_table_count() blocks with the given hash
+// value. Blocks are ordered by x position, then by y position.
+const block_hash *av1_hash_get_first_entry(const hash_table *p_hash_table,
+                                           uint32_t hash_value);
 void av1_generate_block_2x2_hash_value(IntraBCHashInfo *intra_bc_hash_info,
                                        const YV12_BUFFER_CONFIG *picture,
                                        uint32_t *pic_block_hash[2],
@@ -78,6 +89,13 @@ bool av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
                                                  int8_t *pic_is_same,
                                                  int pic_width, int pic_height,
                                                  int block_size);
+// Hashes the luma plane of the picture and adds the square blocks from
+// min_block_size to max_block_size to the hash table, replacing its previous
+// contents. Returns false if memory allocation fails.
+bool av1_hash_table_build(IntraBCHashInfo *intra_bc_hash_info,
+                          hash_table *p_hash_table,
+                          const YV12_BUFFER_CONFIG *picture,
+                          int min_block_size, int max_block_size);
 
 // check whether the block starts from (x_start, y_start) with the size of
 // block_size x block_size has the same color in all rows
@@ -318,27 +318,26 @@ static int rd_pick_filter_intra_sby(const AV1_COMP *const cpi, MACROBLOCK *x,
 }
 
 void av1_count_colors(const uint8_t *src, int stride, int rows, int cols,
-                      int *val_count, int *num_colors) {
+                      int max_colors, int *val_count, int *num_colors) {
   const int max_pix_val = 1 << 8;
   memset(val_count, 0, max_pix_val * sizeof(val_count[0]));
+  int n = 0;
   for (int r = 0; r < rows; ++r) {
     for (int c = 0; c < cols; ++c) {
       const int this_val = src[r * stride + c];
       assert(this_val < max_pix_val);
-      ++val_count[this_val];
+      n += val_count[this_val]++ == 0;
     }
-  }
-  int n = 0;
-  for (int i = 0; i < max_pix_val; ++i) {
-    if (val_count[i]) ++n;
+    // The histogram is not needed once the block has too many colors.
+    if (n > max_colors) break;
   }
   *num_colors = n;
 }
 
 void av1_count_colors_highbd(const uint8_t *src8, int stride, int rows,
-                             int cols, int bit_depth, int *val_count,
-                             int *bin_val_count, int *num_color_bins,
-                             int *num_colors) {
+                             int cols, int bit_depth, int max_colors,
+                             int *val_count, int *bin_val_count,
+                             int *num_color_bins, int *num_colors) {
   assert(bit_depth <= 12);
   const int max_bin_val = 1 << 8;
   const int max_pix_val = 1 << bit_depth;
@@ -346,6 +345,10 @@ void av1_count_colors_highbd(const uint8_t *src8, int stride, int rows,
   memset(bin_val_count, 0, max_bin_val * sizeof(val_count[0]));
   if (val_count != NULL)
     memset(val_count, 0, max_pix_val * sizeof(val_count[0]));
+  // Count the colors based on 8-bit domain used to gate the palette path
+  int n_bins = 0;
+  // Count the actual hbd colors used to create top_colors
+  int n = 0;
   for (int r = 0; r < rows; ++r) {
     for (int c = 0; c < cols; ++c) {
       /*
@@ -357,25 +360,14 @@ void av1_count_colors_highbd(const uint8_t *src8, int stride, int rows,
       const int this_val = ((src[r * stride + c]) >> (bit_depth - 8));
       assert(this_val < max_bin_val);
       if (this_val >= max_bin_val) continue;
-      ++bin_val_count[this_val];
-      if (val_count != NULL) ++val_count[(src[r * stride + c])];
-    }
-  }
-  int n = 0;
-  // Count the colors based on 8-bit domain used to gate the palette path
-  for (int i = 0; i < max_bin_val; ++i) {
-    if (bin_val_count[i]) ++n;
-  }
-  *num_color_bins = n;
-
-  // Count the actual hbd colors used to create top_colors
-  n = 0;
-  if (val_count != NULL) {
-    for (int i = 0; i < max_pix_val; ++i) {
-      if (val_count[i]) ++n;
+      n_bins += bin_val_count[this_val]++ == 0;
+      if (val_count != NULL) n += val_count[(src[r * stride + c])]++ == 0;
     }
-    *num_colors = n;
+    // The histograms are not needed once the block has too many colors.
+    if (n_bins > max_colors) break;
   }
+  *num_color_bins = n_bins;
+  if (val_count != NULL) *num_colors = n;
 }
 
 void set_y_mode_and_delta_angle(const int mode_idx, MB_MODE_INFO *const mbmi,
@@ -273,16 +273,21 @@ int64_t av1_rd_pick_intra_sbuv_mode(const AV1_COMP *const cpi, MACROBLOCK *x,
                                     BLOCK_SIZE bsize, TX_SIZE max_tx_size);
 
 /*! \brief Return the number of colors in src. Used by palette mode.
+ *
+ * Counting stops early once more than max_colors colors are found. In that
+ * case num_colors is only known to be greater than max_colors, and val_count
+ * is incomplete.
  */
 void av1_count_colors(const uint8_t *src, int stride, int rows, int cols,
-                      int *val_count, int *num_colors);
+                      int max_colors, int *val_count, int *num_colors);
 
-/*! \brief See \ref av1_count_colors(), but for highbd.
+/*! \brief See \ref av1_count_colors(), but for highbd. max_colors applies to
+ * num_color_bins.
  */
 void av1_count_colors_highbd(const uint8_t *src8, int stride, int rows,
-                             int cols, int bit_depth, int *val_count,
-                             int *val_count_8bit, int *num_color_bins,
-                             int *num_colors);
+                             int cols, int bit_depth, int max_colors,
+                             int *val_count, int *val_count_8bit,
+                             int *num_color_bins, int *num_colors);
 
 /*! \brief Initializes the \ref IntraModeSearchState struct.
  */
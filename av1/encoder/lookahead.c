@@ -13,6 +13,9 @@
 
 #include "config/aom_config.h"
 
+#include "aom_dsp/flow_estimation/corner_detect.h"
+#include "aom_dsp/pyramid.h"
+#include "aom_mem/aom_mem.h"
 #include "aom_scale/yv12config.h"
 #include "av1/common/common.h"
 #include "av1/encoder/encoder.h"
@@ -30,12 +33,98 @@ static struct lookahead_entry *pop(struct lookahead_ctx *ctx, int *idx) {
   return buf;
 }
 
+// Points img at the given planes. Any pyramid or corners computed from the
+// previous planes are dropped.
+static void set_planes(YV12_BUFFER_CONFIG *img, uint8_t *const buffers[3]) {
+  img->y_buffer = buffers[0];
+  img->u_buffer = buffers[1];
+  img->v_buffer = buffers[2];
+#if !CONFIG_REALTIME_ONLY
+  aom_invalidate_pyramid(img->y_pyramid);
+  av1_invalidate_corner_list(img->corners);
+#endif  // !CONFIG_REALTIME_ONLY
+}
+
+// Hands a borrowed input image back to the application and points the entry
+// at its own buffers again.
+static void release_input(struct lookahead_ctx *ctx,
+                          struct lookahead_entry *buf) {
+  YV12_BUFFER_CONFIG *const img = &buf->img;
+  if (!img->use_external_reference_buffers) return;
+  set_planes(img, img->store_buf_adr);
+  img->use_external_reference_buffers = 0;
+  ctx->zero_copy.release_cb(ctx->zero_copy.cb_priv, buf->user_priv);
+}
+
+// Returns whether dst can borrow the planes of src: src must have the strides
+// and alignment of dst, and the padding av1_copy_and_extend_frame() writes.
+static bool can_borrow_input(const struct lookahead_ctx *ctx,
+                             const YV12_BUFFER_CONFIG *src,
+                             const YV12_BUFFER_CONFIG *dst) {
+  if (ctx->zero_copy.release_cb == NULL) return false;
+  // Monochrome and NV12 images lack planes of their own.
+  if (src->monochrome || src->v_buffer == NULL) return false;
+  if ((src->flags ^ dst->flags) & YV12_FLAG_HIGHBITDEPTH) return false;
+  if (src->y_stride != dst->y_stride || src->uv_stride != dst->uv_stride)
+    return false;
+
+  // The padding of src is counted from its size rounded up to a multiple
+  // of 8, as y_width and y_height are.
+  const int border = (int)ctx->zero_copy.border;
+  const int ext_right = AOMMAX(src->y_width + dst->border,
+                               ALIGN_POWER_OF_TWO(src->y_width, 6)) -
+                        src->y_crop_width;
+  const int ext_bottom = AOMMAX(src->y_height + dst->border,
+                                ALIGN_POWER_OF_TWO(src->y_height, 6)) -
+                         src->y_crop_height;
+  if (border < dst->border ||
+      border + src->y_width - src->y_crop_width < ext_right ||
+      border + src->y_height - src->y_crop_height < ext_bottom)
+    return false;
+
+  uintptr_t y_addr = (uintptr_t)src->y_buffer;
+  uintptr_t u_addr = (uintptr_t)src->u_buffer;
+  uintptr_t v_addr = (uintptr_t)src->v_buffer;
+  if (src->flags & YV12_FLAG_HIGHBITDEPTH) {
+    y_addr = (uintptr_t)CONVERT_TO_SHORTPTR(src->y_buffer);
+    u_addr = (uintptr_t)CONVERT_TO_SHORTPTR(src->u_buffer);
+    v_addr = (uintptr_t)CONVERT_TO_SHORTPTR(src->v_buffer);
+  }
+  return (y_addr & 31) == 0 && (u_addr & 15) == 0 && (v_addr & 15) == 0;
+}
+
+void av1_lookahead_set_zero_copy(struct lookahead_ctx *ctx,
+                                 const aom_zero_copy_input_t *zero_copy) {
+  ctx->zero_copy = *zero_copy;
+}
+
+void av1_lookahead_unborrow(struct lookahead_ctx *ctx,
+                            YV12_BUFFER_CONFIG *img) {
+  if (!img->use_external_reference_buffers) return;
+  for (int i = 0; i < ctx->max_sz; i++) {
+    struct lookahead_entry *const buf = &ctx->buf[i];
+    if (&buf->img != img) continue;
+    const YV12_BUFFER_CONFIG borrowed = *img;
+    // The pixels stay the same, so any pyramid or corners remain valid.
+    img->y_buffer = img->store_buf_adr[0];
+    img->u_buffer = img->store_buf_adr[1];
+    img->v_buffer = img->store_buf_adr[2];
+    img->use_external_reference_buffers = 0;
+    av1_copy_and_extend_frame(&borrowed, img);
+    ctx->zero_copy.release_cb(ctx->zero_copy.cb_priv, buf->user_priv);
+    return;
+  }
+}
+
 void av1_lookahead_destroy(struct lookahead_ctx *ctx) {
   if (ctx) {
     if (ctx->buf) {
       int i;
 
-      for (i = 0; i < ctx->max_sz; i++) aom_free_frame_buffer(&ctx->buf[i].img);
+      for (i = 0; i < ctx->max_sz; i++) {
+        release_input(ctx, &ctx->buf[i]);
+        aom_free_frame_buffer(&ctx->buf[i].img);
+      }
       free(ctx->buf);
     }
     free(ctx);
@@ -78,14 +167,17 @@ struct lookahead_ctx *av1_lookahead_init(
     }
     ctx->buf = calloc(depth, sizeof(*ctx->buf));
     if (!ctx->buf) goto fail;
+    const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_LOOKAHEAD);
     for (i = 0; i < depth; i++) {
       if (aom_realloc_frame_buffer(
               &ctx->buf[i].img, width, height, subsampling_x, subsampling_y,
               use_highbitdepth, border_in_pixels, byte_alignment, NULL, NULL,
               NULL, alloc_pyramid, 0)) {
+        aom_mem_set_tag(prev_tag);
         goto fail;
       }
     }
+    aom_mem_set_tag(prev_tag);
   }
   return ctx;
 fail:
@@ -100,7 +192,8 @@ int av1_lookahead_full(const struct lookahead_ctx *ctx) {
 
 int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
                        int64_t ts_start, int64_t ts_end, int use_highbitdepth,
-                       bool alloc_pyramid, aom_enc_frame_flags_t flags) {
+                       bool alloc_pyramid, aom_enc_frame_flags_t flags,
+                       void *user_priv) {
   int width = src->y_crop_width;
   int height = src->y_crop_height;
   int uv_width = src->uv_crop_width;
@@ -119,6 +212,8 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
   }
 
   struct lookahead_entry *buf = pop(ctx, &ctx->write_idx);
+  // The frame previously held in this entry is no longer needed.
+  release_input(ctx, buf);
 
   new_dimensions = width != buf->img.y_crop_width ||
                    height != buf->img.y_crop_height ||
@@ -132,10 +227,12 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
   if (larger_dimensions) {
     YV12_BUFFER_CONFIG new_img;
     memset(&new_img, 0, sizeof(new_img));
-    if (aom_alloc_frame_buffer(&new_img, width, height, subsampling_x,
-                               subsampling_y, use_highbitdepth,
-                               AOM_BORDER_IN_PIXELS, 0, alloc_pyramid, 0))
-      return 1;
+    const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_LOOKAHEAD);
+    const int alloc_failed = aom_alloc_frame_buffer(
+        &new_img, width, height, subsampling_x, subsampling_y,
+        use_highbitdepth, AOM_BORDER_IN_PIXELS, 0, alloc_pyramid, 0);
+    aom_mem_set_tag(prev_tag);
+    if (alloc_failed) return 1;
     aom_free_frame_buffer(&buf->img);
     buf->img = new_img;
   } else if (new_dimensions) {
@@ -150,7 +247,19 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
     buf->img.subsampling_x = src->subsampling_x;
     buf->img.subsampling_y = src->subsampling_y;
   }
-  av1_copy_and_extend_frame(src, &buf->img);
+  if (can_borrow_input(ctx, src, &buf->img)) {
+    YV12_BUFFER_CONFIG *const img = &buf->img;
+    memcpy(img->store_buf_adr, img->buffers, sizeof(img->store_buf_adr));
+    set_planes(img, src->buffers);
+    img->use_external_reference_buffers = 1;
+    buf->user_priv = user_priv;
+    // Extends the borders in place.
+    av1_copy_and_extend_frame(img, img);
+  } else {
+    av1_copy_and_extend_frame(src, &buf->img);
+    if (ctx->zero_copy.release_cb != NULL)
+      ctx->zero_copy.release_cb(ctx->zero_copy.cb_priv, user_priv);
+  }
 
   buf->ts_start = ts_start;
   buf->ts_end = ts_end;
@@ -19,6 +19,7 @@
 
 #include "aom_scale/yv12config.h"
 #include "aom/aom_integer.h"
+#include "aom/aomcx.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,6 +37,11 @@ struct lookahead_entry {
   int64_t ts_end;
   int display_idx;
   aom_enc_frame_flags_t flags;
+  // While img borrows the planes of an application image (see
+  // AV1E_SET_ZERO_COPY_INPUT), img.use_external_reference_buffers is set,
+  // img.store_buf_adr holds its own plane pointers and user_priv is passed
+  // back to the application on release.
+  void *user_priv;
 };
 
 // The max of past frames we want to keep in the queue.
@@ -58,6 +64,7 @@ struct lookahead_ctx {
   int push_frame_count; /* Number of frames that have been pushed in the queue*/
   uint8_t
       max_pre_frames; /* Maximum number of past frames allowed in the queue */
+  aom_zero_copy_input_t zero_copy; /* Input borrowing, off if no release_cb */
 };
 /*!\endcond */
 
@@ -72,7 +79,29 @@ struct lookahead_ctx *av1_lookahead_init(
     const int border_in_pixels, int byte_alignment, int num_lap_buffers,
     bool is_all_intra, bool alloc_pyramid);
 
+/**\brief Enables borrowing of input images
+ *
+ * \param[in] ctx        Pointer to the lookahead context
+ * \param[in] zero_copy  Release callback and padding of the input images,
+ *                       see AV1E_SET_ZERO_COPY_INPUT
+ */
+void av1_lookahead_set_zero_copy(struct lookahead_ctx *ctx,
+                                 const aom_zero_copy_input_t *zero_copy);
+
+/**\brief Gives a borrowed input image back to the application
+ *
+ * If img is a queue entry borrowing the planes of an application image, the
+ * planes are copied into the entry's own buffers and the image is released,
+ * so that the encoder may modify img in place. Does nothing otherwise.
+ *
+ * \param[in] ctx  Pointer to the lookahead context
+ * \param[in] img  Frame buffer of a queue entry
+ */
+void av1_lookahead_unborrow(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *img);
+
 /**\brief Destroys the lookahead stage
+ *
+ * Releases any input images still borrowed by the queue.
  */
 void av1_lookahead_destroy(struct lookahead_ctx *ctx);
 
@@ -83,7 +112,10 @@ int av1_lookahead_full(const struct lookahead_ctx *ctx);
 /**\brief Enqueue a source buffer
  *
  * This function will copy the source image into a new framebuffer with
- * the expected stride/border.
+ * the expected stride/border. When zero copy is enabled and the source image
+ * already has that stride/border and suitable alignment, the framebuffer
+ * borrows the planes of the source image instead and only its borders are
+ * extended.
  *
  * \param[in] ctx               Pointer to the lookahead context
  * \param[in] src               Pointer to the image to enqueue
@@ -93,10 +125,12 @@ int av1_lookahead_full(const struct lookahead_ctx *ctx);
  * \param[in] alloc_pyramid     Whether to allocate a downsampling pyramid
  *                              for each frame buffer
  * \param[in] flags             Flags set on this frame
+ * \param[in] user_priv         Passed to the release callback of zero copy
  */
 int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
                        int64_t ts_start, int64_t ts_end, int use_highbitdepth,
-                       bool alloc_pyramid, aom_enc_frame_flags_t flags);
+                       bool alloc_pyramid, aom_enc_frame_flags_t flags,
+                       void *user_priv);
 
 /**\brief Get the next source buffer to encode
  *
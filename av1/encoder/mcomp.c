@@ -110,6 +110,8 @@ void av1_make_default_fullpel_ms_params(
   ms_params->sdx4df = ms_params->vfp->sdx4df;
   ms_params->sdx3df = ms_params->vfp->sdx3df;
 
+  av1_zero(ms_params->ref_hash);
+
   if (mv_sf->use_downsampled_sad == 2 && block_size_high[bsize] >= 16) {
     assert(ms_params->vfp->sdsf != NULL);
     ms_params->sdf = ms_params->vfp->sdsf;
@@ -152,6 +154,28 @@ void av1_make_default_fullpel_ms_params(
   }
 }
 
+void av1_set_ms_ref_hash(FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
+                         const struct AV1_COMP *cpi, MACROBLOCK *x,
+                         MV_REFERENCE_FRAME ref_frame) {
+  const BLOCK_SIZE bsize = ms_params->bsize;
+  const int block_size = block_size_wide[bsize];
+  if (block_size != block_size_high[bsize] ||
+      block_size < REF_HASH_MIN_BLOCK_SIZE ||
+      block_size > REF_HASH_MAX_BLOCK_SIZE)
+    return;
+
+  const hash_table *const table = av1_get_ref_frame_hash_table(cpi, ref_frame);
+  if (table == NULL) return;
+
+  const MACROBLOCKD *const xd = &x->e_mbd;
+  RefHashParams *const ref_hash = &ms_params->ref_hash;
+  ref_hash->table = table;
+  ref_hash->hash_info = &x->intrabc_hash_info;
+  ref_hash->x_pos = xd->mi_col * MI_SIZE;
+  ref_hash->y_pos = xd->mi_row * MI_SIZE;
+  ref_hash->use_highbitdepth = is_cur_buf_hbd(xd);
+}
+
 void av1_set_ms_to_intra_mode(FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
                               const IntraBCMVCosts *dv_costs) {
   ms_params->is_intra_mode = 1;
@@ -1787,6 +1811,49 @@ int av1_refining_search_8p_c(const FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
   return best_sad;
 }
 
+// Looks up the blocks of the reference frame whose source exactly matches the
+// source block, and returns the var cost of the best one, or INT_MAX if none of
+// them is usable.
+static int ref_hash_search(const FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
+                           FULLPEL_MV *best_mv,
+                           FULLPEL_MV_STATS *best_mv_stats) {
+  // Repeated patterns can produce long runs of matches, of which only the
+  // first few are evaluated.
+  const int kMaxCandidates = 64;
+  const RefHashParams *const ref_hash = &ms_params->ref_hash;
+  const struct buf_2d *const src = ms_params->ms_buffers.src;
+  uint32_t hash_value1, hash_value2;
+  av1_get_block_hash_value(ref_hash->hash_info, src->buf, src->stride,
+                           block_size_wide[ms_params->bsize], &hash_value1,
+                           &hash_value2, ref_hash->use_highbitdepth);
+
+  const int count = av1_hash_table_count(ref_hash->table, hash_value1);
+  if (count == 0) return INT_MAX;
+
+  const block_hash *const ref_block_hashes =
+      av1_hash_get_first_entry(ref_hash->table, hash_value1);
+  int best_cost = INT_MAX;
+  int num_candidates = 0;
+  for (int i = 0; i < count && num_candidates < kMaxCandidates; i++) {
+    const block_hash *const ref_block_hash = &ref_block_hashes[i];
+    if (ref_block_hash->hash_value2 != hash_value2) continue;
+
+    const FULLPEL_MV hash_mv = { ref_block_hash->y - ref_hash->y_pos,
+                                 ref_block_hash->x - ref_hash->x_pos };
+    if (!av1_is_fullmv_in_range(&ms_params->mv_limits, hash_mv)) continue;
+
+    FULLPEL_MV_STATS mv_stats;
+    const int cost = get_mvpred_var_cost(ms_params, &hash_mv, &mv_stats);
+    if (cost < best_cost) {
+      best_cost = cost;
+      *best_mv = hash_mv;
+      *best_mv_stats = mv_stats;
+    }
+    ++num_candidates;
+  }
+  return best_cost;
+}
+
 int av1_full_pixel_search(const FULLPEL_MV start_mv,
                           const FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
                           const int step_param, int *cost_list,
@@ -1814,6 +1881,35 @@ int av1_full_pixel_search(const FULLPEL_MV start_mv,
 
   assert(ms_params->ms_buffers.ref->stride == ms_params->search_sites->stride);
 
+  // Look up exact matches of the source block in the reference frame first.
+  // A match that also predicts the block without distortion can only be
+  // beaten on mv cost, so the regular search is replaced by a check of the
+  // start mv.
+  FULLPEL_MV hash_mv;
+  FULLPEL_MV_STATS hash_mv_stats;
+  int hash_var = INT_MAX;
+  if (ms_params->ref_hash.table != NULL && !is_intra_mode &&
+      !ms_params->ms_buffers.second_pred) {
+    hash_var = ref_hash_search(ms_params, &hash_mv, &hash_mv_stats);
+    if (hash_var < INT_MAX && hash_mv_stats.distortion == 0) {
+      *best_mv = hash_mv;
+      *best_mv_stats = hash_mv_stats;
+      var = hash_var;
+      FULLPEL_MV clamped_start_mv = start_mv;
+      clamp_fullmv(&clamped_start_mv, &ms_params->mv_limits);
+      FULLPEL_MV_STATS start_mv_stats;
+      const int start_var =
+          get_mvpred_var_cost(ms_params, &clamped_start_mv, &start_mv_stats);
+      if (start_var < var) {
+        *best_mv = clamped_start_mv;
+        *best_mv_stats = start_mv_stats;
+        var = start_var;
+      }
+      if (cost_list) calc_int_cost_list(*best_mv, ms_params, cost_list);
+      return var;
+    }
+  }
+
   switch (search_method) {
     case FAST_BIGDIA:
       var = fast_bigdia_search(start_mv, ms_params, step_param, 0, cost_list,
@@ -1910,6 +2006,17 @@ int av1_full_pixel_search(const FULLPEL_MV start_mv,
     }
   }
 
+  if (hash_var < INT_MAX) {
+    // An exact source match makes the exhaustive search unnecessary.
+    run_mesh_search = 0;
+    if (hash_var < var) {
+      var = hash_var;
+      *best_mv = hash_mv;
+      *best_mv_stats = hash_mv_stats;
+      if (cost_list) calc_int_cost_list(*best_mv, ms_params, cost_list);
+    }
+  }
+
   if (run_mesh_search) {
     int var_ex;
     FULLPEL_MV tmp_mv_ex;
@@ -1962,7 +2069,7 @@ int av1_intrabc_hash_search(const AV1_COMP *cpi, const MACROBLOCKD *xd,
   int best_hash_cost = INT_MAX;
 
   // for the hashMap
-  hash_table *ref_frame_hash = &intrabc_hash_info->intrabc_hash_table;
+  const hash_table *ref_frame_hash = &intrabc_hash_info->intrabc_hash_table;
 
   av1_get_block_hash_value(intrabc_hash_info, src, src_stride, block_width,
                            &hash_value1, &hash_value2, is_cur_buf_hbd(xd));
@@ -1972,9 +2079,10 @@ int av1_intrabc_hash_search(const AV1_COMP *cpi, const MACROBLOCKD *xd,
     return INT_MAX;
   }
 
-  Iterator iterator = av1_hash_get_first_iterator(ref_frame_hash, hash_value1);
-  for (int i = 0; i < count; i++, aom_iterator_increment(&iterator)) {
-    block_hash ref_block_hash = *(block_hash *)(aom_iterator_get(&iterator));
+  const block_hash *const ref_block_hashes =
+      av1_hash_get_first_entry(ref_frame_hash, hash_value1);
+  for (int i = 0; i < count; i++) {
+    const block_hash ref_block_hash = ref_block_hashes[i];
     if (hash_value2 == ref_block_hash.hash_value2) {
       // Make sure the prediction is from valid area.
       const MV dv = { GET_MV_SUBPEL(ref_block_hash.y - y_pos),
@@ -89,6 +89,19 @@ static inline void av1_set_ms_compound_refs(MSBuffers *ms_buffers,
 // =============================================================================
 //  Fullpixel Motion Search
 // =============================================================================
+// Exact-match lookup of the source block in the hash table of a reference
+// frame, done ahead of the regular fullpixel search.
+typedef struct {
+  // Hash table of the reference frame; NULL disables the lookup.
+  const hash_table *table;
+  // Used to compute the hash of the source block.
+  IntraBCHashInfo *hash_info;
+  // Position of the block in the frame, in pixels.
+  int x_pos;
+  int y_pos;
+  int use_highbitdepth;
+} RefHashParams;
+
 // This struct holds fullpixel motion search parameters that should be constant
 // during the search
 typedef struct {
@@ -131,6 +144,9 @@ typedef struct {
   aom_sad_fn_t sdf;
   aom_sad_multi_d_fn_t sdx4df;
   aom_sad_multi_d_fn_t sdx3df;
+
+  // Exact-match lookup in the reference frame hash table.
+  RefHashParams ref_hash;
 } FULLPEL_MOTION_SEARCH_PARAMS;
 
 typedef struct {
@@ -147,6 +163,12 @@ void av1_make_default_fullpel_ms_params(
     const search_site_config search_sites[NUM_DISTINCT_SEARCH_METHODS],
     SEARCH_METHODS search_method, int fine_search_interval);
 
+// Enables the exact-match lookup in the hash table of ref_frame, if it has one
+// and the block size is covered by it.
+void av1_set_ms_ref_hash(FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
+                         const struct AV1_COMP *cpi, MACROBLOCK *x,
+                         MV_REFERENCE_FRAME ref_frame);
+
 /*! Sets the \ref FULLPEL_MOTION_SEARCH_PARAMS to intra mode. */
 void av1_set_ms_to_intra_mode(FULLPEL_MOTION_SEARCH_PARAMS *ms_params,
                               const IntraBCMVCosts *dv_costs);
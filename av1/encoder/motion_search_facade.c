@@ -117,11 +117,11 @@ static inline void get_mv_candidate_from_tpl(const AV1_COMP *const cpi,
   }
 }
 
-void av1_single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
-                              BLOCK_SIZE bsize, int ref_idx, int *rate_mv,
-                              int search_range, inter_mode_info *mode_info,
-                              int_mv *best_mv,
-                              struct HandleInterModeArgs *const args) {
+static void single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
+                                 BLOCK_SIZE bsize, int ref_idx, int *rate_mv,
+                                 int search_range, inter_mode_info *mode_info,
+                                 int_mv *best_mv,
+                                 struct HandleInterModeArgs *const args) {
   MACROBLOCKD *xd = &x->e_mbd;
   const AV1_COMMON *cm = &cpi->common;
   const MotionVectorSearchParams *mv_search_params = &cpi->mv_search_params;
@@ -283,6 +283,7 @@ void av1_single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
         av1_make_default_fullpel_ms_params(
             &full_ms_params, cpi, x, bsize, &ref_mv, smv.as_fullmv,
             src_search_site_cfg, search_method, fine_search_interval);
+        av1_set_ms_ref_hash(&full_ms_params, cpi, x, ref);
 
         const int thissme =
             av1_full_pixel_search(smv.as_fullmv, &full_ms_params, step_param,
@@ -523,10 +524,22 @@ void av1_single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
   }
 }
 
+void av1_single_motion_search(const AV1_COMP *const cpi, MACROBLOCK *x,
+                              BLOCK_SIZE bsize, int ref_idx, int *rate_mv,
+                              int search_range, inter_mode_info *mode_info,
+                              int_mv *best_mv,
+                              struct HandleInterModeArgs *const args) {
+  const int64_t me_start = av1_stage_timer_start(cpi->ppi->stage_timing);
+  single_motion_search(cpi, x, bsize, ref_idx, rate_mv, search_range,
+                       mode_info, best_mv, args);
+  av1_stage_timer_add(cpi->ppi->stage_timing, me_start, &x->me_time_ns);
+}
+
 int av1_joint_motion_search(const AV1_COMP *cpi, MACROBLOCK *x,
                             BLOCK_SIZE bsize, int_mv *cur_mv,
                             const uint8_t *mask, int mask_stride, int *rate_mv,
                             int allow_second_mv, int joint_me_num_refine_iter) {
+  const int64_t me_start = av1_stage_timer_start(cpi->ppi->stage_timing);
   const AV1_COMMON *const cm = &cpi->common;
   const int num_planes = av1_num_planes(cm);
   const int pw = block_size_wide[bsize];
@@ -727,6 +740,7 @@ int av1_joint_motion_search(const AV1_COMP *cpi, MACROBLOCK *x,
                                 mv_costs->mv_cost_stack, MV_COST_WEIGHT);
   }
 
+  av1_stage_timer_add(cpi->ppi->stage_timing, me_start, &x->me_time_ns);
   return AOMMIN(last_besterr[0], last_besterr[1]);
 }
 
@@ -737,6 +751,7 @@ int av1_compound_single_motion_search(const AV1_COMP *cpi, MACROBLOCK *x,
                                       const uint8_t *second_pred,
                                       const uint8_t *mask, int mask_stride,
                                       int *rate_mv, int ref_idx) {
+  const int64_t me_start = av1_stage_timer_start(cpi->ppi->stage_timing);
   const AV1_COMMON *const cm = &cpi->common;
   const int num_planes = av1_num_planes(cm);
   MACROBLOCKD *xd = &x->e_mbd;
@@ -839,6 +854,7 @@ int av1_compound_single_motion_search(const AV1_COMP *cpi, MACROBLOCK *x,
 
   *rate_mv += av1_mv_bit_cost(this_mv, &ref_mv.as_mv, mv_costs->nmv_joint_cost,
                               mv_costs->mv_cost_stack, MV_COST_WEIGHT);
+  av1_stage_timer_add(cpi->ppi->stage_timing, me_start, &x->me_time_ns);
   return bestsme;
 }
 
@@ -970,6 +986,7 @@ int_mv av1_simple_motion_search_sse_var(AV1_COMP *const cpi, MACROBLOCK *x,
                                         FULLPEL_MV start_mv, int num_planes,
                                         int use_subpixel, unsigned int *sse,
                                         unsigned int *var) {
+  const int64_t me_start = av1_stage_timer_start(cpi->ppi->stage_timing);
   assert(num_planes == 1 &&
          "Currently simple_motion_search only supports luma plane");
   assert(!frame_is_intra_only(&cpi->common) &&
@@ -1066,5 +1083,6 @@ int_mv av1_simple_motion_search_sse_var(AV1_COMP *const cpi, MACROBLOCK *x,
     *sse = best_mv_stats.sse;
   }
 
+  av1_stage_timer_add(cpi->ppi->stage_timing, me_start, &x->me_time_ns);
   return best_mv;
 }
@@ -194,6 +194,7 @@ static int combined_motion_search(AV1_COMP *cpi, MACROBLOCK *x,
                                   BLOCK_SIZE bsize, int_mv *tmp_mv,
                                   int *rate_mv, int64_t best_rd_sofar,
                                   int use_base_mv) {
+  const int64_t me_start = av1_stage_timer_start(cpi->ppi->stage_timing);
   MACROBLOCKD *xd = &x->e_mbd;
   const AV1_COMMON *cm = &cpi->common;
   const SPEED_FEATURES *sf = &cpi->sf;
@@ -272,6 +273,7 @@ static int combined_motion_search(AV1_COMP *cpi, MACROBLOCK *x,
   // The final MV can not be equal to the reference MV as this will trigger an
   // assert later. This can happen if both NEAREST and NEAR modes were skipped.
   rv = (tmp_mv->as_mv.col != ref_mv.col || tmp_mv->as_mv.row != ref_mv.row);
+  av1_stage_timer_add(cpi->ppi->stage_timing, me_start, &x->me_time_ns);
   return rv;
 }
 
@@ -31,6 +31,100 @@
 #include "av1/encoder/k_means_template.h"
 #undef AV1_K_MEANS_DIM
 
+// Chroma palette search is skipped for blocks with more colors than this.
+static const int kMaxUvPaletteColors = 64;
+
+int av1_build_color_histogram(const int *count_buf, int bit_depth,
+                              int num_colors, ColorHistogram *hist) {
+  if (num_colors > MAX_HIST_KMEANS_COLORS) return 0;
+  int n = 0;
+  for (int i = 0; i < (1 << bit_depth) && n < num_colors; ++i) {
+    if (count_buf[i] > 0) {
+      hist->colors[n] = (int16_t)i;
+      hist->counts[n] = count_buf[i];
+      ++n;
+    }
+  }
+  assert(n == num_colors);
+  hist->num_colors = n;
+  return 1;
+}
+
+static void hist_calc_indices(const ColorHistogram *hist,
+                              const int16_t *centroids, uint8_t *indices,
+                              int64_t *dist, int k) {
+  *dist = 0;
+  for (int i = 0; i < hist->num_colors; ++i) {
+    int min_dist = abs(hist->colors[i] - centroids[0]);
+    indices[i] = 0;
+    for (int j = 1; j < k; ++j) {
+      const int this_dist = abs(hist->colors[i] - centroids[j]);
+      if (this_dist < min_dist) {
+        min_dist = this_dist;
+        indices[i] = j;
+      }
+    }
+    *dist += (int64_t)hist->counts[i] * min_dist * min_dist;
+  }
+}
+
+// data[] and n are the per-pixel values, which are only used to reseed empty
+// clusters the same way as calc_centroids() in k_means_template.h.
+static void hist_calc_centroids(const ColorHistogram *hist,
+                                const int16_t *data, int n,
+                                int16_t *centroids, const uint8_t *indices,
+                                int k) {
+  int count[PALETTE_MAX_SIZE] = { 0 };
+  int centroids_sum[PALETTE_MAX_SIZE] = { 0 };
+  unsigned int rand_state = (unsigned int)data[0];
+  for (int i = 0; i < hist->num_colors; ++i) {
+    const int index = indices[i];
+    assert(index < k);
+    count[index] += hist->counts[i];
+    centroids_sum[index] += hist->counts[i] * hist->colors[i];
+  }
+  for (int i = 0; i < k; ++i) {
+    if (count[i] == 0) {
+      centroids[i] = data[lcg_rand16(&rand_state) % n];
+    } else {
+      centroids[i] = DIVIDE_AND_ROUND(centroids_sum[i], count[i]);
+    }
+  }
+}
+
+void av1_hist_k_means(const ColorHistogram *hist, const int16_t *data, int n,
+                      int16_t *centroids, int k, int max_itr) {
+  int16_t centroids_tmp[PALETTE_MAX_SIZE];
+  uint8_t indices[MAX_HIST_KMEANS_COLORS];
+  int16_t *meta_centroids[2] = { centroids, centroids_tmp };
+  int i, l = 0, prev_l, best_l = 0;
+  int64_t this_dist;
+
+  hist_calc_indices(hist, centroids, indices, &this_dist, k);
+
+  for (i = 0; i < max_itr; ++i) {
+    const int64_t prev_dist = this_dist;
+    prev_l = l;
+    l = (l == 1) ? 0 : 1;
+
+    hist_calc_centroids(hist, data, n, meta_centroids[l], indices, k);
+    if (!memcmp(meta_centroids[l], meta_centroids[prev_l],
+                sizeof(centroids[0]) * k)) {
+      break;
+    }
+    hist_calc_indices(hist, meta_centroids[l], indices, &this_dist, k);
+
+    if (this_dist > prev_dist) {
+      best_l = prev_l;
+      break;
+    }
+  }
+  if (i == max_itr) best_l = l;
+  if (best_l != 0) {
+    memcpy(centroids, meta_centroids[1], sizeof(centroids[0]) * k);
+  }
+}
+
 static int int16_comparer(const void *a, const void *b) {
   return (*(int16_t *)a - *(int16_t *)b);
 }
@@ -379,7 +473,8 @@ static inline int perform_top_color_palette_search(
 // Performs k-means based palette search with number of colors in interval
 // [start_n, end_n) with step size step_size. If step_size < 0, then end_n can
 // be less than start_n. Saves the last numbers searched in last_n_searched and
-// returns the best number of colors found.
+// returns the best number of colors found. If hist is not NULL, k-means runs
+// on the color histogram of the block instead of its pixels.
 static inline int perform_k_means_palette_search(
     const AV1_COMP *const cpi, MACROBLOCK *x, MB_MODE_INFO *mbmi,
     BLOCK_SIZE bsize, int dc_mode_cost, const int16_t *data, int lower_bound,
@@ -389,7 +484,7 @@ static inline int perform_k_means_palette_search(
     int64_t *best_rd, int *rate, int *rate_tokenonly, int64_t *distortion,
     uint8_t *skippable, int *beat_best_rd, PICK_MODE_CONTEXT *ctx,
     uint8_t *best_blk_skip, uint8_t *tx_type_map, uint8_t *color_map,
-    int data_points, int discount_color_cost) {
+    int data_points, const ColorHistogram *hist, int discount_color_cost) {
   int16_t centroids[PALETTE_MAX_SIZE];
   const int max_itr = 50;
   int n = start_n;
@@ -405,7 +500,10 @@ static inline int perform_k_means_palette_search(
       centroids[i] =
           lower_bound + (2 * i + 1) * (upper_bound - lower_bound) / n / 2;
     }
-    av1_k_means(data, centroids, color_map, data_points, n, 1, max_itr);
+    if (hist != NULL)
+      av1_hist_k_means(hist, data, data_points, centroids, n, max_itr);
+    else
+      av1_k_means(data, centroids, color_map, data_points, n, 1, max_itr);
     palette_rd_y(cpi, x, mbmi, bsize, dc_mode_cost, data, centroids, n,
                  color_cache, n_cache, do_header_rd_based_gating, best_mbmi,
                  best_palette_color_map, best_rd, rate, rate_tokenonly,
@@ -563,17 +661,6 @@ void av1_rd_pick_palette_intra_sby(
   const int discount_color_cost = cpi->sf.rt_sf.use_nonrd_pick_mode;
   int unused;
 
-  int count_buf[1 << 12];  // Maximum (1 << 12) color levels.
-  int colors, colors_threshold = 0;
-  if (is_hbd) {
-    int count_buf_8bit[1 << 8];  // Maximum (1 << 8) bins for hbd path.
-    av1_count_colors_highbd(src, src_stride, rows, cols, bit_depth, count_buf,
-                            count_buf_8bit, &colors_threshold, &colors);
-  } else {
-    av1_count_colors(src, src_stride, rows, cols, count_buf, &colors);
-    colors_threshold = colors;
-  }
-
   uint8_t *const color_map = xd->plane[0].color_index_map;
   int color_thresh_palette = x->color_palette_thresh;
   // Allow for larger color_threshold for palette search, based on color,
@@ -592,6 +679,22 @@ void av1_rd_pick_palette_intra_sby(
     }
     if (norm_color_dist < 8000) color_thresh_palette += 20;
   }
+
+  // Counting stops as soon as the block is known to have too many colors for
+  // palette search.
+  int count_buf[1 << 12];  // Maximum (1 << 12) color levels.
+  int colors, colors_threshold = 0;
+  if (is_hbd) {
+    int count_buf_8bit[1 << 8];  // Maximum (1 << 8) bins for hbd path.
+    av1_count_colors_highbd(src, src_stride, rows, cols, bit_depth,
+                            color_thresh_palette, count_buf, count_buf_8bit,
+                            &colors_threshold, &colors);
+  } else {
+    av1_count_colors(src, src_stride, rows, cols, color_thresh_palette,
+                     count_buf, &colors);
+    colors_threshold = colors;
+  }
+
   if (colors_threshold > 1 && colors_threshold <= color_thresh_palette) {
     int16_t *const data = x->palette_buffer->kmeans_data_buf;
     int16_t centroids[PALETTE_MAX_SIZE];
@@ -610,6 +713,14 @@ void av1_rd_pick_palette_intra_sby(
     find_top_colors(count_buf, bit_depth, AOMMIN(colors, PALETTE_MAX_SIZE),
                     top_colors);
 
+    // Blocks with few distinct colors run k-means on the histogram, which
+    // gives the same centroids as clustering every pixel.
+    ColorHistogram color_hist;
+    const ColorHistogram *const hist =
+        av1_build_color_histogram(count_buf, bit_depth, colors, &color_hist)
+            ? &color_hist
+            : NULL;
+
     // The following are the approaches used for header rdcost based gating
     // for early termination for different values of prune_palette_search_level.
     // 0: Pruning based on header rdcost for ascending order palette_size
@@ -685,7 +796,7 @@ void av1_rd_pick_palette_intra_sby(
           min_n, max_n + 1, step_size, do_header_rd_based_gating, &unused,
           color_cache, n_cache, best_mbmi, best_palette_color_map, best_rd,
           rate, rate_tokenonly, distortion, skippable, beat_best_rd, ctx,
-          best_blk_skip, tx_type_map, color_map, rows * cols,
+          best_blk_skip, tx_type_map, color_map, rows * cols, hist,
           discount_color_cost);
       // Evaluate neighbors for the winner color (if winner is found) in the
       // above coarse search for k-means
@@ -700,7 +811,7 @@ void av1_rd_pick_palette_intra_sby(
             /*do_header_rd_based_gating=*/false, &unused, color_cache, n_cache,
             best_mbmi, best_palette_color_map, best_rd, rate, rate_tokenonly,
             distortion, skippable, beat_best_rd, ctx, best_blk_skip,
-            tx_type_map, color_map, rows * cols, discount_color_cost);
+            tx_type_map, color_map, rows * cols, hist, discount_color_cost);
       }
     } else {
       const int max_n = AOMMIN(colors, PALETTE_MAX_SIZE),
@@ -742,7 +853,7 @@ void av1_rd_pick_palette_intra_sby(
             min_n, max_n + 1, 1, do_header_rd_based_gating, &last_n_searched,
             color_cache, n_cache, best_mbmi, best_palette_color_map, best_rd,
             rate, rate_tokenonly, distortion, skippable, beat_best_rd, ctx,
-            best_blk_skip, tx_type_map, color_map, rows * cols,
+            best_blk_skip, tx_type_map, color_map, rows * cols, hist,
             discount_color_cost);
         if (last_n_searched < max_n) {
           // Search in descending order until we get to the previous best
@@ -752,7 +863,7 @@ void av1_rd_pick_palette_intra_sby(
               &unused, color_cache, n_cache, best_mbmi, best_palette_color_map,
               best_rd, rate, rate_tokenonly, distortion, skippable,
               beat_best_rd, ctx, best_blk_skip, tx_type_map, color_map,
-              rows * cols, discount_color_cost);
+              rows * cols, hist, discount_color_cost);
         }
       }
     }
@@ -801,15 +912,19 @@ void av1_rd_pick_palette_intra_sbuv(const AV1_COMP *cpi, MACROBLOCK *x,
     int count_buf[1 << 12];      // Maximum (1 << 12) color levels.
     int count_buf_8bit[1 << 8];  // Maximum (1 << 8) bins for hbd path.
     av1_count_colors_highbd(src_u, src_stride, rows, cols,
-                            seq_params->bit_depth, count_buf, count_buf_8bit,
-                            &colors_threshold_u, &colors_u);
+                            seq_params->bit_depth, kMaxUvPaletteColors,
+                            count_buf, count_buf_8bit, &colors_threshold_u,
+                            &colors_u);
     av1_count_colors_highbd(src_v, src_stride, rows, cols,
-                            seq_params->bit_depth, count_buf, count_buf_8bit,
-                            &colors_threshold_v, &colors_v);
+                            seq_params->bit_depth, kMaxUvPaletteColors,
+                            count_buf, count_buf_8bit, &colors_threshold_v,
+                            &colors_v);
   } else {
     int count_buf[1 << 8];
-    av1_count_colors(src_u, src_stride, rows, cols, count_buf, &colors_u);
-    av1_count_colors(src_v, src_stride, rows, cols, count_buf, &colors_v);
+    av1_count_colors(src_u, src_stride, rows, cols, kMaxUvPaletteColors,
+                     count_buf, &colors_u);
+    av1_count_colors(src_v, src_stride, rows, cols, kMaxUvPaletteColors,
+                     count_buf, &colors_v);
     colors_threshold_u = colors_u;
     colors_threshold_v = colors_v;
   }
@@ -820,7 +935,7 @@ void av1_rd_pick_palette_intra_sbuv(const AV1_COMP *cpi, MACROBLOCK *x,
   colors_threshold = colors_threshold_u > colors_threshold_v
                          ? colors_threshold_u
                          : colors_threshold_v;
-  if (colors_threshold > 1 && colors_threshold <= 64) {
+  if (colors_threshold > 1 && colors_threshold <= kMaxUvPaletteColors) {
     int r, c, n, i, j;
     const int max_itr = 50;
     int lb_u, ub_u, val_u;
@@ -99,6 +99,55 @@ static inline void av1_k_means(const int16_t *data, int16_t *centroids,
   }
 }
 
+/*!\cond */
+// Luma k-means runs on the color histogram instead of the pixels when the
+// block has no more than this many distinct colors.
+#define MAX_HIST_KMEANS_COLORS 256
+/*!\endcond */
+
+/*!\brief Distinct colors of a block and their pixel counts.
+ */
+typedef struct {
+  //! Distinct colors in ascending order.
+  int16_t colors[MAX_HIST_KMEANS_COLORS];
+  //! Number of pixels of each color.
+  int counts[MAX_HIST_KMEANS_COLORS];
+  //! Number of distinct colors.
+  int num_colors;
+} ColorHistogram;
+
+/*!\brief Builds the list of distinct colors of a block.
+ *
+ * \ingroup palette_mode_search
+ * \param[in]    count_buf          Pixel count of each color value.
+ * \param[in]    bit_depth          Pixel bitdepth of the sequence.
+ * \param[in]    num_colors         Number of distinct colors in count_buf.
+ * \param[out]   hist               The distinct colors and their counts.
+ *
+ * \return Returns 0 if the block has too many colors for the histogram based
+ * k-means, and 1 otherwise.
+ */
+int av1_build_color_histogram(const int *count_buf, int bit_depth,
+                              int num_colors, ColorHistogram *hist);
+
+/*!\brief Performs one dimensional k-means on the color histogram of a block.
+ *
+ * \ingroup palette_mode_search
+ * \param[in]    hist               The distinct colors of the block.
+ * \param[in]    data               The pixels of the block, used to reseed
+ *                                  empty clusters as av1_k_means() does.
+ * \param[in]    n                  Number of pixels.
+ * \param[in]    centroids          Pointer to the initial centroids, which
+ *                                  are replaced by the computed ones.
+ * \param[in]    k                  Number of clusters.
+ * \param[in]    max_itr            Maximum number of iterations to run.
+ *
+ * \remark Computes the same centroids as av1_k_means() with dim 1 on data,
+ * but not the cluster index of each pixel.
+ */
+void av1_hist_k_means(const ColorHistogram *hist, const int16_t *data, int n,
+                      int16_t *centroids, int k, int max_itr);
+
 /*!\brief Checks what colors are in the color cache.
  *
  * \ingroup palette_mode_search
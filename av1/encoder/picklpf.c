@@ -326,11 +326,14 @@ void av1_pick_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
     }
     // The frame buffer last_frame_uf is used to store the non-loop filtered
     // reconstructed frame in search_filter_level().
-    if (aom_realloc_frame_buffer(
-            &cpi->last_frame_uf, cm->width, cm->height,
-            seq_params->subsampling_x, seq_params->subsampling_y,
-            seq_params->use_highbitdepth, cpi->oxcf.border_in_pixels,
-            cm->features.byte_alignment, NULL, NULL, NULL, false, 0))
+    const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_LOOP_FILTER);
+    const int alloc_failed = aom_realloc_frame_buffer(
+        &cpi->last_frame_uf, cm->width, cm->height, seq_params->subsampling_x,
+        seq_params->subsampling_y, seq_params->use_highbitdepth,
+        cpi->oxcf.border_in_pixels, cm->features.byte_alignment, NULL, NULL,
+        NULL, false, 0);
+    aom_mem_set_tag(prev_tag);
+    if (alloc_failed)
       aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
                          "Failed to allocate last frame buffer");
 
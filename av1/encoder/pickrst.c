@@ -2061,11 +2061,14 @@ void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi) {
 
   // Allocate the frame buffer trial_frame_rst, which is used to temporarily
   // store the loop restored frame.
-  if (aom_realloc_frame_buffer(
-          &cpi->trial_frame_rst, cm->superres_upscaled_width,
-          cm->superres_upscaled_height, seq_params->subsampling_x,
-          seq_params->subsampling_y, highbd, AOM_RESTORATION_FRAME_BORDER,
-          cm->features.byte_alignment, NULL, NULL, NULL, false, 0))
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_LOOP_FILTER);
+  const int alloc_failed = aom_realloc_frame_buffer(
+      &cpi->trial_frame_rst, cm->superres_upscaled_width,
+      cm->superres_upscaled_height, seq_params->subsampling_x,
+      seq_params->subsampling_y, highbd, AOM_RESTORATION_FRAME_BORDER,
+      cm->features.byte_alignment, NULL, NULL, NULL, false, 0);
+  aom_mem_set_tag(prev_tag);
+  if (alloc_failed)
     aom_internal_error(cm->error, AOM_CODEC_MEM_ERROR,
                        "Failed to allocate trial restored frame buffer");
 
@@ -3258,6 +3258,26 @@ static void rc_scene_detection_onepass_rt(AV1_COMP *cpi,
                                              sizeof(*cpi->src_sad_blk_64x64)));
     }
   }
+  // Also store the source 8x8 block averages, computed in the same pass as
+  // the SAD, for reuse by the variance based partitioning.
+  SRC_BLK_STATS *const blk_stats = &cpi->src_blk_stats;
+  const int store_blk_stats =
+      cpi->src_sad_blk_64x64 != NULL && !cm->seq_params->use_highbitdepth;
+  if (store_blk_stats) {
+    if (blk_stats->cols != sb_cols || blk_stats->rows != sb_rows) {
+      aom_free(blk_stats->avg_8x8);
+      aom_free(blk_stats->valid);
+      av1_zero(*blk_stats);
+      CHECK_MEM_ERROR(cm, blk_stats->avg_8x8,
+                      (uint8_t *)aom_malloc(sb_cols * sb_rows * 64));
+      CHECK_MEM_ERROR(cm, blk_stats->valid,
+                      (uint8_t *)aom_malloc(sb_cols * sb_rows));
+      blk_stats->cols = sb_cols;
+      blk_stats->rows = sb_rows;
+    }
+    memset(blk_stats->valid, 0, sb_cols * sb_rows);
+    blk_stats->source = unscaled_src;
+  }
   const CommonModeInfoParams *const mi_params = &cpi->common.mi_params;
   const int mi_cols = mi_params->mi_cols;
   const int mi_rows = mi_params->mi_rows;
@@ -3270,7 +3290,13 @@ static void rc_scene_detection_onepass_rt(AV1_COMP *cpi,
         block_is_active = set_block_is_active(active_map_4x4, mi_cols, mi_rows,
                                               sbi_col, sbi_row);
       }
-      if (block_is_active) {
+      if (block_is_active && store_blk_stats) {
+        const int blk_idx = sbi_col + sbi_row * sb_cols;
+        tmp_sad = aom_sad64x64_src_avg8x8(src_y, src_ystride, last_src_y,
+                                          last_src_ystride,
+                                          &blk_stats->avg_8x8[blk_idx * 64]);
+        blk_stats->valid[blk_idx] = 1;
+      } else if (block_is_active) {
         tmp_sad = cpi->ppi->fn_ptr[bsize].sdf(src_y, src_ystride, last_src_y,
                                               last_src_ystride);
       } else {
@@ -3756,6 +3782,7 @@ void av1_get_one_pass_rt_params(AV1_COMP *cpi, FRAME_TYPE *const frame_type,
       if (no_references_set) *frame_type = INTRA_ONLY_FRAME;
     }
   }
+  cpi->src_blk_stats.source = NULL;
   if (cpi->active_map.enabled && cpi->rc.percent_blocks_inactive == 100) {
     rc->frame_source_sad = 0;
     rc->avg_source_sad = (3 * rc->avg_source_sad + rc->frame_source_sad) >> 2;
@@ -584,12 +584,58 @@ static void set_block_thresholds(const AV1_COMMON *cm, RD_OPT *rd,
   }
 }
 
+// Copies cdf to snapshot and returns 1 if they differ, otherwise returns 0.
+static inline int update_cdf_snapshot(void *snapshot, const void *cdf,
+                                      size_t size) {
+  if (!memcmp(snapshot, cdf, size)) return 0;
+  memcpy(snapshot, cdf, size);
+  return 1;
+}
+
+#define UPDATE_CDF_SNAPSHOT(snapshot, cdf) \
+  update_cdf_snapshot(snapshot, cdf, sizeof(snapshot))
+
 void av1_fill_coeff_costs(CoeffCosts *coeff_costs, FRAME_CONTEXT *fc,
                           const int num_planes) {
   const int nplanes = AOMMIN(num_planes, PLANE_TYPES);
+  CoeffCdfs *const cdfs = &coeff_costs->cdfs;
   for (int eob_multi_size = 0; eob_multi_size < 7; ++eob_multi_size) {
     for (int plane = 0; plane < nplanes; ++plane) {
       LV_MAP_EOB_COST *pcost = &coeff_costs->eob_costs[eob_multi_size][plane];
+      int changed;
+      switch (eob_multi_size) {
+        case 0:
+          changed = UPDATE_CDF_SNAPSHOT(cdfs->eob_flag_cdf16[plane],
+                                        fc->eob_flag_cdf16[plane]);
+          break;
+        case 1:
+          changed = UPDATE_CDF_SNAPSHOT(cdfs->eob_flag_cdf32[plane],
+                                        fc->eob_flag_cdf32[plane]);
+          break;
+        case 2:
+          changed = UPDATE_CDF_SNAPSHOT(cdfs->eob_flag_cdf64[plane],
+                                        fc->eob_flag_cdf64[plane]);
+          break;
+        case 3:
+          changed = UPDATE_CDF_SNAPSHOT(cdfs->eob_flag_cdf128[plane],
+                                        fc->eob_flag_cdf128[plane]);
+          break;
+        case 4:
+          changed = UPDATE_CDF_SNAPSHOT(cdfs->eob_flag_cdf256[plane],
+                                        fc->eob_flag_cdf256[plane]);
+          break;
+        case 5:
+          changed = UPDATE_CDF_SNAPSHOT(cdfs->eob_flag_cdf512[plane],
+                                        fc->eob_flag_cdf512[plane]);
+          break;
+        case 6:
+        default:
+          changed = UPDATE_CDF_SNAPSHOT(cdfs->eob_flag_cdf1024[plane],
+                                        fc->eob_flag_cdf1024[plane]);
+          break;
+      }
+      if (!changed && coeff_costs->eob_costs_valid[eob_multi_size][plane])
+        continue;
 
       for (int ctx = 0; ctx < 2; ++ctx) {
         aom_cdf_prob *pcdf;
@@ -605,12 +651,38 @@ void av1_fill_coeff_costs(CoeffCosts *coeff_costs, FRAME_CONTEXT *fc,
         }
         av1_cost_tokens_from_cdf(pcost->eob_cost[ctx], pcdf, NULL);
       }
+      coeff_costs->eob_costs_valid[eob_multi_size][plane] = 1;
     }
   }
+
+  // The CDFs shared by several cost tables are compared once up front.
+  int dc_sign_changed[PLANE_TYPES] = { 0 };
+  int br_changed[TX_32X32 + 1][PLANE_TYPES] = { { 0 } };
+  for (int plane = 0; plane < nplanes; ++plane) {
+    dc_sign_changed[plane] = UPDATE_CDF_SNAPSHOT(cdfs->dc_sign_cdf[plane],
+                                                 fc->dc_sign_cdf[plane]);
+    for (int tx_size = 0; tx_size <= TX_32X32; ++tx_size) {
+      br_changed[tx_size][plane] =
+          UPDATE_CDF_SNAPSHOT(cdfs->coeff_br_cdf[tx_size][plane],
+                              fc->coeff_br_cdf[tx_size][plane]);
+    }
+  }
+
   for (int tx_size = 0; tx_size < TX_SIZES; ++tx_size) {
+    const int txb_skip_changed = UPDATE_CDF_SNAPSHOT(
+        cdfs->txb_skip_cdf[tx_size], fc->txb_skip_cdf[tx_size]);
     for (int plane = 0; plane < nplanes; ++plane) {
       LV_MAP_COEFF_COST *pcost = &coeff_costs->coeff_costs[tx_size][plane];
 
+      int changed = txb_skip_changed | dc_sign_changed[plane] |
+                    br_changed[AOMMIN(tx_size, TX_32X32)][plane];
+      changed |= UPDATE_CDF_SNAPSHOT(cdfs->coeff_base_eob_cdf[tx_size][plane],
+                                     fc->coeff_base_eob_cdf[tx_size][plane]);
+      changed |= UPDATE_CDF_SNAPSHOT(cdfs->coeff_base_cdf[tx_size][plane],
+                                     fc->coeff_base_cdf[tx_size][plane]);
+      changed |= UPDATE_CDF_SNAPSHOT(cdfs->eob_extra_cdf[tx_size][plane],
+                                     fc->eob_extra_cdf[tx_size][plane]);
+      if (!changed && coeff_costs->coeff_costs_valid[tx_size][plane]) continue;
       for (int ctx = 0; ctx < TXB_SKIP_CONTEXTS; ++ctx)
         av1_cost_tokens_from_cdf(pcost->txb_skip_cost[ctx],
                                  fc->txb_skip_cdf[tx_size][ctx], NULL);
@@ -673,6 +745,7 @@ void av1_fill_coeff_costs(CoeffCosts *coeff_costs, FRAME_CONTEXT *fc,
               pcost->lps_cost[ctx][i] - pcost->lps_cost[ctx][i - 1];
         }
       }
+      coeff_costs->coeff_costs_valid[tx_size][plane] = 1;
     }
   }
 }
@@ -686,15 +759,23 @@ void av1_fill_mv_costs(const nmv_context *nmvc, int integer_mv, int usehp,
   mv_costs->nmv_cost[1] = &mv_costs->nmv_cost_alloc[1][MV_MAX];
   mv_costs->nmv_cost_hp[0] = &mv_costs->nmv_cost_hp_alloc[0][MV_MAX];
   mv_costs->nmv_cost_hp[1] = &mv_costs->nmv_cost_hp_alloc[1][MV_MAX];
-  if (integer_mv) {
-    mv_costs->mv_cost_stack = (int **)&mv_costs->nmv_cost;
-    av1_build_nmv_cost_table(mv_costs->nmv_joint_cost, mv_costs->mv_cost_stack,
-                             nmvc, MV_SUBPEL_NONE);
-  } else {
-    mv_costs->mv_cost_stack =
-        usehp ? mv_costs->nmv_cost_hp : mv_costs->nmv_cost;
-    av1_build_nmv_cost_table(mv_costs->nmv_joint_cost, mv_costs->mv_cost_stack,
-                             nmvc, usehp);
+  const int use_hp = !integer_mv && usehp;
+  const MvSubpelPrecision precision = integer_mv ? MV_SUBPEL_NONE : usehp;
+  mv_costs->mv_cost_stack = use_hp ? mv_costs->nmv_cost_hp : mv_costs->nmv_cost;
+  av1_cost_tokens_from_cdf(mv_costs->nmv_joint_cost, nmvc->joints_cdf, NULL);
+  // Only rebuild the component tables whose CDFs or precision changed since
+  // they were last built.
+  for (int i = 0; i < 2; ++i) {
+    if (mv_costs->cost_comps_valid[use_hp][i] &&
+        mv_costs->cost_precision[use_hp][i] == precision &&
+        !memcmp(&mv_costs->cost_comps[use_hp][i], &nmvc->comps[i],
+                sizeof(nmvc->comps[i])))
+      continue;
+    av1_build_nmv_component_cost_table(mv_costs->mv_cost_stack[i],
+                                       &nmvc->comps[i], precision);
+    mv_costs->cost_comps[use_hp][i] = nmvc->comps[i];
+    mv_costs->cost_precision[use_hp][i] = precision;
+    mv_costs->cost_comps_valid[use_hp][i] = 1;
   }
 }
 
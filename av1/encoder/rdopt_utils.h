@@ -743,6 +743,10 @@ static inline void store_winner_mode_stats(
       AOMMIN(x->winner_mode_count + 1, max_winner_mode_count);
 }
 
+// Returns a flat block to be used as the reference when computing the
+// variance of a source block with the variance functions.
+const uint8_t *av1_get_var_offs(int use_hbd, int bd);
+
 unsigned int av1_get_perpixel_variance(const AV1_COMP *cpi,
                                        const MACROBLOCKD *xd,
                                        const struct buf_2d *ref,
@@ -505,6 +505,8 @@ static void set_allintra_speed_features_framesize_independent(
   }
 
   if (speed >= 6) {
+    sf->hl_sf.sc_detection_method = SC_DETECT_SAMPLED;
+
     sf->intra_sf.prune_smooth_intra_mode_for_chroma = 1;
     sf->intra_sf.prune_filter_intra_level = 2;
     sf->intra_sf.chroma_intra_pruning_with_hog = 4;
@@ -1282,6 +1284,7 @@ static void set_good_speed_features_framesize_independent(
 
   if (speed >= 6) {
     sf->hl_sf.disable_extra_sc_testing = 1;
+    sf->hl_sf.sc_detection_method = SC_DETECT_SAMPLED;
     sf->hl_sf.second_alt_ref_filtering = 0;
 
     sf->gm_sf.downsample_level = 2;
@@ -1595,6 +1598,11 @@ static void set_rt_speed_feature_framesize_dependent(const AV1_COMP *const cpi,
     sf->rt_sf.skip_encoding_non_reference_slide_change =
         cpi->oxcf.rc_cfg.drop_frames_water_mark > 0 ? 1 : 0;
     sf->rt_sf.skip_newmv_flat_blocks_screen = 1;
+    // The hash lookup replaces the slow exhaustive search of speeds 5 and
+    // below. At speed 6 and up, hashing the reference frame costs more time
+    // than it saves, and the nonrd search finds nearly the same motion
+    // without it.
+    sf->mv_sf.use_inter_hash_me = speed <= 5;
     sf->rt_sf.use_idtx_nonrd = 1;
     sf->rt_sf.higher_thresh_scene_detection = 0;
     sf->rt_sf.use_nonrd_altref_frame = 0;
@@ -1967,6 +1975,7 @@ static inline void init_hl_sf(HIGH_LEVEL_SPEED_FEATURES *hl_sf) {
   hl_sf->high_precision_mv_usage = CURRENT_Q;
   hl_sf->superres_auto_search_type = SUPERRES_AUTO_ALL;
   hl_sf->disable_extra_sc_testing = 0;
+  hl_sf->sc_detection_method = SC_DETECT_FULL;
   hl_sf->second_alt_ref_filtering = 1;
   hl_sf->adjust_num_frames_for_arf_filtering = 0;
   hl_sf->accurate_bit_estimate = 0;
@@ -2074,6 +2083,7 @@ static inline void init_mv_sf(MV_SPEED_FEATURES *mv_sf) {
   mv_sf->warp_search_method = WARP_SEARCH_SQUARE;
   mv_sf->warp_search_iters = 8;
   mv_sf->use_intrabc = 1;
+  mv_sf->use_inter_hash_me = 0;
 }
 
 static inline void init_inter_sf(INTER_MODE_SPEED_FEATURES *inter_sf) {
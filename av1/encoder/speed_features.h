@@ -156,6 +156,14 @@ enum {
   // Pick 0 to disable LPF if LPF was enabled last frame
   LPF_PICK_MINIMAL_LPF
 } UENUM1BYTE(LPF_PICK_METHOD);
+
+enum {
+  // Scan every block of the frame.
+  SC_DETECT_FULL,
+  // Scan a subset of the blocks, and the remaining blocks only when the
+  // estimate is too close to a decision threshold.
+  SC_DETECT_SAMPLED,
+} UENUM1BYTE(SC_DETECTION_METHOD);
 /*!\endcond */
 
 /*!\enum CDEF_PICK_METHOD
@@ -446,6 +454,15 @@ typedef struct HIGH_LEVEL_SPEED_FEATURES {
    */
   int disable_extra_sc_testing;
 
+  /*!
+   * Method used to estimate whether a key frame is screen content, see
+   * av1_set_screen_content_options():
+   * SC_DETECT_FULL   : Scan every block of the frame.
+   * SC_DETECT_SAMPLED: Scan a subset of the blocks, and the rest only if the
+   * decisions made from the subset are not reliable.
+   */
+  SC_DETECTION_METHOD sc_detection_method;
+
   /*!
    * Enable/disable second_alt_ref temporal filtering.
    */
@@ -886,6 +903,11 @@ typedef struct MV_SPEED_FEATURES {
   // Allow intrabc motion search
   int use_intrabc;
 
+  // Look up exact matches of the source block in a hash table of the
+  // reference frame before the regular full-pixel search of the RD mode
+  // search. Only active when screen content tools are allowed.
+  int use_inter_hash_me;
+
   // Whether to downsample the rows in sad calculation during motion search.
   // This is only active when there are at least 16 rows. When this sf is
   // active, if there is a large discrepancy in the SAD values for the final
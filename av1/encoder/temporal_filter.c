@@ -1417,6 +1417,7 @@ int av1_check_show_filtered_frame(const YV12_BUFFER_CONFIG *frame,
 void av1_temporal_filter(AV1_COMP *cpi, const int filter_frame_lookahead_idx,
                          int gf_frame_index, FRAME_DIFF *frame_diff,
                          YV12_BUFFER_CONFIG *output_frame) {
+  const int64_t stage_start = stage_timer_start(cpi);
   MultiThreadInfo *const mt_info = &cpi->mt_info;
   // Basic informaton of the current frame.
   TemporalFilterCtx *tf_ctx = &cpi->tf_ctx;
@@ -1450,6 +1451,7 @@ void av1_temporal_filter(AV1_COMP *cpi, const int filter_frame_lookahead_idx,
   }
   // Deallocate temporal filter buffers.
   tf_dealloc_data(tf_data, is_highbitdepth);
+  stage_timer_end(cpi, stage_start, AOM_ENC_STAGE_TEMPORAL_FILTER);
 }
 
 int av1_is_temporal_filter_on(const AV1EncoderConfig *oxcf) {
@@ -181,6 +181,8 @@ void av1_setup_tpl_buffers(AV1_PRIMARY *const ppi,
   // allocations are avoided for buffers in tpl_data.
   if (lag_in_frames <= 1) return;
 
+  // The reconstruction frames are counted with the TPL stats.
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_TPL_STATS);
   AOM_CHECK_MEM_ERROR(&ppi->error, tpl_data->txfm_stats_list,
                       aom_calloc(MAX_LENGTH_TPL_FRAME_STATS,
                                  sizeof(*tpl_data->txfm_stats_list)));
@@ -188,9 +190,11 @@ void av1_setup_tpl_buffers(AV1_PRIMARY *const ppi,
   for (int frame = 0; frame < lag_in_frames; ++frame) {
     AOM_CHECK_MEM_ERROR(
         &ppi->error, tpl_data->tpl_stats_pool[frame],
-        aom_calloc(tpl_data->tpl_stats_buffer[frame].width *
-                       tpl_data->tpl_stats_buffer[frame].height,
-                   sizeof(*tpl_data->tpl_stats_buffer[frame].tpl_stats_ptr)));
+        aom_calloc_tagged(
+            tpl_data->tpl_stats_buffer[frame].width *
+                tpl_data->tpl_stats_buffer[frame].height,
+            sizeof(*tpl_data->tpl_stats_buffer[frame].tpl_stats_ptr),
+            AOM_MEM_TAG_TPL_STATS));
 
     if (aom_alloc_frame_buffer(
             &tpl_data->tpl_rec_pool[frame], width, height,
@@ -200,6 +204,7 @@ void av1_setup_tpl_buffers(AV1_PRIMARY *const ppi,
       aom_internal_error(&ppi->error, AOM_CODEC_MEM_ERROR,
                          "Failed to allocate frame buffer");
   }
+  aom_mem_set_tag(prev_tag);
 }
 
 static inline int32_t tpl_get_satd_cost(BitDepthInfo bd_info, int16_t *src_diff,
@@ -1855,8 +1860,8 @@ static double get_frame_importance(const TplParams *tpl_data,
   return exp((mc_dep_cost_base - intra_cost_base) / cbcmp_base);
 }
 
-int av1_tpl_setup_stats(AV1_COMP *cpi, int gop_eval,
-                        const EncodeFrameParams *const frame_params) {
+static int tpl_setup_stats(AV1_COMP *cpi, int gop_eval,
+                           const EncodeFrameParams *const frame_params) {
 #if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, av1_tpl_setup_stats_time);
 #endif
@@ -2006,6 +2011,14 @@ int av1_tpl_setup_stats(AV1_COMP *cpi, int gop_eval,
   return eval_gop_length(beta, gop_eval);
 }
 
+int av1_tpl_setup_stats(AV1_COMP *cpi, int gop_eval,
+                        const EncodeFrameParams *const frame_params) {
+  const int64_t stage_start = stage_timer_start(cpi);
+  const int ret = tpl_setup_stats(cpi, gop_eval, frame_params);
+  stage_timer_end(cpi, stage_start, AOM_ENC_STAGE_TPL);
+  return ret;
+}
+
 void av1_tpl_rdmult_setup(AV1_COMP *cpi) {
   const AV1_COMMON *const cm = &cpi->common;
   const int tpl_idx = cpi->gf_frame_index;
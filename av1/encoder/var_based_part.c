@@ -286,17 +286,45 @@ static inline void fill_variance_8x8avg_highbd(
 }
 #endif
 
+// Returns the source 8x8 block averages stored by the scene detection for the
+// 64x64 block at (mi_row, mi_col), or NULL if they are not available for the
+// current source.
+static inline const uint8_t *get_src_avg_8x8(const AV1_COMP *cpi, int mi_row,
+                                             int mi_col) {
+  const SRC_BLK_STATS *const blk_stats = &cpi->src_blk_stats;
+  if (blk_stats->source == NULL || blk_stats->source != cpi->source)
+    return NULL;
+  const int blk_row = mi_row >> 4;
+  const int blk_col = mi_col >> 4;
+  if (blk_row >= blk_stats->rows || blk_col >= blk_stats->cols) return NULL;
+  const int blk_idx = blk_col + blk_row * blk_stats->cols;
+  return blk_stats->valid[blk_idx] ? &blk_stats->avg_8x8[blk_idx * 64] : NULL;
+}
+
+// src_avg_8x8, if not NULL, holds the source 8x8 block averages of the 64x64
+// block containing the 16x16 block, and is used in place of src_buf.
 static inline void fill_variance_8x8avg_lowbd(
-    const uint8_t *src_buf, int src_stride, const uint8_t *dst_buf,
-    int dst_stride, int x16_idx, int y16_idx, VP16x16 *vst, int pixels_wide,
-    int pixels_high) {
+    const uint8_t *src_buf, int src_stride, const uint8_t *src_avg_8x8,
+    const uint8_t *dst_buf, int dst_stride, int x16_idx, int y16_idx,
+    VP16x16 *vst, int pixels_wide, int pixels_high) {
   unsigned int sse[4] = { 0 };
   int sum[4] = { 0 };
+  const uint8_t *const src_avg_16x16 =
+      src_avg_8x8 ? src_avg_8x8 + ((y16_idx & 63) >> 3) * 8 +
+                        ((x16_idx & 63) >> 3)
+                  : NULL;
 
   if (all_blks_inside(x16_idx, y16_idx, pixels_wide, pixels_high)) {
     int src_avg[4];
     int dst_avg[4];
-    aom_avg_8x8_quad(src_buf, src_stride, x16_idx, y16_idx, src_avg);
+    if (src_avg_16x16) {
+      src_avg[0] = src_avg_16x16[0];
+      src_avg[1] = src_avg_16x16[1];
+      src_avg[2] = src_avg_16x16[8];
+      src_avg[3] = src_avg_16x16[9];
+    } else {
+      aom_avg_8x8_quad(src_buf, src_stride, x16_idx, y16_idx, src_avg);
+    }
     aom_avg_8x8_quad(dst_buf, dst_stride, x16_idx, y16_idx, dst_avg);
     for (int idx = 0; idx < 4; idx++) {
       sum[idx] = src_avg[idx] - dst_avg[idx];
@@ -308,7 +336,10 @@ static inline void fill_variance_8x8avg_lowbd(
       const int y8_idx = y16_idx + GET_BLK_IDX_Y(idx, 3);
       if (x8_idx < pixels_wide && y8_idx < pixels_high) {
         int src_avg =
-            aom_avg_8x8(src_buf + y8_idx * src_stride + x8_idx, src_stride);
+            src_avg_16x16
+                ? src_avg_16x16[(idx >> 1) * 8 + (idx & 1)]
+                : (int)aom_avg_8x8(src_buf + y8_idx * src_stride + x8_idx,
+                                   src_stride);
         int dst_avg =
             aom_avg_8x8(dst_buf + y8_idx * dst_stride + x8_idx, dst_stride);
         sum[idx] = src_avg - dst_avg;
@@ -326,11 +357,10 @@ static inline void fill_variance_8x8avg_lowbd(
 // at 8x8 sub-block level for a given 16x16 block.
 // The function can be called only when is_key_frame is false since sum is
 // computed between source and reference frames.
-static inline void fill_variance_8x8avg(const uint8_t *src_buf, int src_stride,
-                                        const uint8_t *dst_buf, int dst_stride,
-                                        int x16_idx, int y16_idx, VP16x16 *vst,
-                                        int highbd_flag, int pixels_wide,
-                                        int pixels_high) {
+static inline void fill_variance_8x8avg(
+    const uint8_t *src_buf, int src_stride, const uint8_t *src_avg_8x8,
+    const uint8_t *dst_buf, int dst_stride, int x16_idx, int y16_idx,
+    VP16x16 *vst, int highbd_flag, int pixels_wide, int pixels_high) {
 #if CONFIG_AV1_HIGHBITDEPTH
   if (highbd_flag) {
     fill_variance_8x8avg_highbd(src_buf, src_stride, dst_buf, dst_stride,
@@ -341,8 +371,9 @@ static inline void fill_variance_8x8avg(const uint8_t *src_buf, int src_stride,
 #else
   (void)highbd_flag;
 #endif  // CONFIG_AV1_HIGHBITDEPTH
-  fill_variance_8x8avg_lowbd(src_buf, src_stride, dst_buf, dst_stride, x16_idx,
-                             y16_idx, vst, pixels_wide, pixels_high);
+  fill_variance_8x8avg_lowbd(src_buf, src_stride, src_avg_8x8, dst_buf,
+                             dst_stride, x16_idx, y16_idx, vst, pixels_wide,
+                             pixels_high);
 }
 
 static int compute_minmax_8x8(const uint8_t *src_buf, int src_stride,
@@ -1102,7 +1133,7 @@ static void fill_variance_tree_leaves(
     int avg_16x16[][4], int maxvar_16x16[][4], int minvar_16x16[][4],
     int64_t *thresholds, const uint8_t *src_buf, int src_stride,
     const uint8_t *dst_buf, int dst_stride, bool is_key_frame,
-    const bool is_small_sb) {
+    const bool is_small_sb, int mi_row, int mi_col) {
   MACROBLOCKD *xd = &x->e_mbd;
   const int num_64x64_blocks = is_small_sb ? 1 : 4;
   // TODO(kyslov) Bring back compute_minmax_variance with content type detection
@@ -1119,8 +1150,10 @@ static void fill_variance_tree_leaves(
   }
   if (xd->mb_to_right_edge < 0) pixels_wide += (xd->mb_to_right_edge >> 3);
   if (xd->mb_to_bottom_edge < 0) pixels_high += (xd->mb_to_bottom_edge >> 3);
+  int denoiser_enabled = 0;
 #if CONFIG_AV1_TEMPORAL_DENOISING
   temporal_denoising |= cpi->oxcf.noise_sensitivity;
+  denoiser_enabled = cpi->oxcf.noise_sensitivity > 0;
 #endif
   // For temporal filtering or temporal denoiser enabled: since the source
   // is modified we need to avoid 4x4 avg along superblock boundary, since
@@ -1132,6 +1165,13 @@ static void fill_variance_tree_leaves(
     const int x64_idx = GET_BLK_IDX_X(blk64_idx, 6);
     const int y64_idx = GET_BLK_IDX_Y(blk64_idx, 6);
     const int blk64_scale_idx = blk64_idx << 2;
+    // Source 8x8 averages from the scene detection, unless the source is
+    // modified by the denoiser.
+    const uint8_t *const src_avg_8x8 =
+        (is_key_frame || denoiser_enabled)
+            ? NULL
+            : get_src_avg_8x8(cpi, mi_row + (y64_idx >> 2),
+                              mi_col + (x64_idx >> 2));
     force_split[blk64_idx + 1] = PART_EVAL_ALL;
 
     for (int lvl1_idx = 0; lvl1_idx < 4; lvl1_idx++) {
@@ -1161,9 +1201,9 @@ static void fill_variance_tree_leaves(
                                  pixels_wide, pixels_high, border_offset_4x4);
           }
         } else {
-          fill_variance_8x8avg(src_buf, src_stride, dst_buf, dst_stride,
-                               x16_idx, y16_idx, vst, is_cur_buf_hbd(xd),
-                               pixels_wide, pixels_high);
+          fill_variance_8x8avg(src_buf, src_stride, src_avg_8x8, dst_buf,
+                               dst_stride, x16_idx, y16_idx, vst,
+                               is_cur_buf_hbd(xd), pixels_wide, pixels_high);
 
           fill_variance_tree(vst, BLOCK_16X16);
           VPartVar *none_var = &vt->split[blk64_idx]
@@ -1744,7 +1784,8 @@ int av1_choose_var_based_partitioning(AV1_COMP *cpi, const TileInfo *const tile,
   // variances for splits.
   fill_variance_tree_leaves(cpi, x, vt, force_split, avg_16x16, maxvar_16x16,
                             minvar_16x16, thresholds, src_buf, src_stride,
-                            dst_buf, dst_stride, is_key_frame, is_small_sb);
+                            dst_buf, dst_stride, is_key_frame, is_small_sb,
+                            mi_row, mi_col);
 
   avg_64x64 = 0;
   for (int blk64_idx = 0; blk64_idx < num_64x64_blocks; ++blk64_idx) {
@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+#include "common/async_io.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "config/aom_config.h"
+
+#include "aom_util/aom_pthread.h"
+
+struct AvxAsyncReaderStruct {
+  aom_async_read_fn_t read_fn;
+  void *priv;
+  int max_frames;
+  int frames_read;
+  // Ring of num_frames images. The count filled ones start at head; the one
+  // at head is held by the caller if held is set.
+  int num_frames;
+  aom_image_t *frames;
+  int64_t *positions;
+  int head;
+  int count;
+  int held;
+  int eof;
+#if CONFIG_MULTITHREAD
+  int threaded;
+  int stop;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t filled;
+  pthread_cond_t emptied;
+#endif
+};
+
+struct AsyncWriteJob {
+  aom_async_write_fn_t write_fn;
+  void *priv;
+  aom_codec_cx_pkt_t pkt;
+  uint8_t *buf;
+  size_t buf_size;
+};
+
+struct AvxAsyncWriterStruct {
+  // Ring of max_pending jobs; the count queued ones start at head.
+  int max_pending;
+  struct AsyncWriteJob *jobs;
+  int head;
+  int count;
+#if CONFIG_MULTITHREAD
+  int threaded;
+  int stop;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t queued;
+  pthread_cond_t written;
+#endif
+};
+
+// Reads one frame into the slot after the filled ones, or marks the end of
+// the input.
+static void read_one_frame(AvxAsyncReader *reader, int slot) {
+  int64_t pos = 0;
+  const int got_frame =
+      (!reader->max_frames || reader->frames_read < reader->max_frames) &&
+      reader->read_fn(reader->priv, &reader->frames[slot], &pos);
+#if CONFIG_MULTITHREAD
+  if (reader->threaded) pthread_mutex_lock(&reader->mutex);
+#endif
+  if (got_frame) {
+    reader->positions[slot] = pos;
+    ++reader->frames_read;
+    ++reader->count;
+  } else {
+    reader->eof = 1;
+  }
+#if CONFIG_MULTITHREAD
+  if (reader->threaded) {
+    pthread_cond_signal(&reader->filled);
+    pthread_mutex_unlock(&reader->mutex);
+  }
+#endif
+}
+
+#if CONFIG_MULTITHREAD
+static void *reader_thread(void *arg) {
+  AvxAsyncReader *const reader = (AvxAsyncReader *)arg;
+  pthread_mutex_lock(&reader->mutex);
+  while (!reader->eof) {
+    while (reader->count == reader->num_frames && !reader->stop) {
+      pthread_cond_wait(&reader->emptied, &reader->mutex);
+    }
+    if (reader->stop) break;
+    const int slot = (reader->head + reader->count) % reader->num_frames;
+    pthread_mutex_unlock(&reader->mutex);
+    read_one_frame(reader, slot);
+    pthread_mutex_lock(&reader->mutex);
+  }
+  pthread_mutex_unlock(&reader->mutex);
+  return NULL;
+}
+#endif  // CONFIG_MULTITHREAD
+
+AvxAsyncReader *aom_async_reader_create(aom_async_read_fn_t read_fn,
+                                        void *priv, int num_frames,
+                                        int max_frames) {
+  if (num_frames < 1) return NULL;
+  AvxAsyncReader *const reader = (AvxAsyncReader *)calloc(1, sizeof(*reader));
+  if (!reader) return NULL;
+  reader->read_fn = read_fn;
+  reader->priv = priv;
+  reader->max_frames = max_frames;
+  reader->num_frames = num_frames;
+  reader->frames = (aom_image_t *)calloc(num_frames, sizeof(*reader->frames));
+  reader->positions = (int64_t *)calloc(num_frames, sizeof(*reader->positions));
+  if (!reader->frames || !reader->positions) {
+    aom_async_reader_destroy(reader);
+    return NULL;
+  }
+#if CONFIG_MULTITHREAD
+  // With a single image there is nothing to read ahead into.
+  if (num_frames > 1 && !pthread_mutex_init(&reader->mutex, NULL)) {
+    if (!pthread_cond_init(&reader->filled, NULL)) {
+      if (!pthread_cond_init(&reader->emptied, NULL)) {
+        if (!pthread_create(&reader->thread, NULL, reader_thread, reader)) {
+          reader->threaded = 1;
+          return reader;
+        }
+        pthread_cond_destroy(&reader->emptied);
+      }
+      pthread_cond_destroy(&reader->filled);
+    }
+    pthread_mutex_destroy(&reader->mutex);
+  }
+#endif
+  return reader;
+}
+
+aom_image_t *aom_async_reader_next(AvxAsyncReader *reader, int64_t *pos) {
+  aom_image_t *img = NULL;
+#if CONFIG_MULTITHREAD
+  if (reader->threaded) {
+    pthread_mutex_lock(&reader->mutex);
+    if (reader->held) {
+      reader->head = (reader->head + 1) % reader->num_frames;
+      --reader->count;
+      reader->held = 0;
+      pthread_cond_signal(&reader->emptied);
+    }
+    while (!reader->count && !reader->eof) {
+      pthread_cond_wait(&reader->filled, &reader->mutex);
+    }
+    if (reader->count) {
+      img = &reader->frames[reader->head];
+      if (pos) *pos = reader->positions[reader->head];
+      reader->held = 1;
+    }
+    pthread_mutex_unlock(&reader->mutex);
+    return img;
+  }
+#endif
+  if (reader->held) {
+    --reader->count;
+    reader->held = 0;
+  }
+  if (!reader->eof) read_one_frame(reader, reader->head);
+  if (reader->count) {
+    img = &reader->frames[reader->head];
+    if (pos) *pos = reader->positions[reader->head];
+    reader->held = 1;
+  }
+  return img;
+}
+
+void aom_async_reader_destroy(AvxAsyncReader *reader) {
+  if (!reader) return;
+#if CONFIG_MULTITHREAD
+  if (reader->threaded) {
+    pthread_mutex_lock(&reader->mutex);
+    reader->stop = 1;
+    pthread_cond_signal(&reader->emptied);
+    pthread_mutex_unlock(&reader->mutex);
+    pthread_join(reader->thread, NULL);
+    pthread_cond_destroy(&reader->emptied);
+    pthread_cond_destroy(&reader->filled);
+    pthread_mutex_destroy(&reader->mutex);
+  }
+#endif
+  if (reader->frames) {
+    for (int i = 0; i < reader->num_frames; ++i) {
+      aom_img_free(&reader->frames[i]);
+    }
+  }
+  free(reader->frames);
+  free(reader->positions);
+  free(reader);
+}
+
+#if CONFIG_MULTITHREAD
+static void *writer_thread(void *arg) {
+  AvxAsyncWriter *const writer = (AvxAsyncWriter *)arg;
+  pthread_mutex_lock(&writer->mutex);
+  for (;;) {
+    while (!writer->count && !writer->stop) {
+      pthread_cond_wait(&writer->queued, &writer->mutex);
+    }
+    if (!writer->count) break;
+    struct AsyncWriteJob *const job = &writer->jobs[writer->head];
+    pthread_mutex_unlock(&writer->mutex);
+    job->write_fn(job->priv, &job->pkt);
+    pthread_mutex_lock(&writer->mutex);
+    writer->head = (writer->head + 1) % writer->max_pending;
+    --writer->count;
+    pthread_cond_signal(&writer->written);
+  }
+  pthread_mutex_unlock(&writer->mutex);
+  return NULL;
+}
+#endif  // CONFIG_MULTITHREAD
+
+AvxAsyncWriter *aom_async_writer_create(int max_pending) {
+  if (max_pending < 1) return NULL;
+  AvxAsyncWriter *const writer = (AvxAsyncWriter *)calloc(1, sizeof(*writer));
+  if (!writer) return NULL;
+  writer->max_pending = max_pending;
+  writer->jobs =
+      (struct AsyncWriteJob *)calloc(max_pending, sizeof(*writer->jobs));
+  if (!writer->jobs) {
+    aom_async_writer_destroy(writer);
+    return NULL;
+  }
+#if CONFIG_MULTITHREAD
+  if (!pthread_mutex_init(&writer->mutex, NULL)) {
+    if (!pthread_cond_init(&writer->queued, NULL)) {
+      if (!pthread_cond_init(&writer->written, NULL)) {
+        if (!pthread_create(&writer->thread, NULL, writer_thread, writer)) {
+          writer->threaded = 1;
+          return writer;
+        }
+        pthread_cond_destroy(&writer->written);
+      }
+      pthread_cond_destroy(&writer->queued);
+    }
+    pthread_mutex_destroy(&writer->mutex);
+  }
+#endif
+  return writer;
+}
+
+int aom_async_writer_write(AvxAsyncWriter *writer,
+                           aom_async_write_fn_t write_fn, void *priv,
+                           const aom_codec_cx_pkt_t *pkt) {
+#if CONFIG_MULTITHREAD
+  if (writer->threaded) {
+    pthread_mutex_lock(&writer->mutex);
+    while (writer->count == writer->max_pending) {
+      pthread_cond_wait(&writer->written, &writer->mutex);
+    }
+    // The writer thread does not touch the slots past the queued ones.
+    struct AsyncWriteJob *const job =
+        &writer->jobs[(writer->head + writer->count) % writer->max_pending];
+    pthread_mutex_unlock(&writer->mutex);
+    const size_t sz = pkt->data.frame.sz;
+    if (sz > job->buf_size) {
+      uint8_t *const buf = (uint8_t *)realloc(job->buf, sz);
+      if (!buf) return 0;
+      job->buf = buf;
+      job->buf_size = sz;
+    }
+    if (sz) memcpy(job->buf, pkt->data.frame.buf, sz);
+    job->write_fn = write_fn;
+    job->priv = priv;
+    job->pkt = *pkt;
+    job->pkt.data.frame.buf = job->buf;
+
+    pthread_mutex_lock(&writer->mutex);
+    ++writer->count;
+    pthread_cond_signal(&writer->queued);
+    pthread_mutex_unlock(&writer->mutex);
+    return 1;
+  }
+#endif
+  write_fn(priv, pkt);
+  return 1;
+}
+
+void aom_async_writer_flush(AvxAsyncWriter *writer) {
+#if CONFIG_MULTITHREAD
+  if (writer->threaded) {
+    pthread_mutex_lock(&writer->mutex);
+    while (writer->count) {
+      pthread_cond_wait(&writer->written, &writer->mutex);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+  }
+#else
+  (void)writer;
+#endif
+}
+
+void aom_async_writer_destroy(AvxAsyncWriter *writer) {
+  if (!writer) return;
+#if CONFIG_MULTITHREAD
+  if (writer->threaded) {
+    pthread_mutex_lock(&writer->mutex);
+    writer->stop = 1;
+    pthread_cond_signal(&writer->queued);
+    pthread_mutex_unlock(&writer->mutex);
+    pthread_join(writer->thread, NULL);
+    pthread_cond_destroy(&writer->written);
+    pthread_cond_destroy(&writer->queued);
+    pthread_mutex_destroy(&writer->mutex);
+  }
+#endif
+  if (writer->jobs) {
+    for (int i = 0; i < writer->max_pending; ++i) free(writer->jobs[i].buf);
+  }
+  free(writer->jobs);
+  free(writer);
+}
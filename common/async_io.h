@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_COMMON_ASYNC_IO_H_
+#define AOM_COMMON_ASYNC_IO_H_
+
+#include <stdint.h>
+
+#include "aom/aom_encoder.h"
+#include "aom/aom_image.h"
+
+// Reads frames ahead of the encoder on a separate thread, and writes packets
+// behind it on another, so that file I/O and input conversion overlap with
+// encoding. Without CONFIG_MULTITHREAD, or if a thread cannot be started,
+// both do their work synchronously on the calling thread.
+
+struct AvxAsyncReaderStruct;
+typedef struct AvxAsyncReaderStruct AvxAsyncReader;
+
+struct AvxAsyncWriterStruct;
+typedef struct AvxAsyncWriterStruct AvxAsyncWriter;
+
+// Reads the next frame into img. The images in the ring start out zeroed;
+// the callback allocates one the first time it is given it, and the reader
+// frees them with aom_img_free(). *pos receives the input position after the
+// frame. Returns 1 if a frame was read, 0 at the end of the input.
+typedef int (*aom_async_read_fn_t)(void *priv, aom_image_t *img,
+                                   int64_t *pos);
+
+// Writes a frame packet. Called on the writer thread, in the order in which
+// the packets were queued.
+typedef void (*aom_async_write_fn_t)(void *priv, const aom_codec_cx_pkt_t *pkt);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Starts reading up to max_frames frames (0 for no limit) into a ring of
+// num_frames images. Returns NULL upon failure.
+AvxAsyncReader *aom_async_reader_create(aom_async_read_fn_t read_fn,
+                                        void *priv, int num_frames,
+                                        int max_frames);
+
+// Returns the next frame, or NULL at the end of the input. If pos is not
+// NULL, it receives the input position after the frame. The image stays
+// valid until the next call.
+aom_image_t *aom_async_reader_next(AvxAsyncReader *reader, int64_t *pos);
+
+// Stops the reader thread and frees the ring.
+void aom_async_reader_destroy(AvxAsyncReader *reader);
+
+// Starts a writer that holds at most max_pending packets. Returns NULL upon
+// failure.
+AvxAsyncWriter *aom_async_writer_create(int max_pending);
+
+// Copies a frame packet and queues it for write_fn, waiting while the queue
+// is full. Returns 0 upon failure.
+int aom_async_writer_write(AvxAsyncWriter *writer,
+                           aom_async_write_fn_t write_fn, void *priv,
+                           const aom_codec_cx_pkt_t *pkt);
+
+// Waits until all queued packets have been written.
+void aom_async_writer_flush(AvxAsyncWriter *writer);
+
+// Writes the remaining packets, then stops the writer thread.
+void aom_async_writer_destroy(AvxAsyncWriter *writer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_COMMON_ASYNC_IO_H_
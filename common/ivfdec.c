@@ -110,3 +110,34 @@ int ivf_read_frame(struct AvxInputContext *input_ctx, uint8_t **buffer,
 
   return 1;
 }
+
+int ivf_map_frame(struct AvxInputContext *input_ctx, const uint8_t **frame,
+                  size_t *bytes_read, aom_codec_pts_t *pts) {
+  const uint8_t *const raw_header =
+      input_map_bytes(input_ctx, IVF_FRAME_HDR_SZ);
+  if (!raw_header) {
+    if (!input_eof(input_ctx))
+      fprintf(stderr, "Warning: Failed to read frame size\n");
+    return 1;
+  }
+
+  size_t frame_size = mem_get_le32(raw_header);
+  if (frame_size > 256 * 1024 * 1024) {
+    fprintf(stderr, "Warning: Read invalid frame size (%u)\n",
+            (unsigned int)frame_size);
+    frame_size = 0;
+  }
+
+  if (pts) {
+    *pts = mem_get_le32(&raw_header[4]);
+    *pts += ((aom_codec_pts_t)mem_get_le32(&raw_header[8]) << 32);
+  }
+
+  *frame = input_map_bytes(input_ctx, frame_size);
+  if (!*frame) {
+    fprintf(stderr, "Warning: Failed to read full frame\n");
+    return 1;
+  }
+  *bytes_read = frame_size;
+  return 0;
+}
@@ -22,6 +22,10 @@ int file_is_ivf(struct AvxInputContext *input);
 int ivf_read_frame(struct AvxInputContext *input_ctx, uint8_t **buffer,
                    size_t *bytes_read, size_t *buffer_size,
                    aom_codec_pts_t *pts);
+// Like ivf_read_frame(), but for input mapped with input_map_file(): points
+// *frame at the frame data in the mapped file instead of copying it.
+int ivf_map_frame(struct AvxInputContext *input_ctx, const uint8_t **frame,
+                  size_t *bytes_read, aom_codec_pts_t *pts);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -504,6 +504,63 @@ int obudec_read_temporal_unit(struct ObuDecInputContext *obu_ctx,
   return 0;
 }
 
+int obudec_map_temporal_unit(struct ObuDecInputContext *obu_ctx,
+                             const uint8_t **tu, size_t *bytes_read) {
+  struct AvxInputContext *avx_ctx = obu_ctx->avx_ctx;
+  *bytes_read = 0;
+
+  // The buffered bytes were read right before the current position, so the
+  // Temporal Unit starts with them.
+  const uint8_t *const pos = input_map_bytes(avx_ctx, 0);
+  if (!pos) return -1;
+  const uint8_t *const end = avx_ctx->mapped_data + avx_ctx->mapped_size;
+  const uint8_t *const start = pos - obu_ctx->bytes_buffered;
+  const uint8_t *tu_end;
+
+  if (obu_ctx->is_annexb) {
+    if (start == end) return 1;
+    uint64_t size = 0;
+    size_t length_of_temporal_unit_size = 0;
+    if (aom_uleb_decode(start, end - start, &size,
+                        &length_of_temporal_unit_size) != 0) {
+      fprintf(stderr, "obudec: Failure reading temporal unit header\n");
+      return -1;
+    }
+    if (size > (uint64_t)(end - start) - length_of_temporal_unit_size) {
+      fprintf(stderr, "obudec: Failed to read full temporal unit\n");
+      return -1;
+    }
+    tu_end = start + length_of_temporal_unit_size + size;
+  } else {
+    // Without a buffered Temporal Delimiter, the one at the current position
+    // starts the Temporal Unit.
+    if (start == end) return 1;
+    tu_end = pos;
+    int first_obu = obu_ctx->bytes_buffered == 0;
+    while (tu_end < end) {
+      ObuHeader obu_header;
+      size_t payload_size = 0;
+      size_t header_size = 0;
+      if (aom_read_obu_header_and_size(tu_end, end - tu_end, 0, &obu_header,
+                                       &payload_size,
+                                       &header_size) != AOM_CODEC_OK ||
+          payload_size > (size_t)(end - tu_end) - header_size) {
+        fprintf(stderr, "obudec: read_one_obu failed in TU loop\n");
+        return -1;
+      }
+      if (obu_header.type == OBU_TEMPORAL_DELIMITER && !first_obu) break;
+      tu_end += header_size + payload_size;
+      first_obu = 0;
+    }
+  }
+
+  input_map_bytes(avx_ctx, tu_end - pos);
+  obu_ctx->bytes_buffered = 0;
+  *tu = start;
+  *bytes_read = tu_end - start;
+  return 0;
+}
+
 void obudec_free(struct ObuDecInputContext *obu_ctx) {
   free(obu_ctx->buffer);
   obu_ctx->buffer = NULL;
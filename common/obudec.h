@@ -39,6 +39,12 @@ int obudec_read_temporal_unit(struct ObuDecInputContext *obu_ctx,
                               uint8_t **buffer, size_t *bytes_read,
                               size_t *buffer_size);
 
+// Like obudec_read_temporal_unit(), but for input mapped with
+// input_map_file(): points *tu at the Temporal Unit in the mapped file instead
+// of copying it, and stores its size in 'bytes_read'.
+int obudec_map_temporal_unit(struct ObuDecInputContext *obu_ctx,
+                             const uint8_t **tu, size_t *bytes_read);
+
 void obudec_free(struct ObuDecInputContext *obu_ctx);
 
 #ifdef __cplusplus
@@ -9,6 +9,12 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+// fileno() and mmap() are not declared in strict C99 mode. This must be before
+// any #include statements.
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include <assert.h>
 #include <math.h>
 #include <stdarg.h>
@@ -29,6 +35,9 @@
 #if defined(_WIN32)
 #include <io.h>
 #include <fcntl.h>
+#elif CONFIG_OS_SUPPORT
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
 #define LOG_ERROR(label)               \
@@ -85,6 +94,27 @@ const char *image_format_to_string(aom_img_fmt_t fmt) {
   }
 }
 
+void print_mem_usage(const char *label, const aom_mem_usage_t *usage) {
+  fprintf(stderr, "%s memory usage:\n  %-24s %10s %10s\n", label, "(KiB)",
+          "current", "peak");
+  for (int tag = 0; tag < AOM_MEM_TAG_COUNT; ++tag) {
+    if (usage->peak_bytes[tag] == 0) continue;
+    fprintf(stderr, "  %-24s %10zu %10zu\n",
+            aom_mem_tag_to_string((aom_mem_tag_t)tag),
+            usage->current_bytes[tag] >> 10, usage->peak_bytes[tag] >> 10);
+  }
+  fprintf(stderr, "  %-24s %10zu %10zu\n", "total",
+          usage->total_current_bytes >> 10, usage->total_peak_bytes >> 10);
+}
+
+void print_stage_timings(const char *label, const char *const *names,
+                         const int64_t *time_us, int count) {
+  fprintf(stderr, "%s stage timings:\n  %-24s %10s\n", label, "(ms)", "time");
+  for (int i = 0; i < count; ++i) {
+    fprintf(stderr, "  %-24s %10.1f\n", names[i], time_us[i] / 1000.0);
+  }
+}
+
 int read_yuv_frame(struct AvxInputContext *input_ctx, aom_image_t *yuv_frame) {
   FILE *f = input_ctx->file;
   struct FileTypeDetectionBuffer *detect = &input_ctx->detect;
@@ -574,13 +604,24 @@ void aom_img_write_nv12(const aom_image_t *img, FILE *file) {
   }
 }
 
+// Reads from the file, or from the mapped data if the file is mapped.
+static size_t read_file(struct AvxInputContext *input_ctx, size_t n,
+                        unsigned char *buf) {
+  if (!input_ctx->mapped_data) return fread(buf, 1, n, input_ctx->file);
+  const size_t left = input_ctx->mapped_size - input_ctx->mapped_pos;
+  if (n > left) n = left;
+  memcpy(buf, input_ctx->mapped_data + input_ctx->mapped_pos, n);
+  input_ctx->mapped_pos += n;
+  return n;
+}
+
 size_t read_from_input(struct AvxInputContext *input_ctx, size_t n,
                        unsigned char *buf) {
   const size_t buffered_bytes =
       input_ctx->detect.buf_read - input_ctx->detect.position;
   size_t read_n;
   if (buffered_bytes == 0) {
-    read_n = fread(buf, 1, n, input_ctx->file);
+    read_n = read_file(input_ctx, n, buf);
   } else if (n <= buffered_bytes) {
     memcpy(buf, input_ctx->detect.buf + input_ctx->detect.position, n);
     input_ctx->detect.position += n;
@@ -590,8 +631,7 @@ size_t read_from_input(struct AvxInputContext *input_ctx, size_t n,
            buffered_bytes);
     input_ctx->detect.position += buffered_bytes;
     read_n = buffered_bytes;
-    read_n +=
-        fread(buf + buffered_bytes, 1, n - buffered_bytes, input_ctx->file);
+    read_n += read_file(input_ctx, n - buffered_bytes, buf + buffered_bytes);
   }
   return read_n;
 }
@@ -604,16 +644,18 @@ size_t input_to_detect_buf(struct AvxInputContext *input_ctx, size_t n) {
       input_ctx->detect.buf_read - input_ctx->detect.position;
   size_t read_n;
   if (buffered_bytes == 0) {
-    read_n = fread(input_ctx->detect.buf + input_ctx->detect.buf_read, 1, n,
-                   input_ctx->file);
+    read_n = read_file(
+        input_ctx, n,
+        (unsigned char *)input_ctx->detect.buf + input_ctx->detect.buf_read);
     input_ctx->detect.buf_read += read_n;
   } else if (n <= buffered_bytes) {
     // In this case, don't need to do anything as the data is already in
     // the detect buffer
     read_n = n;
   } else {
-    read_n = fread(input_ctx->detect.buf + input_ctx->detect.buf_read, 1,
-                   n - buffered_bytes, input_ctx->file);
+    read_n = read_file(
+        input_ctx, n - buffered_bytes,
+        (unsigned char *)input_ctx->detect.buf + input_ctx->detect.buf_read);
     input_ctx->detect.buf_read += read_n;
     read_n += buffered_bytes;
   }
@@ -639,6 +681,54 @@ void rewind_detect(struct AvxInputContext *input_ctx) {
 }
 
 bool input_eof(struct AvxInputContext *input_ctx) {
-  return feof(input_ctx->file) &&
-         input_ctx->detect.position == input_ctx->detect.buf_read;
+  const bool file_eof = input_ctx->mapped_data
+                            ? input_ctx->mapped_pos == input_ctx->mapped_size
+                            : feof(input_ctx->file);
+  return file_eof && input_ctx->detect.position == input_ctx->detect.buf_read;
+}
+
+bool input_map_file(struct AvxInputContext *input_ctx) {
+#if CONFIG_OS_SUPPORT && !defined(_WIN32)
+  const int fd = fileno(input_ctx->file);
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+      (uint64_t)st.st_size > SIZE_MAX) {
+    return false;
+  }
+  const FileOffset pos = ftello(input_ctx->file);
+  if (pos < 0 || pos > st.st_size) return false;
+  void *const data =
+      mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) return false;
+  posix_madvise(data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+  input_ctx->mapped_data = (const uint8_t *)data;
+  input_ctx->mapped_size = (size_t)st.st_size;
+  input_ctx->mapped_pos = (size_t)pos;
+  return true;
+#else
+  (void)input_ctx;
+  return false;
+#endif
+}
+
+void input_unmap_file(struct AvxInputContext *input_ctx) {
+#if CONFIG_OS_SUPPORT && !defined(_WIN32)
+  if (input_ctx->mapped_data) {
+    munmap((void *)input_ctx->mapped_data, input_ctx->mapped_size);
+  }
+#endif
+  input_ctx->mapped_data = NULL;
+  input_ctx->mapped_size = 0;
+  input_ctx->mapped_pos = 0;
+}
+
+const uint8_t *input_map_bytes(struct AvxInputContext *input_ctx, size_t n) {
+  if (!input_ctx->mapped_data) return NULL;
+  // The bytes left in the detect buffer are the ones right before mapped_pos.
+  const size_t pos = input_ctx->mapped_pos -
+                     (input_ctx->detect.buf_read - input_ctx->detect.position);
+  if (n > input_ctx->mapped_size - pos) return NULL;
+  input_ctx->detect.position = input_ctx->detect.buf_read;
+  input_ctx->mapped_pos = pos + n;
+  return input_ctx->mapped_data + pos;
 }
@@ -118,6 +118,11 @@ struct AvxInputContext {
   y4m_input y4m;
 #endif
   aom_color_range_t color_range;
+  // The whole file, if it is mapped in memory. It is then read from
+  // mapped_pos instead of through |file|.
+  const uint8_t *mapped_data;
+  size_t mapped_size;
+  size_t mapped_pos;
 };
 
 #ifdef __cplusplus
@@ -179,6 +184,13 @@ uint32_t get_fourcc_by_aom_decoder(aom_codec_iface_t *iface);
 
 const char *image_format_to_string(aom_img_fmt_t fmt);
 
+// Prints the current and peak bytes of each memory tag to stderr, in KiB.
+void print_mem_usage(const char *label, const aom_mem_usage_t *usage);
+
+// Prints the time spent in each of count stages to stderr, in milliseconds.
+void print_stage_timings(const char *label, const char *const *names,
+                         const int64_t *time_us, int count);
+
 int read_yuv_frame(struct AvxInputContext *input_ctx, aom_image_t *yuv_frame);
 
 void aom_img_write(const aom_image_t *img, FILE *file);
@@ -205,6 +217,17 @@ size_t buffer_input(struct AvxInputContext *input_ctx, size_t n,
 void rewind_detect(struct AvxInputContext *input_ctx);
 bool input_eof(struct AvxInputContext *input_ctx);
 
+// Maps the input file in memory if it is a regular file, so that its data can
+// be used in place. Reading continues from the current position of the file;
+// any bytes left in the detect buffer must be the ones right before it.
+// Returns false, and leaves the file to be read with fread(), if the file
+// cannot be mapped.
+bool input_map_file(struct AvxInputContext *input_ctx);
+void input_unmap_file(struct AvxInputContext *input_ctx);
+// Returns a pointer to the next n bytes of a mapped input and consumes them,
+// or NULL if the input is not mapped or has fewer than n bytes left.
+const uint8_t *input_map_bytes(struct AvxInputContext *input_ctx, size_t n);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
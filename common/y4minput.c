@@ -16,7 +16,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "config/aom_config.h"
+
 #include "aom/aom_integer.h"
+#include "aom_util/aom_pthread.h"
 #include "y4minput.h"
 
 // Reads 'size' bytes from 'file' into 'buf' with some fault tolerance.
@@ -221,11 +224,283 @@ static int parse_tags(y4m_input *y4m_ctx, FILE *file) {
 
   Conversions which require both horizontal and vertical filtering could
    have these steps pipelined, for less memory consumption and better cache
-   performance, but we do them separately for simplicity.*/
+   performance, but we do them separately for simplicity.
+
+  Each step is a pass over whole rows, with the inner loop running along the
+   row, so that the compiler can vectorize it, and the rows of a pass can be
+   split into bands that are filtered on separate threads.*/
 #define OC_MINI(_a, _b) ((_a) > (_b) ? (_b) : (_a))
 #define OC_MAXI(_a, _b) ((_a) < (_b) ? (_b) : (_a))
 #define OC_CLAMPI(_a, _b, _c) (OC_MAXI(_a, OC_MINI(_b, _c)))
 
+/*Rounds a filtered sum and clamps it to 8 bits.
+  The sums lie between -34 * 255 and 162 * 255 for all of the filters, so
+   biased by 68 * 128 they fit in 16 bits, which lets the compiler vectorize
+   loops with 16-bit lanes.*/
+#define Y4M_FILTER_ROUND(_sum)                                               \
+  ((unsigned char)OC_CLAMPI(                                                 \
+      0, ((uint16_t)((_sum) + 64 + (68 << 7)) >> 7) - 68, 255))
+
+/*The most threads a pass is split across, and the fewest rows per band.*/
+#define Y4M_MAX_THREADS 8
+#define Y4M_MIN_BAND_ROWS 32
+
+/*Filters a row of _src_w samples into a row of _dst_w samples.*/
+typedef void (*y4m_filter_row_func)(unsigned char *_dst,
+                                    const unsigned char *_src, int _src_w,
+                                    int _dst_w);
+
+/*A filter pass over one plane.
+  A horizontal pass filters each of the src_h rows with filter_row.
+  A vertical pass produces (src_h + step - 1) / step rows, applying taps to
+   the source rows y * step + offset through y * step + offset + 5, clamped to
+   the plane, for output row y.*/
+typedef struct {
+  unsigned char *dst;
+  const unsigned char *src;
+  int src_w;
+  int src_h;
+  int dst_w;
+  y4m_filter_row_func filter_row;
+  const int *taps;
+  int step;
+  int offset;
+} y4m_pass;
+
+/*Filter: [3 -17 78 78 -17 3]/128, derived from a 6-tap Lanczos window.*/
+static const int y4m_decimate_taps[6] = { 3, -17, 78, 78, -17, 3 };
+
+static int y4m_pass_rows(const y4m_pass *_pass) {
+  if (_pass->filter_row) return _pass->src_h;
+  return (_pass->src_h + _pass->step - 1) / _pass->step;
+}
+
+static const unsigned char *y4m_pass_src_row(const y4m_pass *_pass,
+                                             int _row) {
+  return _pass->src + OC_CLAMPI(0, _row, _pass->src_h - 1) * _pass->src_w;
+}
+
+static void y4m_filter_rows(const y4m_pass *_pass, int _y_begin, int _y_end) {
+  int y;
+  int x;
+  if (_pass->filter_row) {
+    for (y = _y_begin; y < _y_end; y++) {
+      (*_pass->filter_row)(_pass->dst + y * _pass->dst_w,
+                           _pass->src + y * _pass->src_w, _pass->src_w,
+                           _pass->dst_w);
+    }
+    return;
+  }
+  for (y = _y_begin; y < _y_end; y++) {
+    const int row = y * _pass->step + _pass->offset;
+    const unsigned char *s0 = y4m_pass_src_row(_pass, row);
+    const unsigned char *s1 = y4m_pass_src_row(_pass, row + 1);
+    const unsigned char *s2 = y4m_pass_src_row(_pass, row + 2);
+    const unsigned char *s3 = y4m_pass_src_row(_pass, row + 3);
+    const unsigned char *s4 = y4m_pass_src_row(_pass, row + 4);
+    const unsigned char *s5 = y4m_pass_src_row(_pass, row + 5);
+    const int t0 = _pass->taps[0];
+    const int t1 = _pass->taps[1];
+    const int t2 = _pass->taps[2];
+    const int t3 = _pass->taps[3];
+    const int t4 = _pass->taps[4];
+    const int t5 = _pass->taps[5];
+    const int w = _pass->dst_w;
+    unsigned char *dst = _pass->dst + y * w;
+    for (x = 0; x < w; x++) {
+      dst[x] = Y4M_FILTER_ROUND(t0 * s0[x] + t1 * s1[x] + t2 * s2[x] +
+                                t3 * s3[x] + t4 * s4[x] + t5 * s5[x]);
+    }
+  }
+}
+
+#if CONFIG_MULTITHREAD
+typedef struct {
+  y4m_thread_pool *pool;
+  /*The worker filters band index + 1 of each pass that has that many.*/
+  int index;
+} y4m_worker;
+
+/*Threads that filter the bands of each pass.
+  The pool is created by y4m_input_open() and destroyed by y4m_input_close().
+  Its threads are started the first time a pass is split into bands, since
+   num_threads is set after y4m_input_open() returns, and then wait for the
+   passes of every later frame.*/
+struct y4m_thread_pool {
+  pthread_mutex_t mutex;
+  /*Signaled when a pass is posted or the pool is shut down.*/
+  pthread_cond_t start_cond;
+  /*Signaled when the last band of a pass is done.*/
+  pthread_cond_t done_cond;
+  pthread_t threads[Y4M_MAX_THREADS - 1];
+  y4m_worker workers[Y4M_MAX_THREADS - 1];
+  int num_workers;
+  /*The pass being run, and the first row of each of its bands, followed by
+     its row count.*/
+  const y4m_pass *pass;
+  int band_rows[Y4M_MAX_THREADS + 1];
+  int num_bands;
+  /*Counts the passes posted, so that a worker can tell a new pass from the
+     one it last ran.*/
+  unsigned generation;
+  /*The number of bands of the current pass still being filtered by workers.*/
+  int pending;
+  int shutdown;
+};
+
+static void *y4m_worker_thread(void *_arg) {
+  const y4m_worker *worker = (const y4m_worker *)_arg;
+  y4m_thread_pool *pool = worker->pool;
+  const int band = worker->index + 1;
+  unsigned generation = 0;
+  pthread_mutex_lock(&pool->mutex);
+  for (;;) {
+    while (!pool->shutdown && pool->generation == generation) {
+      pthread_cond_wait(&pool->start_cond, &pool->mutex);
+    }
+    if (pool->shutdown) break;
+    generation = pool->generation;
+    if (band < pool->num_bands) {
+      const y4m_pass *pass = pool->pass;
+      const int y_begin = pool->band_rows[band];
+      const int y_end = pool->band_rows[band + 1];
+      pthread_mutex_unlock(&pool->mutex);
+      y4m_filter_rows(pass, y_begin, y_end);
+      pthread_mutex_lock(&pool->mutex);
+      if (--pool->pending == 0) pthread_cond_signal(&pool->done_cond);
+    }
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  return NULL;
+}
+
+static y4m_thread_pool *y4m_thread_pool_create(void) {
+  y4m_thread_pool *pool = (y4m_thread_pool *)calloc(1, sizeof(*pool));
+  if (!pool) return NULL;
+  if (pthread_mutex_init(&pool->mutex, NULL)) {
+    free(pool);
+    return NULL;
+  }
+  if (pthread_cond_init(&pool->start_cond, NULL)) {
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool);
+    return NULL;
+  }
+  if (pthread_cond_init(&pool->done_cond, NULL)) {
+    pthread_cond_destroy(&pool->start_cond);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool);
+    return NULL;
+  }
+  return pool;
+}
+
+static void y4m_thread_pool_destroy(y4m_thread_pool *_pool) {
+  int i;
+  if (!_pool) return;
+  pthread_mutex_lock(&_pool->mutex);
+  _pool->shutdown = 1;
+  pthread_cond_broadcast(&_pool->start_cond);
+  pthread_mutex_unlock(&_pool->mutex);
+  for (i = 0; i < _pool->num_workers; i++) {
+    pthread_join(_pool->threads[i], NULL);
+  }
+  pthread_cond_destroy(&_pool->done_cond);
+  pthread_cond_destroy(&_pool->start_cond);
+  pthread_mutex_destroy(&_pool->mutex);
+  free(_pool);
+}
+
+/*Starts workers until the pool has _num_workers of them, and returns the
+   number it has, which is smaller if a thread could not be started.
+  Only called while no pass is running.*/
+static int y4m_thread_pool_reserve(y4m_thread_pool *_pool, int _num_workers) {
+  while (_pool->num_workers < _num_workers) {
+    y4m_worker *worker = &_pool->workers[_pool->num_workers];
+    worker->pool = _pool;
+    worker->index = _pool->num_workers;
+    if (pthread_create(&_pool->threads[_pool->num_workers], NULL,
+                       y4m_worker_thread, worker)) {
+      break;
+    }
+    _pool->num_workers++;
+  }
+  return _pool->num_workers;
+}
+#endif
+
+/*Runs a pass, splitting its rows into bands that are filtered by this thread
+   and up to _y4m->num_threads - 1 threads of the pool.*/
+static void y4m_run_pass(const y4m_input *_y4m, const y4m_pass *_pass) {
+  const int rows = y4m_pass_rows(_pass);
+#if CONFIG_MULTITHREAD
+  y4m_thread_pool *pool = _y4m->pool;
+  int num_bands;
+  int i;
+  num_bands = OC_MINI(OC_MINI(_y4m->num_threads, Y4M_MAX_THREADS),
+                      rows / Y4M_MIN_BAND_ROWS);
+  if (pool && num_bands > 1) {
+    num_bands = y4m_thread_pool_reserve(pool, num_bands - 1) + 1;
+  }
+  if (num_bands > 1) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->pass = _pass;
+    for (i = 0; i <= num_bands; i++) {
+      pool->band_rows[i] = rows * i / num_bands;
+    }
+    pool->num_bands = num_bands;
+    pool->pending = num_bands - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->mutex);
+    /*Band 0 is filtered on this thread.*/
+    y4m_filter_rows(_pass, 0, pool->band_rows[1]);
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->pending > 0) {
+      pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return;
+  }
+#else
+  (void)_y4m;
+#endif
+  y4m_filter_rows(_pass, 0, rows);
+}
+
+/*Runs a vertical pass with the given taps.*/
+static void y4m_run_vertical_pass(const y4m_input *_y4m, unsigned char *_dst,
+                                  const unsigned char *_src, int _c_w,
+                                  int _c_h, const int *_taps, int _step,
+                                  int _offset) {
+  y4m_pass pass;
+  memset(&pass, 0, sizeof(pass));
+  pass.dst = _dst;
+  pass.src = _src;
+  pass.src_w = pass.dst_w = _c_w;
+  pass.src_h = _c_h;
+  pass.taps = _taps;
+  pass.step = _step;
+  pass.offset = _offset;
+  y4m_run_pass(_y4m, &pass);
+}
+
+/*Runs a horizontal pass with the given row filter.*/
+static void y4m_run_horizontal_pass(const y4m_input *_y4m, unsigned char *_dst,
+                                    const unsigned char *_src, int _src_w,
+                                    int _dst_w, int _c_h,
+                                    y4m_filter_row_func _filter_row) {
+  y4m_pass pass;
+  memset(&pass, 0, sizeof(pass));
+  pass.dst = _dst;
+  pass.src = _src;
+  pass.src_w = _src_w;
+  pass.src_h = _c_h;
+  pass.dst_w = _dst_w;
+  pass.filter_row = _filter_row;
+  y4m_run_pass(_y4m, &pass);
+}
+
 /*420jpeg chroma samples are sited like:
   Y-------Y-------Y-------Y-------
   |       |       |       |
@@ -267,43 +542,35 @@ static int parse_tags(y4m_input *y4m_ctx, FILE *file) {
   The 4:2:2 modes look exactly the same, except there are twice as many chroma
    lines, and they are vertically co-sited with the luma samples in both the
    mpeg2 and jpeg cases (thus requiring no vertical resampling).*/
-static void y4m_42xmpeg2_42xjpeg_helper(unsigned char *_dst,
-                                        const unsigned char *_src, int _c_w,
-                                        int _c_h) {
-  int y;
+static void y4m_42xmpeg2_42xjpeg_row(unsigned char *_dst,
+                                     const unsigned char *_src, int _c_w,
+                                     int _dst_w) {
   int x;
-  for (y = 0; y < _c_h; y++) {
-    /*Filter: [4 -17 114 35 -9 1]/128, derived from a 6-tap Lanczos
-       window.*/
-    for (x = 0; x < OC_MINI(_c_w, 2); x++) {
-      _dst[x] = (unsigned char)OC_CLAMPI(
-          0,
-          (4 * _src[0] - 17 * _src[OC_MAXI(x - 1, 0)] + 114 * _src[x] +
-           35 * _src[OC_MINI(x + 1, _c_w - 1)] -
-           9 * _src[OC_MINI(x + 2, _c_w - 1)] + _src[OC_MINI(x + 3, _c_w - 1)] +
-           64) >>
-              7,
-          255);
-    }
-    for (; x < _c_w - 3; x++) {
-      _dst[x] = (unsigned char)OC_CLAMPI(
-          0,
-          (4 * _src[x - 2] - 17 * _src[x - 1] + 114 * _src[x] +
-           35 * _src[x + 1] - 9 * _src[x + 2] + _src[x + 3] + 64) >>
-              7,
-          255);
-    }
-    for (; x < _c_w; x++) {
-      _dst[x] = (unsigned char)OC_CLAMPI(
-          0,
-          (4 * _src[x - 2] - 17 * _src[x - 1] + 114 * _src[x] +
-           35 * _src[OC_MINI(x + 1, _c_w - 1)] -
-           9 * _src[OC_MINI(x + 2, _c_w - 1)] + _src[_c_w - 1] + 64) >>
-              7,
-          255);
-    }
-    _dst += _c_w;
-    _src += _c_w;
+  (void)_dst_w;
+  /*Filter: [4 -17 114 35 -9 1]/128, derived from a 6-tap Lanczos window.*/
+  for (x = 0; x < OC_MINI(_c_w, 2); x++) {
+    _dst[x] = (unsigned char)OC_CLAMPI(
+        0,
+        (4 * _src[0] - 17 * _src[OC_MAXI(x - 1, 0)] + 114 * _src[x] +
+         35 * _src[OC_MINI(x + 1, _c_w - 1)] -
+         9 * _src[OC_MINI(x + 2, _c_w - 1)] + _src[OC_MINI(x + 3, _c_w - 1)] +
+         64) >>
+            7,
+        255);
+  }
+  for (; x < _c_w - 3; x++) {
+    _dst[x] = Y4M_FILTER_ROUND(4 * _src[x - 2] - 17 * _src[x - 1] +
+                               114 * _src[x] + 35 * _src[x + 1] -
+                               9 * _src[x + 2] + _src[x + 3]);
+  }
+  for (; x < _c_w; x++) {
+    _dst[x] = (unsigned char)OC_CLAMPI(
+        0,
+        (4 * _src[x - 2] - 17 * _src[x - 1] + 114 * _src[x] +
+         35 * _src[OC_MINI(x + 1, _c_w - 1)] -
+         9 * _src[OC_MINI(x + 2, _c_w - 1)] + _src[_c_w - 1] + 64) >>
+            7,
+        255);
   }
 }
 
@@ -352,13 +619,17 @@ static void y4m_42xmpeg2_42xjpeg_helper(unsigned char *_dst,
    and the C_b location up one quarter pixel.*/
 static void y4m_convert_42xpaldv_42xjpeg(y4m_input *_y4m, unsigned char *_dst,
                                          unsigned char *_aux) {
+  /*Slide C_b up a quarter-pel.
+    This is the same filter used below, but in the other order.*/
+  static const int cb_taps[6] = { 1, -9, 35, 114, -17, 4 };
+  /*Slide C_r down a quarter-pel.
+    This is the same as the horizontal filter.*/
+  static const int cr_taps[6] = { 4, -17, 114, 35, -9, 1 };
   unsigned char *tmp;
   int c_w;
   int c_h;
   int c_sz;
   int pli;
-  int y;
-  int x;
   /*Skip past the luma data.*/
   _dst += _y4m->pic_w * _y4m->pic_h;
   /*Compute the size of each chroma plane.*/
@@ -370,86 +641,15 @@ static void y4m_convert_42xpaldv_42xjpeg(y4m_input *_y4m, unsigned char *_dst,
     /*First do the horizontal re-sampling.
       This is the same as the mpeg2 case, except that after the horizontal
        case, we need to apply a second vertical filter.*/
-    y4m_42xmpeg2_42xjpeg_helper(tmp, _aux, c_w, c_h);
+    y4m_run_horizontal_pass(_y4m, tmp, _aux, c_w, c_w, c_h,
+                            y4m_42xmpeg2_42xjpeg_row);
     _aux += c_sz;
-    switch (pli) {
-      case 1: {
-        /*Slide C_b up a quarter-pel.
-          This is the same filter used above, but in the other order.*/
-        for (x = 0; x < c_w; x++) {
-          for (y = 0; y < OC_MINI(c_h, 3); y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (tmp[0] - 9 * tmp[OC_MAXI(y - 2, 0) * c_w] +
-                 35 * tmp[OC_MAXI(y - 1, 0) * c_w] + 114 * tmp[y * c_w] -
-                 17 * tmp[OC_MINI(y + 1, c_h - 1) * c_w] +
-                 4 * tmp[OC_MINI(y + 2, c_h - 1) * c_w] + 64) >>
-                    7,
-                255);
-          }
-          for (; y < c_h - 2; y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (tmp[(y - 3) * c_w] - 9 * tmp[(y - 2) * c_w] +
-                 35 * tmp[(y - 1) * c_w] + 114 * tmp[y * c_w] -
-                 17 * tmp[(y + 1) * c_w] + 4 * tmp[(y + 2) * c_w] + 64) >>
-                    7,
-                255);
-          }
-          for (; y < c_h; y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (tmp[(y - 3) * c_w] - 9 * tmp[(y - 2) * c_w] +
-                 35 * tmp[(y - 1) * c_w] + 114 * tmp[y * c_w] -
-                 17 * tmp[OC_MINI(y + 1, c_h - 1) * c_w] +
-                 4 * tmp[(c_h - 1) * c_w] + 64) >>
-                    7,
-                255);
-          }
-          _dst++;
-          tmp++;
-        }
-        _dst += c_sz - c_w;
-        tmp -= c_w;
-      } break;
-      case 2: {
-        /*Slide C_r down a quarter-pel.
-          This is the same as the horizontal filter.*/
-        for (x = 0; x < c_w; x++) {
-          for (y = 0; y < OC_MINI(c_h, 2); y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (4 * tmp[0] - 17 * tmp[OC_MAXI(y - 1, 0) * c_w] +
-                 114 * tmp[y * c_w] + 35 * tmp[OC_MINI(y + 1, c_h - 1) * c_w] -
-                 9 * tmp[OC_MINI(y + 2, c_h - 1) * c_w] +
-                 tmp[OC_MINI(y + 3, c_h - 1) * c_w] + 64) >>
-                    7,
-                255);
-          }
-          for (; y < c_h - 3; y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (4 * tmp[(y - 2) * c_w] - 17 * tmp[(y - 1) * c_w] +
-                 114 * tmp[y * c_w] + 35 * tmp[(y + 1) * c_w] -
-                 9 * tmp[(y + 2) * c_w] + tmp[(y + 3) * c_w] + 64) >>
-                    7,
-                255);
-          }
-          for (; y < c_h; y++) {
-            _dst[y * c_w] = (unsigned char)OC_CLAMPI(
-                0,
-                (4 * tmp[(y - 2) * c_w] - 17 * tmp[(y - 1) * c_w] +
-                 114 * tmp[y * c_w] + 35 * tmp[OC_MINI(y + 1, c_h - 1) * c_w] -
-                 9 * tmp[OC_MINI(y + 2, c_h - 1) * c_w] + tmp[(c_h - 1) * c_w] +
-                 64) >>
-                    7,
-                255);
-          }
-          _dst++;
-          tmp++;
-        }
-      } break;
+    if (pli == 1) {
+      y4m_run_vertical_pass(_y4m, _dst, tmp, c_w, c_h, cb_taps, 1, -3);
+    } else {
+      y4m_run_vertical_pass(_y4m, _dst, tmp, c_w, c_h, cr_taps, 1, -2);
     }
+    _dst += c_sz;
     /*For actual interlaced material, this would have to be done separately on
        each field, and the shift amounts would be different.
       C_r moves down 1/8, C_b up 3/8 in the top field, and C_r moves down 3/8,
@@ -462,44 +662,12 @@ static void y4m_convert_42xpaldv_42xjpeg(y4m_input *_y4m, unsigned char *_dst,
 
 /*Perform vertical filtering to reduce a single plane from 4:2:2 to 4:2:0.
   This is used as a helper by several conversion routines.*/
-static void y4m_422jpeg_420jpeg_helper(unsigned char *_dst,
+static void y4m_422jpeg_420jpeg_helper(const y4m_input *_y4m,
+                                       unsigned char *_dst,
                                        const unsigned char *_src, int _c_w,
                                        int _c_h) {
-  int y;
-  int x;
-  /*Filter: [3 -17 78 78 -17 3]/128, derived from a 6-tap Lanczos window.*/
-  for (x = 0; x < _c_w; x++) {
-    for (y = 0; y < OC_MINI(_c_h, 2); y += 2) {
-      _dst[(y >> 1) * _c_w] =
-          OC_CLAMPI(0,
-                    (64 * _src[0] + 78 * _src[OC_MINI(1, _c_h - 1) * _c_w] -
-                     17 * _src[OC_MINI(2, _c_h - 1) * _c_w] +
-                     3 * _src[OC_MINI(3, _c_h - 1) * _c_w] + 64) >>
-                        7,
-                    255);
-    }
-    for (; y < _c_h - 3; y += 2) {
-      _dst[(y >> 1) * _c_w] =
-          OC_CLAMPI(0,
-                    (3 * (_src[(y - 2) * _c_w] + _src[(y + 3) * _c_w]) -
-                     17 * (_src[(y - 1) * _c_w] + _src[(y + 2) * _c_w]) +
-                     78 * (_src[y * _c_w] + _src[(y + 1) * _c_w]) + 64) >>
-                        7,
-                    255);
-    }
-    for (; y < _c_h; y += 2) {
-      _dst[(y >> 1) * _c_w] = OC_CLAMPI(
-          0,
-          (3 * (_src[(y - 2) * _c_w] + _src[(_c_h - 1) * _c_w]) -
-           17 * (_src[(y - 1) * _c_w] + _src[OC_MINI(y + 2, _c_h - 1) * _c_w]) +
-           78 * (_src[y * _c_w] + _src[OC_MINI(y + 1, _c_h - 1) * _c_w]) +
-           64) >>
-              7,
-          255);
-    }
-    _src++;
-    _dst++;
-  }
+  y4m_run_vertical_pass(_y4m, _dst, _src, _c_w, _c_h, y4m_decimate_taps, 2,
+                        -2);
 }
 
 /*420jpeg chroma samples are sited like:
@@ -559,7 +727,7 @@ static void y4m_convert_422jpeg_420jpeg(y4m_input *_y4m, unsigned char *_dst,
   c_sz = c_w * c_h;
   dst_c_sz = dst_c_w * dst_c_h;
   for (pli = 1; pli < 3; pli++) {
-    y4m_422jpeg_420jpeg_helper(_dst, _aux, c_w, c_h);
+    y4m_422jpeg_420jpeg_helper(_y4m, _dst, _aux, c_w, c_h);
     _aux += c_sz;
     _dst += dst_c_sz;
   }
@@ -628,9 +796,10 @@ static void y4m_convert_422_420jpeg(y4m_input *_y4m, unsigned char *_dst,
        less memory consumption and better cache performance, but we do them
        separately for simplicity.*/
     /*First do horizontal filtering (convert to 422jpeg)*/
-    y4m_42xmpeg2_42xjpeg_helper(tmp, _aux, c_w, c_h);
+    y4m_run_horizontal_pass(_y4m, tmp, _aux, c_w, c_w, c_h,
+                            y4m_42xmpeg2_42xjpeg_row);
     /*Now do the vertical filtering.*/
-    y4m_422jpeg_420jpeg_helper(_dst, tmp, c_w, c_h);
+    y4m_422jpeg_420jpeg_helper(_y4m, _dst, tmp, c_w, c_h);
     _aux += c_sz;
     _dst += dst_c_sz;
   }
@@ -677,6 +846,49 @@ static void y4m_convert_422_420jpeg(y4m_input *_y4m, unsigned char *_dst,
    right.
   Then we use another filter to decimate the planes by 2 in the vertical
    direction.*/
+static void y4m_411_422jpeg_row(unsigned char *_dst, const unsigned char *_src,
+                                int _c_w, int _dst_w) {
+  int x;
+  /*Filters: [1 110 18 -1]/128 and [-3 50 86 -5]/128, both derived from a
+     4-tap Mitchell window.*/
+  for (x = 0; x < OC_MINI(_c_w, 1); x++) {
+    _dst[x << 1] = (unsigned char)OC_CLAMPI(
+        0,
+        (111 * _src[0] + 18 * _src[OC_MINI(1, _c_w - 1)] -
+         _src[OC_MINI(2, _c_w - 1)] + 64) >>
+            7,
+        255);
+    _dst[x << 1 | 1] = (unsigned char)OC_CLAMPI(
+        0,
+        (47 * _src[0] + 86 * _src[OC_MINI(1, _c_w - 1)] -
+         5 * _src[OC_MINI(2, _c_w - 1)] + 64) >>
+            7,
+        255);
+  }
+  for (; x < _c_w - 2; x++) {
+    _dst[x << 1] = Y4M_FILTER_ROUND(_src[x - 1] + 110 * _src[x] +
+                                    18 * _src[x + 1] - _src[x + 2]);
+    _dst[x << 1 | 1] = Y4M_FILTER_ROUND(-3 * _src[x - 1] + 50 * _src[x] +
+                                        86 * _src[x + 1] - 5 * _src[x + 2]);
+  }
+  for (; x < _c_w; x++) {
+    _dst[x << 1] = (unsigned char)OC_CLAMPI(
+        0,
+        (_src[x - 1] + 110 * _src[x] + 18 * _src[OC_MINI(x + 1, _c_w - 1)] -
+         _src[_c_w - 1] + 64) >>
+            7,
+        255);
+    if ((x << 1 | 1) < _dst_w) {
+      _dst[x << 1 | 1] = (unsigned char)OC_CLAMPI(
+          0,
+          (-3 * _src[x - 1] + 50 * _src[x] +
+           86 * _src[OC_MINI(x + 1, _c_w - 1)] - 5 * _src[_c_w - 1] + 64) >>
+              7,
+          255);
+    }
+  }
+}
+
 static void y4m_convert_411_420jpeg(y4m_input *_y4m, unsigned char *_dst,
                                     unsigned char *_aux) {
   unsigned char *tmp;
@@ -686,10 +898,7 @@ static void y4m_convert_411_420jpeg(y4m_input *_y4m, unsigned char *_dst,
   int dst_c_w;
   int dst_c_h;
   int dst_c_sz;
-  int tmp_sz;
   int pli;
-  int y;
-  int x;
   /*Skip past the luma data.*/
   _dst += _y4m->pic_w * _y4m->pic_h;
   /*Compute the size of each chroma plane.*/
@@ -699,70 +908,54 @@ static void y4m_convert_411_420jpeg(y4m_input *_y4m, unsigned char *_dst,
   dst_c_h = (_y4m->pic_h + _y4m->dst_c_dec_v - 1) / _y4m->dst_c_dec_v;
   c_sz = c_w * c_h;
   dst_c_sz = dst_c_w * dst_c_h;
-  tmp_sz = dst_c_w * c_h;
   tmp = _aux + 2 * c_sz;
   for (pli = 1; pli < 3; pli++) {
     /*In reality, the horizontal and vertical steps could be pipelined, for
        less memory consumption and better cache performance, but we do them
        separately for simplicity.*/
     /*First do horizontal filtering (convert to 422jpeg)*/
-    for (y = 0; y < c_h; y++) {
-      /*Filters: [1 110 18 -1]/128 and [-3 50 86 -5]/128, both derived from a
-         4-tap Mitchell window.*/
-      for (x = 0; x < OC_MINI(c_w, 1); x++) {
-        tmp[x << 1] = (unsigned char)OC_CLAMPI(
-            0,
-            (111 * _aux[0] + 18 * _aux[OC_MINI(1, c_w - 1)] -
-             _aux[OC_MINI(2, c_w - 1)] + 64) >>
-                7,
-            255);
-        tmp[x << 1 | 1] = (unsigned char)OC_CLAMPI(
-            0,
-            (47 * _aux[0] + 86 * _aux[OC_MINI(1, c_w - 1)] -
-             5 * _aux[OC_MINI(2, c_w - 1)] + 64) >>
-                7,
-            255);
-      }
-      for (; x < c_w - 2; x++) {
-        tmp[x << 1] =
-            (unsigned char)OC_CLAMPI(0,
-                                     (_aux[x - 1] + 110 * _aux[x] +
-                                      18 * _aux[x + 1] - _aux[x + 2] + 64) >>
-                                         7,
-                                     255);
-        tmp[x << 1 | 1] = (unsigned char)OC_CLAMPI(
-            0,
-            (-3 * _aux[x - 1] + 50 * _aux[x] + 86 * _aux[x + 1] -
-             5 * _aux[x + 2] + 64) >>
-                7,
-            255);
-      }
-      for (; x < c_w; x++) {
-        tmp[x << 1] = (unsigned char)OC_CLAMPI(
-            0,
-            (_aux[x - 1] + 110 * _aux[x] + 18 * _aux[OC_MINI(x + 1, c_w - 1)] -
-             _aux[c_w - 1] + 64) >>
-                7,
-            255);
-        if ((x << 1 | 1) < dst_c_w) {
-          tmp[x << 1 | 1] = (unsigned char)OC_CLAMPI(
-              0,
-              (-3 * _aux[x - 1] + 50 * _aux[x] +
-               86 * _aux[OC_MINI(x + 1, c_w - 1)] - 5 * _aux[c_w - 1] + 64) >>
-                  7,
-              255);
-        }
-      }
-      tmp += dst_c_w;
-      _aux += c_w;
-    }
-    tmp -= tmp_sz;
+    y4m_run_horizontal_pass(_y4m, tmp, _aux, c_w, dst_c_w, c_h,
+                            y4m_411_422jpeg_row);
+    _aux += c_sz;
     /*Now do the vertical filtering.*/
-    y4m_422jpeg_420jpeg_helper(_dst, tmp, dst_c_w, c_h);
+    y4m_422jpeg_420jpeg_helper(_y4m, _dst, tmp, dst_c_w, c_h);
     _dst += dst_c_sz;
   }
 }
 
+static void y4m_444_422jpeg_row(unsigned char *_dst, const unsigned char *_src,
+                                int _c_w, int _dst_w) {
+  int x;
+  int i;
+  (void)_dst_w;
+  /*Filter: [3 -17 78 78 -17 3]/128, derived from a 6-tap Lanczos window.*/
+  for (x = 0; x < OC_MINI(_c_w, 2); x += 2) {
+    _dst[x >> 1] = OC_CLAMPI(0,
+                             (64 * _src[0] + 78 * _src[OC_MINI(1, _c_w - 1)] -
+                              17 * _src[OC_MINI(2, _c_w - 1)] +
+                              3 * _src[OC_MINI(3, _c_w - 1)] + 64) >>
+                                 7,
+                             255);
+  }
+  /*Count the interior samples by output position, so that the loop can be
+     vectorized.*/
+  for (i = x >> 1; i < (_c_w - 2) >> 1; i++) {
+    const unsigned char *src = _src + 2 * i;
+    _dst[i] = Y4M_FILTER_ROUND(3 * (src[-2] + src[3]) -
+                               17 * (src[-1] + src[2]) +
+                               78 * (src[0] + src[1]));
+  }
+  for (x = OC_MAXI(x, i << 1); x < _c_w; x += 2) {
+    _dst[x >> 1] =
+        OC_CLAMPI(0,
+                  (3 * (_src[x - 2] + _src[_c_w - 1]) -
+                   17 * (_src[x - 1] + _src[OC_MINI(x + 2, _c_w - 1)]) +
+                   78 * (_src[x] + _src[OC_MINI(x + 1, _c_w - 1)]) + 64) >>
+                      7,
+                  255);
+  }
+}
+
 /*Convert 444 to 420jpeg.*/
 static void y4m_convert_444_420jpeg(y4m_input *_y4m, unsigned char *_dst,
                                     unsigned char *_aux) {
@@ -773,10 +966,7 @@ static void y4m_convert_444_420jpeg(y4m_input *_y4m, unsigned char *_dst,
   int dst_c_w;
   int dst_c_h;
   int dst_c_sz;
-  int tmp_sz;
   int pli;
-  int y;
-  int x;
   /*Skip past the luma data.*/
   _dst += _y4m->pic_w * _y4m->pic_h;
   /*Compute the size of each chroma plane.*/
@@ -786,42 +976,13 @@ static void y4m_convert_444_420jpeg(y4m_input *_y4m, unsigned char *_dst,
   dst_c_h = (_y4m->pic_h + _y4m->dst_c_dec_v - 1) / _y4m->dst_c_dec_v;
   c_sz = c_w * c_h;
   dst_c_sz = dst_c_w * dst_c_h;
-  tmp_sz = dst_c_w * c_h;
   tmp = _aux + 2 * c_sz;
   for (pli = 1; pli < 3; pli++) {
-    /*Filter: [3 -17 78 78 -17 3]/128, derived from a 6-tap Lanczos window.*/
-    for (y = 0; y < c_h; y++) {
-      for (x = 0; x < OC_MINI(c_w, 2); x += 2) {
-        tmp[x >> 1] = OC_CLAMPI(0,
-                                (64 * _aux[0] + 78 * _aux[OC_MINI(1, c_w - 1)] -
-                                 17 * _aux[OC_MINI(2, c_w - 1)] +
-                                 3 * _aux[OC_MINI(3, c_w - 1)] + 64) >>
-                                    7,
-                                255);
-      }
-      for (; x < c_w - 3; x += 2) {
-        tmp[x >> 1] = OC_CLAMPI(0,
-                                (3 * (_aux[x - 2] + _aux[x + 3]) -
-                                 17 * (_aux[x - 1] + _aux[x + 2]) +
-                                 78 * (_aux[x] + _aux[x + 1]) + 64) >>
-                                    7,
-                                255);
-      }
-      for (; x < c_w; x += 2) {
-        tmp[x >> 1] =
-            OC_CLAMPI(0,
-                      (3 * (_aux[x - 2] + _aux[c_w - 1]) -
-                       17 * (_aux[x - 1] + _aux[OC_MINI(x + 2, c_w - 1)]) +
-                       78 * (_aux[x] + _aux[OC_MINI(x + 1, c_w - 1)]) + 64) >>
-                          7,
-                      255);
-      }
-      tmp += dst_c_w;
-      _aux += c_w;
-    }
-    tmp -= tmp_sz;
+    y4m_run_horizontal_pass(_y4m, tmp, _aux, c_w, dst_c_w, c_h,
+                            y4m_444_422jpeg_row);
+    _aux += c_sz;
     /*Now do the vertical filtering.*/
-    y4m_422jpeg_420jpeg_helper(_dst, tmp, dst_c_w, c_h);
+    y4m_422jpeg_420jpeg_helper(_y4m, _dst, tmp, dst_c_w, c_h);
     _dst += dst_c_sz;
   }
 }
@@ -905,6 +1066,8 @@ int y4m_input_open(y4m_input *y4m_ctx, FILE *file, char *skip_buffer,
   y4m_ctx->bit_depth = 8;
   y4m_ctx->aux_buf = NULL;
   y4m_ctx->dst_buf = NULL;
+  y4m_ctx->num_threads = 1;
+  y4m_ctx->pool = NULL;
   if (strcmp(y4m_ctx->chroma_type, "420") == 0 ||
       strcmp(y4m_ctx->chroma_type, "420jpeg") == 0 ||
       strcmp(y4m_ctx->chroma_type, "420mpeg2") == 0) {
@@ -1150,21 +1313,61 @@ int y4m_input_open(y4m_input *y4m_ctx, FILE *file, char *skip_buffer,
       return -1;
     }
   }
+#if CONFIG_MULTITHREAD
+  /*Only a conversion can be split across threads. Without a pool, it runs on
+     the calling thread.*/
+  if (y4m_ctx->convert != y4m_convert_null) {
+    y4m_ctx->pool = y4m_thread_pool_create();
+  }
+#endif
   return 0;
 }
 
 void y4m_input_close(y4m_input *_y4m) {
+#if CONFIG_MULTITHREAD
+  y4m_thread_pool_destroy(_y4m->pool);
+  _y4m->pool = NULL;
+#endif
   free(_y4m->dst_buf);
   free(_y4m->aux_buf);
 }
 
-int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, aom_image_t *_img) {
-  char frame[6];
+/*Points the planes of _img into a converted frame.*/
+static void y4m_input_set_image(const y4m_input *_y4m, unsigned char *_buf,
+                                aom_image_t *_img) {
   int pic_sz;
   int c_w;
   int c_h;
   int c_sz;
   int bytes_per_sample = _y4m->bit_depth > 8 ? 2 : 1;
+  /*Fill in the frame buffer pointers.
+    We don't use aom_img_wrap() because it forces padding for odd picture
+     sizes, which would require a separate fread call for every row.*/
+  memset(_img, 0, sizeof(*_img));
+  /*Y4M has the planes in Y'CbCr order, which libaom calls Y, U, and V.*/
+  _img->fmt = _y4m->aom_fmt;
+  _img->w = _img->d_w = _y4m->pic_w;
+  _img->h = _img->d_h = _y4m->pic_h;
+  _img->bit_depth = _y4m->bit_depth;
+  _img->x_chroma_shift = _y4m->dst_c_dec_h >> 1;
+  _img->y_chroma_shift = _y4m->dst_c_dec_v >> 1;
+  _img->bps = _y4m->bps;
+
+  /*Set up the buffer pointers.*/
+  pic_sz = _y4m->pic_w * _y4m->pic_h * bytes_per_sample;
+  c_w = (_y4m->pic_w + _y4m->dst_c_dec_h - 1) / _y4m->dst_c_dec_h;
+  c_w *= bytes_per_sample;
+  c_h = (_y4m->pic_h + _y4m->dst_c_dec_v - 1) / _y4m->dst_c_dec_v;
+  c_sz = c_w * c_h;
+  _img->stride[AOM_PLANE_Y] = _y4m->pic_w * bytes_per_sample;
+  _img->stride[AOM_PLANE_U] = _img->stride[AOM_PLANE_V] = c_w;
+  _img->planes[AOM_PLANE_Y] = _buf;
+  _img->planes[AOM_PLANE_U] = _buf + pic_sz;
+  _img->planes[AOM_PLANE_V] = _buf + pic_sz + c_sz;
+}
+
+int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, aom_image_t *_img) {
+  char frame[6];
   /*Read and skip the frame header.*/
   if (!file_read(frame, 6, _fin)) return 0;
   if (memcmp(frame, "FRAME", 5)) {
@@ -1193,29 +1396,47 @@ int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, aom_image_t *_img) {
   }
   /*Now convert the just read frame.*/
   (*_y4m->convert)(_y4m, _y4m->dst_buf, _y4m->aux_buf);
-  /*Fill in the frame buffer pointers.
-    We don't use aom_img_wrap() because it forces padding for odd picture
-     sizes, which would require a separate fread call for every row.*/
-  memset(_img, 0, sizeof(*_img));
-  /*Y4M has the planes in Y'CbCr order, which libaom calls Y, U, and V.*/
-  _img->fmt = _y4m->aom_fmt;
-  _img->w = _img->d_w = _y4m->pic_w;
-  _img->h = _img->d_h = _y4m->pic_h;
-  _img->bit_depth = _y4m->bit_depth;
-  _img->x_chroma_shift = _y4m->dst_c_dec_h >> 1;
-  _img->y_chroma_shift = _y4m->dst_c_dec_v >> 1;
-  _img->bps = _y4m->bps;
+  y4m_input_set_image(_y4m, _y4m->dst_buf, _img);
+  return 1;
+}
 
-  /*Set up the buffer pointers.*/
-  pic_sz = _y4m->pic_w * _y4m->pic_h * bytes_per_sample;
-  c_w = (_y4m->pic_w + _y4m->dst_c_dec_h - 1) / _y4m->dst_c_dec_h;
-  c_w *= bytes_per_sample;
-  c_h = (_y4m->pic_h + _y4m->dst_c_dec_v - 1) / _y4m->dst_c_dec_v;
-  c_sz = c_w * c_h;
-  _img->stride[AOM_PLANE_Y] = _y4m->pic_w * bytes_per_sample;
-  _img->stride[AOM_PLANE_U] = _img->stride[AOM_PLANE_V] = c_w;
-  _img->planes[AOM_PLANE_Y] = _y4m->dst_buf;
-  _img->planes[AOM_PLANE_U] = _y4m->dst_buf + pic_sz;
-  _img->planes[AOM_PLANE_V] = _y4m->dst_buf + pic_sz + c_sz;
+int y4m_input_can_map(const y4m_input *_y4m) {
+  return _y4m->convert == y4m_convert_null;
+}
+
+int y4m_input_map_frame(y4m_input *_y4m, const unsigned char *data,
+                        size_t size, size_t *pos, aom_image_t *img) {
+  const unsigned char *p = data + *pos;
+  const unsigned char *const end = data + size;
+  assert(y4m_input_can_map(_y4m));
+  /*Skip the frame header.*/
+  if (end - p < 6) return 0;
+  if (memcmp(p, "FRAME", 5)) {
+    fprintf(stderr, "Loss of framing in Y4M input data\n");
+    return -1;
+  }
+  p += 6;
+  if (p[-1] != '\n') {
+    int j;
+    for (j = 0; j < 79 && p < end && *p != '\n'; j++) p++;
+    if (j == 79) {
+      fprintf(stderr, "Error parsing Y4M frame header\n");
+      return -1;
+    }
+    if (p < end) ++p;
+  }
+  if ((size_t)(end - p) < _y4m->dst_buf_read_sz) {
+    fprintf(stderr, "Error reading Y4M frame data.\n");
+    return -1;
+  }
+  if (_y4m->bit_depth > 8 && ((uintptr_t)p & 1)) {
+    /*High bit depth images need 2-byte aligned planes, so copy the frame.*/
+    memcpy(_y4m->dst_buf, p, _y4m->dst_buf_read_sz);
+    y4m_input_set_image(_y4m, _y4m->dst_buf, img);
+  } else {
+    /*The planes are not written to, so the mapping can be read-only.*/
+    y4m_input_set_image(_y4m, (unsigned char *)p, img);
+  }
+  *pos = p + _y4m->dst_buf_read_sz - data;
   return 1;
 }
@@ -24,6 +24,9 @@ extern "C" {
 
 typedef struct y4m_input y4m_input;
 
+/*The threads that chroma conversion is split across, see num_threads.*/
+typedef struct y4m_thread_pool y4m_thread_pool;
+
 /*The function used to perform chroma conversion.*/
 typedef void (*y4m_convert_func)(y4m_input *_y4m, unsigned char *_dst,
                                  unsigned char *_src);
@@ -56,6 +59,12 @@ struct y4m_input {
   int bps;
   unsigned int bit_depth;
   aom_color_range_t color_range;
+  /*The number of threads chroma conversion may use. Set to 1 by
+     y4m_input_open().*/
+  int num_threads;
+  /*The threads that run the conversion along with the calling thread.
+    Created by y4m_input_open() and destroyed by y4m_input_close().*/
+  y4m_thread_pool *pool;
 };
 
 /**
@@ -75,6 +84,24 @@ int y4m_input_open(y4m_input *y4m_ctx, FILE *file, char *skip_buffer,
 void y4m_input_close(y4m_input *_y4m);
 int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, aom_image_t *img);
 
+/**
+ * Returns 1 if the frames are stored in the file the way they are handed out,
+ * so they can be used in place, and 0 if they need a conversion.
+ */
+int y4m_input_can_map(const y4m_input *_y4m);
+
+/**
+ * Reads the next frame of a file that is mapped in memory at |data|, of
+ * |size| bytes, and has y4m_input_can_map(). The planes of |img| point into
+ * |data|, unless high bit depth samples are misaligned there, in which case
+ * the frame is copied as by y4m_input_fetch_frame(). |pos| is the offset of
+ * the frame and is advanced past it.
+ *
+ * Returns 1 on success, 0 at the end of the data, -1 on failure.
+ */
+int y4m_input_map_frame(y4m_input *_y4m, const unsigned char *data,
+                        size_t size, size_t *pos, aom_image_t *img);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
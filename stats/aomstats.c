@@ -9,6 +9,12 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+// fileno() and mmap() are not declared in strict C99 mode. This must be
+// before any #include statements.
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "stats/aomstats.h"
 
 #include <assert.h>
@@ -16,12 +22,50 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "config/aom_config.h"
+
+#if CONFIG_OS_SUPPORT && !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
 #include "aom_dsp/aom_dsp_common.h"
 #include "common/tools_common.h"
 
+// Maps the first-pass stats file in place of reading it into allocated
+// memory. The second pass annotates the statistics through the encoder's own
+// pointers, so the mapping is writable but private: the file is only opened
+// for reading and is never modified, and only the pages the encoder writes
+// to are copied.
+static int stats_map_file(stats_io_t *stats) {
+#if CONFIG_OS_SUPPORT && !defined(_WIN32)
+  void *const data = mmap(NULL, stats->buf.sz, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE, fileno(stats->file), 0);
+  if (data == MAP_FAILED) return 0;
+  stats->buf.buf = data;
+  stats->mapped = 1;
+  return 1;
+#else
+  (void)stats;
+  return 0;
+#endif
+}
+
+static void stats_free_buf(stats_io_t *stats) {
+#if CONFIG_OS_SUPPORT && !defined(_WIN32)
+  if (stats->mapped) {
+    munmap(stats->buf.buf, stats->buf.sz);
+    stats->mapped = 0;
+    stats->buf.buf = NULL;
+    return;
+  }
+#endif
+  free(stats->buf.buf);
+}
+
 int stats_open_file(stats_io_t *stats, const char *fpf, int pass) {
   int res;
   stats->pass = pass;
+  stats->mapped = 0;
 
   if (pass == 0) {
     stats->file = fopen(fpf, "wb");
@@ -41,6 +85,8 @@ int stats_open_file(stats_io_t *stats, const char *fpf, int pass) {
     stats->buf.sz = stats->buf_alloc_sz = ftell(stats->file);
     rewind(stats->file);
 
+    if (stats->buf.sz > 0 && stats_map_file(stats)) return 1;
+
     stats->buf.buf = malloc(stats->buf_alloc_sz);
 
     if (!stats->buf.buf)
@@ -57,6 +103,7 @@ int stats_open_file(stats_io_t *stats, const char *fpf, int pass) {
 int stats_open_mem(stats_io_t *stats, int pass) {
   int res;
   stats->pass = pass;
+  stats->mapped = 0;
 
   if (!pass) {
     stats->buf.sz = 0;
@@ -72,7 +119,7 @@ int stats_open_mem(stats_io_t *stats, int pass) {
 void stats_close(stats_io_t *stats, int last_pass) {
   if (stats->file) {
     if (stats->pass == last_pass) {
-      free(stats->buf.buf);
+      stats_free_buf(stats);
     }
 
     fclose(stats->file);
@@ -29,6 +29,8 @@ typedef struct {
   FILE *file;
   char *buf_ptr;
   size_t buf_alloc_sz;
+  // 1 if buf maps the stats file in the second pass, 0 if it is allocated.
+  int mapped;
 } stats_io_t;
 
 int stats_open_file(stats_io_t *stats, const char *fpf, int pass);
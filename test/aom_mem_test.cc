@@ -11,8 +11,11 @@
 
 #include "aom_mem/aom_mem.h"
 
+#include <cstdint>
 #include <cstdio>
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
 
 #include "gtest/gtest.h"
 
@@ -32,3 +35,77 @@ TEST(AomMemTest, NullParams) {
   ASSERT_EQ(aom_memset16(nullptr, 0, 0), nullptr);
   aom_free(nullptr);
 }
+
+namespace {
+
+struct AllocatorStats {
+  int num_allocs[AOM_MEM_TAG_COUNT];
+  int num_frees[AOM_MEM_TAG_COUNT];
+  size_t live_bytes;
+};
+
+void *CountingAlloc(void *priv, size_t size, aom_mem_tag_t tag) {
+  AllocatorStats *const stats = static_cast<AllocatorStats *>(priv);
+  ++stats->num_allocs[tag];
+  stats->live_bytes += size;
+  return malloc(size);
+}
+
+void CountingFree(void *priv, void *ptr, size_t size, aom_mem_tag_t tag) {
+  AllocatorStats *const stats = static_cast<AllocatorStats *>(priv);
+  ++stats->num_frees[tag];
+  stats->live_bytes -= size;
+  free(ptr);
+}
+
+}  // namespace
+
+TEST(AomMemTest, Allocator) {
+  AllocatorStats stats = {};
+  const aom_codec_allocator_t allocator = { CountingAlloc, CountingFree,
+                                            &stats, 0 };
+  ASSERT_EQ(aom_mem_set_allocator(&allocator), nullptr);
+  void *const other = aom_malloc(100);
+  void *const frame = aom_memalign_tagged(64, 1000, AOM_MEM_TAG_FRAME_BUFFER);
+  uint8_t *const tpl =
+      static_cast<uint8_t *>(aom_calloc_tagged(10, 10, AOM_MEM_TAG_TPL_STATS));
+  ASSERT_EQ(aom_mem_set_allocator(nullptr), &allocator);
+  ASSERT_NE(other, nullptr);
+  ASSERT_NE(frame, nullptr);
+  ASSERT_NE(tpl, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(frame) % 64, 0u);
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(tpl[i], 0);
+  EXPECT_EQ(stats.num_allocs[AOM_MEM_TAG_OTHER], 1);
+  EXPECT_EQ(stats.num_allocs[AOM_MEM_TAG_FRAME_BUFFER], 1);
+  EXPECT_EQ(stats.num_allocs[AOM_MEM_TAG_TPL_STATS], 1);
+
+  // Blocks go back to the allocator they came from, even though it is no
+  // longer current.
+  void *const unrouted = aom_malloc(100);
+  aom_free(other);
+  aom_free(frame);
+  aom_free(tpl);
+  aom_free(unrouted);
+  EXPECT_EQ(stats.num_frees[AOM_MEM_TAG_OTHER], 1);
+  EXPECT_EQ(stats.num_frees[AOM_MEM_TAG_FRAME_BUFFER], 1);
+  EXPECT_EQ(stats.num_frees[AOM_MEM_TAG_TPL_STATS], 1);
+  EXPECT_EQ(stats.live_bytes, 0u);
+}
+
+TEST(AomMemTest, HugePages) {
+  const aom_codec_allocator_t allocator = { nullptr, nullptr, nullptr, 1 };
+  aom_mem_set_allocator(&allocator);
+  const size_t size = 5 << 20;
+  uint8_t *const frame = static_cast<uint8_t *>(
+      aom_memalign_tagged(32, size, AOM_MEM_TAG_FRAME_BUFFER));
+  uint8_t *const small =
+      static_cast<uint8_t *>(aom_malloc_tagged(1000, AOM_MEM_TAG_MODE_INFO));
+  aom_mem_set_allocator(nullptr);
+  ASSERT_NE(frame, nullptr);
+  ASSERT_NE(small, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(frame) % 32, 0u);
+  memset(frame, 1, size);
+  memset(small, 1, 1000);
+  aom_free(frame);
+  aom_free(small);
+}
@@ -286,6 +286,34 @@ aomenc_av1_webm_cdf_update_mode() {
   fi
 }
 
+# A two-pass bitrate ladder shares one first pass between its streams. Each
+# stream must come out the same as a standalone two-pass encode at its
+# bitrate.
+aomenc_av1_ivf_shared_first_pass() {
+  if [ "$(aomenc_can_encode_av1)" = "yes" ]; then
+    local params="--passes=2
+                  --cpu-used=6
+                  --limit=20
+                  --lag-in-frames=5"
+    local ladder="${AOM_TEST_OUTPUT_DIR}/av1_shared_first_pass"
+    local single="${AOM_TEST_OUTPUT_DIR}/av1_single_first_pass"
+    aomenc $(yuv_raw_input) ${params} \
+      --target-bitrate=200 --output="${ladder}_200.ivf" -- \
+      --target-bitrate=600 --output="${ladder}_600.ivf" || return 1
+
+    for bitrate in 200 600; do
+      aomenc $(yuv_raw_input) ${params} \
+        --target-bitrate=${bitrate} \
+        --output="${single}_${bitrate}.ivf" || return 1
+      if ! diff -q "${ladder}_${bitrate}.ivf" "${single}_${bitrate}.ivf" \
+          > /dev/null; then
+        elog "The ${bitrate} kbps stream differs from a standalone encode."
+        return 1
+      fi
+    done
+  fi
+}
+
 if [ "$(realtime_only_build)" = "yes" ]; then
   aomenc_tests="aomenc_av1_ivf_rt"
 else
@@ -300,7 +328,8 @@ else
                 aomenc_av1_ivf_use_16bit_internal
                 aomenc_av1_webm_lag5_frames10
                 aomenc_av1_webm_non_square_par
-                aomenc_av1_webm_cdf_update_mode"
+                aomenc_av1_webm_cdf_update_mode
+                aomenc_av1_ivf_shared_first_pass"
 fi
 
 run_tests aomenc_verify_environment "${aomenc_tests}"
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "stats/aomstats.h"
+#include "test/acm_random.h"
+#include "test/video_source.h"
+
+namespace {
+
+// Odd-sized packets, so that neither the packets nor the total line up with
+// a page.
+constexpr size_t kPacketSize = 1001;
+constexpr int kNumPackets = 100;
+
+std::vector<uint8_t> RandomStats() {
+  libaom_test::ACMRandom rnd(libaom_test::ACMRandom::DeterministicSeed());
+  std::vector<uint8_t> data(kPacketSize * kNumPackets);
+  for (uint8_t &byte : data) byte = rnd.Rand8();
+  return data;
+}
+
+void WriteStats(stats_io_t *stats, const std::vector<uint8_t> &data) {
+  for (size_t pos = 0; pos < data.size(); pos += kPacketSize) {
+    stats_write(stats, &data[pos], kPacketSize);
+  }
+}
+
+TEST(AomStatsTest, FileRoundTrip) {
+  libaom_test::TempOutFile tmp;
+  ASSERT_NE(tmp.file(), nullptr);
+  const char *const path = tmp.file_name().c_str();
+  const std::vector<uint8_t> data = RandomStats();
+
+  stats_io_t stats = {};
+  ASSERT_TRUE(stats_open_file(&stats, path, 0));
+  WriteStats(&stats, data);
+  stats_close(&stats, 1);
+
+  ASSERT_TRUE(stats_open_file(&stats, path, 1));
+  const aom_fixed_buf_t buf = stats_get(&stats);
+  ASSERT_EQ(buf.sz, data.size());
+  EXPECT_EQ(memcmp(buf.buf, data.data(), data.size()), 0);
+  // The second pass annotates the statistics in place. That must not reach
+  // the stats file.
+  memset(buf.buf, 0, buf.sz);
+  stats_close(&stats, 1);
+
+  FILE *const file = fopen(path, "rb");
+  ASSERT_NE(file, nullptr);
+  std::vector<uint8_t> contents(data.size() + 1);
+  EXPECT_EQ(fread(contents.data(), 1, contents.size(), file), data.size());
+  fclose(file);
+  contents.resize(data.size());
+  EXPECT_EQ(contents, data);
+}
+
+// A stats file whose last packet was cut short is read back as is; the
+// encoder rejects a size that is not a whole number of packets.
+TEST(AomStatsTest, FileTruncated) {
+  libaom_test::TempOutFile tmp;
+  ASSERT_NE(tmp.file(), nullptr);
+  const char *const path = tmp.file_name().c_str();
+  const std::vector<uint8_t> data = RandomStats();
+  const size_t truncated_size = data.size() - kPacketSize / 2;
+
+  FILE *const file = fopen(path, "wb");
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(fwrite(data.data(), 1, truncated_size, file), truncated_size);
+  fclose(file);
+
+  stats_io_t stats = {};
+  ASSERT_TRUE(stats_open_file(&stats, path, 1));
+  const aom_fixed_buf_t buf = stats_get(&stats);
+  ASSERT_EQ(buf.sz, truncated_size);
+  EXPECT_EQ(memcmp(buf.buf, data.data(), truncated_size), 0);
+  stats_close(&stats, 1);
+}
+
+TEST(AomStatsTest, MemRoundTrip) {
+  const std::vector<uint8_t> data = RandomStats();
+
+  stats_io_t stats = {};
+  ASSERT_TRUE(stats_open_mem(&stats, 0));
+  // The buffer starts at 64 KiB, so this also covers its growth.
+  WriteStats(&stats, data);
+  stats_close(&stats, 1);
+
+  ASSERT_TRUE(stats_open_mem(&stats, 1));
+  const aom_fixed_buf_t buf = stats_get(&stats);
+  ASSERT_EQ(buf.sz, data.size());
+  EXPECT_EQ(memcmp(buf.buf, data.data(), data.size()), 0);
+  stats_close(&stats, 1);
+}
+
+}  // namespace
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/async_io.h"
+
+namespace {
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 48;
+constexpr int kNumFrames = 10;
+
+struct Source {
+  int frames_read;
+  int num_frames;
+};
+
+// Fills the frame with its index, and reports the index as the position.
+int ReadFrame(void *priv, aom_image_t *img, int64_t *pos) {
+  Source *const source = static_cast<Source *>(priv);
+  if (source->frames_read == source->num_frames) return 0;
+  if (img->img_data == nullptr &&
+      aom_img_alloc(img, AOM_IMG_FMT_I420, kWidth, kHeight, 32) == nullptr) {
+    return 0;
+  }
+  memset(img->planes[0], source->frames_read, img->stride[0] * kHeight);
+  *pos = source->frames_read++;
+  return 1;
+}
+
+struct Sink {
+  std::vector<int64_t> pts;
+  std::vector<uint8_t> data;
+};
+
+void WritePacket(void *priv, const aom_codec_cx_pkt_t *pkt) {
+  Sink *const sink = static_cast<Sink *>(priv);
+  const uint8_t *const buf = static_cast<const uint8_t *>(pkt->data.frame.buf);
+  sink->pts.push_back(pkt->data.frame.pts);
+  sink->data.insert(sink->data.end(), buf, buf + pkt->data.frame.sz);
+}
+
+class AsyncReaderTest : public ::testing::TestWithParam<int> {};
+
+// Each frame comes out once, in order, and stays intact until the next call.
+TEST_P(AsyncReaderTest, ReadsInOrder) {
+  for (const int max_frames : { 0, 4 }) {
+    Source source = { 0, kNumFrames };
+    AvxAsyncReader *const reader =
+        aom_async_reader_create(ReadFrame, &source, GetParam(), max_frames);
+    ASSERT_NE(reader, nullptr);
+    const int expected_frames = max_frames ? max_frames : kNumFrames;
+    int frame = 0;
+    int64_t pos;
+    aom_image_t *img;
+    while ((img = aom_async_reader_next(reader, &pos)) != nullptr) {
+      ASSERT_LT(frame, expected_frames);
+      EXPECT_EQ(pos, frame);
+      EXPECT_EQ(img->planes[0][0], frame);
+      EXPECT_EQ(img->planes[0][img->stride[0] * (kHeight - 1)], frame);
+      ++frame;
+    }
+    EXPECT_EQ(frame, expected_frames);
+    EXPECT_EQ(aom_async_reader_next(reader, &pos), nullptr);
+    aom_async_reader_destroy(reader);
+  }
+}
+
+// Destroying the reader before the end of the input stops it.
+TEST_P(AsyncReaderTest, StopsEarly) {
+  Source source = { 0, kNumFrames };
+  AvxAsyncReader *const reader =
+      aom_async_reader_create(ReadFrame, &source, GetParam(), 0);
+  ASSERT_NE(reader, nullptr);
+  ASSERT_NE(aom_async_reader_next(reader, nullptr), nullptr);
+  aom_async_reader_destroy(reader);
+  EXPECT_LE(source.frames_read, 1 + GetParam());
+}
+
+INSTANTIATE_TEST_SUITE_P(AsyncIo, AsyncReaderTest, ::testing::Values(1, 2, 4));
+
+class AsyncWriterTest : public ::testing::TestWithParam<int> {};
+
+// Packets are written in order from copies of their data.
+TEST_P(AsyncWriterTest, WritesInOrder) {
+  AvxAsyncWriter *const writer = aom_async_writer_create(GetParam());
+  ASSERT_NE(writer, nullptr);
+  Sink sink;
+  std::vector<uint8_t> expected;
+  std::vector<uint8_t> buf;
+  for (int i = 0; i < kNumFrames; ++i) {
+    buf.assign(i * 100 + 1, static_cast<uint8_t>(i));
+    aom_codec_cx_pkt_t pkt = {};
+    pkt.kind = AOM_CODEC_CX_FRAME_PKT;
+    pkt.data.frame.buf = buf.data();
+    pkt.data.frame.sz = buf.size();
+    pkt.data.frame.pts = i;
+    ASSERT_EQ(aom_async_writer_write(writer, WritePacket, &sink, &pkt), 1);
+    expected.insert(expected.end(), buf.begin(), buf.end());
+    // The writer must not depend on the caller's buffer.
+    std::fill(buf.begin(), buf.end(), 0xff);
+  }
+  aom_async_writer_flush(writer);
+  EXPECT_EQ(sink.data, expected);
+  ASSERT_EQ(sink.pts.size(), static_cast<size_t>(kNumFrames));
+  for (int i = 0; i < kNumFrames; ++i) EXPECT_EQ(sink.pts[i], i);
+  aom_async_writer_destroy(writer);
+}
+
+INSTANTIATE_TEST_SUITE_P(AsyncIo, AsyncWriterTest, ::testing::Values(1, 16));
+
+}  // namespace
@@ -10,6 +10,7 @@
  */
 
 #include <cstdlib>
+#include <cstring>
 #include <new>
 #include <tuple>
 
@@ -292,4 +293,57 @@ INSTANTIATE_TEST_SUITE_P(
                        ::testing::ValuesIn(kValidBlockSize)));
 #endif
 
+// The k-means on the color histogram of a block computes the same centroids as
+// av1_k_means() on its pixels, including when clusters become empty and are
+// reseeded from the pixels.
+TEST(AV1HistKmeansTest, MatchesKmeans) {
+  const int kMaxItr = 50;
+  libaom_test::ACMRandom rnd(libaom_test::ACMRandom::DeterministicSeed());
+  int16_t data[4096];
+  uint8_t indices[4096];
+  int count_buf[1 << 12];
+  for (const int bit_depth : { 8, 10, 12 }) {
+    for (const int max_colors : { 1, 2, 3, 8, 64, 256 }) {
+      for (int iter = 0; iter < 10; ++iter) {
+        const int n = 64 << rnd(7);
+        int16_t palette[256];
+        for (int i = 0; i < max_colors; ++i) {
+          palette[i] = static_cast<int16_t>(rnd(1 << bit_depth));
+        }
+        memset(count_buf, 0, sizeof(count_buf));
+        for (int i = 0; i < n; ++i) {
+          data[i] = palette[rnd(max_colors)];
+          ++count_buf[data[i]];
+        }
+        int num_colors = 0;
+        for (int i = 0; i < (1 << bit_depth); ++i) {
+          num_colors += count_buf[i] > 0;
+        }
+        ColorHistogram hist;
+        ASSERT_EQ(
+            av1_build_color_histogram(count_buf, bit_depth, num_colors, &hist),
+            1);
+        ASSERT_EQ(hist.num_colors, num_colors);
+        const int lower_bound = hist.colors[0];
+        const int upper_bound = hist.colors[num_colors - 1];
+        for (int k = PALETTE_MIN_SIZE; k <= PALETTE_MAX_SIZE; ++k) {
+          int16_t expected[PALETTE_MAX_SIZE];
+          int16_t actual[PALETTE_MAX_SIZE];
+          for (int i = 0; i < k; ++i) {
+            expected[i] = actual[i] = static_cast<int16_t>(
+                lower_bound + (2 * i + 1) * (upper_bound - lower_bound) / k / 2);
+          }
+          av1_k_means(data, expected, indices, n, k, 1, kMaxItr);
+          av1_hist_k_means(&hist, data, n, actual, k, kMaxItr);
+          for (int i = 0; i < k; ++i) {
+            ASSERT_EQ(actual[i], expected[i])
+                << "bit_depth " << bit_depth << " colors " << num_colors
+                << " n " << n << " k " << k << " centroid " << i;
+          }
+        }
+      }
+    }
+  }
+}
+
 }  // namespace AV1Kmeans
@@ -10,6 +10,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <ostream>
 #include <string>
 #include <tuple>
@@ -580,6 +581,61 @@ TEST_P(IntProColTest, DISABLED_Speed) {
   FillRandom();
   RunSpeedTest();
 }
+
+typedef unsigned int (*SadSrcAvg8x8Func)(const uint8_t *src, int src_stride,
+                                         const uint8_t *ref, int ref_stride,
+                                         uint8_t *avg);
+
+class SadSrcAvg8x8Test : public ::testing::TestWithParam<SadSrcAvg8x8Func> {
+ protected:
+  static constexpr int kStride = 80;
+
+  void RunComparison(int max_value) {
+    DECLARE_ALIGNED(16, uint8_t, src[64 * kStride]);
+    DECLARE_ALIGNED(16, uint8_t, ref[64 * kStride]);
+    DECLARE_ALIGNED(16, uint8_t, avg_c[64]);
+    DECLARE_ALIGNED(16, uint8_t, avg_simd[64]);
+    for (int iter = 0; iter < 100; ++iter) {
+      for (int i = 0; i < 64 * kStride; ++i) {
+        src[i] = rnd_.Rand8() % (max_value + 1);
+        ref[i] = iter & 1 ? max_value - src[i] : rnd_.Rand8();
+      }
+      // Odd offsets exercise unaligned loads.
+      const int offset = iter % 16;
+      const unsigned int sad_c = aom_sad64x64_src_avg8x8_c(
+          src + offset, kStride, ref + offset, kStride, avg_c);
+      unsigned int sad_simd;
+      API_REGISTER_STATE_CHECK(sad_simd = GetParam()(src + offset, kStride,
+                                                     ref + offset, kStride,
+                                                     avg_simd));
+      ASSERT_EQ(sad_c, sad_simd);
+      ASSERT_EQ(0, memcmp(avg_c, avg_simd, sizeof(avg_c)));
+    }
+  }
+
+  ACMRandom rnd_{ ACMRandom::DeterministicSeed() };
+};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(SadSrcAvg8x8Test);
+
+TEST_P(SadSrcAvg8x8Test, Random) { RunComparison(255); }
+
+TEST_P(SadSrcAvg8x8Test, LowRange) { RunComparison(3); }
+
+TEST(SadSrcAvg8x8CTest, MatchesReference) {
+  DECLARE_ALIGNED(16, uint8_t, src[64 * 64]);
+  DECLARE_ALIGNED(16, uint8_t, ref[64 * 64]);
+  uint8_t avg[64];
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int i = 0; i < 64 * 64; ++i) {
+    src[i] = rnd.Rand8();
+    ref[i] = rnd.Rand8();
+  }
+  EXPECT_EQ(aom_sad64x64_src_avg8x8_c(src, 64, ref, 64, avg),
+            aom_sad64x64_c(src, 64, ref, 64));
+  for (int i = 0; i < 64; ++i) {
+    EXPECT_EQ(avg[i], aom_avg_8x8_c(src + (i >> 3) * 8 * 64 + (i & 7) * 8, 64));
+  }
+}
 class VectorVarTestBase : public ::testing::Test {
  public:
   explicit VectorVarTestBase(int bwl) { m_bwl = bwl; }
@@ -774,6 +830,9 @@ INSTANTIATE_TEST_SUITE_P(
         make_tuple(32, 32, &aom_int_pro_col_sse2, &aom_int_pro_col_c),
         make_tuple(64, 64, &aom_int_pro_col_sse2, &aom_int_pro_col_c),
         make_tuple(128, 128, &aom_int_pro_col_sse2, &aom_int_pro_col_c)));
+
+INSTANTIATE_TEST_SUITE_P(SSE2, SadSrcAvg8x8Test,
+                         ::testing::Values(&aom_sad64x64_src_avg8x8_sse2));
 #endif
 
 #if HAVE_AVX2
@@ -798,6 +857,9 @@ INSTANTIATE_TEST_SUITE_P(
         make_tuple(32, 32, &aom_int_pro_col_avx2, &aom_int_pro_col_c),
         make_tuple(64, 64, &aom_int_pro_col_avx2, &aom_int_pro_col_c),
         make_tuple(128, 128, &aom_int_pro_col_avx2, &aom_int_pro_col_c)));
+
+INSTANTIATE_TEST_SUITE_P(AVX2, SadSrcAvg8x8Test,
+                         ::testing::Values(&aom_sad64x64_src_avg8x8_avx2));
 #endif
 
 #if HAVE_NEON
@@ -830,6 +892,9 @@ INSTANTIATE_TEST_SUITE_P(
     ::testing::Values(make_tuple(16, 16, 8, 0, 16, &aom_avg_8x8_quad_neon),
                       make_tuple(32, 32, 8, 16, 16, &aom_avg_8x8_quad_neon),
                       make_tuple(32, 32, 8, 8, 16, &aom_avg_8x8_quad_neon)));
+
+INSTANTIATE_TEST_SUITE_P(NEON, SadSrcAvg8x8Test,
+                         ::testing::Values(&aom_sad64x64_src_avg8x8_neon));
 #endif
 
 #if CONFIG_AV1_HIGHBITDEPTH
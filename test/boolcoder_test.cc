@@ -54,7 +54,7 @@ TEST(AV1, TestBitIO) {
         ACMRandom bit_rnd(random_seed);
         aom_writer bw;
         uint8_t bw_buffer[kBufferSize];
-        aom_start_encode(&bw, bw_buffer);
+        aom_start_encode(&bw, bw_buffer, sizeof(bw_buffer));
 
         int bit = (bit_method == 0) ? 0 : (bit_method == 1) ? 1 : 0;
         for (int i = 0; i < kBitsToTest; ++i) {
@@ -96,7 +96,7 @@ TEST(AV1, TestTell) {
   // Coders are noisier at low probabilities, so we start at p = 4.
   for (int p = 4; p < 256; p++) {
     double probability = p / 256.;
-    aom_start_encode(&bw, bw_buffer);
+    aom_start_encode(&bw, bw_buffer, sizeof(bw_buffer));
     for (int i = 0; i < kSymbols; i++) {
       aom_write(&bw, 0, p);
     }
@@ -142,7 +142,7 @@ TEST(AV1, TestHasOverflowed) {
   const int kSymbols = 1024;
   // Coders are noisier at low probabilities, so we start at p = 4.
   for (int p = 4; p < 256; p++) {
-    aom_start_encode(&bw, bw_buffer);
+    aom_start_encode(&bw, bw_buffer, sizeof(bw_buffer));
     for (int i = 0; i < kSymbols; i++) {
       aom_write(&bw, 1, p);
     }
@@ -171,3 +171,29 @@ TEST(AV1, TestHasOverflowed) {
     ASSERT_TRUE(aom_reader_has_overflowed(&br));
   }
 }
+
+// The writer fails rather than write past the end of its buffer.
+TEST(AV1, TestBufferTooSmall) {
+  const int kBufferSize = 10000;
+  const int kSymbols = 1024;
+  uint8_t bw_buffer[kBufferSize];
+  aom_writer bw;
+  aom_start_encode(&bw, bw_buffer, sizeof(bw_buffer));
+  for (int i = 0; i < kSymbols; i++) aom_write(&bw, i & 1, 128);
+  ASSERT_GE(aom_stop_encode(&bw), 0);
+  const unsigned int size = bw.pos;
+  ASSERT_GT(size, 0u);
+
+  memset(bw_buffer, 0xab, sizeof(bw_buffer));
+  aom_start_encode(&bw, bw_buffer, size - 1);
+  for (int i = 0; i < kSymbols; i++) aom_write(&bw, i & 1, 128);
+  EXPECT_LT(aom_stop_encode(&bw), 0);
+  for (unsigned int i = 0; i < sizeof(bw_buffer); i++) {
+    ASSERT_EQ(bw_buffer[i], 0xab) << "byte " << i;
+  }
+
+  aom_start_encode(&bw, bw_buffer, size);
+  for (int i = 0; i < kSymbols; i++) aom_write(&bw, i & 1, 128);
+  EXPECT_GE(aom_stop_encode(&bw), 0);
+  EXPECT_EQ(bw.pos, size);
+}
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "aom/aom_decoder.h"
+#include "aom/aom_encoder.h"
+#include "aom/aomcx.h"
+#include "aom/aomdx.h"
+#include "aom_ports/aom_timer.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/util.h"
+#include "test/video_source.h"
+
+namespace {
+
+constexpr int kWidth = 352;
+constexpr int kHeight = 288;
+constexpr int kNumFrames = 8;
+
+// The frame packets of a bitstream.
+using Frames = std::vector<std::vector<uint8_t>>;
+
+// Counts the allocations per tag. The callbacks are called from the worker
+// threads too, hence the lock.
+struct CountingAllocator {
+  std::mutex mutex;
+  int num_allocs[AOM_MEM_TAG_COUNT] = {};
+  int num_frees[AOM_MEM_TAG_COUNT] = {};
+  size_t live_bytes = 0;
+  size_t peak_bytes = 0;
+  aom_codec_allocator_t allocator = { Alloc, Free, this, 0 };
+
+  static void *Alloc(void *priv, size_t size, aom_mem_tag_t tag) {
+    CountingAllocator *const self = static_cast<CountingAllocator *>(priv);
+    std::lock_guard<std::mutex> lock(self->mutex);
+    ++self->num_allocs[tag];
+    self->live_bytes += size;
+    if (self->live_bytes > self->peak_bytes) {
+      self->peak_bytes = self->live_bytes;
+    }
+    return malloc(size);
+  }
+
+  static void Free(void *priv, void *ptr, size_t size, aom_mem_tag_t tag) {
+    CountingAllocator *const self = static_cast<CountingAllocator *>(priv);
+    std::lock_guard<std::mutex> lock(self->mutex);
+    ++self->num_frees[tag];
+    self->live_bytes -= size;
+    free(ptr);
+  }
+};
+
+class CodecAllocatorTest
+    : public ::libaom_test::CodecTestWith2Params<libaom_test::TestMode, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  CodecAllocatorTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        cpu_used_(GET_PARAM(2)) {}
+  ~CodecAllocatorTest() override = default;
+
+  void SetUp() override {
+    InitializeConfig(encoding_mode_);
+    cfg_.g_threads = 2;
+    cfg_.rc_target_bitrate = 300;
+    if (encoding_mode_ == ::libaom_test::kOnePassGood) {
+      cfg_.g_lag_in_frames = 6;
+    }
+  }
+
+  void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                          ::libaom_test::Encoder *encoder) override {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, cpu_used_);
+      encoder->Control(AV1E_SET_ROW_MT, 1);
+    }
+  }
+
+  // The usage after the last call is the one before the encoder is destroyed.
+  void PostEncodeFrameHook(::libaom_test::Encoder *encoder) override {
+    if (init_flags_ & AOM_CODEC_USE_MEM_ACCOUNTING) {
+      encoder->Control(AV1E_GET_MEM_USAGE, &enc_usage_);
+    }
+  }
+
+  void FramePktHook(const aom_codec_cx_pkt_t *pkt) override {
+    const uint8_t *const buf = static_cast<const uint8_t *>(pkt->data.frame.buf);
+    frames_.emplace_back(buf, buf + pkt->data.frame.sz);
+  }
+
+  // Encodes kNumFrames frames with two threads using the given allocator and
+  // returns the bitstream, one frame per element. With
+  // AOM_CODEC_USE_MEM_ACCOUNTING in flags, the memory usage before the
+  // encoder is destroyed is left in enc_usage_.
+  void Encode(const aom_codec_allocator_t *allocator, Frames *frames,
+              aom_codec_flags_t flags = 0) {
+    set_allocator(allocator);
+    set_init_flags(flags);
+    frames_.clear();
+    ::libaom_test::RandomVideoSource video;
+    video.SetSize(kWidth, kHeight);
+    video.set_limit(kNumFrames);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+    *frames = frames_;
+  }
+
+  // Decodes the frames with two threads using the given allocator and
+  // returns a checksum of the luma output.
+  void Decode(const aom_codec_allocator_t *allocator, const Frames &frames,
+              uint64_t *checksum, aom_codec_flags_t flags = 0,
+              aom_mem_usage_t *mem_usage = nullptr) {
+    aom_codec_dec_cfg_t cfg = { 2, 0, 0, 1 };
+    aom_codec_ctx_t dec;
+    ASSERT_EQ(aom_codec_dec_init_with_allocator(&dec, aom_codec_av1_dx(), &cfg,
+                                                flags, allocator),
+              AOM_CODEC_OK);
+    *checksum = 0;
+    for (const std::vector<uint8_t> &frame : frames) {
+      ASSERT_EQ(aom_codec_decode(&dec, frame.data(), frame.size(), nullptr),
+                AOM_CODEC_OK);
+      aom_codec_iter_t iter = nullptr;
+      aom_image_t *img;
+      while ((img = aom_codec_get_frame(&dec, &iter)) != nullptr) {
+        for (unsigned int r = 0; r < img->d_h; ++r) {
+          const uint8_t *row = img->planes[0] + r * img->stride[0];
+          for (unsigned int c = 0; c < img->d_w; ++c) {
+            *checksum = *checksum * 31 + row[c];
+          }
+        }
+      }
+    }
+    if (mem_usage != nullptr) {
+      EXPECT_EQ(aom_codec_control(&dec, AV1D_GET_MEM_USAGE, mem_usage),
+                AOM_CODEC_OK);
+    }
+    EXPECT_EQ(aom_codec_destroy(&dec), AOM_CODEC_OK);
+  }
+
+  ::libaom_test::TestMode encoding_mode_;
+  int cpu_used_;
+  Frames frames_;
+  aom_mem_usage_t enc_usage_ = {};
+};
+
+// Checks that an application allocator sees every allocation of the tagged
+// kinds, gets all of its memory back, and does not change the output.
+TEST_P(CodecAllocatorTest, RoutesAllAllocations) {
+  Frames reference;
+  ASSERT_NO_FATAL_FAILURE(Encode(nullptr, &reference));
+  CountingAllocator counting;
+  Frames frames;
+  ASSERT_NO_FATAL_FAILURE(Encode(&counting.allocator, &frames));
+  EXPECT_EQ(frames, reference);
+  EXPECT_EQ(counting.live_bytes, 0u);
+  EXPECT_GT(counting.num_allocs[AOM_MEM_TAG_FRAME_BUFFER], 0);
+  EXPECT_GT(counting.num_allocs[AOM_MEM_TAG_MODE_INFO], 0);
+  if (encoding_mode_ == ::libaom_test::kOnePassGood) {
+    EXPECT_GT(counting.num_allocs[AOM_MEM_TAG_TPL_STATS], 0);
+  }
+  for (int tag = 0; tag < AOM_MEM_TAG_COUNT; ++tag) {
+    EXPECT_EQ(counting.num_frees[tag], counting.num_allocs[tag])
+        << "tag " << tag;
+  }
+  RecordProperty("EncoderPeakBytes", std::to_string(counting.peak_bytes));
+
+  uint64_t reference_checksum;
+  ASSERT_NO_FATAL_FAILURE(Decode(nullptr, frames, &reference_checksum));
+  CountingAllocator dec_counting;
+  uint64_t checksum;
+  ASSERT_NO_FATAL_FAILURE(Decode(&dec_counting.allocator, frames, &checksum));
+  EXPECT_EQ(checksum, reference_checksum);
+  EXPECT_EQ(dec_counting.live_bytes, 0u);
+  EXPECT_GT(dec_counting.num_allocs[AOM_MEM_TAG_FRAME_BUFFER], 0);
+  EXPECT_GT(dec_counting.num_allocs[AOM_MEM_TAG_MODE_INFO], 0);
+  RecordProperty("DecoderPeakBytes", std::to_string(dec_counting.peak_bytes));
+}
+
+// The built-in huge page option gives the same output.
+TEST_P(CodecAllocatorTest, HugePages) {
+  Frames reference;
+  ASSERT_NO_FATAL_FAILURE(Encode(nullptr, &reference));
+  const aom_codec_allocator_t huge_pages = { nullptr, nullptr, nullptr, 1 };
+  Frames frames;
+  ASSERT_NO_FATAL_FAILURE(Encode(&huge_pages, &frames));
+  EXPECT_EQ(frames, reference);
+}
+
+// Compares the encode time with malloc and with huge pages.
+TEST_P(CodecAllocatorTest, DISABLED_HugePagesSpeed) {
+  const aom_codec_allocator_t huge_pages = { nullptr, nullptr, nullptr, 1 };
+  const aom_codec_allocator_t *const allocators[2] = { nullptr, &huge_pages };
+  int64_t elapsed_us[2];
+  for (int i = 0; i < 2; ++i) {
+    Frames frames;
+    aom_usec_timer timer;
+    aom_usec_timer_start(&timer);
+    ASSERT_NO_FATAL_FAILURE(Encode(allocators[i], &frames));
+    aom_usec_timer_mark(&timer);
+    elapsed_us[i] = aom_usec_timer_elapsed(&timer);
+  }
+  printf("malloc: %d us, huge pages: %d us\n", static_cast<int>(elapsed_us[0]),
+         static_cast<int>(elapsed_us[1]));
+}
+
+void CheckMemUsage(const aom_mem_usage_t &usage) {
+  size_t total_current = 0;
+  size_t total_peak = 0;
+  for (int tag = 0; tag < AOM_MEM_TAG_COUNT; ++tag) {
+    EXPECT_GE(usage.peak_bytes[tag], usage.current_bytes[tag]) << "tag " << tag;
+    EXPECT_NE(aom_mem_tag_to_string(static_cast<aom_mem_tag_t>(tag)), nullptr);
+    total_current += usage.current_bytes[tag];
+    total_peak += usage.peak_bytes[tag];
+  }
+  EXPECT_EQ(usage.total_current_bytes, total_current);
+  EXPECT_GE(usage.total_peak_bytes, usage.total_current_bytes);
+  // The tags peak at different times.
+  EXPECT_LE(usage.total_peak_bytes, total_peak);
+}
+
+// Checks the per-tag accounting, both on its own and on top of an application
+// allocator, and that it does not change the output.
+TEST_P(CodecAllocatorTest, MemUsage) {
+  Frames reference;
+  ASSERT_NO_FATAL_FAILURE(Encode(nullptr, &reference));
+
+  Frames frames;
+  ASSERT_NO_FATAL_FAILURE(
+      Encode(nullptr, &frames, AOM_CODEC_USE_MEM_ACCOUNTING));
+  EXPECT_EQ(frames, reference);
+  CheckMemUsage(enc_usage_);
+  EXPECT_GT(enc_usage_.current_bytes[AOM_MEM_TAG_FRAME_BUFFER], 0u);
+  EXPECT_GT(enc_usage_.current_bytes[AOM_MEM_TAG_MODE_INFO], 0u);
+  EXPECT_GT(enc_usage_.current_bytes[AOM_MEM_TAG_LOOKAHEAD], 0u);
+  EXPECT_GT(enc_usage_.current_bytes[AOM_MEM_TAG_PC_TREE], 0u);
+  EXPECT_GT(enc_usage_.current_bytes[AOM_MEM_TAG_THREAD_DATA], 0u);
+  if (encoding_mode_ == ::libaom_test::kOnePassGood) {
+    EXPECT_GT(enc_usage_.current_bytes[AOM_MEM_TAG_TPL_STATS], 0u);
+  }
+
+  // The application allocator still sees every allocation.
+  CountingAllocator counting;
+  ASSERT_NO_FATAL_FAILURE(
+      Encode(&counting.allocator, &frames, AOM_CODEC_USE_MEM_ACCOUNTING));
+  EXPECT_EQ(frames, reference);
+  EXPECT_EQ(counting.live_bytes, 0u);
+  EXPECT_GE(counting.peak_bytes, enc_usage_.total_peak_bytes);
+
+  uint64_t reference_checksum;
+  ASSERT_NO_FATAL_FAILURE(Decode(nullptr, frames, &reference_checksum));
+  uint64_t checksum;
+  aom_mem_usage_t dec_usage;
+  ASSERT_NO_FATAL_FAILURE(Decode(nullptr, frames, &checksum,
+                                 AOM_CODEC_USE_MEM_ACCOUNTING, &dec_usage));
+  EXPECT_EQ(checksum, reference_checksum);
+  CheckMemUsage(dec_usage);
+  EXPECT_GT(dec_usage.current_bytes[AOM_MEM_TAG_FRAME_BUFFER], 0u);
+  EXPECT_GT(dec_usage.current_bytes[AOM_MEM_TAG_MODE_INFO], 0u);
+}
+
+AV1_INSTANTIATE_TEST_SUITE(CodecAllocatorTest,
+                           ::testing::Values(::libaom_test::kOnePassGood,
+                                             ::libaom_test::kRealTime),
+                           ::testing::Values(6, 9));
+
+// The memory usage can only be read with AOM_CODEC_USE_MEM_ACCOUNTING.
+TEST(MemUsageControlTest, RequiresAccounting) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  ASSERT_EQ(aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_REALTIME),
+            AOM_CODEC_OK);
+  aom_mem_usage_t usage;
+  aom_codec_ctx_t enc;
+  ASSERT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_GET_MEM_USAGE, &usage),
+            AOM_CODEC_INCAPABLE);
+  EXPECT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_enc_init(&enc, iface, &cfg, AOM_CODEC_USE_MEM_ACCOUNTING),
+            AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_GET_MEM_USAGE, &usage), AOM_CODEC_OK);
+  EXPECT_GT(usage.total_current_bytes, 0u);
+  EXPECT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+}
+
+}  // namespace
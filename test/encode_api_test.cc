@@ -9,12 +9,14 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <tuple>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -604,6 +606,130 @@ TEST(EncodeAPI, PtsSmallerThanInitialPts) {
   aom_codec_destroy(&enc);
 }
 
+// Encodes a few moving frames, with the compressed data delivered in dst_buf
+// if it is not null, and returns the frame packets. Counts in *num_direct the
+// packets that the encoder wrote straight into dst_buf, rather than having
+// aom_codec_get_cx_data() copy them there, and sets *end to the offset in
+// dst_buf past the last packet.
+std::vector<std::vector<uint8_t>> EncodeWithCxDataBuf(
+    int annexb, std::vector<uint8_t> *dst_buf, unsigned int pad_before,
+    unsigned int zero_copy_output, int *num_direct, size_t *end) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  std::vector<std::vector<uint8_t>> packets;
+  EXPECT_EQ(aom_codec_enc_config_default(iface, &cfg, kUsage), AOM_CODEC_OK);
+  cfg.g_w = 64;
+  cfg.g_h = 64;
+  cfg.g_lag_in_frames = 4;
+  cfg.save_as_annexb = annexb;
+  aom_codec_ctx_t enc;
+  EXPECT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AOME_SET_CPUUSED, 6), AOM_CODEC_OK);
+  EXPECT_EQ(
+      aom_codec_control(&enc, AV1E_SET_ZERO_COPY_OUTPUT, zero_copy_output),
+      AOM_CODEC_OK);
+  *end = 0;
+  if (dst_buf) {
+    const aom_fixed_buf_t buf = { dst_buf->data(), dst_buf->size() };
+    EXPECT_EQ(aom_codec_set_cx_data_buf(&enc, &buf, pad_before, 0),
+              AOM_CODEC_OK);
+  }
+  // Returns whether the encoder produced a frame packet.
+  auto get_packets = [&]() {
+    bool got_frame = false;
+    aom_codec_iter_t iter = nullptr;
+    const aom_codec_cx_pkt_t *pkt;
+    // What the buffer holds before aom_codec_get_cx_data() may copy into it.
+    std::vector<uint8_t> encoded;
+    if (dst_buf) encoded = *dst_buf;
+    while ((pkt = aom_codec_get_cx_data(&enc, &iter)) != nullptr) {
+      if (pkt->kind != AOM_CODEC_CX_FRAME_PKT) continue;
+      const uint8_t *data = static_cast<const uint8_t *>(pkt->data.frame.buf);
+      size_t sz = pkt->data.frame.sz;
+      if (dst_buf) {
+        // The packet is in the buffer, after the untouched padding.
+        EXPECT_GE(data, dst_buf->data());
+        EXPECT_LE(data + sz, dst_buf->data() + dst_buf->size());
+        for (unsigned int i = 0; i < pad_before; ++i) {
+          EXPECT_EQ(data[i], 0xab);
+        }
+        data += pad_before;
+        sz -= pad_before;
+        const size_t offset = data - dst_buf->data();
+        if (memcmp(encoded.data() + offset, data, sz) == 0) ++*num_direct;
+        *end = std::max(*end, offset + sz);
+      }
+      packets.emplace_back(data, data + sz);
+      got_frame = true;
+    }
+    return got_frame;
+  };
+  aom_image_t *const image =
+      CreateGrayImage(AOM_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  EXPECT_NE(image, nullptr);
+  for (int frame = 0; frame < 8; ++frame) {
+    for (unsigned int i = 0; i < image->d_h; ++i) {
+      for (unsigned int j = 0; j < image->d_w; ++j) {
+        image->planes[0][i * image->stride[0] + j] =
+            static_cast<uint8_t>((i + j + 3 * frame) * 4);
+      }
+    }
+    EXPECT_EQ(aom_codec_encode(&enc, image, frame, 1, 0), AOM_CODEC_OK);
+    get_packets();
+  }
+  do {
+    EXPECT_EQ(aom_codec_encode(&enc, nullptr, 0, 1, 0), AOM_CODEC_OK);
+  } while (get_packets());
+  aom_img_free(image);
+  EXPECT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+  return packets;
+}
+
+// The encoder writes into the buffer set with aom_codec_set_cx_data_buf() the
+// same packets as it would otherwise return. By default it copies them there
+// and leaves the rest of the buffer alone. With AV1E_SET_ZERO_COPY_OUTPUT it
+// writes them there directly while the buffer has room for a frame, twice the
+// uncompressed size plus 8192 bytes, and then falls back to copying them.
+TEST(EncodeAPI, CxDataBuf) {
+  for (int annexb = 0; annexb <= 1; ++annexb) {
+    int num_direct = 0;
+    size_t end;
+    const std::vector<std::vector<uint8_t>> expected =
+        EncodeWithCxDataBuf(annexb, nullptr, 0, 0, &num_direct, &end);
+    ASSERT_FALSE(expected.empty());
+    const int num_packets = static_cast<int>(expected.size());
+    for (const unsigned int pad_before : { 0u, 12u }) {
+      std::vector<uint8_t> dst_buf(4 << 20, 0xab);
+      num_direct = 0;
+      EXPECT_EQ(EncodeWithCxDataBuf(annexb, &dst_buf, pad_before, 0,
+                                    &num_direct, &end),
+                expected);
+      EXPECT_EQ(num_direct, 0);
+      ASSERT_GT(end, 0u);
+      for (size_t i = end; i < dst_buf.size(); ++i) {
+        ASSERT_EQ(dst_buf[i], 0xab) << "offset " << i;
+      }
+
+      dst_buf.assign(4 << 20, 0xab);
+      num_direct = 0;
+      EXPECT_EQ(EncodeWithCxDataBuf(annexb, &dst_buf, pad_before, 1,
+                                    &num_direct, &end),
+                expected);
+      EXPECT_EQ(num_direct, num_packets);
+
+      // Room for the first few frames only: a 64x64 frame needs 2 * 6144 +
+      // 8192 bytes.
+      dst_buf.assign(pad_before + 20480 + 256, 0xab);
+      num_direct = 0;
+      EXPECT_EQ(EncodeWithCxDataBuf(annexb, &dst_buf, pad_before, 1,
+                                    &num_direct, &end),
+                expected);
+      EXPECT_GT(num_direct, 0);
+      EXPECT_LT(num_direct, num_packets);
+    }
+  }
+}
+
 TEST(EncodeAPI, PtsOrDurationTooBig) {
   // Initialize libaom encoder.
   aom_codec_iface_t *const iface = aom_codec_av1_cx();
@@ -650,6 +776,61 @@ TEST(EncodeAPI, PtsOrDurationTooBig) {
   aom_codec_destroy(&enc);
 }
 
+TEST(EncodeAPI, RtcFrameTimeBudget) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  aom_codec_ctx_t enc;
+  aom_codec_enc_cfg_t cfg;
+
+  ASSERT_EQ(aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_REALTIME),
+            AOM_CODEC_OK);
+  cfg.g_w = 320;
+  cfg.g_h = 240;
+  cfg.rc_end_usage = AOM_CBR;
+  cfg.rc_target_bitrate = 500;
+  ASSERT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(&enc, AOME_SET_CPUUSED, 7), AOM_CODEC_OK);
+  // A budget no frame can meet must raise the speed to the maximum.
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_SET_RTC_FRAME_TIME_BUDGET, 1),
+            AOM_CODEC_OK);
+
+  aom_image_t *const image =
+      CreateGrayImage(AOM_IMG_FMT_I420, cfg.g_w, cfg.g_h);
+  ASSERT_NE(image, nullptr);
+  const int kNumFrames = 10;
+  for (int i = 0; i < kNumFrames; ++i) {
+    ASSERT_EQ(aom_codec_encode(&enc, image, i, 1, 0), AOM_CODEC_OK);
+  }
+  aom_rtc_time_budget_stats_t stats;
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_RTC_TIME_BUDGET_STATS, &stats),
+            AOM_CODEC_OK);
+  EXPECT_EQ(stats.budget_us, 1u);
+  EXPECT_EQ(stats.frame_count, static_cast<unsigned int>(kNumFrames));
+  EXPECT_EQ(stats.over_budget_count, stats.frame_count);
+  EXPECT_EQ(stats.speed, 11);
+
+  // Disabling the budget returns to the configured speed.
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_SET_RTC_FRAME_TIME_BUDGET, 0),
+            AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_encode(&enc, image, kNumFrames, 1, 0), AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_GET_RTC_TIME_BUDGET_STATS, &stats),
+            AOM_CODEC_OK);
+  EXPECT_EQ(stats.frame_count, static_cast<unsigned int>(kNumFrames));
+  EXPECT_EQ(stats.speed, 7);
+
+  aom_img_free(image);
+  ASSERT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+
+#if !CONFIG_REALTIME_ONLY
+  // The budget is only supported in realtime mode.
+  ASSERT_EQ(aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_GOOD_QUALITY),
+            AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_RTC_FRAME_TIME_BUDGET, 1000),
+            AOM_CODEC_INCAPABLE);
+  ASSERT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+#endif
+}
+
 // Reproduces https://crbug.com/339877165.
 TEST(EncodeAPI, Buganizer339877165) {
   // Initialize libaom encoder.
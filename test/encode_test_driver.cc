@@ -24,7 +24,8 @@
 #include "test/video_source.h"
 
 namespace libaom_test {
-void Encoder::InitEncoder(VideoSource *video) {
+void Encoder::InitEncoder(VideoSource *video,
+                          const aom_codec_allocator_t *allocator) {
   aom_codec_err_t res;
   const aom_image_t *img = video->img();
 
@@ -34,7 +35,8 @@ void Encoder::InitEncoder(VideoSource *video) {
     cfg_.g_timebase = video->timebase();
     cfg_.rc_twopass_stats_in = stats_->buf();
 
-    res = aom_codec_enc_init(&encoder_, CodecInterface(), &cfg_, init_flags_);
+    res = aom_codec_enc_init_with_allocator(&encoder_, CodecInterface(), &cfg_,
+                                            init_flags_, allocator);
     ASSERT_EQ(AOM_CODEC_OK, res) << EncoderError();
   }
 }
@@ -193,7 +195,7 @@ void EncoderTest::RunLoop(VideoSource *video) {
     ASSERT_NE(encoder, nullptr);
 
     ASSERT_NO_FATAL_FAILURE(video->Begin());
-    encoder->InitEncoder(video);
+    encoder->InitEncoder(video, allocator_);
 
     if (mode_ == kRealTime) {
       encoder->Control(AOME_SET_ENABLEAUTOALTREF, 0);
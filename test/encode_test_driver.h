@@ -92,7 +92,10 @@ class Encoder {
 
   CxDataIterator GetCxData() { return CxDataIterator(&encoder_); }
 
-  void InitEncoder(VideoSource *video);
+  // Initializes the encoder with the given allocator, or with the default
+  // one if allocator is null.
+  void InitEncoder(VideoSource *video,
+                   const aom_codec_allocator_t *allocator = nullptr);
 
   const aom_image_t *GetPreviewFrame() {
     return aom_codec_get_preview_frame(&encoder_);
@@ -144,11 +147,26 @@ class Encoder {
     ASSERT_EQ(AOM_CODEC_OK, res) << EncoderError();
   }
 
+  void Control(int ctrl_id, aom_mem_usage_t *arg) {
+    const aom_codec_err_t res = aom_codec_control(&encoder_, ctrl_id, arg);
+    ASSERT_EQ(AOM_CODEC_OK, res) << EncoderError();
+  }
+
 #if CONFIG_AV1_ENCODER
   void Control(int ctrl_id, aom_active_map_t *arg) {
     const aom_codec_err_t res = aom_codec_control(&encoder_, ctrl_id, arg);
     ASSERT_EQ(AOM_CODEC_OK, res) << EncoderError();
   }
+
+  void Control(int ctrl_id, aom_zero_copy_input_t *arg) {
+    const aom_codec_err_t res = aom_codec_control(&encoder_, ctrl_id, arg);
+    ASSERT_EQ(AOM_CODEC_OK, res) << EncoderError();
+  }
+
+  void Control(int ctrl_id, aom_enc_stage_timings_t *arg) {
+    const aom_codec_err_t res = aom_codec_control(&encoder_, ctrl_id, arg);
+    ASSERT_EQ(AOM_CODEC_OK, res) << EncoderError();
+  }
 #endif
 
   void SetOption(const char *name, const char *value) {
@@ -193,8 +211,8 @@ class Encoder {
 class EncoderTest {
  protected:
   explicit EncoderTest(const CodecFactory *codec)
-      : codec_(codec), abort_(false), init_flags_(0), frame_flags_(0),
-        mode_(kRealTime) {
+      : codec_(codec), abort_(false), init_flags_(0), allocator_(nullptr),
+        frame_flags_(0), mode_(kRealTime) {
     // Default to 1 thread.
     cfg_.g_threads = 1;
   }
@@ -208,6 +226,11 @@ class EncoderTest {
   // Set encoder flag.
   void set_init_flags(aom_codec_flags_t flag) { init_flags_ = flag; }
 
+  // Set the allocator the encoder is initialized with.
+  void set_allocator(const aom_codec_allocator_t *allocator) {
+    allocator_ = allocator;
+  }
+
   // Main loop
   virtual void RunLoop(VideoSource *video);
 
@@ -277,6 +300,7 @@ class EncoderTest {
   unsigned int passes_;
   TwopassStatsStore stats_;
   aom_codec_flags_t init_flags_;
+  const aom_codec_allocator_t *allocator_;
   aom_enc_frame_flags_t frame_flags_;
   TestMode mode_;
 };
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/ivfdec.h"
+#include "common/obudec.h"
+#include "common/tools_common.h"
+#include "test/video_source.h"
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+// Odd frame and OBU payload sizes, including ones with a two byte leb128 size.
+constexpr size_t kSizes[] = { 1, 7, 131, 1001 };
+constexpr size_t kNumSizes = sizeof(kSizes) / sizeof(kSizes[0]);
+
+void PutLe32(Bytes *data, uint32_t value) {
+  for (int i = 0; i < 4; ++i) data->push_back((value >> (8 * i)) & 0xff);
+}
+
+void PutLeb128(Bytes *data, size_t value) {
+  do {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    if (value) byte |= 0x80;
+    data->push_back(byte);
+  } while (value);
+}
+
+void PutPayload(Bytes *data, size_t size) {
+  for (size_t i = 0; i < size; ++i) data->push_back((i * 7 + size) & 0xff);
+}
+
+// An IVF file with a frame of each size in kSizes, with pts 2 * i.
+// Sets frame_offsets to the offset of each frame's data.
+Bytes MakeIvf(std::vector<size_t> *frame_offsets) {
+  Bytes data = { 'D', 'K', 'I', 'F', 0, 0, 32, 0, 'A', 'V', '0', '1' };
+  PutLe32(&data, 0x01000040);  // 64x256.
+  PutLe32(&data, 30);          // Frame rate.
+  PutLe32(&data, 1);
+  PutLe32(&data, kNumSizes);
+  PutLe32(&data, 0);
+  for (size_t i = 0; i < kNumSizes; ++i) {
+    PutLe32(&data, static_cast<uint32_t>(kSizes[i]));
+    PutLe32(&data, static_cast<uint32_t>(2 * i));
+    PutLe32(&data, 0);
+    frame_offsets->push_back(data.size());
+    PutPayload(&data, kSizes[i]);
+  }
+  return data;
+}
+
+// A Section 5 OBU stream, or an Annex B one if annexb is true, with a
+// Temporal Unit for each size in kSizes: a Temporal Delimiter followed by a
+// padding OBU of that size. Sets tu_offsets to the offset of each Temporal
+// Unit and of the end of the stream.
+Bytes MakeObu(bool annexb, std::vector<size_t> *tu_offsets) {
+  Bytes data;
+  for (size_t size : kSizes) {
+    tu_offsets->push_back(data.size());
+    Bytes padding = { 0x7a };  // OBU_PADDING with a size field.
+    PutLeb128(&padding, size);
+    PutPayload(&padding, size);
+    if (annexb) {
+      // Annex B OBUs have no size field: the OBU length comes first.
+      padding[0] = 0x78;
+      padding.erase(padding.begin() + 1,
+                    padding.end() - static_cast<ptrdiff_t>(size));
+      Bytes frame_unit;
+      frame_unit.push_back(1);
+      frame_unit.push_back(0x10);  // Temporal Delimiter.
+      PutLeb128(&frame_unit, padding.size());
+      frame_unit.insert(frame_unit.end(), padding.begin(), padding.end());
+      Bytes tu;
+      PutLeb128(&tu, frame_unit.size());
+      tu.insert(tu.end(), frame_unit.begin(), frame_unit.end());
+      PutLeb128(&data, tu.size());
+      data.insert(data.end(), tu.begin(), tu.end());
+    } else {
+      data.push_back(0x12);  // Temporal Delimiter with a size field.
+      data.push_back(0);
+      data.insert(data.end(), padding.begin(), padding.end());
+    }
+  }
+  tu_offsets->push_back(data.size());
+  return data;
+}
+
+// Maps the first size bytes of data as an input file would be.
+void MapData(const Bytes &data, size_t size, AvxInputContext *input) {
+  *input = {};
+  input->mapped_data = data.data();
+  input->mapped_size = size;
+}
+
+TEST(MappedInputTest, IvfFrames) {
+  std::vector<size_t> frame_offsets;
+  const Bytes data = MakeIvf(&frame_offsets);
+  AvxInputContext input;
+  MapData(data, data.size(), &input);
+  ASSERT_TRUE(file_is_ivf(&input));
+  EXPECT_EQ(input.width, 64u);
+  EXPECT_EQ(input.height, 256u);
+  for (size_t i = 0; i < kNumSizes; ++i) {
+    const uint8_t *frame = nullptr;
+    size_t size = 0;
+    aom_codec_pts_t pts = 0;
+    ASSERT_EQ(ivf_map_frame(&input, &frame, &size, &pts), 0) << "frame " << i;
+    EXPECT_EQ(frame, data.data() + frame_offsets[i]);
+    EXPECT_EQ(size, kSizes[i]);
+    EXPECT_EQ(pts, static_cast<aom_codec_pts_t>(2 * i));
+  }
+  EXPECT_TRUE(input_eof(&input));
+  const uint8_t *frame = nullptr;
+  size_t size = 0;
+  EXPECT_EQ(ivf_map_frame(&input, &frame, &size, nullptr), 1);
+}
+
+// A file cut anywhere in the last frame or its header yields every frame
+// before it, and then fails without reading past the end.
+TEST(MappedInputTest, IvfTruncated) {
+  std::vector<size_t> frame_offsets;
+  const Bytes data = MakeIvf(&frame_offsets);
+  const size_t last_header = frame_offsets[kNumSizes - 1] - 12;
+  for (size_t end = last_header + 1; end < data.size(); end += 5) {
+    AvxInputContext input;
+    MapData(data, end, &input);
+    ASSERT_TRUE(file_is_ivf(&input));
+    const uint8_t *frame = nullptr;
+    size_t size = 0;
+    for (size_t i = 0; i + 1 < kNumSizes; ++i) {
+      ASSERT_EQ(ivf_map_frame(&input, &frame, &size, nullptr), 0)
+          << "end " << end << " frame " << i;
+      EXPECT_EQ(size, kSizes[i]);
+    }
+    EXPECT_EQ(ivf_map_frame(&input, &frame, &size, nullptr), 1)
+        << "end " << end;
+  }
+}
+
+// The real mapping of a file whose size is not a multiple of the page size.
+TEST(MappedInputTest, IvfFile) {
+  std::vector<size_t> frame_offsets;
+  const Bytes data = MakeIvf(&frame_offsets);
+  libaom_test::TempOutFile tmp;
+  ASSERT_NE(tmp.file(), nullptr);
+  ASSERT_EQ(fwrite(data.data(), 1, data.size(), tmp.file()), data.size());
+  ASSERT_EQ(fflush(tmp.file()), 0);
+
+  AvxInputContext input = {};
+  input.file = fopen(tmp.file_name().c_str(), "rb");
+  ASSERT_NE(input.file, nullptr);
+  ASSERT_TRUE(file_is_ivf(&input));
+  if (!input_map_file(&input)) {
+    fclose(input.file);
+    GTEST_SKIP() << "Input files cannot be mapped";
+  }
+  for (size_t i = 0; i < kNumSizes; ++i) {
+    const uint8_t *frame = nullptr;
+    size_t size = 0;
+    ASSERT_EQ(ivf_map_frame(&input, &frame, &size, nullptr), 0) << "frame " << i;
+    EXPECT_EQ(Bytes(frame, frame + size),
+              Bytes(data.begin() + frame_offsets[i],
+                    data.begin() + frame_offsets[i] + kSizes[i]));
+  }
+  EXPECT_TRUE(input_eof(&input));
+  input_unmap_file(&input);
+  fclose(input.file);
+}
+
+class MappedObuTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(MappedObuTest, TemporalUnits) {
+  const bool annexb = GetParam();
+  std::vector<size_t> tu_offsets;
+  const Bytes data = MakeObu(annexb, &tu_offsets);
+  AvxInputContext input;
+  MapData(data, data.size(), &input);
+  ObuDecInputContext obu_ctx = { &input, nullptr, 0, 0, annexb };
+  ASSERT_TRUE(file_is_obu(&obu_ctx));
+  for (size_t i = 0; i < kNumSizes; ++i) {
+    const uint8_t *tu = nullptr;
+    size_t size = 0;
+    ASSERT_EQ(obudec_map_temporal_unit(&obu_ctx, &tu, &size), 0)
+        << "temporal unit " << i;
+    EXPECT_EQ(tu, data.data() + tu_offsets[i]);
+    EXPECT_EQ(size, tu_offsets[i + 1] - tu_offsets[i]);
+  }
+  const uint8_t *tu = nullptr;
+  size_t size = 0;
+  EXPECT_EQ(obudec_map_temporal_unit(&obu_ctx, &tu, &size), 1);
+  EXPECT_EQ(size, 0u);
+  obudec_free(&obu_ctx);
+}
+
+// A stream cut inside the padding OBU of its last Temporal Unit yields every
+// Temporal Unit before it, and then fails without reading past the end. A
+// Section 5 Temporal Unit ends at the next Temporal Delimiter, so the cut is
+// after the one that starts the last Temporal Unit.
+TEST_P(MappedObuTest, Truncated) {
+  const bool annexb = GetParam();
+  std::vector<size_t> tu_offsets;
+  const Bytes data = MakeObu(annexb, &tu_offsets);
+  for (size_t end = tu_offsets[kNumSizes - 1] + 3; end < data.size();
+       end += 5) {
+    AvxInputContext input;
+    MapData(data, end, &input);
+    ObuDecInputContext obu_ctx = { &input, nullptr, 0, 0, annexb };
+    ASSERT_TRUE(file_is_obu(&obu_ctx)) << "end " << end;
+    const uint8_t *tu = nullptr;
+    size_t size = 0;
+    for (size_t i = 0; i + 1 < kNumSizes; ++i) {
+      ASSERT_EQ(obudec_map_temporal_unit(&obu_ctx, &tu, &size), 0)
+          << "end " << end << " temporal unit " << i;
+      EXPECT_EQ(size, tu_offsets[i + 1] - tu_offsets[i]);
+    }
+    EXPECT_LT(obudec_map_temporal_unit(&obu_ctx, &tu, &size), 0)
+        << "end " << end;
+    obudec_free(&obu_ctx);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AV1, MappedObuTest, ::testing::Bool());
+
+}  // namespace
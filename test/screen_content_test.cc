@@ -8,12 +8,23 @@
  * Media Patent License 1.0 was not distributed with this source code in the
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "config/aom_dsp_rtcd.h"
+
 #include "aom/aom_codec.h"
+#include "av1/encoder/encoder.h"
 #include "gtest/gtest.h"
+#include "test/acm_random.h"
 #include "test/codec_factory.h"
 #include "test/encode_test_driver.h"
 #include "test/y4m_video_source.h"
 #include "test/util.h"
+#include "test/video_source.h"
 
 namespace {
 // This class is used to validate if screen_content_tools are turned on
@@ -132,4 +143,231 @@ AV1_INSTANTIATE_TEST_SUITE(ScreenContentToolsMultiThreadTestLarge,
                            ::testing::Values(::libaom_test::kOnePassGood,
                                              ::libaom_test::kTwoPassGood),
                            ::testing::Values(AOM_Q));
+
+// Text scrolling up by kScrollRows rows per frame, further than the regular
+// motion search reaches.
+class ScrollingTextSource : public ::libaom_test::VideoSource {
+ public:
+  static constexpr int kWidth = 320;
+  static constexpr int kHeight = 192;
+  static constexpr int kScrollRows = 37;
+
+  explicit ScrollingTextSource(int limit) : limit_(limit), frame_(0) {
+    const int canvas_height = kHeight + kScrollRows * limit;
+    canvas_.assign(static_cast<size_t>(kWidth) * canvas_height, 255);
+    ::libaom_test::ACMRandom rnd(::libaom_test::ACMRandom::DeterministicSeed());
+    // Lines of 6x10 glyphs of random dots, with 4 pixels between glyphs
+    // and 6 rows between lines.
+    for (int y = 4; y + 10 <= canvas_height; y += 16) {
+      for (int x = 4; x + 6 <= kWidth; x += 10) {
+        if (rnd(8) == 0) continue;
+        for (int r = 0; r < 10; ++r) {
+          for (int c = 0; c < 6; ++c) {
+            if (rnd(3) == 0) canvas_[(y + r) * kWidth + x + c] = 16;
+          }
+        }
+      }
+    }
+    aom_img_alloc(&img_, AOM_IMG_FMT_I420, kWidth, kHeight, 32);
+  }
+  ~ScrollingTextSource() override { aom_img_free(&img_); }
+
+  void Begin() override {
+    frame_ = 0;
+    FillFrame();
+  }
+  void Next() override {
+    ++frame_;
+    FillFrame();
+  }
+  aom_image_t *img() const override {
+    return frame_ < limit_ ? const_cast<aom_image_t *>(&img_) : nullptr;
+  }
+  aom_codec_pts_t pts() const override { return frame_; }
+  unsigned long duration() const override { return 1; }
+  aom_rational_t timebase() const override { return { 1, 30 }; }
+  unsigned int frame() const override { return frame_; }
+  unsigned int limit() const override { return limit_; }
+
+ private:
+  void FillFrame() {
+    if (frame_ >= limit_) return;
+    const uint8_t *const src = &canvas_[frame_ * kScrollRows * kWidth];
+    for (int r = 0; r < kHeight; ++r) {
+      memcpy(img_.planes[0] + r * img_.stride[0], src + r * kWidth, kWidth);
+    }
+    for (int plane = 1; plane < 3; ++plane) {
+      for (int r = 0; r < kHeight / 2; ++r) {
+        memset(img_.planes[plane] + r * img_.stride[plane], 128, kWidth / 2);
+      }
+    }
+  }
+
+  unsigned int limit_;
+  unsigned int frame_;
+  std::vector<uint8_t> canvas_;
+  aom_image_t img_;
+};
+
+// Checks that the inter hash motion search finds the scrolled text: each inter
+// frame then costs less than the key frame, where it costs about twice as much
+// without the hash search. The decoder checks that its output matches the
+// encoder's reconstruction.
+class InterHashMotionSearchTest
+    : public ::libaom_test::CodecTestWith2Params<libaom_test::TestMode, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  InterHashMotionSearchTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        cpu_used_(GET_PARAM(2)) {}
+  ~InterHashMotionSearchTest() override = default;
+
+  void SetUp() override {
+    InitializeConfig(encoding_mode_);
+    cfg_.rc_end_usage = AOM_Q;
+    cfg_.g_threads = 1;
+  }
+
+  void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                          ::libaom_test::Encoder *encoder) override {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, cpu_used_);
+      encoder->Control(AOME_SET_CQ_LEVEL, 30);
+      encoder->Control(AV1E_SET_TUNE_CONTENT, AOM_CONTENT_SCREEN);
+    }
+  }
+
+  void FramePktHook(const aom_codec_cx_pkt_t *pkt) override {
+    frame_sizes_.push_back(pkt->data.frame.sz);
+  }
+
+  ::libaom_test::TestMode encoding_mode_;
+  int cpu_used_;
+  std::vector<size_t> frame_sizes_;
+};
+
+TEST_P(InterHashMotionSearchTest, FindsScrolledText) {
+  constexpr int kNumFrames = 6;
+  ScrollingTextSource video(kNumFrames);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  ASSERT_EQ(frame_sizes_.size(), static_cast<size_t>(kNumFrames));
+  for (int i = 1; i < kNumFrames; ++i) {
+    EXPECT_LT(frame_sizes_[i], frame_sizes_[0]) << "frame " << i;
+  }
+}
+
+// Speed 5 is the fastest realtime speed that uses the hash search.
+AV1_INSTANTIATE_TEST_SUITE(InterHashMotionSearchTest,
+                           ::testing::Values(::libaom_test::kRealTime),
+                           ::testing::Values(5));
+
+// Synthetic content for the screen content detection, from clear screen
+// content to clear camera content.
+enum class DetectContent {
+  kText,           // Black glyphs on white.
+  kRectangles,     // Overlapping flat rectangles of a few colors.
+  kTextOverNoise,  // Text above noise, with more text in every frame.
+  kGradient,       // A smooth gradient with a little noise.
+  kNoise,          // Uniform noise.
+};
+
+// Fills the luma plane of img with frame frame of content.
+void FillDetectContent(DetectContent content, int frame, aom_image_t *img) {
+  const int width = static_cast<int>(img->d_w);
+  const int height = static_cast<int>(img->d_h);
+  uint8_t *const y = img->planes[AOM_PLANE_Y];
+  const int stride = img->stride[AOM_PLANE_Y];
+  ::libaom_test::ACMRandom rnd(
+      ::libaom_test::ACMRandom::DeterministicSeed() + frame);
+  // The rows of text for kTextOverNoise grow from none to the whole frame.
+  const int text_rows = content == DetectContent::kText ? height
+                        : content == DetectContent::kTextOverNoise
+                            ? frame * height / 9
+                            : 0;
+  for (int r = 0; r < height; ++r) {
+    for (int c = 0; c < width; ++c) {
+      uint8_t value;
+      if (r < text_rows || content == DetectContent::kRectangles) {
+        value = 255;
+      } else if (content == DetectContent::kGradient) {
+        value = static_cast<uint8_t>(
+            std::min(255, (r + c + 4 * frame) / 2 + static_cast<int>(rnd(8))));
+      } else {
+        value = rnd.Rand8();
+      }
+      y[r * stride + c] = value;
+    }
+  }
+  if (content == DetectContent::kRectangles) {
+    static const uint8_t kColors[] = { 16, 64, 128, 200 };
+    for (int i = 0; i < 24; ++i) {
+      const int x0 = rnd(width - 8);
+      const int y0 = rnd(height - 8);
+      const int w = 8 + rnd(width - x0 - 7);
+      const int h = 8 + rnd(height - y0 - 7);
+      const uint8_t color = kColors[rnd(4)];
+      for (int r = y0; r < y0 + h; ++r) memset(y + r * stride + x0, color, w);
+    }
+  }
+  // Lines of 6x10 glyphs of random dots, as in ScrollingTextSource.
+  for (int r0 = 4; r0 + 10 <= text_rows; r0 += 16) {
+    for (int c0 = 4; c0 + 6 <= width; c0 += 10) {
+      if (rnd(8) == 0) continue;
+      for (int r = 0; r < 10; ++r) {
+        for (int c = 0; c < 6; ++c) {
+          if (rnd(3) == 0) y[(r0 + r) * stride + c0 + c] = 16;
+        }
+      }
+    }
+  }
+}
+
+// Checks that the sampled screen content detection makes the same decisions
+// as the scan of every block.
+class ScreenContentDetectionTest
+    : public ::testing::TestWithParam<DetectContent> {
+ protected:
+  static ScreenContentDecision Detect(const aom_image_t *img, bool sampled) {
+    static const uint8_t kFlat[SC_DETECT_BLOCK_SIZE] = {
+      128, 128, 128, 128, 128, 128, 128, 128,
+      128, 128, 128, 128, 128, 128, 128, 128,
+    };
+    const ScreenContentSource source = {
+      img->planes[AOM_PLANE_Y], img->stride[AOM_PLANE_Y],
+      static_cast<int>(img->d_w), static_cast<int>(img->d_h),
+      /*use_hbd=*/0, /*bit_depth=*/8, aom_variance16x16, kFlat,
+    };
+    ScreenContentDecision decision;
+    av1_detect_screen_content(/*cpi=*/nullptr, &source,
+                              sampled ? SC_DETECT_SAMPLED : SC_DETECT_FULL,
+                              &decision);
+    return decision;
+  }
+};
+
+TEST_P(ScreenContentDetectionTest, SampledMatchesFullScan) {
+  // Odd sizes, so that the frame does not end on a whole block.
+  aom_image_t *const img =
+      aom_img_alloc(nullptr, AOM_IMG_FMT_I420, 638, 358, 32);
+  ASSERT_NE(img, nullptr);
+  for (int frame = 0; frame < 10; ++frame) {
+    FillDetectContent(GetParam(), frame, img);
+    const ScreenContentDecision full = Detect(img, false);
+    const ScreenContentDecision sampled = Detect(img, true);
+    EXPECT_EQ(full.allow_screen_content_tools,
+              sampled.allow_screen_content_tools)
+        << "frame " << frame;
+    EXPECT_EQ(full.allow_intrabc, sampled.allow_intrabc) << "frame " << frame;
+    EXPECT_EQ(full.is_screen_content_type, sampled.is_screen_content_type)
+        << "frame " << frame;
+  }
+  aom_img_free(img);
+}
+
+INSTANTIATE_TEST_SUITE_P(AV1, ScreenContentDetectionTest,
+                         ::testing::Values(DetectContent::kText,
+                                           DetectContent::kRectangles,
+                                           DetectContent::kTextOverNoise,
+                                           DetectContent::kGradient,
+                                           DetectContent::kNoise));
 }  // namespace
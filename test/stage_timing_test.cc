@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "aom/aom_decoder.h"
+#include "aom/aom_encoder.h"
+#include "aom/aomcx.h"
+#include "aom/aomdx.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/util.h"
+#include "test/video_source.h"
+
+namespace {
+
+constexpr int kWidth = 352;
+constexpr int kHeight = 288;
+constexpr int kNumFrames = 8;
+
+// The frame packets of a bitstream.
+using Frames = std::vector<std::vector<uint8_t>>;
+
+class StageTimingTest
+    : public ::libaom_test::CodecTestWith2Params<libaom_test::TestMode, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  StageTimingTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        cpu_used_(GET_PARAM(2)) {}
+  ~StageTimingTest() override = default;
+
+  void SetUp() override {
+    InitializeConfig(encoding_mode_);
+    cfg_.rc_target_bitrate = 300;
+    if (encoding_mode_ == ::libaom_test::kOnePassGood) {
+      cfg_.g_lag_in_frames = 6;
+    }
+  }
+
+  void BeginPassHook(unsigned int /*pass*/) override {
+    frames_.clear();
+    timings_ = {};
+    for (int64_t &sum : sum_us_) sum = 0;
+    num_calls_ = 0;
+  }
+
+  void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                          ::libaom_test::Encoder *encoder) override {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, cpu_used_);
+      encoder->Control(AV1E_SET_STAGE_TIMING, stage_timing_);
+    }
+  }
+
+  void PostEncodeFrameHook(::libaom_test::Encoder *encoder) override {
+    ++num_calls_;
+    if (!stage_timing_) return;
+    encoder->Control(AV1E_GET_STAGE_TIMINGS, &timings_);
+    for (int stage = 0; stage < AOM_ENC_STAGE_COUNT; ++stage) {
+      EXPECT_GE(timings_.frame_us[stage], 0);
+      EXPECT_LE(timings_.frame_us[stage], timings_.total_us[stage]);
+      sum_us_[stage] += timings_.frame_us[stage];
+    }
+  }
+
+  void FramePktHook(const aom_codec_cx_pkt_t *pkt) override {
+    const uint8_t *const buf = static_cast<const uint8_t *>(pkt->data.frame.buf);
+    frames_.emplace_back(buf, buf + pkt->data.frame.sz);
+  }
+
+  // Encodes kNumFrames frames into frames_, with stage timing enabled if
+  // stage_timing is true.
+  void Encode(bool stage_timing) {
+    stage_timing_ = stage_timing;
+    ::libaom_test::RandomVideoSource video;
+    video.SetSize(kWidth, kHeight);
+    video.set_limit(kNumFrames);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+    if (stage_timing) {
+      // The totals are the sums of the per-call times, give or take the
+      // rounding of each call down to microseconds.
+      for (int stage = 0; stage < AOM_ENC_STAGE_COUNT; ++stage) {
+        EXPECT_LE(sum_us_[stage], timings_.total_us[stage]);
+        EXPECT_GE(sum_us_[stage] + num_calls_, timings_.total_us[stage]);
+      }
+    }
+  }
+
+  ::libaom_test::TestMode encoding_mode_;
+  int cpu_used_;
+  int stage_timing_ = 0;
+  Frames frames_;
+  aom_enc_stage_timings_t timings_ = {};
+  int64_t sum_us_[AOM_ENC_STAGE_COUNT] = {};
+  int num_calls_ = 0;
+};
+
+// Checks that stage timing leaves the bitstream unchanged and accounts for
+// the stages every encode goes through, and that the decoder reports its
+// own stages.
+TEST_P(StageTimingTest, EncodeAndDecode) {
+  ASSERT_NO_FATAL_FAILURE(Encode(/*stage_timing=*/false));
+  const Frames untimed = frames_;
+  ASSERT_NO_FATAL_FAILURE(Encode(/*stage_timing=*/true));
+  EXPECT_EQ(untimed, frames_);
+  EXPECT_GT(timings_.total_us[AOM_ENC_STAGE_RD], 0);
+  EXPECT_GT(timings_.total_us[AOM_ENC_STAGE_PACK], 0);
+  if (encoding_mode_ != ::libaom_test::kAllIntra) {
+    EXPECT_GT(timings_.total_us[AOM_ENC_STAGE_MOTION_SEARCH], 0);
+  }
+  if (encoding_mode_ == ::libaom_test::kOnePassGood) {
+    EXPECT_GT(timings_.total_us[AOM_ENC_STAGE_TPL], 0);
+  }
+
+  aom_codec_ctx_t dec;
+  ASSERT_EQ(aom_codec_dec_init(&dec, aom_codec_av1_dx(), nullptr, 0),
+            AOM_CODEC_OK);
+  aom_dec_stage_timings_t dec_timings;
+  EXPECT_EQ(aom_codec_control(&dec, AV1D_GET_STAGE_TIMINGS, &dec_timings),
+            AOM_CODEC_INCAPABLE);
+  ASSERT_EQ(aom_codec_control(&dec, AV1D_SET_STAGE_TIMING, 1u), AOM_CODEC_OK);
+  for (const std::vector<uint8_t> &frame : frames_) {
+    ASSERT_EQ(aom_codec_decode(&dec, frame.data(), frame.size(), nullptr),
+              AOM_CODEC_OK);
+    ASSERT_EQ(aom_codec_control(&dec, AV1D_GET_STAGE_TIMINGS, &dec_timings),
+              AOM_CODEC_OK);
+    for (int stage = 0; stage < AOM_DEC_STAGE_COUNT; ++stage) {
+      EXPECT_GE(dec_timings.frame_us[stage], 0);
+      EXPECT_LE(dec_timings.frame_us[stage], dec_timings.total_us[stage]);
+    }
+  }
+  EXPECT_GT(dec_timings.total_us[AOM_DEC_STAGE_PARSE], 0);
+  EXPECT_GT(dec_timings.total_us[AOM_DEC_STAGE_RECON], 0);
+  EXPECT_EQ(aom_codec_destroy(&dec), AOM_CODEC_OK);
+}
+
+AV1_INSTANTIATE_TEST_SUITE(StageTimingTest,
+                           ::testing::Values(::libaom_test::kOnePassGood,
+                                             ::libaom_test::kRealTime,
+                                             ::libaom_test::kAllIntra),
+                           ::testing::Values(6, 9));
+
+// The timings can only be read while stage timing is enabled.
+TEST(StageTimingControlTest, GetRequiresEnable) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  ASSERT_EQ(aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_REALTIME),
+            AOM_CODEC_OK);
+  aom_codec_ctx_t enc;
+  ASSERT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  aom_enc_stage_timings_t timings;
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_GET_STAGE_TIMINGS, &timings),
+            AOM_CODEC_INCAPABLE);
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_SET_STAGE_TIMING, 1u), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_GET_STAGE_TIMINGS, &timings),
+            AOM_CODEC_OK);
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_SET_STAGE_TIMING, 0u), AOM_CODEC_OK);
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_GET_STAGE_TIMINGS, &timings),
+            AOM_CODEC_INCAPABLE);
+  EXPECT_EQ(aom_codec_control(&enc, AV1E_SET_STAGE_TIMING, 2u),
+            AOM_CODEC_INVALID_PARAM);
+  EXPECT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+}
+
+}  // namespace
@@ -54,6 +54,7 @@ list(APPEND AOM_UNIT_TEST_DECODER_SOURCES "${AOM_ROOT}/test/decode_api_test.cc"
             "${AOM_ROOT}/test/decode_scalability_test.cc"
             "${AOM_ROOT}/test/external_frame_buffer_test.cc"
             "${AOM_ROOT}/test/invalid_file_test.cc"
+            "${AOM_ROOT}/test/mapped_input_test.cc"
             "${AOM_ROOT}/test/test_vector_test.cc"
             "${AOM_ROOT}/test/ivf_video_source.h")
 add_to_libaom_test_srcs(AOM_UNIT_TEST_DECODER_SOURCES)
@@ -61,6 +62,7 @@ add_to_libaom_test_srcs(AOM_UNIT_TEST_DECODER_SOURCES)
 list(APPEND AOM_UNIT_TEST_ENCODER_SOURCES
             "${AOM_ROOT}/test/active_map_test.cc"
             "${AOM_ROOT}/test/aq_segment_test.cc"
+            "${AOM_ROOT}/test/async_io_test.cc"
             "${AOM_ROOT}/test/av1_external_partition_test.cc"
             "${AOM_ROOT}/test/avif_progressive_test.cc"
             "${AOM_ROOT}/test/borders_test.cc"
@@ -98,6 +100,7 @@ list(APPEND AOM_UNIT_TEST_ENCODER_SOURCES
 add_to_libaom_test_srcs(AOM_UNIT_TEST_ENCODER_SOURCES)
 
 list(APPEND AOM_ENCODE_PERF_TEST_SOURCES "${AOM_ROOT}/test/encode_perf_test.cc")
+list(APPEND AOM_ENCODER_STATS_TEST_SOURCES "${AOM_ROOT}/test/aomstats_test.cc")
 list(APPEND AOM_UNIT_TEST_WEBM_SOURCES "${AOM_ROOT}/test/webm_video_source.h")
 add_to_libaom_test_srcs(AOM_UNIT_TEST_WEBM_SOURCES)
 list(APPEND AOM_TEST_INTRA_PRED_SPEED_SOURCES
@@ -256,6 +259,7 @@ if(NOT BUILD_SHARED_LIBS)
                 "${AOM_ROOT}/test/binary_codes_test.cc"
                 "${AOM_ROOT}/test/boolcoder_test.cc"
                 "${AOM_ROOT}/test/cnn_test.cc"
+                "${AOM_ROOT}/test/codec_allocator_test.cc"
                 "${AOM_ROOT}/test/decode_multithreaded_test.cc"
                 "${AOM_ROOT}/test/divu_small_test.cc"
                 "${AOM_ROOT}/test/dr_prediction_test.cc"
@@ -272,11 +276,13 @@ if(NOT BUILD_SHARED_LIBS)
                 "${AOM_ROOT}/test/sb_qp_sweep_test.cc"
                 "${AOM_ROOT}/test/screen_content_test.cc"
                 "${AOM_ROOT}/test/segment_binarization_sync.cc"
+                "${AOM_ROOT}/test/stage_timing_test.cc"
                 "${AOM_ROOT}/test/still_picture_test.cc"
                 "${AOM_ROOT}/test/temporal_filter_test.cc"
                 "${AOM_ROOT}/test/tile_config_test.cc"
                 "${AOM_ROOT}/test/tile_independence_test.cc"
-                "${AOM_ROOT}/test/tpl_model_test.cc")
+                "${AOM_ROOT}/test/tpl_model_test.cc"
+                "${AOM_ROOT}/test/zero_copy_input_test.cc")
     if(CONFIG_AV1_HIGHBITDEPTH)
       list(APPEND AOM_UNIT_TEST_COMMON_SOURCES
                   "${AOM_ROOT}/test/coding_path_sync.cc")
@@ -484,6 +490,11 @@ function(setup_aom_test_targets)
       target_sources(test_libaom PRIVATE ${AOM_ENCODE_PERF_TEST_SOURCES})
     endif()
 
+    if(ENABLE_EXAMPLES)
+      target_sources(test_libaom PRIVATE ${AOM_ENCODER_STATS_TEST_SOURCES}
+                     $<TARGET_OBJECTS:aom_encoder_stats>)
+    endif()
+
     if(NOT BUILD_SHARED_LIBS)
       add_executable(test_intra_pred_speed ${AOM_TEST_INTRA_PRED_SPEED_SOURCES}
                                            $<TARGET_OBJECTS:aom_common_app_util>
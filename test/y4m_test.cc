@@ -9,12 +9,15 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <cstdio>
 #include <string>
 
 #include "config/aom_config.h"
 
+#include "aom_ports/aom_timer.h"
 #include "common/y4menc.h"
 #include "gtest/gtest.h"
+#include "test/acm_random.h"
 #include "test/md5_helper.h"
 #include "test/util.h"
 #include "test/y4m_video_source.h"
@@ -261,6 +264,126 @@ TEST(Y4MHeaderTest, FullRangeHeader) {
   y4m_input_close(&y4m);
 }
 
+static const char kY4MTwoFrames[] =
+    "YUV4MPEG2 W4 H4 F30:1 Ip A0:0 C420jpeg\n"
+    "FRAME\n"
+    "012345678912345601230123"
+    "FRAME Ixyz\n"
+    "abcdefghijklmnopqrstuvwx";
+
+// Frames read from the file in memory point into it and match the fetched
+// ones.
+TEST(Y4MHeaderTest, MapFrame) {
+  libaom_test::TempOutFile tmpfile;
+  FILE *f = tmpfile.file();
+  ASSERT_NE(f, nullptr);
+  const size_t size = sizeof(kY4MTwoFrames) - 1;
+  fwrite(kY4MTwoFrames, 1, size, f);
+  fflush(f);
+  EXPECT_EQ(fseek(f, 0, 0), 0);
+
+  y4m_input y4m;
+  ASSERT_EQ(y4m_input_open(&y4m, f, nullptr, 0, AOM_CSP_UNKNOWN,
+                           /*only_420=*/0),
+            0);
+  EXPECT_EQ(y4m_input_can_map(&y4m), 1);
+  const unsigned char *const data =
+      reinterpret_cast<const unsigned char *>(kY4MTwoFrames);
+  size_t pos = static_cast<size_t>(ftell(f));
+  for (int frame = 0; frame < 2; ++frame) {
+    aom_image_t fetched;
+    aom_image_t mapped;
+    ASSERT_EQ(y4m_input_fetch_frame(&y4m, f, &fetched), 1);
+    ASSERT_EQ(y4m_input_map_frame(&y4m, data, size, &pos, &mapped), 1);
+    EXPECT_GE(mapped.planes[0], data);
+    EXPECT_LT(mapped.planes[2], data + size);
+    for (int plane = 0; plane < 3; ++plane) {
+      EXPECT_EQ(mapped.stride[plane], fetched.stride[plane]);
+      EXPECT_EQ(memcmp(mapped.planes[plane], fetched.planes[plane],
+                       plane ? 4 : 16),
+                0);
+    }
+  }
+  aom_image_t img;
+  EXPECT_EQ(y4m_input_map_frame(&y4m, data, size, &pos, &img), 0);
+  EXPECT_EQ(pos, size);
+  y4m_input_close(&y4m);
+}
+
+// The chroma types that are converted to 4:2:0 when only_420 is set.
+const char *const kY4mConvertedChromaTypes[] = { "420paldv", "422jpeg", "422",
+                                                 "411", "444" };
+
+class Y4mConvertTest : public ::testing::TestWithParam<const char *> {
+ protected:
+  // Opens a header for a w x h input of the chroma type under test.
+  void Open(y4m_input *y4m, int w, int h) {
+    libaom_test::TempOutFile tmpfile;
+    ASSERT_NE(tmpfile.file(), nullptr);
+    fprintf(tmpfile.file(), "YUV4MPEG2 W%d H%d F30:1 Ip C%s\n", w, h,
+            GetParam());
+    fflush(tmpfile.file());
+    rewind(tmpfile.file());
+    ASSERT_EQ(y4m_input_open(y4m, tmpfile.file(), nullptr, 0, AOM_CSP_UNKNOWN,
+                             /*only_420=*/1),
+              0);
+  }
+};
+
+// Splitting the conversion across threads does not change its output, for
+// each of several frames converted by the same pool of threads.
+TEST_P(Y4mConvertTest, ThreadsMatch) {
+  libaom_test::ACMRandom rnd(libaom_test::ACMRandom::DeterministicSeed());
+  for (const int size : { 1, 7, 66, 353 }) {
+    y4m_input single;
+    y4m_input threaded;
+    Open(&single, size, size + 3);
+    Open(&threaded, size, size + 3);
+    threaded.num_threads = 4;
+    for (int frame = 0; frame < 3; ++frame) {
+      for (size_t i = 0; i < single.aux_buf_read_sz; ++i) {
+        single.aux_buf[i] = threaded.aux_buf[i] = rnd.Rand8();
+      }
+      single.convert(&single, single.dst_buf, single.aux_buf);
+      threaded.convert(&threaded, threaded.dst_buf, threaded.aux_buf);
+      // The luma is read directly into the frame buffer, not converted.
+      const size_t luma_sz = single.dst_buf_read_sz;
+      EXPECT_EQ(memcmp(single.dst_buf + luma_sz, threaded.dst_buf + luma_sz,
+                       single.dst_buf_sz - luma_sz),
+                0)
+          << size << " frame " << frame;
+    }
+    y4m_input_close(&single);
+    y4m_input_close(&threaded);
+  }
+}
+
+TEST_P(Y4mConvertTest, DISABLED_Speed) {
+  const int kNumFrames = 20;
+  libaom_test::ACMRandom rnd(libaom_test::ACMRandom::DeterministicSeed());
+  for (const int num_threads : { 1, 4 }) {
+    y4m_input y4m;
+    Open(&y4m, 3840, 2160);
+    y4m.num_threads = num_threads;
+    for (size_t i = 0; i < y4m.aux_buf_read_sz; ++i) {
+      y4m.aux_buf[i] = rnd.Rand8();
+    }
+    aom_usec_timer timer;
+    aom_usec_timer_start(&timer);
+    for (int i = 0; i < kNumFrames; ++i) {
+      y4m.convert(&y4m, y4m.dst_buf, y4m.aux_buf);
+    }
+    aom_usec_timer_mark(&timer);
+    const double elapsed = static_cast<double>(aom_usec_timer_elapsed(&timer));
+    printf("%s 3840x2160, %d thread(s): %7.2f ms/frame\n", GetParam(),
+           num_threads, elapsed / 1000 / kNumFrames);
+    y4m_input_close(&y4m);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(C, Y4mConvertTest,
+                         ::testing::ValuesIn(kY4mConvertedChromaTypes));
+
 TEST(Y4MHeaderTest, WriteStudioColorRange) {
   char buf[128];
   struct AvxRational framerate = { /*numerator=*/30, /*denominator=*/1 };
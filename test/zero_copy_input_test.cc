@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2024, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "aom/aom_encoder.h"
+#include "aom/aomcx.h"
+#include "aom_ports/aom_timer.h"
+#include "test/acm_random.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/util.h"
+#include "test/video_source.h"
+
+namespace {
+
+// Not a multiple of 8, so the encoder extends the right and bottom edges by
+// more than its border.
+constexpr int kWidth = 346;
+constexpr int kHeight = 282;
+constexpr int kNumFrames = 10;
+
+// Random frames, each in an image of its own, as the encoder may hold on to
+// several of them. The images are allocated with a given border so that the
+// encoder can borrow them, and a copy of each frame is kept to check that
+// the encoder leaves them intact. Static frames repeat the first one with a
+// little noise, like a camera pointed at a still scene.
+class BorderedVideoSource : public ::libaom_test::VideoSource {
+ public:
+  BorderedVideoSource(int width, int height, int num_frames,
+                      bool static_content)
+      : width_(width), height_(height), static_content_(static_content),
+        images_(num_frames), frame_(0) {
+    Realloc(0);
+  }
+
+  ~BorderedVideoSource() override {
+    for (aom_image_t &img : images_) aom_img_free(&img);
+  }
+
+  // Reallocates the images with the given border and refills them.
+  void Realloc(unsigned int border) {
+    ::libaom_test::ACMRandom rnd(::libaom_test::ACMRandom::DeterministicSeed());
+    frames_.clear();
+    for (size_t i = 0; i < images_.size(); ++i) {
+      aom_image_t *const img = &images_[i];
+      aom_img_free(img);
+      ASSERT_NE(aom_img_alloc_with_border(img, AOM_IMG_FMT_I420, width_,
+                                          height_, 32, 8, border),
+                nullptr);
+      img->user_priv = reinterpret_cast<void *>(static_cast<intptr_t>(i));
+      std::vector<uint8_t> pixels;
+      size_t j = 0;
+      for (int plane = 0; plane < 3; ++plane) {
+        for (int r = 0; r < PlaneHeight(plane); ++r) {
+          uint8_t *const row = img->planes[plane] + r * img->stride[plane];
+          for (int c = 0; c < PlaneWidth(plane); ++c) {
+            if (static_content_ && i > 0) {
+              const int value = frames_[0][j++] + rnd(3) - 1;
+              row[c] = static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+            } else {
+              row[c] = rnd.Rand8();
+            }
+            pixels.push_back(row[c]);
+          }
+        }
+      }
+      frames_.push_back(pixels);
+    }
+  }
+
+  // Returns whether the image of the given frame still holds that frame.
+  bool Unchanged(int frame) const {
+    const aom_image_t *const img = &images_[frame];
+    size_t i = 0;
+    for (int plane = 0; plane < 3; ++plane) {
+      for (int r = 0; r < PlaneHeight(plane); ++r) {
+        const uint8_t *const row = img->planes[plane] + r * img->stride[plane];
+        for (int c = 0; c < PlaneWidth(plane); ++c) {
+          if (row[c] != frames_[frame][i++]) return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void Begin() override { frame_ = 0; }
+
+  void Next() override { ++frame_; }
+
+  aom_image_t *img() const override {
+    return frame_ < images_.size()
+               ? const_cast<aom_image_t *>(&images_[frame_])
+               : nullptr;
+  }
+
+  aom_codec_pts_t pts() const override { return frame_; }
+
+  unsigned long duration() const override { return 1; }
+
+  aom_rational_t timebase() const override {
+    const aom_rational_t t = { 1, 30 };
+    return t;
+  }
+
+  unsigned int frame() const override { return frame_; }
+
+  unsigned int limit() const override {
+    return static_cast<unsigned int>(images_.size());
+  }
+
+ protected:
+  int PlaneWidth(int plane) const { return plane ? (width_ + 1) >> 1 : width_; }
+  int PlaneHeight(int plane) const {
+    return plane ? (height_ + 1) >> 1 : height_;
+  }
+
+  int width_;
+  int height_;
+  bool static_content_;
+  std::vector<aom_image_t> images_;
+  std::vector<std::vector<uint8_t>> frames_;
+  unsigned int frame_;
+};
+
+void ReleaseInput(void *cb_priv, void *user_priv) {
+  std::vector<int> *const num_releases =
+      static_cast<std::vector<int> *>(cb_priv);
+  ++(*num_releases)[reinterpret_cast<intptr_t>(user_priv)];
+}
+
+struct EncodeResult {
+  std::vector<uint8_t> bitstream;
+  // Number of release callbacks per frame, and how many of them had been
+  // made by the time aom_codec_encode() returned.
+  std::vector<int> num_releases;
+  std::vector<int> num_releases_on_return;
+  int64_t encode_time_us;
+};
+
+class ZeroCopyInputTest
+    : public ::libaom_test::CodecTestWith2Params<libaom_test::TestMode, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  ZeroCopyInputTest()
+      : EncoderTest(GET_PARAM(0)), encoding_mode_(GET_PARAM(1)),
+        cpu_used_(GET_PARAM(2)) {}
+  ~ZeroCopyInputTest() override = default;
+
+  void SetUp() override {
+    InitializeConfig(encoding_mode_);
+    cfg_.rc_target_bitrate = 400;
+    if (encoding_mode_ == ::libaom_test::kOnePassGood) {
+      cfg_.g_lag_in_frames = 8;
+    }
+  }
+
+  // Once the encoder is set up, reallocates the images with the border of
+  // the lookahead buffers minus border_shrink_, and enables zero copy if
+  // zero_copy_ is set.
+  void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                          ::libaom_test::Encoder *encoder) override {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, cpu_used_);
+      int input_border;
+      encoder->Control(AV1E_GET_INPUT_BORDER, &input_border);
+      const unsigned int border = input_border - border_shrink_;
+      ASSERT_NO_FATAL_FAILURE(video_->Realloc(border));
+      if (zero_copy_) {
+        aom_zero_copy_input_t zero_copy_input = {
+          ReleaseInput, &result_->num_releases, border
+        };
+        encoder->Control(AV1E_SET_ZERO_COPY_INPUT, &zero_copy_input);
+      }
+    }
+    aom_usec_timer_start(&timer_);
+  }
+
+  void PostEncodeFrameHook(::libaom_test::Encoder * /*encoder*/) override {
+    aom_usec_timer_mark(&timer_);
+    result_->encode_time_us += aom_usec_timer_elapsed(&timer_);
+    const unsigned int frame = video_->frame();
+    if (frame < video_->limit()) {
+      result_->num_releases_on_return[frame] = result_->num_releases[frame];
+    }
+  }
+
+  void FramePktHook(const aom_codec_cx_pkt_t *pkt) override {
+    const uint8_t *const buf = static_cast<const uint8_t *>(pkt->data.frame.buf);
+    result_->bitstream.insert(result_->bitstream.end(), buf,
+                              buf + pkt->data.frame.sz);
+  }
+
+  // Encodes num_frames_ frames, each in its own image with the border of the
+  // lookahead buffers minus border_shrink. Zero copy is enabled if zero_copy
+  // is true.
+  void Encode(bool zero_copy, int border_shrink, EncodeResult *result) {
+    zero_copy_ = zero_copy;
+    border_shrink_ = border_shrink;
+    result_ = result;
+    result->bitstream.clear();
+    result->num_releases.assign(num_frames_, 0);
+    result->num_releases_on_return.assign(num_frames_, 0);
+    result->encode_time_us = 0;
+    BorderedVideoSource video(width_, height_, num_frames_, static_content_);
+    video_ = &video;
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+    video_ = nullptr;
+    for (int frame = 0; frame < num_frames_; ++frame) {
+      EXPECT_TRUE(video.Unchanged(frame)) << "frame " << frame;
+    }
+  }
+
+  ::libaom_test::TestMode encoding_mode_;
+  int cpu_used_;
+  int width_ = kWidth;
+  int height_ = kHeight;
+  int num_frames_ = kNumFrames;
+  bool static_content_ = false;
+  bool zero_copy_ = false;
+  int border_shrink_ = 0;
+  EncodeResult *result_ = nullptr;
+  BorderedVideoSource *video_ = nullptr;
+  aom_usec_timer timer_;
+};
+
+// Checks that borrowing the input images gives the same bitstream as copying
+// them, that the encoder leaves them intact, and that each is released once.
+TEST_P(ZeroCopyInputTest, MatchesCopiedInput) {
+  EncodeResult copied;
+  ASSERT_NO_FATAL_FAILURE(Encode(/*zero_copy=*/false, 0, &copied));
+  EncodeResult borrowed;
+  ASSERT_NO_FATAL_FAILURE(Encode(/*zero_copy=*/true, 0, &borrowed));
+  EXPECT_EQ(copied.bitstream, borrowed.bitstream);
+  EXPECT_EQ(borrowed.num_releases, std::vector<int>(kNumFrames, 1));
+  // The queue holds on to the images until they are released, except at the
+  // realtime speeds that filter the source in place: those copy it first.
+  const bool filters_source =
+      encoding_mode_ == ::libaom_test::kRealTime && cpu_used_ >= 7;
+  EXPECT_EQ(borrowed.num_releases_on_return[kNumFrames - 1],
+            filters_source ? 1 : 0);
+}
+
+// Static content makes the realtime encoder filter the source in place,
+// which must not reach the borrowed images.
+TEST_P(ZeroCopyInputTest, StaticContent) {
+  static_content_ = true;
+  num_frames_ = 30;
+  EncodeResult copied;
+  ASSERT_NO_FATAL_FAILURE(Encode(/*zero_copy=*/false, 0, &copied));
+  EncodeResult borrowed;
+  ASSERT_NO_FATAL_FAILURE(Encode(/*zero_copy=*/true, 0, &borrowed));
+  EXPECT_EQ(copied.bitstream, borrowed.bitstream);
+  EXPECT_EQ(borrowed.num_releases, std::vector<int>(num_frames_, 1));
+}
+
+// Images without enough padding are copied and released right away.
+TEST_P(ZeroCopyInputTest, SmallBorderIsCopied) {
+  EncodeResult copied;
+  ASSERT_NO_FATAL_FAILURE(Encode(/*zero_copy=*/false, 0, &copied));
+  EncodeResult small_border;
+  ASSERT_NO_FATAL_FAILURE(Encode(/*zero_copy=*/true, 16, &small_border));
+  EXPECT_EQ(copied.bitstream, small_border.bitstream);
+  EXPECT_EQ(small_border.num_releases_on_return,
+            std::vector<int>(kNumFrames, 1));
+  EXPECT_EQ(small_border.num_releases, std::vector<int>(kNumFrames, 1));
+}
+
+// Compares the time spent in aom_codec_encode() with copied and borrowed 720p
+// input. Each mode is encoded kNumRuns times and the fastest run is kept.
+TEST_P(ZeroCopyInputTest, DISABLED_Speed) {
+  constexpr int kNumRuns = 3;
+  width_ = 1280;
+  height_ = 720;
+  num_frames_ = 10;
+  int64_t best_us[2] = { INT64_MAX, INT64_MAX };
+  for (int run = 0; run < kNumRuns; ++run) {
+    for (int zero_copy = 0; zero_copy <= 1; ++zero_copy) {
+      EncodeResult result;
+      ASSERT_NO_FATAL_FAILURE(Encode(zero_copy != 0, 0, &result));
+      best_us[zero_copy] = std::min(best_us[zero_copy], result.encode_time_us);
+    }
+  }
+  printf("Copied input:   %7.1f us/frame\n",
+         static_cast<double>(best_us[0]) / num_frames_);
+  printf("Borrowed input: %7.1f us/frame\n",
+         static_cast<double>(best_us[1]) / num_frames_);
+}
+
+AV1_INSTANTIATE_TEST_SUITE(ZeroCopyInputTest,
+                           ::testing::Values(::libaom_test::kOnePassGood,
+                                             ::libaom_test::kRealTime,
+                                             ::libaom_test::kAllIntra),
+                           ::testing::Values(6, 9));
+
+// Images the encoder rejects are released once, right away; images rejected
+// by aom_codec_encode() before they reach the encoder are not.
+TEST(ZeroCopyInputControlTest, RejectedImagesAreReleased) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  ASSERT_EQ(aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_REALTIME),
+            AOM_CODEC_OK);
+  cfg.g_w = 64;
+  cfg.g_h = 64;
+  aom_codec_ctx_t enc;
+  ASSERT_EQ(aom_codec_enc_init(&enc, iface, &cfg, 0), AOM_CODEC_OK);
+  std::vector<int> num_releases(3, 0);
+  aom_zero_copy_input_t zero_copy_input = { ReleaseInput, &num_releases, 0 };
+  ASSERT_EQ(aom_codec_control(&enc, AV1E_SET_ZERO_COPY_INPUT, &zero_copy_input),
+            AOM_CODEC_OK);
+
+  aom_image_t img;
+  ASSERT_NE(aom_img_alloc(&img, AOM_IMG_FMT_I420, 64, 64, 32), nullptr);
+  memset(img.img_data, 128, img.sz);
+  aom_image_t small_img;
+  ASSERT_NE(aom_img_alloc(&small_img, AOM_IMG_FMT_I420, 32, 32, 32), nullptr);
+  memset(small_img.img_data, 128, small_img.sz);
+
+  // The wrong size.
+  small_img.user_priv = reinterpret_cast<void *>(0);
+  EXPECT_EQ(aom_codec_encode(&enc, &small_img, 0, 1, 0),
+            AOM_CODEC_INVALID_PARAM);
+  EXPECT_EQ(num_releases, std::vector<int>({ 1, 0, 0 }));
+  // A zero duration.
+  img.user_priv = reinterpret_cast<void *>(1);
+  EXPECT_EQ(aom_codec_encode(&enc, &img, 0, 0, 0), AOM_CODEC_INVALID_PARAM);
+  EXPECT_EQ(num_releases, std::vector<int>({ 1, 0, 0 }));
+  // A pts before the first one.
+  EXPECT_EQ(aom_codec_encode(&enc, &img, 1, 1, 0), AOM_CODEC_OK);
+  EXPECT_EQ(num_releases, std::vector<int>({ 1, 1, 0 }));
+  img.user_priv = reinterpret_cast<void *>(2);
+  EXPECT_EQ(aom_codec_encode(&enc, &img, 0, 1, 0), AOM_CODEC_INVALID_PARAM);
+  EXPECT_EQ(num_releases, std::vector<int>({ 1, 1, 1 }));
+
+  EXPECT_EQ(aom_codec_destroy(&enc), AOM_CODEC_OK);
+  EXPECT_EQ(num_releases, std::vector<int>({ 1, 1, 1 }));
+  aom_img_free(&small_img);
+  aom_img_free(&img);
+}
+
+}  // namespace